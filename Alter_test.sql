@@ -0,0 +1,94 @@
+--CS457 ALTER
+
+--Construct the database and table
+CREATE DATABASE CS457_ALTER;
+USE CS457_ALTER;
+CREATE TABLE Product (pid int, name varchar(20), price float);
+insert into Product values(1, 'Gizmo', 19.99);
+insert into Product values(2, 'PowerGizmo', 29.99);
+insert into Product values(3, 'SingleTouch', 149.99);
+
+--ADD gives old records the default
+ALTER TABLE Product ADD stock int DEFAULT 5, note varchar(10);
+insert into Product values(4, 'MultiTouch', 199.99, 0, 'new');
+select * from Product;
+
+--DROP and MODIFY change how records are read
+ALTER TABLE Product DROP note;
+ALTER TABLE Product MODIFY price int;
+select * from Product;
+ALTER TABLE Product DROP missing;
+ALTER TABLE Product RENAME name;
+
+--REWRITE writes the records out in the current schema
+ALTER TABLE Product REWRITE;
+update Product set stock = 7 where pid = 2;
+select * from Product;
+ALTER TABLE Product REWRITE FIXED;
+update Product set name = 'Gadget' where pid = 1;
+select * from Product;
+ALTER TABLE Product REWRITE COMPRESSED;
+delete from Product where pid = 3;
+select * from Product;
+ALTER TABLE Product REWRITE BLOOM (name);
+select pid from Product where name = 'Gadget';
+ALTER TABLE Product REWRITE VARIABLE;
+ALTER TABLE Product REWRITE SIDEWAYS;
+select * from Product;
+
+.exit
+
+-- Expected output
+--
+-- Database CS457_ALTER created.
+-- Using Database CS457_ALTER.
+-- Table Product created.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- Table Product modified.
+-- 1 new record inserted.
+-- pid int|name varchar(20)|price float|stock int|note varchar(10)
+-- 1|Gizmo|19.99|5|null
+-- 2|PowerGizmo|29.99|5|null
+-- 3|SingleTouch|149.99|5|null
+-- 4|MultiTouch|199.99|0|new
+-- Table Product modified.
+-- Table Product modified.
+-- pid int|name varchar(20)|price int|stock int
+-- 1|Gizmo|19|5
+-- 2|PowerGizmo|29|5
+-- 3|SingleTouch|149|5
+-- 4|MultiTouch|199|0
+-- !Failed to modify table Product because attribute missing does not exist.
+-- !Failed to modify table Product because RENAME is not a known change.
+-- Table Product rewritten.
+-- 1 record modified.
+-- pid int|name varchar(20)|price int|stock int
+-- 1|Gizmo|19|5
+-- 2|PowerGizmo|29|7
+-- 3|SingleTouch|149|5
+-- 4|MultiTouch|199|0
+-- Table Product rewritten.
+-- 1 record modified.
+-- pid int|name varchar(20)|price int|stock int
+-- 1|Gadget|19|5
+-- 2|PowerGizmo|29|7
+-- 3|SingleTouch|149|5
+-- 4|MultiTouch|199|0
+-- Table Product rewritten.
+-- 1 record deleted.
+-- pid int|name varchar(20)|price int|stock int
+-- 1|Gadget|19|5
+-- 2|PowerGizmo|29|7
+-- 4|MultiTouch|199|0
+-- Table Product rewritten.
+-- pid int
+-- 1
+-- Table Product rewritten.
+-- !Failed to rewrite table Product because SIDEWAYS is not a known option.
+-- pid int|name varchar(20)|price int|stock int
+-- 1|Gadget|19|5
+-- 2|PowerGizmo|29|7
+-- 4|MultiTouch|199|0
+-- All done.
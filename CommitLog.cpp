@@ -0,0 +1,670 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file CommitLog.cpp
+ *
+ * @brief Implementation file for the CommitLog class
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements the write-ahead log with group commit. A transaction
+ *          is written as a BEGIN line, one line per change and a COMMIT
+ *          line, and counts as committed once that COMMIT line is synced.
+ *          Opening the log redoes every committed transaction whose changes
+ *          may not have reached the disk
+ *
+ * @Note Requires CommitLog.h
+ */
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <cerrno>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <set>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "CommitLog.h"
+#include "StorageEngine.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef COMMITLOG_CPP
+#define COMMITLOG_CPP
+
+int checkpointIntervalOverride = 0;
+
+//false lets autocommits return before their records are synced
+bool syncCommitEnabled = true;
+
+/**
+ * @brief CommitLog default constructor
+ *
+ * @note None
+ */
+CommitLog::CommitLog()
+	: lastTransaction( 0 )
+{
+	fd = -1;
+	appendedSequence = 0;
+	flushedSequence = 0;
+	durableSize = 0;
+	flushing = false;
+	logFailed = false;
+	pendingSync = false;
+	unsynced = false;
+	closing = false;
+}
+
+/**
+ * @brief CommitLog destructor
+ *
+ * @details stops the sync thread and syncs what it had not synced yet
+ *
+ * @note None
+ */
+CommitLog::~CommitLog()
+{
+	{
+		lock_guard< mutex > guard( logLock );
+		closing = true;
+	}
+	syncerSignal.notify_all();
+	if( syncer.joinable() )
+	{
+		syncer.join();
+	}
+	if( fd >= 0 )
+	{
+		if( unsynced )
+		{
+			fdatasync( fd );
+		}
+		close( fd );
+	}
+}
+
+/**
+ * @brief open
+ *
+ * @details opens the log for appending, creating it if needed
+ *
+ * @par Algorithm committed transactions left in the log are redone first.
+ *      Once their tables are synced the log is emptied, otherwise the
+ *      highest transaction id still in it is found so new transactions
+ *      continue after it. With sync commit off a thread syncs the records
+ *      of autocommits shortly after they were written
+ *
+ * @param [in] string path - inside the DatabaseSystem directory
+ *
+ * @return bool false if the log could not be opened
+ *
+ * @note None
+ */
+bool CommitLog::open( string path )
+{
+	logPath = path;
+	systemPath = logPath.substr( 0, logPath.find_last_of( '/' ) );
+	bool recovered = recover();
+
+	fd = ::open( logPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644 );
+	if( fd < 0 )
+	{
+		return false;
+	}
+	if( !syncCommitEnabled )
+	{
+		syncer = thread( &CommitLog::syncLoop, this );
+	}
+	if( recovered && ftruncate( fd, 0 ) == 0 && fsync( fd ) == 0 )
+	{
+		return true;
+	}
+
+	ifstream fin( logPath.c_str() );
+	string line;
+	while( getline( fin, line ) )
+	{
+		if( line.compare( 0, 6, "BEGIN " ) == 0 && atol( line.c_str() + 6 ) > lastTransaction )
+		{
+			lastTransaction = atol( line.c_str() + 6 );
+		}
+	}
+	struct stat buffer;
+	durableSize = ( fstat( fd, &buffer ) == 0 ) ? buffer.st_size : 0;
+	return true;
+}
+
+/**
+ * @brief recover
+ *
+ * @details redoes the committed transactions found in the log
+ *
+ * @par Algorithm the lines of a transaction are contiguous, so a BEGIN
+ *      starts collecting records and the matching COMMIT redoes them. A
+ *      transaction cut off by a crash has no COMMIT and is skipped. A
+ *      REPLACE whose staged file is still there renames it over the table,
+ *      an INSERT is redone only if its record is not already in the file
+ *      and a WRITE puts its record back at its offset. A staged file holds
+ *      every earlier change to its table, so INSERT and WRITE records are
+ *      only redone after the last REPLACE of their table. Lines of other
+ *      kinds were logged by the storage engine of their table, which redoes
+ *      those after the last REPLACE once the others are redone. All of them are safe to redo any number of times
+ *
+ * @return bool true if every table redone was synced, the log is then no
+ *         longer needed
+ *
+ * @note None
+ */
+bool CommitLog::recover()
+{
+	ifstream fin( logPath.c_str() );
+	if( !fin.is_open() )
+	{
+		return true;
+	}
+
+	vector< long > transactions;
+	vector< vector< vector< string > > > committed;
+	vector< vector< string > > records;
+	map< string, int > lastReplaced;
+	long currentTransaction = -1;
+	string line;
+	while( getline( fin, line ) )
+	{
+		if( line.compare( 0, 6, "BEGIN " ) == 0 )
+		{
+			currentTransaction = atol( line.c_str() + 6 );
+			records.clear();
+		}
+		else if( line.compare( 0, 7, "COMMIT " ) == 0 && atol( line.c_str() + 7 ) == currentTransaction )
+		{
+			int recordSize = records.size();
+			for( int index = 0; index < recordSize; index++ )
+			{
+				if( records[ index ][ 0 ] == "REPLACE" )
+				{
+					lastReplaced[ systemPath + "/" + records[ index ][ 1 ] ] = committed.size();
+				}
+			}
+			transactions.push_back( currentTransaction );
+			committed.push_back( records );
+			currentTransaction = -1;
+		}
+		else if( currentTransaction >= 0 )
+		{
+			vector< string > fields = splitRow( line );
+			if( fields.size() > 1 )
+			{
+				records.push_back( fields );
+			}
+		}
+	}
+
+	set< string > redonePaths;
+	map< string, vector< vector< string > > > engineRecords;
+	int committedSize = committed.size();
+	for( int transaction = 0; transaction < committedSize; transaction++ )
+	{
+		vector< vector< string > > &redoRecords = committed[ transaction ];
+		int recordSize = redoRecords.size();
+		for( int index = 0; index < recordSize; index++ )
+		{
+			string tableFilePath = systemPath + "/" + redoRecords[ index ][ 1 ];
+			map< string, int >::iterator replaced = lastReplaced.find( tableFilePath );
+			bool superseded = ( replaced != lastReplaced.end() && replaced->second >= transaction );
+			if( redoRecords[ index ][ 0 ] == "REPLACE" )
+			{
+				string stagedPath = getWorkPath( tableFilePath, "txn" + to_string( transactions[ transaction ] ) );
+				if( access( stagedPath.c_str(), F_OK ) == 0 )
+				{
+					rename( stagedPath.c_str(), tableFilePath.c_str() );
+				}
+				redonePaths.insert( tableFilePath );
+			}
+			else if( redoRecords[ index ][ 0 ] == "INSERT" && redoRecords[ index ].size() > 2 && !superseded )
+			{
+				redoInsert( tableFilePath, redoRecords[ index ] );
+				redonePaths.insert( tableFilePath );
+			}
+			else if( redoRecords[ index ][ 0 ] == "WRITE" && redoRecords[ index ].size() > 3 && !superseded )
+			{
+				redoWrite( tableFilePath, redoRecords[ index ] );
+				redonePaths.insert( tableFilePath );
+			}
+			else if( redoRecords[ index ][ 0 ] != "INSERT" && redoRecords[ index ][ 0 ] != "WRITE" &&
+				redoRecords[ index ][ 0 ] != "UPDATE" && redoRecords[ index ][ 0 ] != "DELETE" && !superseded )
+			{
+				engineRecords[ tableFilePath ].push_back( redoRecords[ index ] );
+			}
+		}
+	}
+	for( map< string, vector< vector< string > > >::iterator it = engineRecords.begin(); it != engineRecords.end(); ++it )
+	{
+		TableScan scan;
+		if( scan.scanOpen( it->first ) && !getStorageEngine( scan ).redo( scan, it->second ) )
+		{
+			cout << "-- !Failed to redo changes to " << it->first.substr( systemPath.size() + 1 ) << "." << endl;
+		}
+		redonePaths.insert( it->first );
+	}
+
+	bool synced = true;
+	for( set< string >::iterator it = redonePaths.begin(); it != redonePaths.end(); ++it )
+	{
+		struct stat buffer;
+		if( stat( it->c_str(), &buffer ) == 0 )
+		{
+			synced = syncFile( *it ) && syncDirectory( *it ) && synced;
+		}
+	}
+	return synced;
+}
+
+/**
+ * @brief redoInsert
+ *
+ * @details puts a logged record back at the end of its table
+ *
+ * @par Algorithm inserts reach a table in log order, so the file ends at
+ *      the logged offset before the record and past it afterwards. A file
+ *      that already holds the whole record is left alone, a torn record is
+ *      cut off and written again
+ *
+ * @param [in] string tableFilePath
+ *
+ * @param [in] vector< string > &fields - INSERT, table, offset, values
+ *
+ * @return None
+ *
+ * @note None
+ */
+void CommitLog::redoInsert( string tableFilePath, vector< string > &fields )
+{
+	long insertOffset = atol( fields[ 2 ].c_str() );
+	string contentStr = "\n" + joinRow( vector< string >( fields.begin() + 3, fields.end() ) );
+
+	int tableFd = ::open( tableFilePath.c_str(), O_RDWR );
+	struct stat buffer;
+	if( tableFd < 0 || fstat( tableFd, &buffer ) != 0 )
+	{
+		if( tableFd >= 0 )
+		{
+			close( tableFd );
+		}
+		return;
+	}
+
+	long tableSize = buffer.st_size;
+	if( tableSize < insertOffset + (long) contentStr.size() )
+	{
+		if( tableSize > insertOffset && ftruncate( tableFd, insertOffset ) == 0 )
+		{
+			tableSize = insertOffset;
+		}
+		if( pwrite( tableFd, contentStr.c_str(), contentStr.size(), tableSize ) != (long) contentStr.size() )
+		{
+			cout << "-- !Failed to redo insert into " << fields[ 1 ] << "." << endl;
+		}
+	}
+	close( tableFd );
+}
+
+/**
+ * @brief redoWrite
+ *
+ * @details puts a logged record back at its place in a fixed width table
+ *
+ * @param [in] string tableFilePath
+ *
+ * @param [in] vector< string > &fields - WRITE, table, offset, values
+ *
+ * @return None
+ *
+ * @note writing the record again leaves the table as it was. The zone map is
+ *       dropped and built again by the next checkpoint
+ */
+void CommitLog::redoWrite( string tableFilePath, vector< string > &fields )
+{
+	map< long, string > writes;
+	writes[ atol( fields[ 2 ].c_str() ) ] = joinRow( vector< string >( fields.begin() + 3, fields.end() ) );
+
+	//the zones may not have been widened to the record
+	unlink( getWorkPath( tableFilePath, ZONES_SUFFIX ).c_str() );
+	if( !writeRecords( tableFilePath, writes ) )
+	{
+		cout << "-- !Failed to redo write to " << fields[ 1 ] << "." << endl;
+	}
+}
+
+/**
+ * @brief nextTransaction
+ *
+ * @return long id for a new transaction
+ *
+ * @note None
+ */
+long CommitLog::nextTransaction()
+{
+	return ++lastTransaction;
+}
+
+/**
+ * @brief append
+ *
+ * @details adds the records of one transaction and waits until they are durable
+ *
+ * @par Algorithm records are queued behind those of other committers. If no
+ *      flush is running the caller becomes the leader: it takes everything
+ *      queued so far, writes it and syncs it once, then wakes every
+ *      committer whose records were in that batch. Others wait for the
+ *      leader, so many commits cost one fsync. With sync commit off a batch
+ *      of autocommits is only written, and the sync thread syncs it within
+ *      SYNC_COMMIT_DELAY. A batch holding an explicit COMMIT is always
+ *      synced, which also syncs every batch written before it
+ *
+ * @param [in] string records - complete lines, BEGIN to COMMIT
+ *
+ * @param [in] bool autocommit - true for a statement run outside BEGIN and
+ *             COMMIT
+ *
+ * @return bool false if the log could not be written
+ *
+ * @note after a failed write the log accepts no further commits. A crash of
+ *       the machine may lose the autocommits of the last SYNC_COMMIT_DELAY
+ *       when sync commit is off, never part of one
+ */
+bool CommitLog::append( string records, bool autocommit )
+{
+	unique_lock< mutex > guard( logLock );
+	if( fd < 0 || logFailed )
+	{
+		return false;
+	}
+
+	pendingRecords += records;
+	pendingSync = pendingSync || !autocommit || syncCommitEnabled;
+	long sequence = ++appendedSequence;
+	while( flushedSequence < sequence && !logFailed )
+	{
+		if( flushing )
+		{
+			flushDone.wait( guard );
+			continue;
+		}
+
+		flushing = true;
+		string batch;
+		batch.swap( pendingRecords );
+		long batchSequence = appendedSequence;
+		bool syncBatch = pendingSync;
+		pendingSync = false;
+		guard.unlock();
+
+		bool written = true;
+		size_t offset = 0;
+		while( written && offset < batch.size() )
+		{
+			ssize_t count = write( fd, batch.data() + offset, batch.size() - offset );
+			if( count < 0 && errno == EINTR )
+			{
+				continue;
+			}
+			written = ( count > 0 );
+			offset += ( count > 0 ) ? count : 0;
+		}
+		written = written && ( !syncBatch || fdatasync( fd ) == 0 );
+
+		guard.lock();
+		flushing = false;
+		logFailed = !written;
+		unsynced = !syncBatch;
+		durableSize += written ? batch.size() : 0;
+		flushedSequence = batchSequence;
+		flushDone.notify_all();
+	}
+	return !logFailed;
+}
+
+/**
+ * @brief syncLoop
+ *
+ * @details body of the thread that syncs the records of autocommits when
+ *          sync commit is off
+ *
+ * @par Algorithm wakes every SYNC_COMMIT_DELAY and, if records were written
+ *      without a sync, takes the place of a flush leader so no batch is
+ *      written while it syncs
+ *
+ * @return None
+ *
+ * @note None
+ */
+void CommitLog::syncLoop()
+{
+	unique_lock< mutex > guard( logLock );
+	while( !syncerSignal.wait_for( guard, chrono::milliseconds( SYNC_COMMIT_DELAY ), [ this ]() { return closing; } ) )
+	{
+		if( !unsynced || flushing || logFailed )
+		{
+			continue;
+		}
+		flushing = true;
+		guard.unlock();
+		bool synced = fdatasync( fd ) == 0;
+		guard.lock();
+		flushing = false;
+		logFailed = !synced;
+		unsynced = false;
+		flushDone.notify_all();
+	}
+}
+
+/**
+ * @brief getDurableSize
+ *
+ * @return long bytes of the log that are written, always whole
+ *         transactions. With sync commit off the last of them may not be
+ *         synced yet
+ *
+ * @note None
+ */
+long CommitLog::getDurableSize()
+{
+	lock_guard< mutex > guard( logLock );
+	return durableSize;
+}
+
+/**
+ * @brief truncate
+ *
+ * @details drops the start of the log once a checkpoint made it unnecessary
+ *
+ * @par Algorithm commits are held off as if a flush was running. The part of
+ *      the log written after the checkpoint began is copied to a new file
+ *      which is synced and renamed over the log
+ *
+ * @param [in] long checkpointSize - durable size when the checkpoint began
+ *
+ * @return bool true if the log was trimmed
+ *
+ * @note None
+ */
+bool CommitLog::truncate( long checkpointSize )
+{
+	unique_lock< mutex > guard( logLock );
+	while( flushing )
+	{
+		flushDone.wait( guard );
+	}
+	if( fd < 0 || logFailed || checkpointSize <= 0 )
+	{
+		return false;
+	}
+	flushing = true;
+	long keptSize = durableSize - checkpointSize;
+	guard.unlock();
+
+	string tempPath = logPath + ".tmp";
+	int readFd = ::open( logPath.c_str(), O_RDONLY );
+	int tempFd = ::open( tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	bool trimmed = ( readFd >= 0 && tempFd >= 0 );
+	vector< char > buffer( READ_BLOCK_SIZE );
+	long offset = checkpointSize;
+	while( trimmed && offset < checkpointSize + keptSize )
+	{
+		long bytesRead = pread( readFd, &buffer[ 0 ], min( (long) buffer.size(), checkpointSize + keptSize - offset ), offset );
+		trimmed = ( bytesRead > 0 ) && write( tempFd, &buffer[ 0 ], bytesRead ) == bytesRead;
+		offset += ( bytesRead > 0 ) ? bytesRead : 0;
+	}
+	trimmed = trimmed && fsync( tempFd ) == 0;
+	if( readFd >= 0 )
+	{
+		close( readFd );
+	}
+	if( tempFd >= 0 )
+	{
+		close( tempFd );
+	}
+
+	int newFd = -1;
+	if( trimmed && rename( tempPath.c_str(), logPath.c_str() ) == 0 )
+	{
+		syncDirectory( logPath );
+		newFd = ::open( logPath.c_str(), O_WRONLY | O_APPEND );
+	}
+	else
+	{
+		unlink( tempPath.c_str() );
+	}
+
+	guard.lock();
+	if( newFd >= 0 )
+	{
+		close( fd );
+		fd = newFd;
+		durableSize -= checkpointSize;
+		unsynced = false;
+	}
+	flushing = false;
+	flushDone.notify_all();
+	return newFd >= 0;
+}
+
+/**
+ * @brief Checkpointer default constructor
+ *
+ * @note None
+ */
+Checkpointer::Checkpointer()
+{
+	stopping = false;
+}
+
+/**
+ * @brief Checkpointer destructor
+ *
+ * @details stops the checkpoint thread after a last checkpoint
+ *
+ * @note None
+ */
+Checkpointer::~Checkpointer()
+{
+	stop();
+}
+
+/**
+ * @brief start
+ *
+ * @details starts the thread that checkpoints on a fixed interval
+ *
+ * @param [in] function< void() > checkpoint
+ *
+ * @return None
+ *
+ * @note the interval bounds how much log a restart has to redo
+ */
+void Checkpointer::start( function< void() > checkpoint )
+{
+	runCheckpoint = checkpoint;
+	stopping = false;
+	int interval = ( checkpointIntervalOverride > 0 ) ? checkpointIntervalOverride : DEFAULT_CHECKPOINT_INTERVAL;
+	worker = thread( [ this, interval ]()
+	{
+		unique_lock< mutex > guard( checkpointerLock );
+		while( !stopSignal.wait_for( guard, chrono::seconds( interval ), [ this ]() { return stopping; } ) )
+		{
+			guard.unlock();
+			runCheckpoint();
+			guard.lock();
+		}
+	} );
+}
+
+/**
+ * @brief stop
+ *
+ * @details ends the checkpoint thread and takes a last checkpoint, so a
+ *          clean shutdown leaves nothing to redo
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Checkpointer::stop()
+{
+	if( !worker.joinable() )
+	{
+		return;
+	}
+	{
+		lock_guard< mutex > guard( checkpointerLock );
+		stopping = true;
+	}
+	stopSignal.notify_all();
+	worker.join();
+	runCheckpoint();
+}
+
+/**
+ * @brief setCheckpointInterval
+ *
+ * @details sets the seconds between checkpoints of catalogs opened later
+ *
+ * @param [in] int seconds - 0 keeps the default
+ *
+ * @return None
+ *
+ * @note None
+ */
+void setCheckpointInterval( int seconds )
+{
+	checkpointIntervalOverride = seconds;
+}
+
+/**
+ * @brief setSyncCommit
+ *
+ * @details sets whether autocommits of catalogs opened later wait for
+ *          their records to be synced
+ *
+ * @param [in] bool enabled - false syncs them within SYNC_COMMIT_DELAY,
+ *             explicit COMMITs are synced either way
+ *
+ * @return None
+ *
+ * @note None
+ */
+void setSyncCommit( bool enabled )
+{
+	syncCommitEnabled = enabled;
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
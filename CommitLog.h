@@ -0,0 +1,93 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file CommitLog.h
+ *
+ * @brief Definition file for the CommitLog class
+ *
+ * @details Specifies the write-ahead log that makes a transaction durable
+ *          before its changes reach the table files. Transactions that
+ *          commit at the same time share one write and one fsync. The log is
+ *          replayed when it is opened and trimmed by periodic checkpoints
+ *
+ * @Note None
+ */
+
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef COMMITLOG_H
+#define COMMITLOG_H
+
+//name of the log file inside the DatabaseSystem directory
+const string COMMIT_LOG_NAME = ".wal";
+
+//seconds of log kept between checkpoints unless overridden
+const int DEFAULT_CHECKPOINT_INTERVAL = 30;
+
+//milliseconds an autocommit may stay unsynced when sync commit is off
+const int SYNC_COMMIT_DELAY = 200;
+
+class CommitLog{
+	public:
+		CommitLog();
+		~CommitLog();
+		bool open( string path );
+		long nextTransaction();
+		bool append( string records, bool autocommit );
+		long getDurableSize();
+		bool truncate( long checkpointSize );
+
+	private:
+		string logPath;
+		string systemPath;
+		int fd;
+		atomic< long > lastTransaction;
+		mutex logLock;
+		condition_variable flushDone;
+		string pendingRecords;
+		long appendedSequence;
+		long flushedSequence;
+		long durableSize;
+		bool flushing;
+		bool logFailed;
+		bool pendingSync;
+		bool unsynced;
+		thread syncer;
+		condition_variable syncerSignal;
+		bool closing;
+
+		bool recover();
+		void syncLoop();
+		void redoInsert( string tableFilePath, vector< string > &fields );
+		void redoWrite( string tableFilePath, vector< string > &fields );
+};
+
+//runs a checkpoint every interval until it is stopped
+class Checkpointer{
+	public:
+		Checkpointer();
+		~Checkpointer();
+		void start( function< void() > checkpoint );
+		void stop();
+
+	private:
+		function< void() > runCheckpoint;
+		thread worker;
+		mutex checkpointerLock;
+		condition_variable stopSignal;
+		bool stopping;
+};
+
+void setCheckpointInterval( int seconds );
+void setSyncCommit( bool enabled );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,2380 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file Connection.cpp
+ *
+ * @brief Implementation file for the Connection, Statement and ResultSet classes
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements the embeddable API. The catalog of databases and
+ *          tables is read once when the connection is opened and kept for
+ *          every statement executed on it
+ *
+ * @Note Requires Connection.h, statements are run by startEvent in sim.cpp
+ */
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <memory>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include "Connection.h"
+#include "PreparedStatement.h"
+#include "LockManager.h"
+#include "CommitLog.h"
+#include "ResultCache.h"
+#include "StorageEngine.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef CONNECTION_CPP
+#define CONNECTION_CPP
+
+//ALTER TABLE ... REWRITE BACKGROUND running on its own thread, which sets
+//finished as its last step so the thread can be joined
+struct BackgroundRewrite{
+	thread worker;
+	atomic< bool > finished;
+};
+
+//databases and tables found in the DatabaseSystem directory, shared by
+//every connection opened on it. The checkpointer is declared last so it
+//stops before anything it checkpoints is destroyed, background rewrites
+//are waited for before that. Unique indexes are kept per table file for
+//the version they were built at
+struct Catalog{
+	vector< Database > dbms;
+	long catalogVersion;
+	LockManager locks;
+	CommitLog commitLog;
+	shared_ptr< ResultCache > resultCache;
+	mutex checkpointLock;
+	mutex dirtyLock;
+	set< string > dirtyTables;
+	mutex rewriterLock;
+	vector< shared_ptr< BackgroundRewrite > > rewriters;
+	mutex rewritingLock;
+	mutex uniqueLock;
+	map< string, shared_ptr< UniqueIndex > > uniqueIndexes;
+	Checkpointer checkpointer;
+
+	~Catalog()
+	{
+		lock_guard< mutex > guard( rewriterLock );
+		for( unsigned int index = 0; index < rewriters.size(); index++ )
+		{
+			rewriters[ index ]->worker.join();
+		}
+		rewriters.clear();
+	}
+};
+
+//a transaction between its statements being resolved and applied. Each
+//table it writes is staged, updated in place or only appended to, and
+//messages and failures hold what each statement reported
+struct PendingCommit{
+	vector< shared_ptr< PreparedStatement > > statements;
+	vector< string > statementTables;
+	set< string > tableFilePaths;
+	set< string > stagedTables;
+	set< string > inPlaceTables;
+	map< string, shared_ptr< map< long, string > > > tableWrites;
+	map< string, shared_ptr< UniqueIndex > > uniqueIndexes;
+	long transaction;
+	string stagedSuffix;
+	vector< string > messages;
+	vector< bool > failures;
+};
+
+//optimistic attempts of ALTER TABLE ... REWRITE before it blocks writers
+const int REWRITE_ATTEMPTS = 3;
+
+//record layout asked for by ALTER TABLE ... REWRITE
+const int FORMAT_KEEP = 0;
+const int FORMAT_FIXED = 1;
+const int FORMAT_VARIABLE = 2;
+const int FORMAT_COMPRESSED = 3;
+
+bool startEvent( string input, vector< Database > &dbms, string currentWorkingDirectory, string &currentDatabase, bool &errorCode, ostream &out, shared_ptr< Operator > &plan );
+bool prepareStatement( string input, vector< Database > &dbms, string currentWorkingDirectory, string currentDatabase, PreparedStatement &prepared, int &errorType, string &errorContainerName );
+void handleError( int errorType, string commandError, string errorContainerName, ostream &out );
+bool compactTable( Catalog &catalog, string tableFilePath, function< int() > compaction );
+bool stringValid( string str );
+void reapRewriters( Catalog &catalog );
+void removeNewLine( string &input );
+void convertToUC( string &input );
+void convertToLC( string &input );
+string getNextWord( string &input );
+
+/**
+ * @brief normalizeStatement
+ *
+ * @details prepares statement text for parsing
+ *
+ * @par Algorithm newlines become spaces and the surrounding white space and
+ *      closing semicolon are removed
+ *
+ * @param [in] string &sql
+ *
+ * @return bool false if nothing is left of the statement
+ *
+ * @note None
+ */
+bool normalizeStatement( string &sql )
+{
+	removeNewLine( sql );
+	size_t first = sql.find_first_not_of( " \t\r" );
+	size_t last = sql.find_last_not_of( " \t\r;" );
+	if( first == string::npos || last == string::npos || last < first )
+	{
+		return false;
+	}
+	sql = sql.substr( first, last - first + 1 );
+	return stringValid( sql );
+}
+
+/**
+ * @brief read_Directory method
+ *
+ * @details reads contents of a directory into a vector
+ *
+ * @param [in] string &name
+ *
+ * @param [in] vector <string &v>
+ *
+ * @return bool
+ *
+ * @note Code from stack overflow
+ */
+bool read_directory(const std::string& name, vector< string >& v)
+{
+	struct stat buffer;
+	if( !( stat( name.c_str(), &buffer ) == 0 ) )
+		return false;
+
+    DIR* dirp = opendir(name.c_str());
+    struct dirent * dp;
+    while ((dp = readdir(dirp)) != NULL) {
+        v.push_back(dp->d_name);
+    }
+    closedir(dirp);
+
+    return true;
+}
+
+/**
+ * @brief isWorkFile
+ *
+ * @details tells a work file left by an interrupted write from other hidden
+ *          files next to the tables
+ *
+ * @param [in] string name - directory entry
+ *
+ * @return bool true for .table.tmp, .table.alter, .table.rewrite,
+ *         .table.partN and .table.txnN entries
+ *
+ * @note None
+ */
+bool isWorkFile( string name )
+{
+	size_t dotIndex = name.find_last_of( '.' );
+	if( name.empty() || name[ 0 ] != '.' || dotIndex == 0 || dotIndex == string::npos )
+	{
+		return false;
+	}
+	string suffix = name.substr( dotIndex + 1 );
+	return suffix == "tmp" || suffix == "alter" || suffix == "rewrite" ||
+		( suffix.compare( 0, 4, "part" ) == 0 && suffix.size() > 4 && isdigit( suffix[ 4 ] ) ) ||
+		( suffix.compare( 0, 3, "txn" ) == 0 && suffix.size() > 3 && isdigit( suffix[ 3 ] ) );
+}
+
+/**
+ * @brief checkpointCatalog
+ *
+ * @details makes the tables changed since the last checkpoint durable and
+ *          drops the log that led up to them
+ *
+ * @par Algorithm the durable size of the log is taken first. A committer
+ *      marks its tables changed before its records are logged, so every
+ *      transaction logged before that point has its tables in the set taken
+ *      next. Each table is synced under its shared lock, which waits for a
+ *      committer still applying changes to it. Transactions logged after
+ *      the checkpoint began stay in the log. Writers are only held up while
+ *      their own table is synced and its storage engine brings what it
+ *      keeps next to it up to date, under the exclusive lock if the engine
+ *      writes to the table
+ *
+ * @param [in] Catalog &catalog
+ *
+ * @return bool true if the log was dropped up to where the checkpoint
+ *         began, false if a table was not made durable and the log kept
+ *
+ * @note None
+ */
+bool checkpointCatalog( Catalog &catalog )
+{
+	lock_guard< mutex > guard( catalog.checkpointLock );
+	long checkpointSize = catalog.commitLog.getDurableSize();
+	set< string > tableFilePaths;
+	{
+		lock_guard< mutex > dirtyGuard( catalog.dirtyLock );
+		tableFilePaths.swap( catalog.dirtyTables );
+	}
+
+	bool synced = true;
+	for( set< string >::iterator it = tableFilePaths.begin(); it != tableFilePaths.end(); ++it )
+	{
+		TableScan scan;
+		bool exclusive = scan.scanOpen( *it ) && getStorageEngine( scan ).writesAtCheckpoint();
+		LockSet tableLocks;
+		if( exclusive )
+		{
+			tableLocks.lockExclusive( catalog.locks.getTableLock( *it ) );
+		}
+		else
+		{
+			tableLocks.lockShared( catalog.locks.getTableLock( *it ) );
+		}
+		struct stat buffer;
+		if( stat( it->c_str(), &buffer ) == 0 )
+		{
+			synced = syncFile( *it ) && syncDirectory( *it ) && synced;
+			if( !scan.scanOpen( *it ) )
+			{
+				continue;
+			}
+
+			//a table created again with an engine that writes at checkpoints
+			//is left to the next one
+			StorageEngine &engine = getStorageEngine( scan );
+			if( engine.writesAtCheckpoint() && !exclusive )
+			{
+				synced = false;
+				continue;
+			}
+			synced = compactTable( catalog, *it, [ & ]()
+			{
+				return engine.checkpoint( scan );
+			} ) && synced;
+		}
+	}
+
+	if( !synced )
+	{
+		lock_guard< mutex > dirtyGuard( catalog.dirtyLock );
+		catalog.dirtyTables.insert( tableFilePaths.begin(), tableFilePaths.end() );
+		return false;
+	}
+
+	//a log holding nothing from before the checkpoint is left as it is
+	return checkpointSize <= 0 || catalog.commitLog.truncate( checkpointSize );
+}
+
+/**
+ * @brief reapRewriters
+ *
+ * @details joins the threads of background rewrites that have finished, so
+ *          a long running catalog does not keep one per rewrite
+ *
+ * @param [in] Catalog &catalog
+ *
+ * @return None
+ *
+ * @note None
+ */
+void reapRewriters( Catalog &catalog )
+{
+	lock_guard< mutex > guard( catalog.rewriterLock );
+	for( unsigned int index = 0; index < catalog.rewriters.size(); )
+	{
+		if( catalog.rewriters[ index ]->finished )
+		{
+			catalog.rewriters[ index ]->worker.join();
+			catalog.rewriters.erase( catalog.rewriters.begin() + index );
+		}
+		else
+		{
+			index++;
+		}
+	}
+}
+
+/**
+ * @brief syncDatabaseSystem
+ *
+ * @details syncs every table file and directory of the DatabaseSystem
+ *
+ * @param [in] string systemPath
+ *
+ * @return None
+ *
+ * @note used after a schema change, which is not logged
+ */
+void syncDatabaseSystem( string systemPath )
+{
+	vector< string > directoryItems;
+	read_directory( systemPath, directoryItems );
+	for( unsigned int i = 0; i < directoryItems.size(); i++ )
+	{
+		if( directoryItems[i][0] == '.' )
+		{
+			continue;
+		}
+
+		string databasePath = systemPath + "/" + directoryItems[i];
+		vector< string > tableItems;
+		read_directory( databasePath, tableItems );
+		for( unsigned int j = 0; j < tableItems.size(); j++ )
+		{
+			if( tableItems[j][0] != '.' )
+			{
+				syncFile( databasePath + "/" + tableItems[j] );
+			}
+		}
+		syncFile( databasePath );
+	}
+	syncFile( systemPath );
+}
+
+/**
+ * @brief getUniqueIndex
+ *
+ * @details gives the unique index of a table as last committed
+ *
+ * @par Algorithm an index built at the current versions of the table and
+ *      the catalog is taken as it is, otherwise the storage engine of the
+ *      table builds it again. Indexes of older catalog versions are dropped
+ *      with it
+ *
+ * @param [in] Catalog &catalog
+ *
+ * @param [in] string tableFilePath
+ *
+ * @return shared_ptr< UniqueIndex > NULL if the table cannot be read
+ *
+ * @note the caller holds the table lock exclusively
+ */
+shared_ptr< UniqueIndex > getUniqueIndex( Catalog &catalog, string tableFilePath )
+{
+	long tableVersion = catalog.locks.getTableVersion( tableFilePath );
+	{
+		lock_guard< mutex > guard( catalog.uniqueLock );
+		map< string, shared_ptr< UniqueIndex > >::iterator it = catalog.uniqueIndexes.find( tableFilePath );
+		if( it != catalog.uniqueIndexes.end() && it->second->tableVersion == tableVersion &&
+			it->second->catalogVersion == catalog.catalogVersion )
+		{
+			return it->second;
+		}
+	}
+
+	TableScan scan;
+	if( !scan.scanOpen( tableFilePath ) )
+	{
+		return NULL;
+	}
+	shared_ptr< UniqueIndex > index( new UniqueIndex );
+	getStorageEngine( scan ).buildUniqueIndex( scan, *index );
+	index->tableVersion = tableVersion;
+	index->catalogVersion = catalog.catalogVersion;
+
+	lock_guard< mutex > guard( catalog.uniqueLock );
+	for( map< string, shared_ptr< UniqueIndex > >::iterator it = catalog.uniqueIndexes.begin(); it != catalog.uniqueIndexes.end(); )
+	{
+		if( it->second->catalogVersion != catalog.catalogVersion )
+		{
+			catalog.uniqueIndexes.erase( it++ );
+		}
+		else
+		{
+			++it;
+		}
+	}
+	catalog.uniqueIndexes[ tableFilePath ] = index;
+	return index;
+}
+
+/**
+ * @brief compactTable
+ *
+ * @details runs a step of a table's storage engine that may rewrite the
+ *          table file
+ *
+ * @par Algorithm a table file the step rewrote gets a new version. It holds
+ *      the same records as before, so a unique index of the old version is
+ *      taken over
+ *
+ * @param [in] Catalog &catalog
+ *
+ * @param [in] string tableFilePath
+ *
+ * @param [in] function< int() > compaction - the step, -1 if it failed, 1
+ *             if it rewrote the table file, otherwise 0
+ *
+ * @return bool false if the step failed
+ *
+ * @note the caller holds the table lock exclusively, or shared for a step
+ *       that does not write
+ */
+bool compactTable( Catalog &catalog, string tableFilePath, function< int() > compaction )
+{
+	long tableVersion = catalog.locks.getTableVersion( tableFilePath );
+	int compacted = compaction();
+	if( compacted > 0 )
+	{
+		catalog.locks.commitTableVersion( tableFilePath );
+		lock_guard< mutex > guard( catalog.uniqueLock );
+		map< string, shared_ptr< UniqueIndex > >::iterator it = catalog.uniqueIndexes.find( tableFilePath );
+		if( it != catalog.uniqueIndexes.end() && it->second->tableVersion == tableVersion )
+		{
+			it->second->tableVersion = catalog.locks.getTableVersion( tableFilePath );
+		}
+	}
+	return compacted >= 0;
+}
+
+/**
+ * @brief rewriteTable
+ *
+ * @details physically applies the columns dropped, modified and added since
+ *          the table file was written, after which its schema file is gone.
+ *          The dictionaries of its encoded columns are built again, so
+ *          values written since the last rewrite are coded too
+ *
+ * @par Algorithm the table is compacted from a snapshot into a work file
+ *      while readers and writers carry on. The work file then replaces the
+ *      table under the exclusive catalog lock, but only if neither the
+ *      schema nor the table changed in the meantime, otherwise it is thrown
+ *      away and the table compacted again. The last attempt holds the
+ *      exclusive catalog lock throughout, like any other schema change, so
+ *      a busy table is still rewritten. A table whose storage engine keeps
+ *      records outside the file goes straight to that attempt and has them
+ *      merged into the file first. The commit log is checkpointed before
+ *      the swap and the table kept if that fails. Rewrites run one at a
+ *      time, as a table has one work file
+ *
+ * @param [in] Catalog &catalog
+ *
+ * @param [in] string tableFilePath
+ *
+ * @param [in] string tableName - name used in messages
+ *
+ * @param [in] int tableFormat - FORMAT_FIXED, FORMAT_VARIABLE or
+ *             FORMAT_COMPRESSED changes the record layout, FORMAT_KEEP
+ *             keeps it
+ *
+ * @param [in] vector< string > bloomColumns - columns whose zones get a
+ *             Bloom filter
+ *
+ * @param [in] bool bloomChanged - false keeps the columns of the table
+ *
+ * @param [out] bool &errorCode - set if the table was not rewritten
+ *
+ * @param [in] ostream &out
+ *
+ * @return None
+ *
+ * @note None
+ */
+void rewriteTable( Catalog &catalog, string tableFilePath, string tableName, int tableFormat,
+	vector< string > bloomColumns, bool bloomChanged, bool &errorCode, ostream &out )
+{
+	lock_guard< mutex > rewritingGuard( catalog.rewritingLock );
+	string workPath = getWorkPath( tableFilePath, "rewrite" );
+	TableScan mergeScan;
+	bool merging = mergeScan.scanOpen( tableFilePath ) && getStorageEngine( mergeScan ).needsBlockingRewrite();
+	for( int attempt = merging ? REWRITE_ATTEMPTS - 1 : 0; attempt < REWRITE_ATTEMPTS; attempt++ )
+	{
+		bool blocking = ( attempt == REWRITE_ATTEMPTS - 1 );
+		LockSet locks;
+		TableScan scan;
+		long catalogVersion = 0;
+		long tableVersion = 0;
+		bool opened;
+		if( blocking )
+		{
+			locks.lockExclusive( catalog.locks.getCatalogLock() );
+			if( merging && mergeScan.scanOpen( tableFilePath ) )
+			{
+				StorageEngine &engine = getStorageEngine( mergeScan );
+				if( !compactTable( catalog, tableFilePath, [ & ]()
+				{
+					return engine.mergeRecords( mergeScan );
+				} ) )
+				{
+					errorCode = true;
+					out << "-- !Failed to rewrite table " << tableName << "." << endl;
+					return;
+				}
+			}
+			opened = scan.scanOpen( tableFilePath );
+		}
+		else
+		{
+			LockSet readLocks;
+			readLocks.lockShared( catalog.locks.getCatalogLock() );
+			catalogVersion = catalog.catalogVersion;
+			readLocks.lockShared( catalog.locks.getTableLock( tableFilePath ) );
+			tableVersion = catalog.locks.getTableVersion( tableFilePath );
+			opened = scan.scanOpen( tableFilePath ) && scan.snapshotOpen( tableVersion, shared_ptr< atomic< int > >() );
+		}
+
+		string schemaPath = getWorkPath( tableFilePath, SCHEMA_SUFFIX );
+		for( unsigned int index = 0; opened && bloomChanged && index < bloomColumns.size(); index++ )
+		{
+			int attributeIndex = 0;
+			int attributeSize = scan.attributes.size();
+			while( attributeIndex < attributeSize && scan.attributes[ attributeIndex ].attributeName != bloomColumns[ index ] )
+			{
+				attributeIndex++;
+			}
+			if( attributeIndex == attributeSize || getValueType( scan.attributes[ attributeIndex ].attributeType ) == TYPE_FLOAT )
+			{
+				errorCode = true;
+				out << "-- !Failed to rewrite table " << tableName << " because column " << bloomColumns[ index ] <<
+					" cannot have a Bloom filter." << endl;
+				return;
+			}
+		}
+		if( bloomChanged )
+		{
+			scan.bloomColumns = bloomColumns;
+		}
+		bool fixedWidth = ( tableFormat == FORMAT_KEEP ) ? scan.recordWidth > 0 : tableFormat == FORMAT_FIXED;
+		bool compressedPages = ( tableFormat == FORMAT_KEEP ) ? scan.compressed : tableFormat == FORMAT_COMPRESSED;
+		if( !opened || !scan.compactTo( workPath, fixedWidth, compressedPages ) )
+		{
+			unlink( workPath.c_str() );
+			errorCode = true;
+			out << "-- !Failed to rewrite table " << tableName;
+			if( opened && fixedWidth )
+			{
+				out << " because a record is longer than its fixed width";
+			}
+			out << "." << endl;
+			return;
+		}
+
+		if( !blocking )
+		{
+			locks.lockExclusive( catalog.locks.getCatalogLock() );
+			if( catalogVersion != catalog.catalogVersion || tableVersion != catalog.locks.getTableVersion( tableFilePath ) )
+			{
+				unlink( workPath.c_str() );
+				continue;
+			}
+		}
+
+		//logged inserts refer to offsets in the file being replaced, which
+		//recovery would append again to the rewritten one
+		if( !checkpointCatalog( catalog ) )
+		{
+			unlink( workPath.c_str() );
+			errorCode = true;
+			out << "-- !Failed to rewrite table " << tableName << " because the commit log could not be checkpointed." << endl;
+			return;
+		}
+		if( rename( workPath.c_str(), tableFilePath.c_str() ) != 0 )
+		{
+			unlink( workPath.c_str() );
+			errorCode = true;
+			out << "-- !Failed to rewrite table " << tableName << "." << endl;
+			return;
+		}
+		unlink( schemaPath.c_str() );
+		syncDirectory( tableFilePath );
+
+		//statements resolved against the schema file must be resolved again
+		catalog.catalogVersion++;
+		catalog.locks.commitTableVersion( tableFilePath );
+		out << "-- Table " << tableName << " rewritten." << endl;
+		return;
+	}
+}
+
+/**
+ * @brief ResultSet default constructor
+ *
+ * @details creates a result with no rows and no message
+ *
+ * @note None
+ */
+ResultSet::ResultSet()
+{
+	opened = false;
+	exitRequested = false;
+	failed = false;
+}
+
+/**
+ * @brief ResultSet destructor
+ *
+ * @note the plan is released with the last copy of the result
+ */
+ResultSet::~ResultSet()
+{
+
+}
+
+/**
+ * @brief isQuery
+ *
+ * @return bool true if the statement produced rows to read
+ *
+ * @note None
+ */
+bool ResultSet::isQuery()
+{
+	return plan != NULL;
+}
+
+/**
+ * @brief isExit
+ *
+ * @return bool true if the statement was .EXIT
+ *
+ * @note None
+ */
+bool ResultSet::isExit()
+{
+	return exitRequested;
+}
+
+/**
+ * @brief hasError
+ *
+ * @return bool true if the statement reported a failure
+ *
+ * @note None
+ */
+bool ResultSet::hasError()
+{
+	return failed;
+}
+
+/**
+ * @brief getMessage
+ *
+ * @details status lines of the statement, as the command line shows them
+ *
+ * @return string
+ *
+ * @note None
+ */
+string ResultSet::getMessage()
+{
+	return message;
+}
+
+/**
+ * @brief getColumns
+ *
+ * @return vector< Attribute > columns of the returned rows, empty if no query
+ *
+ * @note None
+ */
+vector< Attribute > ResultSet::getColumns()
+{
+	if( plan == NULL )
+	{
+		return vector< Attribute >();
+	}
+	return plan->getColumns();
+}
+
+/**
+ * @brief next
+ *
+ * @details moves to the next row, the plan is opened on the first call
+ *
+ * @return bool false once there are no more rows
+ *
+ * @note None
+ */
+bool ResultSet::next()
+{
+	if( plan == NULL )
+	{
+		return false;
+	}
+	if( !opened )
+	{
+		plan->open();
+		opened = true;
+	}
+	return plan->next( currentRow );
+}
+
+/**
+ * @brief getValue
+ *
+ * @param [in] int column - zero based column of the current row
+ *
+ * @return Value a null value if the column does not exist
+ *
+ * @note None
+ */
+Value ResultSet::getValue( int column )
+{
+	if( column < 0 || column >= (int) currentRow.values.size() )
+	{
+		return makeValue( "", TYPE_STRING );
+	}
+	return currentRow.values[ column ];
+}
+
+/**
+ * @brief getString
+ *
+ * @param [in] int column
+ *
+ * @return string value as displayed
+ *
+ * @note None
+ */
+string ResultSet::getString( int column )
+{
+	return getValue( column ).text;
+}
+
+/**
+ * @brief getInt
+ *
+ * @param [in] int column
+ *
+ * @return long
+ *
+ * @note None
+ */
+long ResultSet::getInt( int column )
+{
+	return getValue( column ).intValue;
+}
+
+/**
+ * @brief getDouble
+ *
+ * @param [in] int column
+ *
+ * @return double
+ *
+ * @note None
+ */
+double ResultSet::getDouble( int column )
+{
+	return getValue( column ).floatValue;
+}
+
+/**
+ * @brief isNull
+ *
+ * @param [in] int column
+ *
+ * @return bool
+ *
+ * @note None
+ */
+bool ResultSet::isNull( int column )
+{
+	return getValue( column ).isNull;
+}
+
+/**
+ * @brief print
+ *
+ * @details outputs the message and any rows in the command line format
+ *
+ * @param [in] ostream &out
+ *
+ * @return None
+ *
+ * @note consumes the rows
+ */
+void ResultSet::print( ostream &out )
+{
+	out << message;
+	if( plan != NULL && !opened )
+	{
+		opened = true;
+		printResults( *plan, out );
+	}
+}
+
+/**
+ * @brief close
+ *
+ * @details releases the rows that have not been read
+ *
+ * @return None
+ *
+ * @note None
+ */
+void ResultSet::close()
+{
+	if( plan != NULL && opened )
+	{
+		plan->close();
+	}
+	plan.reset();
+}
+
+/**
+ * @brief Statement constructor
+ *
+ * @param [in] Connection &conn - connection the statement runs on
+ *
+ * @param [in] string sql
+ *
+ * @note None
+ */
+Statement::Statement( Connection &conn, string sql )
+	: connection( conn ), statementText( sql )
+{
+	ostringstream messages;
+	if( connection.isOpen() )
+	{
+		shared_ptr< LockSet > locks = connection.lockCatalog( false );
+		prepared = connection.prepareCached( sql, "PREPARE", messages );
+	}
+}
+
+/**
+ * @brief Statement destructor
+ *
+ * @note None
+ */
+Statement::~Statement()
+{
+
+}
+
+/**
+ * @brief getParameterCount
+ *
+ * @return int number of ? parameters of the statement
+ *
+ * @note None
+ */
+int Statement::getParameterCount()
+{
+	if( prepared == NULL )
+	{
+		return 0;
+	}
+	return prepared->parameters.size();
+}
+
+/**
+ * @brief setArgument
+ *
+ * @details stores the value of one parameter as it is written in a statement
+ *
+ * @param [in] int parameter - zero based, in the order the ?s appear
+ *
+ * @param [in] string value
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Statement::setArgument( int parameter, string value )
+{
+	if( parameter < 0 )
+	{
+		return;
+	}
+	if( parameter >= (int) arguments.size() )
+	{
+		arguments.resize( parameter + 1 );
+	}
+	arguments[ parameter ] = value;
+}
+
+/**
+ * @brief setString
+ *
+ * @param [in] int parameter
+ *
+ * @param [in] string value - stored with quotes
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Statement::setString( int parameter, string value )
+{
+	setArgument( parameter, "'" + value + "'" );
+}
+
+/**
+ * @brief setInt
+ *
+ * @param [in] int parameter
+ *
+ * @param [in] long value
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Statement::setInt( int parameter, long value )
+{
+	setArgument( parameter, to_string( value ) );
+}
+
+/**
+ * @brief setDouble
+ *
+ * @param [in] int parameter
+ *
+ * @param [in] double value
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Statement::setDouble( int parameter, double value )
+{
+	ostringstream text;
+	text << setprecision( 15 ) << value;
+	setArgument( parameter, text.str() );
+}
+
+/**
+ * @brief setNull
+ *
+ * @param [in] int parameter
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Statement::setNull( int parameter )
+{
+	setArgument( parameter, "null" );
+}
+
+/**
+ * @brief execute
+ *
+ * @details runs the statement with the current parameter values, may be
+ *          called repeatedly
+ *
+ * @par Algorithm a statement that could be prepared reuses its parse tree,
+ *      any other statement is run from its text
+ *
+ * @return ResultSet
+ *
+ * @note None
+ */
+ResultSet Statement::execute()
+{
+	if( prepared == NULL )
+	{
+		return connection.execute( statementText );
+	}
+	return connection.executeCached( *prepared, arguments );
+}
+
+/**
+ * @brief Connection default constructor
+ *
+ * @details creates a closed connection
+ *
+ * @note None
+ */
+Connection::Connection()
+{
+	inTransaction = false;
+}
+
+/**
+ * @brief Connection destructor
+ *
+ * @note None
+ */
+Connection::~Connection()
+{
+	close();
+}
+
+/**
+ * @brief open
+ *
+ * @details opens the DatabaseSystem directory below the given directory
+ *
+ * @par Algorithm creates the directory if needed and opens the commit log,
+ *      which redoes the transactions a crash may have cut short. Every
+ *      database directory and its table files are then read into the
+ *      catalog and checkpoints are started
+ *
+ * @param [in] string workingDirectory - directory holding DatabaseSystem
+ *
+ * @return bool true if the directory could be read
+ *
+ * @note None
+ */
+bool Connection::open( string workingDirectory )
+{
+	currentWorkingDirectory = workingDirectory + "/DatabaseSystem";
+	currentDatabase.clear();
+
+	// Check if the database system directory exists
+	struct stat buffer;
+	if( !( stat( currentWorkingDirectory.c_str(), &buffer ) == 0 ) )
+	{
+		// if not, create it.
+		system( ( "mkdir " + currentWorkingDirectory ).c_str() );
+	}
+
+	catalog = shared_ptr< Catalog >( new Catalog );
+	catalog->catalogVersion = 0;
+	catalog->resultCache = shared_ptr< ResultCache >( new ResultCache );
+	preparedStatements.clear();
+	inTransaction = false;
+	transactionStatements.clear();
+
+	//records the storage engines kept for tables of an earlier catalog are
+	//read again, recovery may change them
+	vector< StorageEngine * > &engines = getStorageEngines();
+	for( unsigned int index = 0; index < engines.size(); index++ )
+	{
+		engines[ index ]->release( currentWorkingDirectory );
+	}
+
+	if( !catalog->commitLog.open( currentWorkingDirectory + "/" + COMMIT_LOG_NAME ) )
+	{
+		catalog.reset();
+		return false;
+	}
+
+	// Retrieve all of the information about existing directories
+	vector< string > directoryItems;
+	if( !read_directory( currentWorkingDirectory, directoryItems ) )
+	{
+		catalog.reset();
+		return false;
+	}
+
+	for( unsigned int i = 0; i < directoryItems.size(); i++ )
+	{
+		//hidden entries are work files, not databases
+		if( directoryItems[i][0] == '.' )
+		{
+			continue;
+		}
+
+		Database tempDatabase;
+		tempDatabase.databaseName = directoryItems[i];
+
+		vector< string > tableItems;
+		Table tempTable;
+
+		if( read_directory( currentWorkingDirectory + "/" + tempDatabase.databaseName, tableItems ) )
+		{
+			for( unsigned int j = 0; j < tableItems.size(); j++ )
+			{
+				//hidden entries are table work files, not tables. Those left
+				//by a write that never committed are removed
+				if( isWorkFile( tableItems[j] ) )
+				{
+					unlink( ( currentWorkingDirectory + "/" + tempDatabase.databaseName + "/" + tableItems[j] ).c_str() );
+				}
+				else if( tableItems[j][0] != '.' )
+				{
+					tempTable.tableName = tableItems[j];
+					tempDatabase.databaseTable.push_back(tempTable);
+				}
+			}
+		}
+
+		catalog->dbms.push_back(tempDatabase);
+	}
+
+	Catalog *opened = catalog.get();
+	catalog->checkpointer.start( [ opened ]()
+	{
+		checkpointCatalog( *opened );
+		reapRewriters( *opened );
+	} );
+	return true;
+}
+
+/**
+ * @brief open
+ *
+ * @details opens a session on the catalog of another connection
+ *
+ * @par Algorithm the catalog is shared, the current database and prepared
+ *      statements belong to this connection alone
+ *
+ * @param [in] Connection &shared - connection that is already open
+ *
+ * @return bool false if the other connection is not open
+ *
+ * @note statements of connections sharing a catalog may run at the same
+ *       time on different threads, the catalog locks keep them apart
+ */
+bool Connection::open( Connection &shared )
+{
+	preparedStatements.clear();
+	currentDatabase.clear();
+	inTransaction = false;
+	transactionStatements.clear();
+	catalog = shared.catalog;
+	currentWorkingDirectory = shared.currentWorkingDirectory;
+	return isOpen();
+}
+
+/**
+ * @brief close
+ *
+ * @details releases the catalog
+ *
+ * @return None
+ *
+ * @note an open transaction is rolled back
+ */
+void Connection::close()
+{
+	inTransaction = false;
+	transactionStatements.clear();
+	preparedStatements.clear();
+	catalog.reset();
+	currentDatabase.clear();
+}
+
+/**
+ * @brief isOpen
+ *
+ * @return bool true between open and close
+ *
+ * @note None
+ */
+bool Connection::isOpen()
+{
+	return catalog != NULL;
+}
+
+/**
+ * @brief getCurrentDatabase
+ *
+ * @return string database selected by the last USE, empty if none
+ *
+ * @note None
+ */
+string Connection::getCurrentDatabase()
+{
+	return currentDatabase;
+}
+
+/**
+ * @brief prepare
+ *
+ * @param [in] string sql
+ *
+ * @return Statement bound to this connection
+ *
+ * @note None
+ */
+Statement Connection::prepare( string sql )
+{
+	return Statement( *this, sql );
+}
+
+/**
+ * @brief execute
+ *
+ * @details runs one statement against the catalog of this connection
+ *
+ * @par Algorithm newlines become spaces and the surrounding white space and
+ *      closing semicolon are removed. SELECT, INSERT, UPDATE and DELETE are
+ *      prepared and run under the lock of their table, anything else is
+ *      handed to startEvent. Messages are collected into the result, a query
+ *      leaves its plan in the result to be read row by row
+ *
+ * @param [in] string sql - one statement, with or without the semicolon
+ *
+ * @return ResultSet
+ *
+ * @note None
+ */
+ResultSet Connection::execute( string sql )
+{
+	ResultSet result;
+	if( !isOpen() )
+	{
+		result.message = "-- !Connection is not open.\n";
+		result.failed = true;
+		return result;
+	}
+	if( !normalizeStatement( sql ) || executeNamed( sql, result ) || executeTransaction( sql, result ) || executeRewrite( sql, result ) )
+	{
+		return result;
+	}
+
+	ostringstream out;
+	string actionType = sql.substr( 0, sql.find( ' ' ) );
+	convertToUC( actionType );
+
+	if( actionType == "SELECT" || actionType == "INSERT" || actionType == "UPDATE" || actionType == "DELETE" )
+	{
+		shared_ptr< LockSet > locks = lockCatalog( false );
+		shared_ptr< PreparedStatement > prepared = prepareCached( sql, actionType, out );
+		if( prepared != NULL )
+		{
+			runPrepared( *prepared, locks, result, out );
+		}
+		else
+		{
+			result.failed = true;
+		}
+	}
+	else if( ( actionType == "CREATE" || actionType == "DROP" || actionType == "ALTER" ) && inTransaction )
+	{
+		out << "-- !Failed to complete command because a transaction is in progress." << endl;
+		result.failed = true;
+	}
+	else if( actionType == "CREATE" || actionType == "DROP" || actionType == "ALTER" )
+	{
+		//schema changes are not logged, so the log is emptied before one and
+		//the change is durable before any logged change can refer to it
+		shared_ptr< LockSet > locks = lockCatalog( true );
+		checkpointCatalog( *catalog );
+
+		//a table is altered once the records its storage engine keeps
+		//outside the table file are merged into it
+		string words = sql;
+		string tableName;
+		if( actionType == "ALTER" )
+		{
+			getNextWord( words );
+			getNextWord( words );
+			tableName = getNextWord( words );
+		}
+		string tableFilePath = currentWorkingDirectory + "/" + currentDatabase + "/" + tableName;
+		TableScan scan;
+		if( !tableName.empty() && scan.scanOpen( tableFilePath ) )
+		{
+			StorageEngine &engine = getStorageEngine( scan );
+			if( !compactTable( *catalog, tableFilePath, [ & ]()
+			{
+				return engine.mergeRecords( scan );
+			} ) )
+			{
+				out << "-- !Failed to alter table " << tableName << " because its records could not be merged." << endl;
+				result.message = out.str();
+				result.failed = true;
+				return result;
+			}
+		}
+		result.exitRequested = startEvent( sql, catalog->dbms, currentWorkingDirectory, currentDatabase, result.failed, out, result.plan );
+		syncDatabaseSystem( currentWorkingDirectory );
+
+		//prepared statements resolved before a schema change must be resolved again
+		catalog->catalogVersion++;
+	}
+	else
+	{
+		shared_ptr< LockSet > locks = lockCatalog( false );
+		result.exitRequested = startEvent( sql, catalog->dbms, currentWorkingDirectory, currentDatabase, result.failed, out, result.plan );
+	}
+	result.message = out.str();
+	return result;
+}
+
+/**
+ * @brief lockCatalog
+ *
+ * @details takes the catalog lock for one statement
+ *
+ * @param [in] bool exclusive - true for statements that change the catalog
+ *
+ * @return shared_ptr< LockSet > holds the lock until it is released
+ *
+ * @note None
+ */
+shared_ptr< LockSet > Connection::lockCatalog( bool exclusive )
+{
+	shared_ptr< LockSet > locks( new LockSet );
+	if( exclusive )
+	{
+		locks->lockExclusive( catalog->locks.getCatalogLock() );
+	}
+	else
+	{
+		locks->lockShared( catalog->locks.getCatalogLock() );
+	}
+	return locks;
+}
+
+/**
+ * @brief prepareCached
+ *
+ * @details parses and resolves a statement so it can be executed repeatedly
+ *
+ * @param [in] string sql
+ *
+ * @param [in] string commandError - action named in an error message
+ *
+ * @param [in] ostream &out - stream that receives any error
+ *
+ * @return shared_ptr< PreparedStatement > empty if it could not be prepared
+ *
+ * @note the caller holds the catalog lock
+ */
+shared_ptr< PreparedStatement > Connection::prepareCached( string sql, string commandError, ostream &out )
+{
+	int errorType;
+	string errorContainerName;
+	shared_ptr< PreparedStatement > prepared( new PreparedStatement );
+
+	if( !isOpen() || !normalizeStatement( sql ) )
+	{
+		return shared_ptr< PreparedStatement >();
+	}
+	if( !prepareStatement( sql, catalog->dbms, currentWorkingDirectory, currentDatabase, *prepared, errorType, errorContainerName ) )
+	{
+		handleError( errorType, commandError, errorContainerName, out );
+		return shared_ptr< PreparedStatement >();
+	}
+	prepared->catalogVersion = catalog->catalogVersion;
+	return prepared;
+}
+
+/**
+ * @brief runPrepared
+ *
+ * @details runs a bound statement
+ *
+ * @par Algorithm a query whose result is cached at the table's current
+ *      version is answered from the cache without opening the table.
+ *      Otherwise it shares the table lock only while it pins a snapshot of
+ *      the last committed version, its rows are then read without any lock,
+ *      so long queries and writers never wait on each other, and recorded
+ *      for the cache as they are returned. A change is added to the open
+ *      transaction, or committed on its own when there is none
+ *
+ * @param [in] PreparedStatement &bound
+ *
+ * @param [in] shared_ptr< LockSet > locks - already holds the catalog lock
+ *
+ * @param [out] ResultSet &result
+ *
+ * @param [in] ostream &out
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Connection::runPrepared( PreparedStatement &bound, shared_ptr< LockSet > locks, ResultSet &result, ostream &out )
+{
+	if( bound.actionType == "SELECT" )
+	{
+		string tableFilePath = bound.scan.filePath;
+		string resultKey = getResultKey( bound );
+		long catalogVersion = catalog->catalogVersion;
+		shared_ptr< CachedResult > cached = catalog->resultCache->lookup( resultKey, catalogVersion, catalog->locks.getTableVersion( tableFilePath ) );
+		if( cached != NULL )
+		{
+			locks->release();
+			result.plan = shared_ptr< Operator >( new CachedResultOperator( cached ) );
+			return;
+		}
+
+		locks->lockShared( catalog->locks.getTableLock( tableFilePath ) );
+		long tableVersion = catalog->locks.getTableVersion( tableFilePath );
+		bound.scan.snapshotOpen( tableVersion, catalog->locks.getSnapshotPins( tableFilePath ) );
+
+		//the storage engine takes the records it keeps outside the table
+		//file as of this version while the plan is built
+		executePrepared( bound, result.failed, out, result.plan );
+		locks->release();
+		result.plan = shared_ptr< Operator >( new ResultRecorder( result.plan, catalog->resultCache, resultKey, catalogVersion, tableVersion ) );
+	}
+	else if( bound.actionType == "INSERT" && !padRecord( bound.insertValues, bound.scan.recordWidth ) )
+	{
+		out << "-- !Failed to insert into " << bound.table.tableName << " because a record is longer than its fixed width." << endl;
+		result.failed = true;
+	}
+	else if( bound.actionType == "INSERT" && bound.scan.getKeyAttribute() >= 0 &&
+		isNullValue( bound.scan.readRow( joinRow( bound.insertValues ) )[ bound.scan.getKeyAttribute() ] ) )
+	{
+		out << "-- !Failed to insert into " << bound.table.tableName << " because its primary key ";
+		out << bound.scan.keyName << " cannot be null." << endl;
+		result.failed = true;
+	}
+	else if( bound.actionType == "UPDATE" && bound.scan.getKeyAttribute() >= 0 &&
+		bound.sCond.attributeIndex == bound.scan.getKeyAttribute() && isNullValue( bound.sCond.newValue ) )
+	{
+		out << "-- !Failed to update table " << bound.table.tableName << " because its primary key ";
+		out << bound.scan.keyName << " cannot be null." << endl;
+		result.failed = true;
+	}
+	else if( inTransaction )
+	{
+		transactionStatements.push_back( shared_ptr< PreparedStatement >( new PreparedStatement( bound ) ) );
+		out << "-- Statement added to transaction." << endl;
+	}
+	else
+	{
+		vector< shared_ptr< PreparedStatement > > statements;
+		statements.push_back( shared_ptr< PreparedStatement >( new PreparedStatement( bound ) ) );
+		result.failed = !commitStatements( statements, locks, true, out );
+	}
+}
+
+/**
+ * @brief commitStatements
+ *
+ * @details durably applies the changes of one transaction
+ *
+ * @par Algorithm the tables written are locked exclusively in path order, so
+ *      committers cannot deadlock. A table with an UPDATE or DELETE gets a
+ *      staged copy that takes all of the transaction's changes to it and is
+ *      synced. The changes are then written to the commit log, which batches
+ *      concurrent commits into one fsync. Only after that are staged copies
+ *      renamed over their tables and inserts appended to the others, so a
+ *      crash at any point leaves each table either before the transaction
+ *      or redoable from the log. A fixed width table that is only updated
+ *      and has no snapshot open is not staged: its changed records are
+ *      logged and then written over the old ones, unless the primary key
+ *      is set. Inserts that would break the key order of a clustered table
+ *      stage it too and are placed where their keys belong. Values of
+ *      unique columns are looked up in an index of the committed table as
+ *      each statement adds them, a taken one fails the transaction. The
+ *      storage engine of a table decides whether its inserts are staged,
+ *      how they are logged and what follows the commit, and merges the
+ *      records it keeps outside the file into it before an update or
+ *      delete. Each table gets a new version. The transaction is planned
+ *      here, stageCommit, logCommit and applyCommit take the three steps
+ *
+ * @param [in] vector< shared_ptr< PreparedStatement > > &statements - bound
+ *
+ * @param [in] shared_ptr< LockSet > locks - already holds the catalog lock
+ *
+ * @param [in] bool autocommit - true for a statement committed on its own,
+ *             which need not wait for the log sync when sync commit is off
+ *
+ * @param [in] ostream &out
+ *
+ * @return bool false if nothing was applied or a change failed
+ *
+ * @note None
+ */
+bool Connection::commitStatements( vector< shared_ptr< PreparedStatement > > &statements, shared_ptr< LockSet > locks, bool autocommit, ostream &out )
+{
+	PendingCommit commit;
+	commit.statements = statements;
+	int statementSize = statements.size();
+	vector< string > &statementTables = commit.statementTables;
+	set< string > &tableFilePaths = commit.tableFilePaths;
+	set< string > &stagedTables = commit.stagedTables;
+	statementTables.resize( statementSize );
+	for( int index = 0; index < statementSize; index++ )
+	{
+		//changes resolved before a schema change cannot be applied
+		if( statements[ index ]->catalogVersion != catalog->catalogVersion )
+		{
+			out << "-- !Failed to commit transaction because table ";
+			out << statements[ index ]->table.tableName << " was changed." << endl;
+			return false;
+		}
+		statementTables[ index ] = statements[ index ]->scan.filePath;
+		tableFilePaths.insert( statementTables[ index ] );
+		if( statements[ index ]->actionType != "INSERT" )
+		{
+			stagedTables.insert( statementTables[ index ] );
+		}
+	}
+	for( set< string >::iterator it = tableFilePaths.begin(); it != tableFilePaths.end(); ++it )
+	{
+		locks->lockExclusive( catalog->locks.getTableLock( *it ) );
+	}
+
+	//a staged table is rewritten from its file, which first takes the
+	//records its storage engine keeps outside it. The statements are then
+	//resolved against the file
+	for( set< string >::iterator it = stagedTables.begin(); it != stagedTables.end(); ++it )
+	{
+		TableScan scan;
+		if( !scan.scanOpen( *it ) )
+		{
+			continue;
+		}
+		StorageEngine &engine = getStorageEngine( scan );
+		bool merged = compactTable( *catalog, *it, [ & ]()
+		{
+			return engine.mergeRecords( scan );
+		} );
+		for( int index = 0; index < statementSize && merged; index++ )
+		{
+			if( statementTables[ index ] == *it )
+			{
+				statements[ index ]->scan.scanOpen( *it );
+			}
+		}
+		if( !merged )
+		{
+			out << "-- !Failed to commit transaction because the records of table ";
+			out << it->substr( currentWorkingDirectory.size() + 1 ) << " could not be merged." << endl;
+			return false;
+		}
+	}
+
+	//inserts the storage engine cannot take as they are, like those that
+	//would fill the overflow file of a clustered text table, are placed in
+	//a staged copy
+	for( set< string >::iterator it = tableFilePaths.begin(); it != tableFilePaths.end(); ++it )
+	{
+		vector< vector< string > > insertRows;
+		int insertIndex = -1;
+		for( int index = 0; index < statementSize; index++ )
+		{
+			if( statementTables[ index ] == *it && statements[ index ]->actionType == "INSERT" )
+			{
+				insertRows.push_back( statements[ index ]->insertValues );
+				insertIndex = index;
+			}
+		}
+		if( insertIndex < 0 )
+		{
+			continue;
+		}
+		TableScan &scan = statements[ insertIndex ]->scan;
+		if( getStorageEngine( scan ).stagesInserts( scan, insertRows ) )
+		{
+			stagedTables.insert( *it );
+		}
+	}
+
+	//unique values are checked against an index of each table as committed,
+	//the changes of the transaction are counted on top of it
+	map< string, shared_ptr< UniqueIndex > > &uniqueIndexes = commit.uniqueIndexes;
+	for( int index = 0; index < statementSize; index++ )
+	{
+		if( uniqueIndexes.count( statementTables[ index ] ) == 0 && !statements[ index ]->scan.getUniqueAttributes().empty() )
+		{
+			uniqueIndexes[ statementTables[ index ] ] = getUniqueIndex( *catalog, statementTables[ index ] );
+		}
+	}
+
+	//no snapshot can be opened while the table lock is held. The records
+	//of an overflow file are only updated by a rewrite, which takes them in
+	set< string > &inPlaceTables = commit.inPlaceTables;
+	map< string, shared_ptr< map< long, string > > > &tableWrites = commit.tableWrites;
+	for( set< string >::iterator it = stagedTables.begin(); it != stagedTables.end(); ++it )
+	{
+		bool inPlace = *catalog->locks.getSnapshotPins( *it ) == 0;
+		for( int index = 0; index < statementSize; index++ )
+		{
+			if( statementTables[ index ] == *it )
+			{
+				inPlace = inPlace && statements[ index ]->actionType == "UPDATE" && statements[ index ]->scan.recordWidth > 0 &&
+					!statements[ index ]->scan.isKeyAttribute( statements[ index ]->sCond.attributeIndex ) &&
+					statements[ index ]->scan.getOverflowSize() == 0;
+			}
+		}
+		if( inPlace )
+		{
+			inPlaceTables.insert( *it );
+			tableWrites[ *it ] = shared_ptr< map< long, string > >( new map< long, string > );
+		}
+	}
+	for( set< string >::iterator it = inPlaceTables.begin(); it != inPlaceTables.end(); ++it )
+	{
+		stagedTables.erase( *it );
+	}
+
+	commit.transaction = catalog->commitLog.nextTransaction();
+	commit.stagedSuffix = "txn" + to_string( commit.transaction );
+	commit.messages.assign( statementSize, "" );
+	commit.failures.assign( statementSize, false );
+
+	//nothing is applied unless every change is staged and logged
+	string failure;
+	if( !stageCommit( commit ) || !logCommit( commit, autocommit, failure ) )
+	{
+		abandonCommit( commit, failure, out );
+		return false;
+	}
+	return applyCommit( commit, out );
+}
+
+/**
+ * @brief stageCommit
+ *
+ * @details applies the statements of a transaction to the staged copies of
+ *          their tables, or collects the records updated in place
+ *
+ * @par Algorithm the first change to a staged table reads the table and
+ *      writes the staged copy, later ones work on the copy. Inserts placed
+ *      into a clustered table are written with one rewrite, and the staged
+ *      copies are synced before the transaction is logged. Statements on
+ *      tables that are only appended to are left for applyCommit
+ *
+ * @param [in/out] PendingCommit &commit - messages and failures take what
+ *                 each statement reported
+ *
+ * @return bool false if a statement failed or a copy could not be written
+ *
+ * @note the caller holds the table locks exclusively
+ */
+bool Connection::stageCommit( PendingCommit &commit )
+{
+	vector< shared_ptr< PreparedStatement > > &statements = commit.statements;
+	int statementSize = statements.size();
+	vector< string > &statementTables = commit.statementTables;
+	set< string > &stagedTables = commit.stagedTables;
+	set< string > &inPlaceTables = commit.inPlaceTables;
+	map< string, shared_ptr< UniqueIndex > > &uniqueIndexes = commit.uniqueIndexes;
+	string stagedSuffix = commit.stagedSuffix;
+	vector< string > &messages = commit.messages;
+	vector< bool > &failures = commit.failures;
+	shared_ptr< Operator > plan;
+	bool staged = true;
+
+	//inserts placed into a clustered table are collected by the scan of the
+	//first of them, and placed with one rewrite before another statement
+	//changes the table or once every statement is staged
+	map< string, vector< int > > placingStatements;
+	function< bool( const string &tableFilePath ) > placeCollected = [ & ]( const string &tableFilePath )
+	{
+		map< string, vector< int > >::iterator placing = placingStatements.find( tableFilePath );
+		if( placing == placingStatements.end() )
+		{
+			return true;
+		}
+		vector< int > placed = placing->second;
+		placingStatements.erase( placing );
+		if( statements[ placed.front() ]->scan.placeRecords() >= 0 )
+		{
+			return true;
+		}
+		for( unsigned int member = 0; member < placed.size(); member++ )
+		{
+			messages[ placed[ member ] ] = "-- !Failed to insert into " + statements[ placed[ member ] ]->table.tableName + ".\n";
+			failures[ placed[ member ] ] = true;
+		}
+		return false;
+	};
+
+	//the first change to a staged table reads the table and writes the
+	//staged copy, later ones work on the copy. Updates in place only
+	//collect the records they change
+	for( int index = 0; index < statementSize && staged; index++ )
+	{
+		PreparedStatement &bound = *statements[ index ];
+		string stagedPath = getWorkPath( statementTables[ index ], stagedSuffix );
+		string violation;
+		map< string, shared_ptr< UniqueIndex > >::iterator uniqueIndex = uniqueIndexes.find( statementTables[ index ] );
+		bound.scan.uniqueIndex = ( uniqueIndex != uniqueIndexes.end() ) ? uniqueIndex->second : NULL;
+		if( bound.actionType == "INSERT" && bound.scan.uniqueIndex != NULL && !bound.scan.addUniqueRecord( bound.insertValues, violation ) )
+		{
+			messages[ index ] = "-- !Failed to insert into " + bound.table.tableName + " because " + violation + " already exists.\n";
+			failures[ index ] = true;
+			staged = false;
+			continue;
+		}
+		map< string, vector< int > >::iterator placing = placingStatements.find( statementTables[ index ] );
+		if( placing != placingStatements.end() && bound.actionType == "INSERT" )
+		{
+			ostringstream statementOut;
+			bool statementFailed = false;
+			bound.table.insertRecord( statements[ placing->second.front() ]->scan, bound.insertValues, statementFailed, statementOut );
+			placing->second.push_back( index );
+			messages[ index ] = statementOut.str();
+			failures[ index ] = statementFailed;
+			staged = !statementFailed;
+			continue;
+		}
+		staged = placeCollected( statementTables[ index ] );
+		if( !staged )
+		{
+			continue;
+		}
+		if( inPlaceTables.count( statementTables[ index ] ) != 0 )
+		{
+			bound.scan.pendingWrites = commit.tableWrites[ statementTables[ index ] ];
+		}
+		else if( stagedTables.count( statementTables[ index ] ) == 0 )
+		{
+			continue;
+		}
+		else if( access( stagedPath.c_str(), F_OK ) == 0 )
+		{
+			bound.scan.filePath = stagedPath;
+			bound.scan.placeInserts = bound.actionType == "INSERT" && bound.scan.isClustered();
+		}
+		else if( bound.actionType == "INSERT" && bound.scan.isClustered() )
+		{
+			bound.scan.rewritePath = stagedPath;
+			bound.scan.placeInserts = true;
+		}
+		else if( bound.actionType == "INSERT" )
+		{
+			staged = copyFile( statementTables[ index ], stagedPath );
+			bound.scan.filePath = stagedPath;
+		}
+		else
+		{
+			bound.scan.rewritePath = stagedPath;
+		}
+
+		ostringstream statementOut;
+		bool statementFailed = false;
+		if( staged )
+		{
+			executePrepared( bound, statementFailed, statementOut, plan );
+		}
+		messages[ index ] = statementOut.str();
+		failures[ index ] = statementFailed;
+		staged = staged && !statementFailed;
+		if( staged && bound.scan.placeInserts )
+		{
+			placingStatements[ statementTables[ index ] ].push_back( index );
+		}
+		if( staged && bound.actionType == "UPDATE" && bound.scan.uniqueIndex != NULL && !bound.scan.checkUniqueValues( violation ) )
+		{
+			messages[ index ] = "-- !Failed to update table " + bound.table.tableName + " because " + violation + " already exists.\n";
+			failures[ index ] = true;
+			staged = false;
+		}
+	}
+	for( set< string >::iterator it = stagedTables.begin(); it != stagedTables.end() && staged; ++it )
+	{
+		staged = placeCollected( *it );
+	}
+	for( set< string >::iterator it = stagedTables.begin(); it != stagedTables.end() && staged; ++it )
+	{
+		staged = syncFile( getWorkPath( *it, stagedSuffix ) ) && syncDirectory( *it );
+	}
+	return staged;
+}
+
+/**
+ * @brief logCommit
+ *
+ * @details writes the changes of a staged transaction to the commit log
+ *
+ * @par Algorithm inserts into tables that are not staged are described by
+ *      their storage engine, staged tables by a REPLACE of the copy and
+ *      records updated in place by a WRITE of each. Zones are widened over
+ *      the new values before the records are overwritten, and the tables
+ *      are marked for the next checkpoint before the log is appended to
+ *
+ * @param [in] PendingCommit &commit
+ *
+ * @param [in] bool autocommit - true for a statement committed on its own,
+ *             which need not wait for the log sync when sync commit is off
+ *
+ * @param [out] string &failure - why the transaction could not be logged
+ *
+ * @return bool false if nothing was logged
+ *
+ * @note the caller holds the table locks exclusively
+ */
+bool Connection::logCommit( PendingCommit &commit, bool autocommit, string &failure )
+{
+	vector< shared_ptr< PreparedStatement > > &statements = commit.statements;
+	int statementSize = statements.size();
+	vector< string > &statementTables = commit.statementTables;
+	set< string > &stagedTables = commit.stagedTables;
+	set< string > &inPlaceTables = commit.inPlaceTables;
+	map< string, shared_ptr< map< long, string > > > &tableWrites = commit.tableWrites;
+
+	//inserts applied after the commit is logged are described by the
+	//storage engine, which tracks where each goes, the end of a text table
+	//starting unknown
+	map< string, InsertCursor > insertCursors;
+	InsertCursor unknownEnd = { -1, -1, false, "" };
+	ostringstream records;
+	records << "BEGIN " << commit.transaction << "\n";
+	for( int index = 0; index < statementSize; index++ )
+	{
+		PreparedStatement &bound = *statements[ index ];
+		string tableName = statementTables[ index ].substr( currentWorkingDirectory.size() + 1 );
+		if( bound.actionType == "INSERT" && stagedTables.count( statementTables[ index ] ) == 0 )
+		{
+			InsertCursor &cursor = insertCursors.insert( make_pair( statementTables[ index ], unknownEnd ) ).first->second;
+			records << getStorageEngine( bound.scan ).logInsert( bound.scan, tableName, bound.insertValues, cursor ) << "\n";
+		}
+		else
+		{
+			records << getRedoRecord( bound, tableName, 0 ) << "\n";
+		}
+	}
+	for( set< string >::iterator it = stagedTables.begin(); it != stagedTables.end(); ++it )
+	{
+		records << "REPLACE\t" << it->substr( currentWorkingDirectory.size() + 1 ) << "\n";
+	}
+	for( set< string >::iterator it = inPlaceTables.begin(); it != inPlaceTables.end(); ++it )
+	{
+		map< long, string > &writes = *tableWrites[ *it ];
+		for( map< long, string >::iterator write = writes.begin(); write != writes.end(); ++write )
+		{
+			records << "WRITE\t" << it->substr( currentWorkingDirectory.size() + 1 ) << "\t" << write->first << "\t" << write->second << "\n";
+		}
+	}
+	records << "COMMIT " << commit.transaction << "\n";
+
+	//zones must hold the records before they are overwritten
+	for( set< string >::iterator it = inPlaceTables.begin(); it != inPlaceTables.end(); ++it )
+	{
+		int index = 0;
+		while( statementTables[ index ] != *it )
+		{
+			index++;
+		}
+		if( !statements[ index ]->scan.widenZones( *tableWrites[ *it ] ) )
+		{
+			failure = "-- !Failed to commit transaction because a zone map could not be updated.";
+			return false;
+		}
+	}
+
+	//the next checkpoint must sync these tables before it drops this record
+	{
+		lock_guard< mutex > dirtyGuard( catalog->dirtyLock );
+		catalog->dirtyTables.insert( commit.tableFilePaths.begin(), commit.tableFilePaths.end() );
+	}
+	if( !catalog->commitLog.append( records.str(), autocommit ) )
+	{
+		failure = "-- !Failed to commit transaction because the commit log could not be written.";
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief abandonCommit
+ *
+ * @details undoes a transaction that was not logged
+ *
+ * @par Algorithm the unique indexes forget the values the transaction
+ *      counted, staged copies are removed and the statements that failed
+ *      are reported, the tables are left as they were
+ *
+ * @param [in] PendingCommit &commit
+ *
+ * @param [in] string failure - reported after the statements, none if empty
+ *
+ * @param [in] ostream &out
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Connection::abandonCommit( PendingCommit &commit, string failure, ostream &out )
+{
+	for( map< string, shared_ptr< UniqueIndex > >::iterator it = commit.uniqueIndexes.begin(); it != commit.uniqueIndexes.end(); ++it )
+	{
+		if( it->second != NULL )
+		{
+			it->second->changes.assign( it->second->changes.size(), map< string, long >() );
+			it->second->added.clear();
+		}
+	}
+	for( set< string >::iterator it = commit.stagedTables.begin(); it != commit.stagedTables.end(); ++it )
+	{
+		unlink( getWorkPath( *it, commit.stagedSuffix ).c_str() );
+	}
+	for( unsigned int index = 0; index < commit.statements.size(); index++ )
+	{
+		if( commit.failures[ index ] )
+		{
+			out << commit.messages[ index ];
+		}
+	}
+	if( !failure.empty() )
+	{
+		out << failure << endl;
+	}
+}
+
+/**
+ * @brief applyCommit
+ *
+ * @details applies a logged transaction to its tables
+ *
+ * @par Algorithm staged copies are renamed over their tables, records
+ *      updated in place are written over the old ones and the remaining
+ *      statements are executed, appending their inserts. Each table then
+ *      gets a new version, the unique indexes count the committed tables
+ *      and the storage engine finishes the tables the statements were
+ *      applied to
+ *
+ * @param [in] PendingCommit &commit
+ *
+ * @param [in] ostream &out
+ *
+ * @return bool false if a change failed after the transaction was logged
+ *
+ * @note the caller holds the table locks exclusively
+ */
+bool Connection::applyCommit( PendingCommit &commit, ostream &out )
+{
+	vector< shared_ptr< PreparedStatement > > &statements = commit.statements;
+	int statementSize = statements.size();
+	vector< string > &statementTables = commit.statementTables;
+	set< string > &tableFilePaths = commit.tableFilePaths;
+	set< string > &stagedTables = commit.stagedTables;
+	set< string > &inPlaceTables = commit.inPlaceTables;
+	map< string, shared_ptr< map< long, string > > > &tableWrites = commit.tableWrites;
+	map< string, shared_ptr< UniqueIndex > > &uniqueIndexes = commit.uniqueIndexes;
+	vector< string > &messages = commit.messages;
+	vector< bool > &failures = commit.failures;
+	shared_ptr< Operator > plan;
+
+	for( set< string >::iterator it = stagedTables.begin(); it != stagedTables.end(); ++it )
+	{
+		rename( getWorkPath( *it, commit.stagedSuffix ).c_str(), it->c_str() );
+	}
+	for( set< string >::iterator it = inPlaceTables.begin(); it != inPlaceTables.end(); ++it )
+	{
+		writeRecords( *it, *tableWrites[ *it ] );
+	}
+	for( int index = 0; index < statementSize; index++ )
+	{
+		if( stagedTables.count( statementTables[ index ] ) == 0 && inPlaceTables.count( statementTables[ index ] ) == 0 )
+		{
+			ostringstream statementOut;
+			bool statementFailed = false;
+			executePrepared( *statements[ index ], statementFailed, statementOut, plan );
+			messages[ index ] = statementOut.str();
+			failures[ index ] = statementFailed;
+		}
+		out << messages[ index ];
+	}
+	for( set< string >::iterator it = tableFilePaths.begin(); it != tableFilePaths.end(); ++it )
+	{
+		catalog->locks.commitTableVersion( *it );
+	}
+
+	//the unique indexes now count the committed tables
+	for( map< string, shared_ptr< UniqueIndex > >::iterator it = uniqueIndexes.begin(); it != uniqueIndexes.end(); ++it )
+	{
+		if( it->second == NULL )
+		{
+			continue;
+		}
+		UniqueIndex &uniqueIndex = *it->second;
+		for( unsigned int column = 0; column < uniqueIndex.changes.size(); column++ )
+		{
+			map< string, long > &changes = uniqueIndex.changes[ column ];
+			for( map< string, long >::iterator change = changes.begin(); change != changes.end(); ++change )
+			{
+				long &count = uniqueIndex.counts[ column ][ change->first ];
+				count += change->second;
+				if( count <= 0 )
+				{
+					uniqueIndex.counts[ column ].erase( change->first );
+				}
+			}
+			changes.clear();
+		}
+		uniqueIndex.tableVersion = catalog->locks.getTableVersion( it->first );
+		uniqueIndex.catalogVersion = catalog->catalogVersion;
+	}
+
+	//the storage engine finishes the tables the statements were applied
+	//to, a step that fails is taken again by the next checkpoint or redone
+	//from the log
+	for( set< string >::iterator it = tableFilePaths.begin(); it != tableFilePaths.end(); ++it )
+	{
+		TableScan scan;
+		if( stagedTables.count( *it ) != 0 || inPlaceTables.count( *it ) != 0 || !scan.scanOpen( *it ) )
+		{
+			continue;
+		}
+		StorageEngine &engine = getStorageEngine( scan );
+		compactTable( *catalog, *it, [ & ]()
+		{
+			return engine.finishCommit( scan );
+		} );
+	}
+
+	//the transaction is logged, but a change that then failed is reported
+	return find( failures.begin(), failures.end(), true ) == failures.end();
+}
+
+/**
+ * @brief executeTransaction
+ *
+ * @details handles BEGIN, COMMIT and ROLLBACK
+ *
+ * @par Algorithm between BEGIN and COMMIT changes are resolved and bound as
+ *      they are entered but kept by the connection. COMMIT applies all of
+ *      them at once, ROLLBACK drops them. Queries inside a transaction see
+ *      the committed tables, not the changes kept so far
+ *
+ * @param [in] string input - normalized statement
+ *
+ * @param [out] ResultSet &result
+ *
+ * @return bool false if the statement is none of these
+ *
+ * @note None
+ */
+bool Connection::executeTransaction( string input, ResultSet &result )
+{
+	ostringstream out;
+	string actionType = getNextWord( input );
+	string transactionWord = input;
+	convertToUC( actionType );
+	convertToUC( transactionWord );
+	if( ( actionType != "BEGIN" && actionType != "COMMIT" && actionType != "ROLLBACK" ) ||
+		( !transactionWord.empty() && transactionWord != "TRANSACTION" && transactionWord != "WORK" ) )
+	{
+		return false;
+	}
+
+	if( actionType == "BEGIN" && inTransaction )
+	{
+		out << "-- !Failed to begin transaction because one is already in progress." << endl;
+		result.failed = true;
+	}
+	else if( actionType == "BEGIN" )
+	{
+		inTransaction = true;
+		transactionStatements.clear();
+		out << "-- Transaction started." << endl;
+	}
+	else if( !inTransaction )
+	{
+		convertToLC( actionType );
+		out << "-- !Failed to " << actionType << " transaction because none is in progress." << endl;
+		result.failed = true;
+	}
+	else if( actionType == "COMMIT" )
+	{
+		inTransaction = false;
+		shared_ptr< LockSet > locks = lockCatalog( false );
+		if( transactionStatements.empty() || commitStatements( transactionStatements, locks, false, out ) )
+		{
+			out << "-- Transaction committed." << endl;
+		}
+		else
+		{
+			result.failed = true;
+		}
+		transactionStatements.clear();
+	}
+	else
+	{
+		inTransaction = false;
+		transactionStatements.clear();
+		out << "-- Transaction rolled back." << endl;
+	}
+
+	result.message = out.str();
+	return true;
+}
+
+/**
+ * @brief executeRewrite
+ *
+ * @details handles ALTER TABLE name REWRITE [FIXED | VARIABLE | COMPRESSED]
+ *          [BLOOM ( name, ... )] [BACKGROUND], BLOOM () removes the Bloom
+ *          filters
+ *
+ * @par Algorithm the table is rewritten by rewriteTable. In the background
+ *      the rewrite runs on its own thread and the statement returns at
+ *      once. The messages of a background rewrite that fails go to the
+ *      error stream. Finished threads are joined by the next background
+ *      rewrite or checkpoint, the catalog waits for the others before it
+ *      is closed
+ *
+ * @param [in] string input - normalized statement
+ *
+ * @param [out] ResultSet &result
+ *
+ * @return bool false if the statement is not a rewrite
+ *
+ * @note None
+ */
+bool Connection::executeRewrite( string input, ResultSet &result )
+{
+	ostringstream out;
+	string actionType = getNextWord( input );
+	string tableWord = getNextWord( input );
+	string tableName = getNextWord( input );
+	string rewriteWord = getNextWord( input );
+	convertToUC( actionType );
+	convertToUC( tableWord );
+	convertToUC( rewriteWord );
+	if( actionType != "ALTER" || tableWord != "TABLE" || rewriteWord != "REWRITE" )
+	{
+		return false;
+	}
+
+	//BLOOM ( names ) may stand anywhere among the options
+	vector< string > bloomColumns;
+	bool bloomChanged = false;
+	string upperInput = input;
+	convertToUC( upperInput );
+	size_t bloomIndex = upperInput.find( "BLOOM" );
+	if( bloomIndex != string::npos )
+	{
+		size_t openIndex = input.find_first_not_of( " ", bloomIndex + 5 );
+		size_t closeIndex = input.find( ')', bloomIndex );
+		if( openIndex == string::npos || input[ openIndex ] != '(' || closeIndex == string::npos )
+		{
+			out << "-- !Failed to rewrite table " << tableName << " because BLOOM takes a list of columns in parentheses." << endl;
+			result.message = out.str();
+			result.failed = true;
+			return true;
+		}
+		string bloomList = input.substr( openIndex + 1, closeIndex - openIndex - 1 ) + ",";
+		for( size_t commaIndex = bloomList.find( ',' ); commaIndex != string::npos; commaIndex = bloomList.find( ',' ) )
+		{
+			string columnName = bloomList.substr( 0, commaIndex );
+			bloomList.erase( 0, commaIndex + 1 );
+			size_t first = columnName.find_first_not_of( " " );
+			if( first != string::npos )
+			{
+				bloomColumns.push_back( columnName.substr( first, columnName.find_last_not_of( " " ) - first + 1 ) );
+			}
+		}
+		input.erase( bloomIndex, closeIndex + 1 - bloomIndex );
+		size_t first = input.find_first_not_of( " " );
+		input = ( first == string::npos ) ? "" : input.substr( first, input.find_last_not_of( " " ) - first + 1 );
+		size_t doubleSpace = input.find( "  " );
+		if( doubleSpace != string::npos )
+		{
+			input.erase( doubleSpace, 1 );
+		}
+		bloomChanged = true;
+	}
+
+	string formatWord = getNextWord( input );
+	string backgroundWord = input;
+	convertToUC( formatWord );
+	convertToUC( backgroundWord );
+	if( formatWord == "BACKGROUND" && backgroundWord.empty() )
+	{
+		formatWord.swap( backgroundWord );
+	}
+	if( ( !formatWord.empty() && formatWord != "FIXED" && formatWord != "VARIABLE" && formatWord != "COMPRESSED" ) ||
+		( !backgroundWord.empty() && backgroundWord != "BACKGROUND" ) )
+	{
+		string option = ( !formatWord.empty() && formatWord != "FIXED" && formatWord != "VARIABLE" && formatWord != "COMPRESSED" ) ? formatWord : backgroundWord;
+		out << "-- !Failed to rewrite table " << tableName << " because " << option << " is not a known option." << endl;
+		result.message = out.str();
+		result.failed = true;
+		return true;
+	}
+	int tableFormat = ( formatWord == "FIXED" ) ? FORMAT_FIXED : ( formatWord == "VARIABLE" ) ? FORMAT_VARIABLE :
+		( formatWord == "COMPRESSED" ) ? FORMAT_COMPRESSED : FORMAT_KEEP;
+
+	bool tableFound = false;
+	{
+		shared_ptr< LockSet > locks = lockCatalog( false );
+		int tableIndex;
+		for( unsigned int index = 0; index < catalog->dbms.size(); index++ )
+		{
+			if( catalog->dbms[ index ].databaseName == currentDatabase )
+			{
+				tableFound = catalog->dbms[ index ].tableExists( tableName, tableIndex );
+			}
+		}
+	}
+
+	string tableFilePath = currentWorkingDirectory + "/" + currentDatabase + "/" + tableName;
+	if( inTransaction )
+	{
+		out << "-- !Failed to complete command because a transaction is in progress." << endl;
+		result.failed = true;
+	}
+	else if( !tableFound )
+	{
+		out << "-- !Failed to rewrite table " << tableName << " because it does not exist." << endl;
+		result.failed = true;
+	}
+	else if( backgroundWord.empty() )
+	{
+		rewriteTable( *catalog, tableFilePath, tableName, tableFormat, bloomColumns, bloomChanged, result.failed, out );
+	}
+	else
+	{
+		reapRewriters( *catalog );
+		Catalog *rewriteCatalog = catalog.get();
+		lock_guard< mutex > guard( catalog->rewriterLock );
+		shared_ptr< BackgroundRewrite > rewrite( new BackgroundRewrite );
+		BackgroundRewrite *running = rewrite.get();
+		running->finished = false;
+		running->worker = thread( [ rewriteCatalog, running, tableFilePath, tableName, tableFormat, bloomColumns, bloomChanged ]()
+		{
+			ostringstream rewriteOut;
+			bool failed = false;
+			rewriteTable( *rewriteCatalog, tableFilePath, tableName, tableFormat, bloomColumns, bloomChanged, failed, rewriteOut );
+			if( failed )
+			{
+				cerr << rewriteOut.str();
+			}
+			running->finished = true;
+		} );
+		catalog->rewriters.push_back( rewrite );
+		out << "-- Table " << tableName << " rewrite started." << endl;
+	}
+
+	result.message = out.str();
+	return true;
+}
+
+/**
+ * @brief executeCached
+ *
+ * @details binds the arguments to a copy of a prepared statement and runs it
+ *
+ * @par Algorithm a statement prepared before the last CREATE, DROP or ALTER
+ *      is prepared again from its text first
+ *
+ * @param [in] PreparedStatement &prepared - cached statement
+ *
+ * @param [in] vector< string > arguments
+ *
+ * @return ResultSet
+ *
+ * @note None
+ */
+ResultSet Connection::executeCached( PreparedStatement &prepared, vector< string > arguments )
+{
+	ResultSet result;
+	ostringstream out;
+	if( !isOpen() )
+	{
+		result.message = "-- !Connection is not open.\n";
+		result.failed = true;
+		return result;
+	}
+
+	shared_ptr< LockSet > locks = lockCatalog( false );
+	if( prepared.catalogVersion != catalog->catalogVersion )
+	{
+		shared_ptr< PreparedStatement > refreshed = prepareCached( prepared.statementText, "PREPARE", out );
+		if( refreshed == NULL )
+		{
+			result.message = out.str();
+			result.failed = true;
+			return result;
+		}
+		prepared = *refreshed;
+	}
+
+	PreparedStatement bound = prepared;
+	if( !bindParameters( bound, arguments ) )
+	{
+		out << "-- !Failed to execute statement because it expects ";
+		out << prepared.parameters.size() << " parameters." << endl;
+		result.failed = true;
+	}
+	else
+	{
+		runPrepared( bound, locks, result, out );
+	}
+	result.message = out.str();
+	return result;
+}
+
+/**
+ * @brief executeNamed
+ *
+ * @details handles PREPARE name AS ..., EXECUTE name( ... ) and
+ *          DEALLOCATE name
+ *
+ * @param [in] string input - normalized statement
+ *
+ * @param [out] ResultSet &result
+ *
+ * @return bool false if the statement is none of these
+ *
+ * @note prepared statements belong to the connection
+ */
+bool Connection::executeNamed( string input, ResultSet &result )
+{
+	ostringstream out;
+	string actionType = getNextWord( input );
+	convertToUC( actionType );
+
+	if( actionType == "PREPARE" )
+	{
+		string statementName = getNextWord( input );
+		string asWord = getNextWord( input );
+		convertToUC( asWord );
+		if( asWord != "AS" || statementName.empty() )
+		{
+			handleError( -5, actionType, "PREPARE " + statementName + " " + asWord + " " + input, out );
+			result.failed = true;
+		}
+		else
+		{
+			shared_ptr< LockSet > locks = lockCatalog( false );
+			shared_ptr< PreparedStatement > prepared = prepareCached( input, "PREPARE", out );
+			if( prepared != NULL )
+			{
+				preparedStatements[ statementName ] = prepared;
+				out << "-- Statement " << statementName << " prepared." << endl;
+			}
+			else
+			{
+				result.failed = true;
+			}
+		}
+	}
+	else if( actionType == "EXECUTE" )
+	{
+		string statementName = input.substr( 0, input.find_first_of( " (" ) );
+		vector< string > arguments;
+		size_t openIndex = input.find( '(' );
+		size_t closeIndex = input.find_last_of( ')' );
+		if( openIndex != string::npos && closeIndex != string::npos && closeIndex > openIndex )
+		{
+			arguments = getArguments( input.substr( openIndex + 1, closeIndex - openIndex - 1 ) );
+		}
+
+		if( preparedStatements.find( statementName ) == preparedStatements.end() )
+		{
+			out << "-- !Failed to execute statement " << statementName;
+			out << " because it does not exist." << endl;
+			result.failed = true;
+		}
+		else
+		{
+			result = executeCached( *preparedStatements[ statementName ], arguments );
+			return true;
+		}
+	}
+	else if( actionType == "DEALLOCATE" )
+	{
+		if( preparedStatements.erase( input ) == 0 )
+		{
+			out << "-- !Failed to deallocate statement " << input;
+			out << " because it does not exist." << endl;
+			result.failed = true;
+		}
+		else
+		{
+			out << "-- Statement " << input << " deallocated." << endl;
+		}
+	}
+	else
+	{
+		return false;
+	}
+
+	result.message = out.str();
+	return true;
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
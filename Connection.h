@@ -0,0 +1,121 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file Connection.h
+ *
+ * @brief Definition file for the Connection, Statement and ResultSet classes
+ *
+ * @details Specifies the embeddable API of the database. A Connection opens
+ *          the DatabaseSystem directory once, Statements are executed
+ *          against it and query results are read through a ResultSet as
+ *          typed values instead of console text
+ *
+ * @Note Link against libdbms.a
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <map>
+#include "Table.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+struct Catalog;
+class LockSet;
+struct PreparedStatement;
+struct PendingCommit;
+class Connection;
+
+class ResultSet{
+	public:
+		ResultSet();
+		~ResultSet();
+		bool isQuery();
+		bool isExit();
+		bool hasError();
+		string getMessage();
+		vector< Attribute > getColumns();
+		bool next();
+		Value getValue( int column );
+		string getString( int column );
+		long getInt( int column );
+		double getDouble( int column );
+		bool isNull( int column );
+		void print( ostream &out );
+		void close();
+
+	private:
+		friend class Connection;
+		shared_ptr< Operator > plan;
+		Row currentRow;
+		string message;
+		bool opened;
+		bool exitRequested;
+		bool failed;
+};
+
+class Statement{
+	public:
+		Statement( Connection &conn, string sql );
+		~Statement();
+		int getParameterCount();
+		void setString( int parameter, string value );
+		void setInt( int parameter, long value );
+		void setDouble( int parameter, double value );
+		void setNull( int parameter );
+		ResultSet execute();
+
+	private:
+		friend class Connection;
+		Connection &connection;
+		string statementText;
+		shared_ptr< PreparedStatement > prepared;
+		vector< string > arguments;
+
+		void setArgument( int parameter, string value );
+};
+
+class Connection{
+	public:
+		Connection();
+		~Connection();
+		bool open( string workingDirectory );
+		bool open( Connection &shared );
+		void close();
+		bool isOpen();
+		string getCurrentDatabase();
+		Statement prepare( string sql );
+		ResultSet execute( string sql );
+
+	private:
+		friend class Statement;
+		shared_ptr< Catalog > catalog;
+		string currentWorkingDirectory;
+		string currentDatabase;
+		map< string, shared_ptr< PreparedStatement > > preparedStatements;
+		bool inTransaction;
+		vector< shared_ptr< PreparedStatement > > transactionStatements;
+
+		shared_ptr< LockSet > lockCatalog( bool exclusive );
+		shared_ptr< PreparedStatement > prepareCached( string sql, string commandError, ostream &out );
+		ResultSet executeCached( PreparedStatement &prepared, vector< string > arguments );
+		void runPrepared( PreparedStatement &bound, shared_ptr< LockSet > locks, ResultSet &result, ostream &out );
+		bool commitStatements( vector< shared_ptr< PreparedStatement > > &statements, shared_ptr< LockSet > locks, bool autocommit, ostream &out );
+		bool stageCommit( PendingCommit &commit );
+		bool logCommit( PendingCommit &commit, bool autocommit, string &failure );
+		void abandonCommit( PendingCommit &commit, string failure, ostream &out );
+		bool applyCommit( PendingCommit &commit, ostream &out );
+		bool executeTransaction( string input, ResultSet &result );
+		bool executeNamed( string input, ResultSet &result );
+		bool executeRewrite( string input, ResultSet &result );
+};
+
+void setResultCacheSize( long bytes );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -95,13 +95,15 @@ Database::~Database()
  *
  * @param [in] string currentWorkingDirectory
  *
+ * @param [in] ostream &out - stream that receives the messages
+ *
  * @return None
  * 
  * @note None
  */
-void Database::databaseDrop(string currentWorkingDirectory)
+void Database::databaseDrop( string currentWorkingDirectory, ostream &out )
 {
-	cout << "-- Database " << databaseName << " deleted." << endl;
+	out << "-- Database " << databaseName << " deleted." << endl;
 	
 	//FIND FILES
 	DIR* dirp = opendir( ( currentWorkingDirectory + "/" + databaseName ).c_str() );
@@ -129,14 +131,16 @@ void Database::databaseDrop(string currentWorkingDirectory)
  *
  * @par Algorithm Uses system lib to run linux commands through program
  *      
+ * @param [in] ostream &out - stream that receives the messages
+ *
  * @return None
  *
  * @note None
  */
-void Database::databaseCreate()
+void Database::databaseCreate( string currentWorkingDirectory, ostream &out )
 {
-	cout << "-- Database " << databaseName << " created." << endl;
-	system( ( "mkdir DatabaseSystem/" + databaseName ).c_str() );
+	out << "-- Database " << databaseName << " created." << endl;
+	system( ( "mkdir " + currentWorkingDirectory + "/" + databaseName ).c_str() );
 }
 
 /**
@@ -164,15 +168,16 @@ void Database::databaseAlter( string input )
  *
  * @par Algorithm 
  *      
-
+ * @param [in] ostream &out - stream that receives the messages
+ *
  * @return None
  *
  * @note None
  */
-void Database::databaseUse()
+void Database::databaseUse( ostream &out )
 {
-	cout << "-- Using Database " << databaseName;
-	cout << "." << endl;
+	out << "-- Using Database " << databaseName;
+	out << "." << endl;
 }
 
 /**
@@ -29,10 +29,10 @@ class Database{
 
 		Database();
 		~Database();
-		void databaseDrop(string currentWorkingDirectory);
-		void databaseCreate();
+		void databaseDrop( string currentWorkingDirectory, ostream &out );
+		void databaseCreate( string currentWorkingDirectory, ostream &out );
 		void databaseAlter( string input );
-		void databaseUse();
+		void databaseUse( ostream &out );
 		bool tableExists( string &tblName, int &tblReturn );
 };
 
@@ -0,0 +1,135 @@
+--CS457 PRIMARY KEY and UNIQUE
+
+--Construct the database and table
+CREATE DATABASE CS457_KEYS;
+USE CS457_KEYS;
+CREATE TABLE Customer (cid int PRIMARY KEY, email varchar(40) UNIQUE, name varchar(20));
+
+--Records are kept in key order
+insert into Customer values(30, 'c@x.org', 'Cid');
+insert into Customer values(10, 'a@x.org', 'Ann');
+insert into Customer values(20, NULL, 'Bob');
+insert into Customer values(5, NULL, 'Dee');
+select * from Customer;
+
+--Inserts below the last key come back in key order
+BEGIN;
+insert into Customer values(25, 'e@x.org', 'Eve');
+insert into Customer values(1, 'f@x.org', 'Fay');
+insert into Customer values(40, 'g@x.org', 'Gus');
+COMMIT;
+select cid, name from Customer;
+
+--A key cannot be null or repeated
+insert into Customer values(NULL, 'h@x.org', 'Hal');
+insert into Customer values(10, 'i@x.org', 'Ivy');
+update Customer set cid = NULL where cid = 40;
+update Customer set cid = 30 where cid = 40;
+
+--Unique values cannot be repeated, nulls can
+insert into Customer values(50, 'a@x.org', 'Jon');
+insert into Customer values(60, NULL, 'Kim');
+update Customer set email = 'c@x.org' where cid = 25;
+update Customer set email = 'k@x.org' where cid = 60;
+delete from Customer where cid = 30;
+insert into Customer values(70, 'c@x.org', 'Lee');
+select * from Customer where cid > 20;
+
+--A key lookup reads the key range
+select name from Customer where cid >= 20 and cid < 50;
+select name from Customer where cid = 70;
+
+--A prepared key lookup binds its value as an int
+PREPARE byKey AS select name from Customer where cid = ?;
+EXECUTE byKey(25);
+EXECUTE byKey('40');
+PREPARE rename AS update Customer set name = ? where cid = ?;
+EXECUTE rename('Max', 60);
+EXECUTE byKey(60);
+DEALLOCATE byKey;
+
+--Records inserted below the last key are updated, deleted and rewritten
+insert into Customer values(2, 'm@x.org', 'Mo');
+update Customer set name = 'Moe' where cid = 2;
+delete from Customer where cid = 5;
+ALTER TABLE Customer REWRITE;
+insert into Customer values(3, 'n@x.org', 'Ned');
+select cid, name from Customer where cid < 25;
+
+.exit
+
+-- Expected output
+--
+-- Database CS457_KEYS created.
+-- Using Database CS457_KEYS.
+-- Table Customer created.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- cid int|email varchar(40)|name varchar(20)
+-- 5|null|Dee
+-- 10|a@x.org|Ann
+-- 20|null|Bob
+-- 30|c@x.org|Cid
+-- Transaction started.
+-- Statement added to transaction.
+-- Statement added to transaction.
+-- Statement added to transaction.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- Transaction committed.
+-- cid int|name varchar(20)
+-- 1|Fay
+-- 5|Dee
+-- 10|Ann
+-- 20|Bob
+-- 25|Eve
+-- 30|Cid
+-- 40|Gus
+-- !Failed to insert into Customer because its primary key cid cannot be null.
+-- !Failed to insert into Customer because cid = 10 already exists.
+-- !Failed to update table Customer because its primary key cid cannot be null.
+-- !Failed to update table Customer because cid = 30 already exists.
+-- !Failed to insert into Customer because email = 'a@x.org' already exists.
+-- 1 new record inserted.
+-- !Failed to update table Customer because email = 'c@x.org' already exists.
+-- 1 record modified.
+-- 1 record deleted.
+-- 1 new record inserted.
+-- cid int|email varchar(40)|name varchar(20)
+-- 25|e@x.org|Eve
+-- 40|g@x.org|Gus
+-- 60|k@x.org|Kim
+-- 70|c@x.org|Lee
+-- name varchar(20)
+-- Bob
+-- Eve
+-- Gus
+-- Kim
+-- Lee
+-- name varchar(20)
+-- Lee
+-- Statement byKey prepared.
+-- name varchar(20)
+-- Eve
+-- name varchar(20)
+-- Gus
+-- Statement rename prepared.
+-- 1 record modified.
+-- name varchar(20)
+-- Max
+-- Statement byKey deallocated.
+-- 1 new record inserted.
+-- 1 record modified.
+-- 1 record deleted.
+-- Table Customer rewritten.
+-- 1 new record inserted.
+-- cid int|name varchar(20)
+-- 1|Fay
+-- 2|Moe
+-- 3|Ned
+-- 10|Ann
+-- 20|Bob
+-- All done.
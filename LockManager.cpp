@@ -0,0 +1,288 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file LockManager.cpp
+ *
+ * @brief Implementation file for the RWLock, LockSet and LockManager classes
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements the catalog and table locks. Locks are always taken in
+ *          the order catalog, then tables by path, so statements cannot
+ *          deadlock each other
+ *
+ * @Note Requires LockManager.h
+ */
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include "LockManager.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef LOCKMANAGER_CPP
+#define LOCKMANAGER_CPP
+
+/**
+ * @brief RWLock constructor
+ *
+ * @note None
+ */
+RWLock::RWLock()
+{
+	readers = 0;
+	waitingWriters = 0;
+	writing = false;
+}
+
+/**
+ * @brief lockShared
+ *
+ * @details waits until no writer holds or waits for the lock
+ *
+ * @return None
+ *
+ * @note not reentrant, a thread must not take a lock it already holds
+ */
+void RWLock::lockShared()
+{
+	unique_lock< mutex > guard( stateLock );
+	stateChanged.wait( guard, [ this ]() { return !writing && waitingWriters == 0; } );
+	readers++;
+}
+
+/**
+ * @brief unlockShared
+ *
+ * @return None
+ *
+ * @note None
+ */
+void RWLock::unlockShared()
+{
+	lock_guard< mutex > guard( stateLock );
+	readers--;
+	if( readers == 0 )
+	{
+		stateChanged.notify_all();
+	}
+}
+
+/**
+ * @brief lockExclusive
+ *
+ * @details waits until there are no readers and no writer
+ *
+ * @return None
+ *
+ * @note None
+ */
+void RWLock::lockExclusive()
+{
+	unique_lock< mutex > guard( stateLock );
+	waitingWriters++;
+	stateChanged.wait( guard, [ this ]() { return !writing && readers == 0; } );
+	waitingWriters--;
+	writing = true;
+}
+
+/**
+ * @brief unlockExclusive
+ *
+ * @return None
+ *
+ * @note None
+ */
+void RWLock::unlockExclusive()
+{
+	lock_guard< mutex > guard( stateLock );
+	writing = false;
+	stateChanged.notify_all();
+}
+
+/**
+ * @brief LockSet constructor
+ *
+ * @note None
+ */
+LockSet::LockSet()
+{
+
+}
+
+/**
+ * @brief LockSet destructor
+ *
+ * @details releases every lock still held
+ *
+ * @note None
+ */
+LockSet::~LockSet()
+{
+	release();
+}
+
+/**
+ * @brief lockShared
+ *
+ * @param [in] RWLock &lock
+ *
+ * @return None
+ *
+ * @note None
+ */
+void LockSet::lockShared( RWLock &lock )
+{
+	lock.lockShared();
+	heldLocks.push_back( &lock );
+	exclusiveLocks.push_back( false );
+}
+
+/**
+ * @brief lockExclusive
+ *
+ * @param [in] RWLock &lock
+ *
+ * @return None
+ *
+ * @note None
+ */
+void LockSet::lockExclusive( RWLock &lock )
+{
+	lock.lockExclusive();
+	heldLocks.push_back( &lock );
+	exclusiveLocks.push_back( true );
+}
+
+/**
+ * @brief release
+ *
+ * @details releases the locks in the reverse order they were taken
+ *
+ * @return None
+ *
+ * @note None
+ */
+void LockSet::release()
+{
+	for( int index = heldLocks.size() - 1; index >= 0; index-- )
+	{
+		if( exclusiveLocks[ index ] )
+		{
+			heldLocks[ index ]->unlockExclusive();
+		}
+		else
+		{
+			heldLocks[ index ]->unlockShared();
+		}
+	}
+	heldLocks.clear();
+	exclusiveLocks.clear();
+}
+
+/**
+ * @brief LockManager constructor
+ *
+ * @note None
+ */
+LockManager::LockManager()
+{
+	lastVersion = 0;
+}
+
+/**
+ * @brief getCatalogLock
+ *
+ * @return RWLock & lock over the databases and tables of the catalog
+ *
+ * @note None
+ */
+RWLock &LockManager::getCatalogLock()
+{
+	return catalogLock;
+}
+
+/**
+ * @brief getTableLock
+ *
+ * @details finds the lock of a table, creating it on first use
+ *
+ * @param [in] string tableFilePath - path of the table file
+ *
+ * @return RWLock &
+ *
+ * @note locks live as long as the manager, so the reference stays valid
+ */
+RWLock &LockManager::getTableLock( string tableFilePath )
+{
+	lock_guard< mutex > guard( tableMapLock );
+	shared_ptr< RWLock > &tableLock = tableLocks[ tableFilePath ];
+	if( tableLock == NULL )
+	{
+		tableLock = shared_ptr< RWLock >( new RWLock );
+	}
+	return *tableLock;
+}
+
+/**
+ * @brief getTableVersion
+ *
+ * @param [in] string tableFilePath
+ *
+ * @return long version of the last committed write, 0 if never written
+ *
+ * @note None
+ */
+long LockManager::getTableVersion( string tableFilePath )
+{
+	lock_guard< mutex > guard( tableMapLock );
+	map< string, long >::iterator it = tableVersions.find( tableFilePath );
+	return ( it == tableVersions.end() ) ? 0 : it->second;
+}
+
+/**
+ * @brief commitTableVersion
+ *
+ * @details stamps a committed write of a table with the next version
+ *
+ * @param [in] string tableFilePath
+ *
+ * @return long the new version of the table
+ *
+ * @note versions grow across all tables, so they also order commits
+ */
+long LockManager::commitTableVersion( string tableFilePath )
+{
+	lock_guard< mutex > guard( tableMapLock );
+	tableVersions[ tableFilePath ] = ++lastVersion;
+	return lastVersion;
+}
+
+/**
+ * @brief getSnapshotPins
+ *
+ * @details finds the count of open snapshots of a table, creating it on
+ *          first use
+ *
+ * @param [in] string tableFilePath
+ *
+ * @return shared_ptr< atomic< int > > raised by every snapshot while open
+ *
+ * @note a writer holding the table lock sees the count only go down
+ */
+shared_ptr< atomic< int > > LockManager::getSnapshotPins( string tableFilePath )
+{
+	lock_guard< mutex > guard( tableMapLock );
+	shared_ptr< atomic< int > > &pins = snapshotPins[ tableFilePath ];
+	if( pins == NULL )
+	{
+		pins = shared_ptr< atomic< int > >( new atomic< int >( 0 ) );
+	}
+	return pins;
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
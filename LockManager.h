@@ -0,0 +1,81 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file LockManager.h
+ *
+ * @brief Definition file for the RWLock, LockSet and LockManager classes
+ *
+ * @details Specifies the locks that let statements of several connections
+ *          run at the same time. The catalog lock is shared by every
+ *          statement and taken exclusively by CREATE, DROP and ALTER, each
+ *          table has a lock that is shared by readers and exclusive for
+ *          writers. Every committed write gives its table a new version
+ *
+ * @Note None
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef LOCKMANAGER_H
+#define LOCKMANAGER_H
+
+//shared/exclusive lock, waiting writers keep new readers out so a stream
+//of readers cannot starve them
+class RWLock{
+	public:
+		RWLock();
+		void lockShared();
+		void unlockShared();
+		void lockExclusive();
+		void unlockExclusive();
+
+	private:
+		mutex stateLock;
+		condition_variable stateChanged;
+		int readers;
+		int waitingWriters;
+		bool writing;
+};
+
+//locks held by one statement, released together when it is destroyed
+class LockSet{
+	public:
+		LockSet();
+		~LockSet();
+		void lockShared( RWLock &lock );
+		void lockExclusive( RWLock &lock );
+		void release();
+
+	private:
+		vector< RWLock* > heldLocks;
+		vector< bool > exclusiveLocks;
+};
+
+class LockManager{
+	public:
+		LockManager();
+		RWLock &getCatalogLock();
+		RWLock &getTableLock( string tableFilePath );
+		long getTableVersion( string tableFilePath );
+		long commitTableVersion( string tableFilePath );
+		shared_ptr< atomic< int > > getSnapshotPins( string tableFilePath );
+
+	private:
+		RWLock catalogLock;
+		mutex tableMapLock;
+		map< string, shared_ptr< RWLock > > tableLocks;
+		map< string, long > tableVersions;
+		map< string, shared_ptr< atomic< int > > > snapshotPins;
+		long lastVersion;
+};
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
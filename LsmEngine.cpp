@@ -0,0 +1,1364 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file LsmEngine.cpp
+ *
+ * @brief Implementation file for the LSM storage engine
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements the LSM engine built on the text engine, with the
+ *          memtables and sorted runs it keeps next to its tables and the
+ *          merges that fold them into the table files
+ *
+ * @Note Requires LsmEngine.h
+ */
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <map>
+#include <queue>
+#include <algorithm>
+#include <mutex>
+#include <functional>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "LsmEngine.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef LSMENGINE_CPP
+#define LSMENGINE_CPP
+
+/**
+ * @brief getName
+ *
+ * @return string name given after ENGINE=
+ *
+ * @note None
+ */
+string LsmEngine::getName()
+{
+	return "LSM";
+}
+
+/**
+ * @brief needsKey
+ *
+ * @return bool true, the memtable and runs are ordered by the primary key
+ *
+ * @note None
+ */
+bool LsmEngine::needsKey()
+{
+	return true;
+}
+
+/**
+ * @brief getCreateFields
+ *
+ * @return string the engine field and the sequence field of a table none
+ *         of whose inserts were merged into its file yet
+ *
+ * @note None
+ */
+string LsmEngine::getCreateFields()
+{
+	return TextEngine::getCreateFields() + "\t" + LSM_FIELD + " " + string( LSM_SEQUENCE_SIZE, '0' );
+}
+
+/**
+ * @brief scan
+ *
+ * @details builds the operator reading the table file, the runs and the
+ *          memtable of the table as of its current version, merged in key
+ *          order like the file of a clustered text table
+ *
+ * @param [in] TableScan &scan - scan that has read the attributes
+ *
+ * @param [in] WhereCondition wCond
+ *
+ * @param [in] vector< int > projection - attribute indexes to return
+ *
+ * @return shared_ptr< Operator > scan with the condition and projection
+ *         pushed into it, not yet opened
+ *
+ * @note the caller holds the table lock shared or exclusively, the state
+ *       taken keeps the operator reading that version after it is released
+ */
+shared_ptr< Operator > LsmEngine::scan( TableScan &scan, WhereCondition wCond, vector< int > projection )
+{
+	shared_ptr< LsmState > state = getState( *getTree( scan ) );
+	TableScan recordScan( scan );
+	RecordScanner scanMemtable = [ this, recordScan, state ]( WhereCondition condition, vector< int > projectionIndexes, MorselResult &result ) mutable
+	{
+		scanRecords( recordScan, *state, condition, projectionIndexes, result );
+	};
+	return shared_ptr< Operator >( new TableScanOperator( scan, wCond, projection, getRunScans( scan, *state ), scanMemtable ) );
+}
+
+/**
+ * @brief insert
+ *
+ * @details adds one record to the memtable
+ *
+ * @par Algorithm inserts a transaction places in a staged copy of the
+ *      table, which had its runs merged into its file, are taken the way
+ *      the text engine takes them
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] vector< string > values - stored values of the record
+ *
+ * @return int records inserted, -1 if the table has no key to order by
+ *
+ * @note the caller holds the table lock exclusively
+ */
+int LsmEngine::insert( TableScan &scan, vector< string > values )
+{
+	if( scan.placeInserts )
+	{
+		return TextEngine::insert( scan, values );
+	}
+	if( !scan.isClustered() )
+	{
+		return -1;
+	}
+	putRecord( scan, *getTree( scan ), values );
+	return 1;
+}
+
+/**
+ * @brief alter
+ *
+ * @details gives the table a new schema once its runs are merged into the
+ *          table file, as runs hold their records in the old one
+ *
+ * @par Algorithm the primary key orders the memtable and runs, so it can
+ *      neither be dropped nor change its type. The tree is loaded again
+ *      for the new schema
+ *
+ * @param [in] TableScan &scan - scan of the table in its old schema
+ *
+ * @param [in] const vector< StoredColumn > &storedColumns - new schema
+ *
+ * @param [out] string &reason - why the change failed
+ *
+ * @return bool false if the old schema was kept
+ *
+ * @note the caller merges the memtable and runs first
+ */
+bool LsmEngine::alter( TableScan &scan, const vector< StoredColumn > &storedColumns, string &reason )
+{
+	if( scan.keyColumn >= 0 && ( storedColumns[ scan.keyColumn ].dropped || storedColumns[ scan.keyColumn ].modified ) )
+	{
+		reason = "the " + getName() + " engine needs its primary key " + scan.keyName;
+		return false;
+	}
+	if( !getRunPaths( scan.filePath ).empty() )
+	{
+		reason = "its runs are not merged";
+		return false;
+	}
+	forgetTree( scan.filePath );
+	return TextEngine::alter( scan, storedColumns, reason );
+}
+
+/**
+ * @brief drop
+ *
+ * @details removes the table file, its hidden files, its runs and its tree
+ *
+ * @param [in] string tableFilePath
+ *
+ * @return None
+ *
+ * @note None
+ */
+void LsmEngine::drop( string tableFilePath )
+{
+	TextEngine::drop( tableFilePath );
+	vector< string > runPaths = getRunPaths( tableFilePath );
+	for( unsigned int index = 0; index < runPaths.size(); index++ )
+	{
+		unlink( runPaths[ index ].c_str() );
+	}
+	forgetTree( tableFilePath );
+}
+
+/**
+ * @brief release
+ *
+ * @details forgets the trees of the tables below a DatabaseSystem
+ *          directory. Their memtables are redone from its commit log
+ *
+ * @param [in] string systemPath
+ *
+ * @return None
+ *
+ * @note None
+ */
+void LsmEngine::release( string systemPath )
+{
+	lock_guard< mutex > guard( treeLock );
+	string prefix = systemPath + "/";
+	for( map< string, shared_ptr< LsmTree > >::iterator it = trees.begin(); it != trees.end(); )
+	{
+		if( it->first.compare( 0, prefix.size(), prefix ) == 0 )
+		{
+			trees.erase( it++ );
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+/**
+ * @brief buildUniqueIndex
+ *
+ * @details counts the records holding each value of the unique columns in
+ *          the table file, the runs and the memtable
+ *
+ * @param [in] TableScan &scan - scan of the table as committed
+ *
+ * @param [out] UniqueIndex &index - versions are left to the caller
+ *
+ * @return None
+ *
+ * @note the caller holds the table lock
+ */
+void LsmEngine::buildUniqueIndex( TableScan &scan, UniqueIndex &index )
+{
+	shared_ptr< LsmState > state = getState( *getTree( scan ) );
+	vector< TableScan > runScans = getRunScans( scan, *state );
+	vector< string > records;
+	records.reserve( state->records.size() );
+	for( unsigned int record = 0; record < state->records.size(); record++ )
+	{
+		records.push_back( state->records[ record ].second );
+	}
+	scan.buildUniqueIndex( index, runScans, records );
+}
+
+/**
+ * @brief mergeRecords
+ *
+ * @details merges the memtable and every run into the table file
+ *
+ * @param [in] TableScan &scan - scan of the table file
+ *
+ * @return int -1 if the records could not be merged, 1 if the table file
+ *         was rewritten, 0 if there was nothing to merge
+ *
+ * @note the caller holds the table lock exclusively
+ */
+int LsmEngine::mergeRecords( TableScan &scan )
+{
+	return foldRuns( scan, *getTree( scan ) );
+}
+
+/**
+ * @brief needsBlockingRewrite
+ *
+ * @return bool true, the runs are merged into the file before it is
+ *         compacted
+ *
+ * @note None
+ */
+bool LsmEngine::needsBlockingRewrite()
+{
+	return true;
+}
+
+/**
+ * @brief writesAtCheckpoint
+ *
+ * @return bool true, a checkpoint writes the memtable out as a run
+ *
+ * @note None
+ */
+bool LsmEngine::writesAtCheckpoint()
+{
+	return true;
+}
+
+/**
+ * @brief checkpoint
+ *
+ * @details extends the zone map like the text engine and writes the
+ *          memtable out as a run, its inserts are then no longer needed in
+ *          the log
+ *
+ * @param [in] TableScan &scan - scan of the table file
+ *
+ * @return int -1 if the run could not be written, 1 if runs were merged
+ *         into the table file, otherwise 0
+ *
+ * @note the caller holds the table lock exclusively. A tree that was not
+ *       loaded has an empty memtable
+ */
+int LsmEngine::checkpoint( TableScan &scan )
+{
+	TextEngine::checkpoint( scan );
+	shared_ptr< LsmTree > tree = findTree( scan.filePath );
+	if( tree == NULL || tree->memtable->size() == 0 )
+	{
+		return 0;
+	}
+	return flushMemtable( scan, *tree );
+}
+
+/**
+ * @brief stagesInserts
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] const vector< vector< string > > &rows - stored values of the
+ *             inserted records
+ *
+ * @return bool false, the memtable takes records in any key order
+ *
+ * @note None
+ */
+bool LsmEngine::stagesInserts( TableScan &scan, const vector< vector< string > > &rows )
+{
+	return false;
+}
+
+/**
+ * @brief logInsert
+ *
+ * @details describes an insert into the memtable as a commit log line,
+ *          PUT table sequence value...
+ *
+ * @par Algorithm recovery redoes the line only if the memtable of that
+ *      sequence was not written out as a run
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] string tableName - database/table below DatabaseSystem
+ *
+ * @param [in] const vector< string > &values - stored values of the record
+ *
+ * @param [in/out] InsertCursor &cursor - unused, records are not appended
+ *
+ * @return string record without the newline
+ *
+ * @note the caller holds the table lock exclusively until the record is
+ *       put, so the memtable keeps its sequence
+ */
+string LsmEngine::logInsert( TableScan &scan, string tableName, const vector< string > &values, InsertCursor &cursor )
+{
+	vector< string > fields;
+	fields.push_back( "PUT" );
+	fields.push_back( tableName );
+	fields.push_back( to_string( getTree( scan )->memtableSequence ) );
+	fields.insert( fields.end(), values.begin(), values.end() );
+	return joinRow( fields );
+}
+
+/**
+ * @brief finishCommit
+ *
+ * @details writes a full memtable out as a run. A run that failed is
+ *          written by the next checkpoint or redone from the log
+ *
+ * @param [in] TableScan &scan - scan of the table file
+ *
+ * @return int -1 if the run could not be written, 1 if runs were merged
+ *         into the table file, otherwise 0
+ *
+ * @note the caller holds the table lock exclusively
+ */
+int LsmEngine::finishCommit( TableScan &scan )
+{
+	shared_ptr< LsmTree > tree = findTree( scan.filePath );
+	if( tree == NULL || tree->memtable->getByteSize() < LSM_MEMTABLE_SIZE )
+	{
+		return 0;
+	}
+	return flushMemtable( scan, *tree );
+}
+
+/**
+ * @brief redo
+ *
+ * @details puts logged records back into the memtables of the table and
+ *          writes each one out as a run
+ *
+ * @par Algorithm memtables are written out in sequence order, so those up
+ *      to the newest run or the sequence of the table file are already on
+ *      disk. The others are filled again from their PUT lines
+ *
+ * @param [in] TableScan &scan - scan of the table file
+ *
+ * @param [in] vector< vector< string > > &records - PUT table sequence
+ *             value... in log order
+ *
+ * @return bool false if a run could not be written
+ *
+ * @note runs only while the commit log is opened
+ */
+bool LsmEngine::redo( TableScan &scan, vector< vector< string > > &records )
+{
+	map< long, vector< vector< string > > > puts;
+	for( unsigned int index = 0; index < records.size(); index++ )
+	{
+		vector< string > &fields = records[ index ];
+		if( fields[ 0 ] == "PUT" && fields.size() > 3 )
+		{
+			puts[ atol( fields[ 2 ].c_str() ) ].push_back( vector< string >( fields.begin() + 3, fields.end() ) );
+		}
+	}
+	if( puts.empty() )
+	{
+		return true;
+	}
+	if( !scan.isClustered() )
+	{
+		return false;
+	}
+
+	forgetTree( scan.filePath );
+	LsmTree tree;
+	loadTree( scan, tree );
+	for( map< long, vector< vector< string > > >::iterator it = puts.begin(); it != puts.end(); ++it )
+	{
+		if( it->first < tree.memtableSequence )
+		{
+			continue;
+		}
+		tree.memtableSequence = it->first;
+		for( unsigned int index = 0; index < it->second.size(); index++ )
+		{
+			putRecord( scan, tree, it->second[ index ] );
+		}
+		if( flushMemtable( scan, tree ) < 0 )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief findTree
+ *
+ * @param [in] string tableFilePath
+ *
+ * @return shared_ptr< LsmTree > tree of the table, NULL if it was not
+ *         loaded
+ *
+ * @note None
+ */
+shared_ptr< LsmTree > LsmEngine::findTree( string tableFilePath )
+{
+	lock_guard< mutex > guard( treeLock );
+	map< string, shared_ptr< LsmTree > >::iterator found = trees.find( tableFilePath );
+	return ( found == trees.end() ) ? NULL : found->second;
+}
+
+/**
+ * @brief getTree
+ *
+ * @details gives the memtable and runs of a table, loading them from the
+ *          table file and its runs when the tree is first used
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @return shared_ptr< LsmTree >
+ *
+ * @note the caller holds the table lock
+ */
+shared_ptr< LsmTree > LsmEngine::getTree( TableScan &scan )
+{
+	lock_guard< mutex > guard( treeLock );
+	map< string, shared_ptr< LsmTree > >::iterator found = trees.find( scan.filePath );
+	if( found != trees.end() )
+	{
+		return found->second;
+	}
+
+	//the scan may have been opened before the runs were last merged
+	TableScan tableScan;
+	shared_ptr< LsmTree > tree( new LsmTree );
+	tableScan.scanOpen( scan.filePath );
+	loadTree( tableScan, *tree );
+	trees[ scan.filePath ] = tree;
+	return tree;
+}
+
+/**
+ * @brief forgetTree
+ *
+ * @details drops the tree of a table, the next use loads it again
+ *
+ * @param [in] string tableFilePath
+ *
+ * @return None
+ *
+ * @note None
+ */
+void LsmEngine::forgetTree( string tableFilePath )
+{
+	lock_guard< mutex > guard( treeLock );
+	trees.erase( tableFilePath );
+}
+
+/**
+ * @brief loadTree
+ *
+ * @details finds the runs of an LSM table and gives it an empty memtable
+ *
+ * @par Algorithm a run whose sequences were all merged into the table file,
+ *      or into a larger run, was left behind by a crash and is removed. The
+ *      memtable numbers on from the newest run
+ *
+ * @param [in] TableScan &scan - scan of the table file
+ *
+ * @param [out] LsmTree &tree
+ *
+ * @return None
+ *
+ * @note the caller holds the table lock
+ */
+void LsmEngine::loadTree( TableScan &scan, LsmTree &tree )
+{
+	int keyType = scan.isClustered() ? getValueType( scan.storedColumns[ scan.keyColumn ].attribute.attributeType ) : TYPE_STRING;
+	tree.tableSequence = scan.lsmSequence;
+	tree.memtableSequence = scan.lsmSequence + 1;
+	tree.memtable.reset( new SkipList( [ keyType ]( const string &key, const string &other )
+	{
+		return compareKeys( key, other, keyType );
+	} ) );
+	tree.runs.clear();
+	tree.state.reset();
+	if( !scan.isClustered() )
+	{
+		return;
+	}
+
+	vector< string > runPaths = getRunPaths( scan.filePath );
+	vector< LsmRun > found;
+	for( unsigned int index = 0; index < runPaths.size(); index++ )
+	{
+		LsmRun run;
+		if( !readRun( runPaths[ index ], run ) )
+		{
+			continue;
+		}
+		if( run.lastSequence <= scan.lsmSequence )
+		{
+			unlink( run.path.c_str() );
+			continue;
+		}
+		found.push_back( run );
+	}
+	for( unsigned int index = 0; index < found.size(); index++ )
+	{
+		bool merged = false;
+		for( unsigned int other = 0; other < found.size() && !merged; other++ )
+		{
+			merged = other != index && found[ other ].firstSequence <= found[ index ].firstSequence &&
+				found[ index ].lastSequence <= found[ other ].lastSequence;
+		}
+		if( merged )
+		{
+			unlink( found[ index ].path.c_str() );
+		}
+		else
+		{
+			tree.runs.push_back( found[ index ] );
+		}
+	}
+	sort( tree.runs.begin(), tree.runs.end(), []( const LsmRun &run, const LsmRun &other )
+	{
+		return run.lastSequence > other.lastSequence;
+	} );
+	if( !tree.runs.empty() )
+	{
+		tree.memtableSequence = tree.runs.front().lastSequence + 1;
+	}
+}
+
+/**
+ * @brief getState
+ *
+ * @details gives the queries of a table version the records of its LSM
+ *          tree outside the table file
+ *
+ * @par Algorithm the memtable is copied once per version, later queries
+ *      share the copy until a writer changes the tree
+ *
+ * @param [in] LsmTree &tree
+ *
+ * @return shared_ptr< LsmState >
+ *
+ * @note the caller holds the table lock shared or exclusively
+ */
+shared_ptr< LsmState > LsmEngine::getState( LsmTree &tree )
+{
+	lock_guard< mutex > guard( tree.stateLock );
+	if( tree.state == NULL )
+	{
+		shared_ptr< LsmState > state( new LsmState );
+		state->runs = tree.runs;
+		state->records.reserve( tree.memtable->size() );
+		tree.memtable->forEach( [ & ]( const string &key, const string &record )
+		{
+			state->records.push_back( make_pair( key, record ) );
+		} );
+		tree.state = state;
+	}
+	return tree.state;
+}
+
+/**
+ * @brief getRunScans
+ *
+ * @details gives a scan of each run of the LSM state a query reads
+ *
+ * @par Algorithm a run scan is a copy of the table scan reading the run
+ *      file, so it finds its morsels through the zones and Bloom filters
+ *      of the run and binary search on the key like the table file
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] const LsmState &state
+ *
+ * @return vector< TableScan > oldest run first
+ *
+ * @note None
+ */
+vector< TableScan > LsmEngine::getRunScans( TableScan &scan, const LsmState &state )
+{
+	vector< TableScan > runScans;
+	for( int index = (int) state.runs.size() - 1; index >= 0; index-- )
+	{
+		const LsmRun &run = state.runs[ index ];
+		TableScan runScan( scan );
+		runScan.filePath = run.path;
+		runScan.snapshot = run.snapshot;
+		runScan.dataOffset = run.dataOffset;
+		runScan.fileSize = run.fileSize;
+		runScan.compressed = false;
+		runScan.zones = run.zones;
+		runScan.zoneFilePath.clear();
+		runScan.bloomFilePath.clear();
+		runScan.overflowFilePath.clear();
+		runScan.filtersLoaded = true;
+		runScans.push_back( runScan );
+	}
+	return runScans;
+}
+
+/**
+ * @brief scanRecords
+ *
+ * @details reads the rows of the memtable records of the LSM state that
+ *          satisfy a condition
+ *
+ * @par Algorithm the records are in key order, a comparison of the key
+ *      with a value only reads those in range, found by binary search
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] const LsmState &state
+ *
+ * @param [in] WhereCondition wCond - empty operator matches every row
+ *
+ * @param [in] vector< int > projection - attribute indexes to keep
+ *
+ * @param [out] MorselResult &result
+ *
+ * @return None
+ *
+ * @note None
+ */
+void LsmEngine::scanRecords( TableScan &scan, const LsmState &state, WhereCondition wCond, vector< int > projection, MorselResult &result )
+{
+	typedef vector< pair< string, string > >::const_iterator RecordIterator;
+	const vector< pair< string, string > > &records = state.records;
+	RecordIterator first = records.begin();
+	RecordIterator last = records.end();
+	const string &operatorValue = wCond.operatorValue;
+	int keyType = scan.isKeyAttribute( wCond.attributeIndex ) ? getValueType( scan.storedColumns[ scan.keyColumn ].attribute.attributeType ) : TYPE_FLOAT;
+	if( keyType != TYPE_FLOAT && !wCond.comparisonValue.empty() && !wCond.floatValue && wCond.intValue == ( keyType == TYPE_INT ) )
+	{
+		function< bool( const pair< string, string > &record, const string &key ) > below = [ keyType ]( const pair< string, string > &record, const string &key )
+		{
+			return compareKeys( record.first, key, keyType ) < 0;
+		};
+		function< bool( const string &key, const pair< string, string > &record ) > above = [ keyType ]( const string &key, const pair< string, string > &record )
+		{
+			return compareKeys( key, record.first, keyType ) < 0;
+		};
+		if( operatorValue == "=" || operatorValue == ">=" )
+		{
+			first = lower_bound( records.begin(), records.end(), wCond.comparisonValue, below );
+		}
+		else if( operatorValue == ">" )
+		{
+			first = upper_bound( records.begin(), records.end(), wCond.comparisonValue, above );
+		}
+		if( operatorValue == "=" || operatorValue == "<=" )
+		{
+			last = upper_bound( records.begin(), records.end(), wCond.comparisonValue, above );
+		}
+		else if( operatorValue == "<" )
+		{
+			last = lower_bound( records.begin(), records.end(), wCond.comparisonValue, below );
+		}
+	}
+
+	scan.resolveCondition( wCond );
+	for( RecordIterator record = first; record < last; ++record )
+	{
+		scan.addMatchingRow( record->second, wCond, projection, result );
+	}
+}
+
+/**
+ * @brief putRecord
+ *
+ * @details inserts a record into the memtable
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] LsmTree &tree
+ *
+ * @param [in] const vector< string > &values - stored values, padded
+ *
+ * @return None
+ *
+ * @note None
+ */
+void LsmEngine::putRecord( TableScan &scan, LsmTree &tree, const vector< string > &values )
+{
+	string record = joinRow( values );
+	tree.memtable->insert( scan.getRecordKey( scan.getRecordValues( record ), scan.keyColumn ), record );
+	tree.state.reset();
+}
+
+/**
+ * @brief readRun
+ *
+ * @details opens a run file and reads its zones
+ *
+ * @param [in] string runPath
+ *
+ * @param [out] LsmRun &run
+ *
+ * @return bool false if the file is not a whole run
+ *
+ * @note None
+ */
+bool LsmEngine::readRun( string runPath, LsmRun &run )
+{
+	ifstream fin( runPath.c_str(), ifstream::binary );
+	string line;
+	if( !fin.is_open() || !getline( fin, line ) )
+	{
+		return false;
+	}
+	vector< string > fields = splitRow( line );
+	if( fields.size() != 5 || fields[ 0 ] != "#" + RUN_SUFFIX )
+	{
+		return false;
+	}
+	run.path = runPath;
+	run.level = atoi( fields[ 1 ].c_str() );
+	run.firstSequence = atol( fields[ 2 ].c_str() );
+	run.lastSequence = atol( fields[ 3 ].c_str() );
+	run.dataOffset = line.size() + 1;
+	run.fileSize = atol( fields[ 4 ].c_str() );
+	if( run.fileSize < run.dataOffset )
+	{
+		return false;
+	}
+
+	//a line per zone follows the records, with the smallest and largest
+	//value and the Bloom filter of each column
+	vector< Zone > zoneList;
+	fin.seekg( run.fileSize + 1 );
+	while( getline( fin, line ) )
+	{
+		fields = splitRow( line );
+		if( fields.size() < 2 || ( fields.size() - 2 ) % 3 != 0 )
+		{
+			return false;
+		}
+		Zone zone;
+		zone.startOffset = atol( fields[ 0 ].c_str() );
+		zone.endOffset = atol( fields[ 1 ].c_str() );
+		for( unsigned int index = 2; index < fields.size(); index += 3 )
+		{
+			const string &hex = fields[ index + 2 ];
+			string filter;
+			for( unsigned int byte = 0; byte + 1 < hex.size(); byte += 2 )
+			{
+				filter += (char) strtol( hex.substr( byte, 2 ).c_str(), NULL, 16 );
+			}
+			zone.minimums.push_back( fields[ index ] );
+			zone.maximums.push_back( fields[ index + 1 ] );
+			zone.filters.push_back( filter );
+		}
+		zoneList.push_back( zone );
+	}
+	if( zoneList.empty() )
+	{
+		return false;
+	}
+
+	shared_ptr< TableSnapshot > opened( new TableSnapshot );
+	opened->fd = open( runPath.c_str(), O_RDONLY );
+	opened->fileSize = run.fileSize;
+	if( opened->fd < 0 )
+	{
+		return false;
+	}
+	run.zones.reset( new vector< Zone >( zoneList ) );
+	run.snapshot = opened;
+	return true;
+}
+
+/**
+ * @brief writeRun
+ *
+ * @details writes records in key order to a new run file
+ *
+ * @par Algorithm the records are written like those of the table file,
+ *      zones of about a morsel each, and the zones after them. Every zone
+ *      gets a Bloom filter of its keys, so a lookup skips the runs not
+ *      holding its key. The header is written last with where the records
+ *      end, then the file is synced and renamed into place
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in/out] LsmRun &run - path, level and sequences set, the rest
+ *                 filled in
+ *
+ * @param [in] function< bool( string &record ) > nextRecord - gives the
+ *             records in key order, false after the last
+ *
+ * @return bool false if the run could not be written
+ *
+ * @note None
+ */
+bool LsmEngine::writeRun( TableScan &scan, LsmRun &run, function< bool( string &record ) > nextRecord )
+{
+	char header[ 80 ];
+	function< void( long recordsEnd ) > formatHeader = [ & ]( long recordsEnd )
+	{
+		snprintf( header, sizeof( header ), "#%s\t%d\t%016ld\t%016ld\t%016ld", RUN_SUFFIX.c_str(),
+			run.level, run.firstSequence, run.lastSequence, recordsEnd );
+	};
+	string tempPath = run.path + ".tmp";
+	ofstream fout( tempPath.c_str(), ofstream::binary | ofstream::trunc );
+	formatHeader( 0 );
+	fout << header;
+
+	//runs are text whatever the table file is
+	bool tableCompressed = scan.compressed;
+	scan.compressed = false;
+	scan.setZoneColumns();
+	scan.filteredColumns[ scan.keyColumn ] = scan.columnTypes[ scan.keyColumn ] != TYPE_FLOAT;
+	vector< Zone > zoneList;
+	vector< SortedRecord > chunk;
+	long chunkBytes = 0;
+	SortedRecord record;
+	while( nextRecord( record.record ) )
+	{
+		record.values = scan.getRecordValues( record.record );
+		record.key = scan.getRecordKey( record.values, scan.keyColumn );
+		chunkBytes += record.record.size() + 1;
+		chunk.push_back( record );
+		if( chunkBytes >= MORSEL_SIZE )
+		{
+			scan.writeSortedRecords( fout, chunk, chunkBytes, zoneList );
+			chunk.clear();
+			chunkBytes = 0;
+		}
+	}
+	if( !chunk.empty() )
+	{
+		scan.writeSortedRecords( fout, chunk, chunkBytes, zoneList );
+	}
+	scan.compressed = tableCompressed;
+
+	long recordsEnd = fout.tellp();
+	char hex[ 3 ];
+	for( unsigned int index = 0; index < zoneList.size(); index++ )
+	{
+		const Zone &zone = zoneList[ index ];
+		fout << "\n" << zone.startOffset << "\t" << zone.endOffset;
+		for( unsigned int column = 0; column < zone.minimums.size(); column++ )
+		{
+			fout << "\t" << zone.minimums[ column ] << "\t" << zone.maximums[ column ] << "\t";
+			for( unsigned int byte = 0; column < zone.filters.size() && byte < zone.filters[ column ].size(); byte++ )
+			{
+				snprintf( hex, sizeof( hex ), "%02x", (unsigned char) zone.filters[ column ][ byte ] );
+				fout << hex;
+			}
+		}
+	}
+	formatHeader( recordsEnd );
+	fout.seekp( 0 );
+	fout << header;
+	fout.close();
+
+	if( zoneList.empty() || fout.fail() || !syncFile( tempPath ) || rename( tempPath.c_str(), run.path.c_str() ) != 0 )
+	{
+		unlink( tempPath.c_str() );
+		return false;
+	}
+	return syncDirectory( run.path ) && readRun( run.path, run );
+}
+
+/**
+ * @brief writeMemtable
+ *
+ * @details writes the memtable of an LSM table out as a run of level 0
+ *          and empties it
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] LsmTree &tree
+ *
+ * @return bool false if the run could not be written, the memtable then
+ *         keeps its records
+ *
+ * @note None
+ */
+bool LsmEngine::writeMemtable( TableScan &scan, LsmTree &tree )
+{
+	if( tree.memtable->size() == 0 )
+	{
+		return true;
+	}
+
+	LsmRun run;
+	run.level = 0;
+	run.firstSequence = tree.memtableSequence;
+	run.lastSequence = tree.memtableSequence;
+	run.path = getWorkPath( scan.filePath, RUN_SUFFIX + to_string( run.firstSequence ) + "-" + to_string( run.lastSequence ) );
+	vector< string > records;
+	records.reserve( tree.memtable->size() );
+	tree.memtable->forEach( [ & ]( const string &key, const string &record )
+	{
+		records.push_back( record );
+	} );
+	unsigned int next = 0;
+	if( !writeRun( scan, run, [ & ]( string &record )
+	{
+		if( next == records.size() )
+		{
+			return false;
+		}
+		record = records[ next++ ];
+		return true;
+	} ) )
+	{
+		return false;
+	}
+
+	tree.runs.insert( tree.runs.begin(), run );
+	tree.memtable->clear();
+	tree.memtableSequence++;
+	tree.state.reset();
+	return true;
+}
+
+/**
+ * @brief mergeRuns
+ *
+ * @details merges runs of an LSM table into one run of a level
+ *
+ * @par Algorithm the first record of each run is kept in a priority queue,
+ *      ties taken from the newer run and the older record dropped. A run
+ *      alone only has the level in its header changed
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] LsmTree &tree
+ *
+ * @param [in] vector< LsmRun > &inputs - newest first
+ *
+ * @param [in] int level
+ *
+ * @return bool false if the merged run could not be written, the runs are
+ *         then kept
+ *
+ * @note None
+ */
+bool LsmEngine::mergeRuns( TableScan &scan, LsmTree &tree, vector< LsmRun > &inputs, int level )
+{
+	int inputCount = inputs.size();
+	if( inputCount == 1 )
+	{
+		char levelDigit = '0' + level;
+		int fd = open( inputs[ 0 ].path.c_str(), O_WRONLY );
+		bool moved = fd >= 0 && pwrite( fd, &levelDigit, 1, RUN_SUFFIX.size() + 2 ) == 1 && fsync( fd ) == 0;
+		if( fd >= 0 )
+		{
+			close( fd );
+		}
+		for( unsigned int index = 0; moved && index < tree.runs.size(); index++ )
+		{
+			if( tree.runs[ index ].path == inputs[ 0 ].path )
+			{
+				tree.runs[ index ].level = level;
+			}
+		}
+		tree.state.reset();
+		return moved;
+	}
+
+	LsmRun output;
+	output.level = level;
+	output.firstSequence = inputs[ 0 ].firstSequence;
+	output.lastSequence = inputs[ 0 ].lastSequence;
+	for( int input = 0; input < inputCount; input++ )
+	{
+		output.firstSequence = min( output.firstSequence, inputs[ input ].firstSequence );
+		output.lastSequence = max( output.lastSequence, inputs[ input ].lastSequence );
+	}
+	output.path = getWorkPath( scan.filePath, RUN_SUFFIX + to_string( output.firstSequence ) + "-" + to_string( output.lastSequence ) );
+
+	int keyType = getValueType( scan.storedColumns[ scan.keyColumn ].attribute.attributeType );
+	vector< shared_ptr< ifstream > > streams( inputCount );
+	vector< long > positions( inputCount );
+	vector< SortedRecord > heads( inputCount );
+	function< bool( int input ) > readHead = [ & ]( int input )
+	{
+		if( positions[ input ] >= inputs[ input ].fileSize || !getline( *streams[ input ], heads[ input ].record ) )
+		{
+			return false;
+		}
+		positions[ input ] += heads[ input ].record.size() + 1;
+		heads[ input ].key = scan.getRecordKey( scan.getRecordValues( heads[ input ].record ), scan.keyColumn );
+		return true;
+	};
+	function< bool( int input, int other ) > later = [ & ]( int input, int other )
+	{
+		int order = compareKeys( heads[ input ].key, heads[ other ].key, keyType );
+		return order > 0 || ( order == 0 && input > other );
+	};
+	priority_queue< int, vector< int >, function< bool( int input, int other ) > > nextRecords( later );
+	for( int input = 0; input < inputCount; input++ )
+	{
+		streams[ input ].reset( new ifstream( inputs[ input ].path.c_str(), ifstream::binary ) );
+		streams[ input ]->seekg( inputs[ input ].dataOffset );
+		positions[ input ] = inputs[ input ].dataOffset;
+		if( readHead( input ) )
+		{
+			nextRecords.push( input );
+		}
+	}
+
+	if( !writeRun( scan, output, [ & ]( string &record )
+	{
+		if( nextRecords.empty() )
+		{
+			return false;
+		}
+		int input = nextRecords.top();
+		nextRecords.pop();
+		string key = heads[ input ].key;
+		record.swap( heads[ input ].record );
+		if( readHead( input ) )
+		{
+			nextRecords.push( input );
+		}
+		while( !nextRecords.empty() && compareKeys( heads[ nextRecords.top() ].key, key, keyType ) == 0 )
+		{
+			int older = nextRecords.top();
+			nextRecords.pop();
+			if( readHead( older ) )
+			{
+				nextRecords.push( older );
+			}
+		}
+		return true;
+	} ) )
+	{
+		return false;
+	}
+
+	for( int input = 0; input < inputCount; input++ )
+	{
+		unlink( inputs[ input ].path.c_str() );
+		for( unsigned int index = 0; index < tree.runs.size(); index++ )
+		{
+			if( tree.runs[ index ].path == inputs[ input ].path )
+			{
+				tree.runs.erase( tree.runs.begin() + index );
+				break;
+			}
+		}
+	}
+	unsigned int place = 0;
+	while( place < tree.runs.size() && tree.runs[ place ].lastSequence > output.lastSequence )
+	{
+		place++;
+	}
+	tree.runs.insert( tree.runs.begin() + place, output );
+	tree.state.reset();
+	return true;
+}
+
+/**
+ * @brief foldLevel
+ *
+ * @details merges runs of an LSM table into its table file
+ *
+ * @par Algorithm the table is rewritten with the records of the runs as
+ *      partitions of their own, and its attribute line takes the last
+ *      sequence merged. The runs are removed once the table is in place,
+ *      a crash in between leaves runs that the next load removes
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] LsmTree &tree
+ *
+ * @param [in] vector< LsmRun > &runs - the oldest runs
+ *
+ * @return bool false if the table could not be rewritten, the runs are
+ *         then kept
+ *
+ * @note the caller holds the table lock exclusively
+ */
+bool LsmEngine::foldLevel( TableScan &scan, LsmTree &tree, vector< LsmRun > &runs )
+{
+	long previousSequence = scan.lsmSequence;
+	scan.mergedFiles.clear();
+	for( unsigned int index = 0; index < runs.size(); index++ )
+	{
+		scan.lsmSequence = max( scan.lsmSequence, runs[ index ].lastSequence );
+		SortedFile sorted;
+		sorted.snapshot = runs[ index ].snapshot;
+		sorted.dataOffset = runs[ index ].dataOffset;
+		sorted.fileSize = runs[ index ].fileSize;
+		scan.mergedFiles.push_back( sorted );
+	}
+	int recordCount = scan.parallelRewrite( []( vector< string > &row )
+	{
+		return ROW_KEEP;
+	}, NULL );
+	scan.mergedFiles.clear();
+	if( recordCount < 0 )
+	{
+		scan.lsmSequence = previousSequence;
+		return false;
+	}
+	syncDirectory( scan.filePath );
+	scan.attributeData = setLsmSequence( scan.attributeData, scan.lsmSequence );
+
+	for( unsigned int index = 0; index < runs.size(); index++ )
+	{
+		unlink( runs[ index ].path.c_str() );
+		for( unsigned int run = 0; run < tree.runs.size(); run++ )
+		{
+			if( tree.runs[ run ].path == runs[ index ].path )
+			{
+				tree.runs.erase( tree.runs.begin() + run );
+				break;
+			}
+		}
+	}
+	tree.tableSequence = scan.lsmSequence;
+	tree.state.reset();
+	return true;
+}
+
+/**
+ * @brief compactRuns
+ *
+ * @details merges the runs of an LSM table as its levels fill up
+ *
+ * @par Algorithm more than LSM_LEVEL0_RUNS runs of level 0 are merged with
+ *      the run of level 1. A run larger than its level allows is merged
+ *      with the run of the next level, or into the table file from the
+ *      last level. Repeated until every level fits
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] LsmTree &tree
+ *
+ * @return int -1 if a merge failed, 1 if runs were merged into the table
+ *         file, otherwise 0
+ *
+ * @note the caller holds the table lock exclusively
+ */
+int LsmEngine::compactRuns( TableScan &scan, LsmTree &tree )
+{
+	int folded = 0;
+	function< int( int level ) > findRun = [ & ]( int level )
+	{
+		for( unsigned int index = 0; index < tree.runs.size(); index++ )
+		{
+			if( tree.runs[ index ].level == level )
+			{
+				return (int) index;
+			}
+		}
+		return -1;
+	};
+	while( true )
+	{
+		vector< LsmRun > inputs;
+		for( unsigned int index = 0; index < tree.runs.size(); index++ )
+		{
+			if( tree.runs[ index ].level == 0 )
+			{
+				inputs.push_back( tree.runs[ index ] );
+			}
+		}
+		if( (int) inputs.size() > LSM_LEVEL0_RUNS )
+		{
+			if( findRun( 1 ) >= 0 )
+			{
+				inputs.push_back( tree.runs[ findRun( 1 ) ] );
+			}
+			if( !mergeRuns( scan, tree, inputs, 1 ) )
+			{
+				return -1;
+			}
+			continue;
+		}
+
+		bool merged = false;
+		long levelLimit = LSM_MEMTABLE_SIZE * LSM_LEVEL0_RUNS;
+		for( int level = 1; level <= LSM_LEVELS && !merged; level++, levelLimit *= LSM_LEVEL_RATIO )
+		{
+			int run = findRun( level );
+			if( run < 0 || tree.runs[ run ].fileSize - tree.runs[ run ].dataOffset <= levelLimit )
+			{
+				continue;
+			}
+			merged = true;
+			inputs.assign( 1, tree.runs[ run ] );
+			if( level == LSM_LEVELS )
+			{
+				if( !foldLevel( scan, tree, inputs ) )
+				{
+					return -1;
+				}
+				folded = 1;
+				continue;
+			}
+			if( findRun( level + 1 ) >= 0 )
+			{
+				inputs.push_back( tree.runs[ findRun( level + 1 ) ] );
+			}
+			if( !mergeRuns( scan, tree, inputs, level + 1 ) )
+			{
+				return -1;
+			}
+		}
+		if( !merged )
+		{
+			return folded;
+		}
+	}
+}
+
+/**
+ * @brief flushMemtable
+ *
+ * @details writes the memtable of an LSM table out as a run and merges
+ *          the runs as their levels fill up
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] LsmTree &tree
+ *
+ * @return int -1 if a run could not be written, 1 if runs were merged into
+ *         the table file, which then has a new version, otherwise 0
+ *
+ * @note the caller holds the table lock exclusively
+ */
+int LsmEngine::flushMemtable( TableScan &scan, LsmTree &tree )
+{
+	if( !writeMemtable( scan, tree ) )
+	{
+		return -1;
+	}
+	return compactRuns( scan, tree );
+}
+
+/**
+ * @brief foldRuns
+ *
+ * @details merges the memtable and every run of an LSM table into its
+ *          table file, before the file is rewritten by an update, delete
+ *          or alter
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] LsmTree &tree
+ *
+ * @return int -1 if the records could not be merged, 1 if the table file
+ *         was rewritten, 0 if there was nothing to merge
+ *
+ * @note the caller holds the table lock exclusively
+ */
+int LsmEngine::foldRuns( TableScan &scan, LsmTree &tree )
+{
+	if( !writeMemtable( scan, tree ) )
+	{
+		return -1;
+	}
+	if( tree.runs.empty() )
+	{
+		return 0;
+	}
+	vector< LsmRun > runs = tree.runs;
+	return foldLevel( scan, tree, runs ) ? 1 : -1;
+}
+
+/**
+ * @brief getRunPaths
+ *
+ * @details lists the run files kept next to an LSM table
+ *
+ * @param [in] string tableFilePath
+ *
+ * @return vector< string > paths of the form directory/.table.runFIRST-LAST,
+ *         work files left by a crash are not listed
+ *
+ * @note None
+ */
+vector< string > getRunPaths( string tableFilePath )
+{
+	vector< string > runPaths;
+	size_t slashIndex = tableFilePath.find_last_of( '/' );
+	string directory = tableFilePath.substr( 0, slashIndex + 1 );
+	string prefix = "." + tableFilePath.substr( slashIndex + 1 ) + "." + RUN_SUFFIX;
+	DIR *dirp = opendir( directory.empty() ? "." : directory.c_str() );
+	if( dirp == NULL )
+	{
+		return runPaths;
+	}
+	struct dirent *entry;
+	while( ( entry = readdir( dirp ) ) != NULL )
+	{
+		string name = entry->d_name;
+		if( name.size() > prefix.size() && name.compare( 0, prefix.size(), prefix ) == 0 &&
+			isdigit( name[ prefix.size() ] ) && name.find( '.', prefix.size() ) == string::npos )
+		{
+			runPaths.push_back( directory + name );
+		}
+	}
+	closedir( dirp );
+	return runPaths;
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
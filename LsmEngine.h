@@ -0,0 +1,130 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file LsmEngine.h
+ *
+ * @brief Definition file for the LSM storage engine
+ *
+ * @details Specifies the engine that keeps a table as a log-structured merge
+ *          tree: a memtable and sorted runs next to the table file, which
+ *          are merged into it as they grow
+ *
+ * @Note None
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <map>
+#include <mutex>
+#include "StorageEngine.h"
+#include "SkipList.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef LSMENGINE_H
+#define LSMENGINE_H
+
+//an LSM table writes its memtable out as a run of level 0 once the records
+//in it take this many bytes
+const long LSM_MEMTABLE_SIZE = 4 << 20;
+
+//runs of level 0 are merged into level 1 once there are more than this
+//many. Level 1 holds one run of up to that many memtables and each level
+//after it one run of up to LSM_LEVEL_RATIO times as many bytes. A run
+//outgrowing the last level is merged into the table file
+const int LSM_LEVEL0_RUNS = 4;
+const int LSM_LEVEL_RATIO = 10;
+const int LSM_LEVELS = 2;
+
+//hidden file next to an LSM table holding one run, named by the first and
+//last sequence of the memtables merged into it
+const string RUN_SUFFIX = "run";
+
+//sorted run of an LSM table. Its records follow a header line like those of
+//the table and are split into zones, each with a Bloom filter of its keys.
+//The snapshot keeps the file open for the queries reading the run, its
+//size is where the records end
+struct LsmRun{
+	string path;
+	int level;
+	long firstSequence;
+	long lastSequence;
+	long dataOffset;
+	long fileSize;
+	shared_ptr< vector< Zone > > zones;
+	shared_ptr< TableSnapshot > snapshot;
+};
+
+//records of an LSM table that are not in its table file as of one
+//version, shared by the queries reading that version. The runs are newest
+//first, the memtable records in key order with their keys
+struct LsmState{
+	vector< LsmRun > runs;
+	vector< pair< string, string > > records;
+};
+
+//the records of an LSM table kept outside its table file. The memtable
+//takes inserts in key order and is written out as a run, sequences number
+//the memtables in the order they were written. Only changed under the
+//exclusive table lock, state is taken by queries under the shared one
+struct LsmTree{
+	long tableSequence;
+	long memtableSequence;
+	shared_ptr< SkipList > memtable;
+	vector< LsmRun > runs;
+	mutex stateLock;
+	shared_ptr< LsmState > state;
+};
+
+//inserts go to the memtable and sorted runs next to the table file, which
+//are merged into it before an update, delete, rewrite or schema change.
+//The tree of a table is loaded when it is first used and kept until the
+//table is altered or dropped
+class LsmEngine : public TextEngine{
+	public:
+		string getName();
+		bool needsKey();
+		string getCreateFields();
+		shared_ptr< Operator > scan( TableScan &scan, WhereCondition wCond, vector< int > projection );
+		int insert( TableScan &scan, vector< string > values );
+		bool alter( TableScan &scan, const vector< StoredColumn > &storedColumns, string &reason );
+		void drop( string tableFilePath );
+		void release( string systemPath );
+		void buildUniqueIndex( TableScan &scan, UniqueIndex &index );
+		int mergeRecords( TableScan &scan );
+		bool needsBlockingRewrite();
+		bool writesAtCheckpoint();
+		int checkpoint( TableScan &scan );
+		bool stagesInserts( TableScan &scan, const vector< vector< string > > &rows );
+		string logInsert( TableScan &scan, string tableName, const vector< string > &values, InsertCursor &cursor );
+		int finishCommit( TableScan &scan );
+		bool redo( TableScan &scan, vector< vector< string > > &records );
+
+	private:
+		mutex treeLock;
+		map< string, shared_ptr< LsmTree > > trees;
+
+		shared_ptr< LsmTree > findTree( string tableFilePath );
+		shared_ptr< LsmTree > getTree( TableScan &scan );
+		void forgetTree( string tableFilePath );
+		void loadTree( TableScan &scan, LsmTree &tree );
+		shared_ptr< LsmState > getState( LsmTree &tree );
+		vector< TableScan > getRunScans( TableScan &scan, const LsmState &state );
+		void scanRecords( TableScan &scan, const LsmState &state, WhereCondition wCond, vector< int > projection, MorselResult &result );
+		void putRecord( TableScan &scan, LsmTree &tree, const vector< string > &values );
+		bool readRun( string runPath, LsmRun &run );
+		bool writeRun( TableScan &scan, LsmRun &run, function< bool( string &record ) > nextRecord );
+		bool writeMemtable( TableScan &scan, LsmTree &tree );
+		bool mergeRuns( TableScan &scan, LsmTree &tree, vector< LsmRun > &inputs, int level );
+		bool foldLevel( TableScan &scan, LsmTree &tree, vector< LsmRun > &runs );
+		int compactRuns( TableScan &scan, LsmTree &tree );
+		int flushMemtable( TableScan &scan, LsmTree &tree );
+		int foldRuns( TableScan &scan, LsmTree &tree );
+};
+
+vector< string > getRunPaths( string tableFilePath );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,79 @@
+--CS457 ENGINE=LSM
+
+--Construct the database and table
+CREATE DATABASE CS457_LSM;
+USE CS457_LSM;
+CREATE TABLE Reading (rid int PRIMARY KEY, sensor varchar(20), value float) ENGINE=LSM;
+CREATE TABLE Loose (rid int, sensor varchar(20)) ENGINE=LSM;
+CREATE TABLE Odd (rid int PRIMARY KEY) ENGINE=PAPER;
+
+--Inserts in any key order go to the memtable, a repeated key is refused
+insert into Reading values(42, 's1', 4.2);
+insert into Reading values(7, 's2', 0.7);
+insert into Reading values(19, 's1', 1.9);
+BEGIN;
+insert into Reading values(3, 's3', 0.3);
+insert into Reading values(88, 's2', 8.8);
+COMMIT;
+insert into Reading values(19, 's9', 9.9);
+select * from Reading;
+select sensor, value from Reading where rid > 10;
+
+--Updates and deletes merge everything into the table file
+update Reading set value = 2.0 where rid = 19;
+delete from Reading where sensor = 's2';
+insert into Reading values(1, 's4', 0.1);
+select * from Reading;
+
+--The engine needs its primary key
+ALTER TABLE Reading DROP rid;
+ALTER TABLE Reading MODIFY rid varchar(10);
+ALTER TABLE Reading DROP value;
+select * from Reading;
+
+.exit
+
+-- Expected output
+--
+-- Database CS457_LSM created.
+-- Using Database CS457_LSM.
+-- Table Reading created.
+-- !Failed to create table Loose because the LSM engine needs a primary key.
+-- !Failed to create table Odd because its engine is not known.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- Transaction started.
+-- Statement added to transaction.
+-- Statement added to transaction.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- Transaction committed.
+-- !Failed to insert into Reading because rid = 19 already exists.
+-- rid int|sensor varchar(20)|value float
+-- 3|s3|0.3
+-- 7|s2|0.7
+-- 19|s1|1.9
+-- 42|s1|4.2
+-- 88|s2|8.8
+-- sensor varchar(20)|value float
+-- s1|1.9
+-- s1|4.2
+-- s2|8.8
+-- 1 record modified.
+-- 2 records deleted.
+-- 1 new record inserted.
+-- rid int|sensor varchar(20)|value float
+-- 1|s4|0.1
+-- 3|s3|0.3
+-- 19|s1|2.0
+-- 42|s1|4.2
+-- !Failed to modify table Reading because the LSM engine needs its primary key rid.
+-- !Failed to modify table Reading because the LSM engine needs its primary key rid.
+-- Table Reading modified.
+-- rid int|sensor varchar(20)
+-- 1|s4
+-- 3|s3
+-- 19|s1
+-- 42|s1
+-- All done.
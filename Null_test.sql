@@ -0,0 +1,65 @@
+--CS457 NULL
+
+--Construct the database and table
+CREATE DATABASE CS457_NULL;
+USE CS457_NULL;
+CREATE TABLE Product (pid int, name varchar(20), price float);
+
+--Insert and assign null
+insert into Product values(1, 'Gizmo', 19.99);
+insert into Product values(2, NULL, 29.99);
+insert into Product values(3, 'SingleTouch', NULL);
+insert into Product values(NULL, 'MultiTouch', 199.99);
+update Product set price = NULL where pid = 1;
+select * from Product;
+
+--IS NULL and IS NOT NULL test for null
+select pid, name from Product where price is null;
+select name from Product where pid is not null;
+
+--A comparison with null is never true
+select name from Product where price > 0;
+select name from Product where price != 19.99;
+select name from Product where name = NULL;
+
+--Delete by null
+delete from Product where name is null;
+select * from Product;
+
+.exit
+
+-- Expected output
+--
+-- Database CS457_NULL created.
+-- Using Database CS457_NULL.
+-- Table Product created.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- 1 record modified.
+-- pid int|name varchar(20)|price float
+-- 1|Gizmo|null
+-- 2|null|29.99
+-- 3|SingleTouch|null
+-- null|MultiTouch|199.99
+-- pid int|name varchar(20)
+-- 1|Gizmo
+-- 3|SingleTouch
+-- name varchar(20)
+-- Gizmo
+-- null
+-- SingleTouch
+-- name varchar(20)
+-- null
+-- MultiTouch
+-- name varchar(20)
+-- null
+-- MultiTouch
+-- name varchar(20)
+-- 1 record deleted.
+-- pid int|name varchar(20)|price float
+-- 1|Gizmo|null
+-- 3|SingleTouch|null
+-- null|MultiTouch|199.99
+-- All done.
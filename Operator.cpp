@@ -0,0 +1,474 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file Operator.cpp
+ *
+ * @brief Implementation file for the query operators
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements the iterator based operators that query results are
+ *          pulled through and the console printer that consumes them
+ *
+ * @Note Requires Operator.h
+ */
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cctype>
+#include "Operator.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef OPERATOR_CPP
+#define OPERATOR_CPP
+
+/**
+ * @brief getValueType
+ *
+ * @details maps a declared attribute type onto a value type
+ *
+ * @param [in] string attributeType - e.g. int, float, varchar(20)
+ *
+ * @return int TYPE_INT, TYPE_FLOAT or TYPE_STRING
+ *
+ * @note None
+ */
+int getValueType( string attributeType )
+{
+	int typeSize = attributeType.size();
+	for( int index = 0; index < typeSize; index++ )
+	{
+		attributeType[ index ] = tolower( attributeType[ index ] );
+	}
+
+	if( attributeType == "int" || attributeType == "integer" )
+	{
+		return TYPE_INT;
+	}
+	else if( attributeType == "float" || attributeType == "double" )
+	{
+		return TYPE_FLOAT;
+	}
+	return TYPE_STRING;
+}
+
+/**
+ * @brief makeValue
+ *
+ * @details converts a stored value into a typed value
+ *
+ * @param [in] string content - value as stored in the table file
+ *
+ * @param [in] int valueType
+ *
+ * @return Value
+ *
+ * @note quotes around stored strings are not part of the value
+ */
+Value makeValue( string content, int valueType )
+{
+	Value value;
+	value.valueType = valueType;
+	value.isNull = isNullValue( content );
+	value.intValue = 0;
+	value.floatValue = 0.0;
+
+	if( content.size() > 1 && content[ 0 ] == '\'' && content[ content.size() - 1 ] == '\'' )
+	{
+		content = content.substr( 1, content.size() - 2 );
+		value.isNull = false;
+	}
+	value.text = value.isNull ? "null" : content;
+
+	if( !value.isNull && valueType == TYPE_INT )
+	{
+		value.intValue = atol( content.c_str() );
+		value.floatValue = value.intValue;
+	}
+	else if( !value.isNull && valueType == TYPE_FLOAT )
+	{
+		value.floatValue = atof( content.c_str() );
+		value.intValue = (long) value.floatValue;
+	}
+	return value;
+}
+
+/**
+ * @brief Operator destructor
+ *
+ * @note None
+ */
+Operator::~Operator()
+{
+
+}
+
+/**
+ * @brief TableScanOperator constructor
+ *
+ * @param [in] TableScan tableScan - scan that has already read the attributes
+ *
+ * @param [in] WhereCondition wCond - empty operator matches every row
+ *
+ * @param [in] vector< int > projection - attribute indexes to return
+ *
+ * @note None
+ */
+TableScanOperator::TableScanOperator( TableScan tableScan, WhereCondition wCond, vector< int > projection )
+	: TableScanOperator( tableScan, wCond, projection, vector< TableScan >(), NULL )
+{
+
+}
+
+/**
+ * @brief TableScanOperator constructor
+ *
+ * @param [in] TableScan tableScan - scan that has already read the attributes
+ *
+ * @param [in] WhereCondition wCond - empty operator matches every row
+ *
+ * @param [in] vector< int > projection - attribute indexes to return
+ *
+ * @param [in] vector< TableScan > moreScans - scans of the other files the
+ *             table's records are kept in
+ *
+ * @param [in] RecordScanner moreRecords - reads the records kept in memory,
+ *             may be empty
+ *
+ * @note None
+ */
+TableScanOperator::TableScanOperator( TableScan tableScan, WhereCondition wCond, vector< int > projection,
+	vector< TableScan > moreScans, RecordScanner moreRecords )
+	: scan( tableScan ), condition( wCond ), projectionIndexes( projection ), extraScans( moreScans ), recordScanner( moreRecords )
+{
+	nextMorsel = 0;
+	recordsScanned = true;
+	windowIndex = 0;
+	rowIndex = 0;
+
+	int projectionSize = projectionIndexes.size();
+	for( int index = 0; index < projectionSize; index++ )
+	{
+		columns.push_back( scan.attributes[ projectionIndexes[ index ] ] );
+		columnTypes.push_back( getValueType( columns[ index ].attributeType ) );
+	}
+
+	//a merge reads the key behind the projected attributes of each row
+	int keyAttribute = scan.isClustered() ? scan.getKeyAttribute() : -1;
+	merging = keyAttribute >= 0 && ( !extraScans.empty() || recordScanner != NULL );
+	keyType = merging ? getValueType( scan.storedColumns[ scan.keyColumn ].attribute.attributeType ) : TYPE_STRING;
+	scanProjection = projectionIndexes;
+	if( merging )
+	{
+		scanProjection.push_back( keyAttribute );
+	}
+}
+
+/**
+ * @brief TableScanOperator destructor
+ *
+ * @note None
+ */
+TableScanOperator::~TableScanOperator()
+{
+
+}
+
+/**
+ * @brief open
+ *
+ * @details cuts the table into morsels and loads the Bloom filters the
+ *          condition can use, no rows are read yet. A comparison with the
+ *          primary key keeps only the morsels its binary search finds
+ *
+ * @par Algorithm the other files of the table are cut into morsels the
+ *      same way and follow those of the table file, the records kept in
+ *      memory come after them. Each file and the records are a source a
+ *      merge reads on its own
+ *
+ * @return bool true if there is a table to scan
+ *
+ * @note None
+ */
+bool TableScanOperator::open()
+{
+	scans.assign( 1, scan );
+	scans.insert( scans.end(), extraScans.begin(), extraScans.end() );
+	morsels.clear();
+	morselScans.clear();
+	sourceNext.clear();
+	sourceEnds.clear();
+	for( int index = 0; index < (int) scans.size(); index++ )
+	{
+		vector< Morsel > scanMorsels = scans[ index ].getMorsels( MORSEL_SIZE );
+		scans[ index ].loadFilters( &condition );
+		scans[ index ].narrowMorsels( scanMorsels, condition );
+		sourceNext.push_back( morsels.size() );
+		morsels.insert( morsels.end(), scanMorsels.begin(), scanMorsels.end() );
+		morselScans.insert( morselScans.end(), scanMorsels.size(), index );
+		sourceEnds.push_back( morsels.size() );
+	}
+	nextMorsel = 0;
+	recordsScanned = recordScanner == NULL;
+	window.clear();
+	windowIndex = 0;
+	rowIndex = 0;
+	sourceRows.assign( scans.size() + 1, MorselResult() );
+	sourceRowIndexes.assign( scans.size() + 1, 0 );
+	return !scan.filePath.empty();
+}
+
+/**
+ * @brief fillWindow
+ *
+ * @details scans the next group of morsels in parallel
+ *
+ * @par Algorithm a window holds two morsels per worker, which keeps every
+ *      core busy while only a bounded part of the table is in memory. The
+ *      records kept in memory make up the last window
+ *
+ * @return bool false once every morsel has been scanned
+ *
+ * @note None
+ */
+bool TableScanOperator::fillWindow()
+{
+	int morselCount = morsels.size();
+	if( nextMorsel >= morselCount && !recordsScanned )
+	{
+		window.assign( 1, MorselResult() );
+		recordScanner( condition, projectionIndexes, window[ 0 ] );
+		recordsScanned = true;
+		windowIndex = 0;
+		rowIndex = 0;
+		return true;
+	}
+	if( nextMorsel >= morselCount )
+	{
+		return false;
+	}
+
+	int windowSize = getThreadPool().size() * 2;
+	if( windowSize > morselCount - nextMorsel )
+	{
+		windowSize = morselCount - nextMorsel;
+	}
+
+	window.clear();
+	window.resize( windowSize );
+	int firstMorsel = nextMorsel;
+	parallelFor( windowSize, [ & ]( int index )
+	{
+		scans[ morselScans[ firstMorsel + index ] ].scanMorsel( morsels[ firstMorsel + index ], condition, projectionIndexes, window[ index ] );
+	} );
+
+	nextMorsel += windowSize;
+	windowIndex = 0;
+	rowIndex = 0;
+	return true;
+}
+
+/**
+ * @brief fillSource
+ *
+ * @details reads the next rows of one source of a merge
+ *
+ * @par Algorithm a file is scanned a window of morsels at a time in
+ *      parallel like fillWindow, the records kept in memory all at once.
+ *      Morsels none of whose rows match are passed over
+ *
+ * @param [in] int source - index of the scan, the number of scans for the
+ *             records kept in memory
+ *
+ * @return bool false once the source is exhausted
+ *
+ * @note None
+ */
+bool TableScanOperator::fillSource( int source )
+{
+	vector< vector< string > > &rows = sourceRows[ source ].rows;
+	rows.clear();
+	sourceRowIndexes[ source ] = 0;
+	if( source == (int) scans.size() )
+	{
+		if( !recordsScanned )
+		{
+			recordScanner( condition, scanProjection, sourceRows[ source ] );
+			recordsScanned = true;
+		}
+		return !rows.empty();
+	}
+
+	while( rows.empty() && sourceNext[ source ] < sourceEnds[ source ] )
+	{
+		int windowSize = getThreadPool().size() * 2;
+		if( windowSize > sourceEnds[ source ] - sourceNext[ source ] )
+		{
+			windowSize = sourceEnds[ source ] - sourceNext[ source ];
+		}
+		vector< MorselResult > results( windowSize );
+		int firstMorsel = sourceNext[ source ];
+		parallelFor( windowSize, [ & ]( int index )
+		{
+			scans[ source ].scanMorsel( morsels[ firstMorsel + index ], condition, scanProjection, results[ index ] );
+		} );
+		for( int index = 0; index < windowSize; index++ )
+		{
+			rows.insert( rows.end(), results[ index ].rows.begin(), results[ index ].rows.end() );
+		}
+		sourceNext[ source ] += windowSize;
+	}
+	return !rows.empty();
+}
+
+/**
+ * @brief next
+ *
+ * @details returns the next matching row in table order
+ *
+ * @par Algorithm a merge takes the row with the smallest key among the
+ *      next rows of its sources, the earlier source on equal keys
+ *
+ * @param [out] Row &row
+ *
+ * @return bool false once the table is exhausted
+ *
+ * @note None
+ */
+bool TableScanOperator::next( Row &row )
+{
+	vector< string > *content = NULL;
+	if( merging )
+	{
+		int sourceCount = sourceRows.size();
+		int chosen = -1;
+		for( int source = 0; source < sourceCount; source++ )
+		{
+			if( sourceRowIndexes[ source ] >= (int) sourceRows[ source ].rows.size() && !fillSource( source ) )
+			{
+				continue;
+			}
+			if( chosen < 0 || compareKeys( sourceRows[ source ].rows[ sourceRowIndexes[ source ] ].back(),
+				sourceRows[ chosen ].rows[ sourceRowIndexes[ chosen ] ].back(), keyType ) < 0 )
+			{
+				chosen = source;
+			}
+		}
+		if( chosen < 0 )
+		{
+			return false;
+		}
+		content = &sourceRows[ chosen ].rows[ sourceRowIndexes[ chosen ]++ ];
+	}
+	else
+	{
+		while( windowIndex >= (int) window.size() || rowIndex >= (int) window[ windowIndex ].rows.size() )
+		{
+			if( windowIndex < (int) window.size() )
+			{
+				windowIndex++;
+				rowIndex = 0;
+			}
+			else if( !fillWindow() )
+			{
+				return false;
+			}
+		}
+		content = &window[ windowIndex ].rows[ rowIndex++ ];
+	}
+
+	int columnSize = columnTypes.size();
+	row.values.clear();
+	for( int index = 0; index < columnSize; index++ )
+	{
+		row.values.push_back( makeValue( ( *content )[ index ], columnTypes[ index ] ) );
+	}
+	return true;
+}
+
+/**
+ * @brief close
+ *
+ * @details releases the buffered rows
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TableScanOperator::close()
+{
+	window.clear();
+	morsels.clear();
+	morselScans.clear();
+	scans.clear();
+	sourceRows.clear();
+	sourceRowIndexes.clear();
+}
+
+/**
+ * @brief getColumns
+ *
+ * @return vector< Attribute > attributes of the returned rows
+ *
+ * @note None
+ */
+vector< Attribute > TableScanOperator::getColumns()
+{
+	return columns;
+}
+
+/**
+ * @brief printResults
+ *
+ * @details console consumer of a query plan
+ *
+ * @par Algorithm outputs the column line, then pulls every row out of the
+ *      plan and outputs it with values separated by |
+ *
+ * @param [in] Operator &plan
+ *
+ * @param [in] ostream &out
+ *
+ * @return None
+ *
+ * @note None
+ */
+void printResults( Operator &plan, ostream &out )
+{
+	vector< Attribute > columns = plan.getColumns();
+	int columnSize = columns.size();
+
+	out << "-- ";
+	for( int index = 0; index < columnSize; index++ )
+	{
+		if( index != 0 )
+		{
+			out << "|";
+		}
+		out << columns[ index ].attributeName << " " << columns[ index ].attributeType;
+	}
+	out << endl;
+
+	Row row;
+	plan.open();
+	while( plan.next( row ) )
+	{
+		int valueSize = row.values.size();
+		out << "-- ";
+		for( int index = 0; index < valueSize; index++ )
+		{
+			if( index != 0 )
+			{
+				out << "|";
+			}
+			out << row.values[ index ].text;
+		}
+		out << endl;
+	}
+	plan.close();
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
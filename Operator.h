@@ -0,0 +1,87 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file Operator.h
+ *
+ * @brief Definition file for the query operators
+ *
+ * @details Specifies the iterator interface (open/next/close) that query
+ *          results are pulled through, along with the typed rows it returns
+ *
+ * @Note None
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+#include "TableScan.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef OPERATOR_H
+#define OPERATOR_H
+
+class Operator{
+	public:
+		virtual ~Operator();
+		virtual bool open() = 0;
+		virtual bool next( Row &row ) = 0;
+		virtual void close() = 0;
+		virtual vector< Attribute > getColumns() = 0;
+};
+
+//reads the records of a table in memory, those matching the condition
+//are added to the result with the projected attributes
+typedef function< void( WhereCondition wCond, vector< int > projection, MorselResult &result ) > RecordScanner;
+
+//reads a table with the where condition and projection pushed into the
+//morsel-driven scan, handing out rows one window of morsels at a time. The
+//storage engine may add scans of other files and records kept in memory.
+//Those of a clustered table are each in key order and are merged with the
+//table file by key, otherwise they are read after it
+class TableScanOperator : public Operator{
+	public:
+		TableScanOperator( TableScan tableScan, WhereCondition wCond, vector< int > projection );
+		TableScanOperator( TableScan tableScan, WhereCondition wCond, vector< int > projection,
+			vector< TableScan > moreScans, RecordScanner moreRecords );
+		~TableScanOperator();
+		bool open();
+		bool next( Row &row );
+		void close();
+		vector< Attribute > getColumns();
+
+	private:
+		TableScan scan;
+		WhereCondition condition;
+		vector< int > projectionIndexes;
+		vector< Attribute > columns;
+		vector< int > columnTypes;
+		vector< TableScan > extraScans;
+		RecordScanner recordScanner;
+		vector< TableScan > scans;
+		vector< Morsel > morsels;
+		vector< int > morselScans;
+		vector< MorselResult > window;
+		int nextMorsel;
+		bool recordsScanned;
+		int windowIndex;
+		int rowIndex;
+		bool merging;
+		int keyType;
+		vector< int > scanProjection;
+		vector< int > sourceNext;
+		vector< int > sourceEnds;
+		vector< MorselResult > sourceRows;
+		vector< int > sourceRowIndexes;
+
+		bool fillWindow();
+		bool fillSource( int source );
+};
+
+int getValueType( string attributeType );
+Value makeValue( string content, int valueType );
+void printResults( Operator &plan, ostream &out );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,734 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file PageCodec.cpp
+ *
+ * @brief Implementation file for the page codec
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements the encodings of the columns of a page and the LZ
+ *          codec used for columns no lighter encoding suits. Pages are
+ *          self-describing, so a page can be decoded without the table's
+ *          attribute line
+ *
+ * @Note Requires PageCodec.h
+ */
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include "PageCodec.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef PAGECODEC_CPP
+#define PAGECODEC_CPP
+
+/**
+ * @brief putVarint
+ *
+ * @details appends a number in 7 bit groups, low group first, the high bit
+ *          of a byte telling that another group follows
+ *
+ * @param [in/out] string &output
+ *
+ * @param [in] uint64_t value
+ *
+ * @return None
+ *
+ * @note None
+ */
+void putVarint( string &output, uint64_t value )
+{
+	while( value >= 0x80 )
+	{
+		output += (char)( ( value & 0x7f ) | 0x80 );
+		value >>= 7;
+	}
+	output += (char) value;
+}
+
+/**
+ * @brief getVarint
+ *
+ * @param [in] const string &input
+ *
+ * @param [in/out] size_t &position - moved past the number
+ *
+ * @param [out] uint64_t &value
+ *
+ * @return bool false if the input ends inside the number
+ *
+ * @note None
+ */
+bool getVarint( const string &input, size_t &position, uint64_t &value )
+{
+	value = 0;
+	for( int shift = 0; shift < 64 && position < input.size(); shift += 7 )
+	{
+		unsigned char byte = input[ position++ ];
+		value |= (uint64_t)( byte & 0x7f ) << shift;
+		if( byte < 0x80 )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief encodeZigzag
+ *
+ * @details maps signed numbers to unsigned ones so small negative numbers
+ *          stay small varints
+ *
+ * @param [in] int64_t value
+ *
+ * @return uint64_t
+ *
+ * @note None
+ */
+uint64_t encodeZigzag( int64_t value )
+{
+	return ( (uint64_t) value << 1 ) ^ (uint64_t)( value >> 63 );
+}
+
+/**
+ * @brief decodeZigzag
+ *
+ * @param [in] uint64_t value
+ *
+ * @return int64_t the reverse of encodeZigzag
+ *
+ * @note None
+ */
+int64_t decodeZigzag( uint64_t value )
+{
+	return (int64_t)( value >> 1 ) ^ -(int64_t)( value & 1 );
+}
+
+/**
+ * @brief getIntegerValue
+ *
+ * @details tells whether a stored value is an integer written the way
+ *          to_string writes it, so it can be stored as a number and given
+ *          back unchanged
+ *
+ * @param [in] const string &value
+ *
+ * @param [out] int64_t &number
+ *
+ * @return bool false for any other value, including null
+ *
+ * @note numbers are limited to 18 digits so differences never overflow
+ */
+bool getIntegerValue( const string &value, int64_t &number )
+{
+	size_t digitStart = ( !value.empty() && value[ 0 ] == '-' ) ? 1 : 0;
+	size_t digitCount = value.size() - digitStart;
+	if( digitCount == 0 || digitCount > 18 || value.find_first_not_of( "0123456789", digitStart ) != string::npos ||
+		( value[ digitStart ] == '0' && ( digitCount > 1 || digitStart > 0 ) ) )
+	{
+		return false;
+	}
+	number = atoll( value.c_str() );
+	return true;
+}
+
+/**
+ * @brief putLength
+ *
+ * @details appends the part of an LZ length that did not fit its token
+ *
+ * @param [in/out] string &output
+ *
+ * @param [in] size_t length - length less 15
+ *
+ * @return None
+ *
+ * @note None
+ */
+void putLength( string &output, size_t length )
+{
+	while( length >= 255 )
+	{
+		output += (char) 255;
+		length -= 255;
+	}
+	output += (char) length;
+}
+
+/**
+ * @brief getLength
+ *
+ * @param [in] const string &input
+ *
+ * @param [in/out] size_t &position
+ *
+ * @param [in/out] size_t &length - 15 from the token, the rest is added
+ *
+ * @return bool false if the input ends inside the length
+ *
+ * @note None
+ */
+bool getLength( const string &input, size_t &position, size_t &length )
+{
+	while( position < input.size() )
+	{
+		unsigned char byte = input[ position++ ];
+		length += byte;
+		if( byte < 255 )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief lzCompress
+ *
+ * @details compresses bytes with a greedy LZ77 coder
+ *
+ * @par Algorithm a hash of the next 4 bytes finds the last position they
+ *      were seen at. A match there is extended as far as it goes and
+ *      written as a sequence: a token with the literal and match lengths,
+ *      the literals since the last match, the offset back to the match and
+ *      any length that did not fit the token. The input ends with a
+ *      sequence of literals only
+ *
+ * @param [in] const string &input
+ *
+ * @return string compressed bytes
+ *
+ * @note None
+ */
+string lzCompress( const string &input )
+{
+	string output;
+	size_t inputSize = input.size();
+	vector< long > lastSeen( 1 << LZ_HASH_BITS, -1 );
+	size_t literalStart = 0;
+	size_t position = 0;
+	while( position + LZ_MIN_MATCH <= inputSize )
+	{
+		uint32_t sequence;
+		memcpy( &sequence, input.data() + position, sizeof( sequence ) );
+		uint32_t hash = ( sequence * 2654435761U ) >> ( 32 - LZ_HASH_BITS );
+		long candidate = lastSeen[ hash ];
+		lastSeen[ hash ] = position;
+		if( candidate < 0 || (long) position - candidate > LZ_MAX_OFFSET ||
+			memcmp( input.data() + candidate, input.data() + position, LZ_MIN_MATCH ) != 0 )
+		{
+			position++;
+			continue;
+		}
+
+		size_t matchLength = LZ_MIN_MATCH;
+		while( position + matchLength < inputSize && input[ candidate + matchLength ] == input[ position + matchLength ] )
+		{
+			matchLength++;
+		}
+		size_t literalLength = position - literalStart;
+		size_t matchCode = matchLength - LZ_MIN_MATCH;
+		output += (char)( ( ( literalLength < 15 ? literalLength : 15 ) << 4 ) | ( matchCode < 15 ? matchCode : 15 ) );
+		if( literalLength >= 15 )
+		{
+			putLength( output, literalLength - 15 );
+		}
+		output.append( input, literalStart, literalLength );
+		long offset = position - candidate;
+		output += (char)( offset & 0xff );
+		output += (char)( offset >> 8 );
+		if( matchCode >= 15 )
+		{
+			putLength( output, matchCode - 15 );
+		}
+		position += matchLength;
+		literalStart = position;
+	}
+
+	size_t literalLength = inputSize - literalStart;
+	output += (char)( ( literalLength < 15 ? literalLength : 15 ) << 4 );
+	if( literalLength >= 15 )
+	{
+		putLength( output, literalLength - 15 );
+	}
+	output.append( input, literalStart, literalLength );
+	return output;
+}
+
+/**
+ * @brief lzDecompress
+ *
+ * @param [in] const string &input - output of lzCompress
+ *
+ * @param [in] size_t rawSize - size of the bytes that were compressed
+ *
+ * @param [out] string &output
+ *
+ * @return bool false if the input is damaged
+ *
+ * @note the literals reaching rawSize end the input, every other sequence
+ *       is followed by a match
+ */
+bool lzDecompress( const string &input, size_t rawSize, string &output )
+{
+	output.clear();
+	output.reserve( rawSize );
+	size_t inputSize = input.size();
+	size_t position = 0;
+	while( position < inputSize )
+	{
+		unsigned char token = input[ position++ ];
+		size_t literalLength = token >> 4;
+		if( literalLength == 15 && !getLength( input, position, literalLength ) )
+		{
+			return false;
+		}
+		if( literalLength > inputSize - position || output.size() + literalLength > rawSize )
+		{
+			return false;
+		}
+		output.append( input, position, literalLength );
+		position += literalLength;
+		if( output.size() == rawSize )
+		{
+			return position == inputSize;
+		}
+
+		if( position + 2 > inputSize )
+		{
+			return false;
+		}
+		size_t offset = (unsigned char) input[ position ] | ( (size_t)(unsigned char) input[ position + 1 ] << 8 );
+		position += 2;
+		size_t matchLength = token & 15;
+		if( matchLength == 15 && !getLength( input, position, matchLength ) )
+		{
+			return false;
+		}
+		matchLength += LZ_MIN_MATCH;
+		if( offset == 0 || offset > output.size() || output.size() + matchLength > rawSize )
+		{
+			return false;
+		}
+
+		//a match may overlap the bytes it produces, so it is copied bytewise
+		size_t matchStart = output.size() - offset;
+		for( size_t index = 0; index < matchLength; index++ )
+		{
+			output += output[ matchStart + index ];
+		}
+	}
+	return output.size() == rawSize;
+}
+
+/**
+ * @brief encodeColumn
+ *
+ * @details encodes the values of one column of a page
+ *
+ * @par Algorithm ENCODING_LZ compresses the values, each ended by a
+ *      newline. ENCODING_RUN_LENGTH stores each run of equal values once
+ *      with its length. ENCODING_DELTA stores each integer as its difference
+ *      to the one before and ENCODING_FRAME as its difference to the
+ *      smallest one, in as few bytes as the largest difference needs
+ *
+ * @param [in] const vector< string > &values
+ *
+ * @param [in] int encoding
+ *
+ * @param [out] string &chunk
+ *
+ * @return bool false if a value does not suit the encoding
+ *
+ * @note delta and frame of reference only take integers
+ */
+bool encodeColumn( const vector< string > &values, int encoding, string &chunk )
+{
+	chunk.clear();
+	size_t valueCount = values.size();
+	if( encoding == ENCODING_LZ )
+	{
+		string raw;
+		for( size_t index = 0; index < valueCount; index++ )
+		{
+			raw += values[ index ];
+			raw += '\n';
+		}
+		putVarint( chunk, raw.size() );
+		chunk += lzCompress( raw );
+		return true;
+	}
+
+	if( encoding == ENCODING_RUN_LENGTH )
+	{
+		for( size_t runStart = 0; runStart < valueCount; )
+		{
+			size_t runEnd = runStart + 1;
+			while( runEnd < valueCount && values[ runEnd ] == values[ runStart ] )
+			{
+				runEnd++;
+			}
+			putVarint( chunk, runEnd - runStart );
+			putVarint( chunk, values[ runStart ].size() );
+			chunk += values[ runStart ];
+			runStart = runEnd;
+		}
+		return true;
+	}
+
+	vector< int64_t > numbers( valueCount );
+	for( size_t index = 0; index < valueCount; index++ )
+	{
+		if( !getIntegerValue( values[ index ], numbers[ index ] ) )
+		{
+			return false;
+		}
+	}
+
+	if( encoding == ENCODING_DELTA )
+	{
+		int64_t previous = 0;
+		for( size_t index = 0; index < valueCount; index++ )
+		{
+			putVarint( chunk, encodeZigzag( numbers[ index ] - previous ) );
+			previous = numbers[ index ];
+		}
+		return true;
+	}
+
+	if( encoding == ENCODING_FRAME )
+	{
+		int64_t minimum = 0;
+		uint64_t range = 0;
+		if( valueCount > 0 )
+		{
+			minimum = numbers[ 0 ];
+			int64_t maximum = numbers[ 0 ];
+			for( size_t index = 1; index < valueCount; index++ )
+			{
+				minimum = ( numbers[ index ] < minimum ) ? numbers[ index ] : minimum;
+				maximum = ( numbers[ index ] > maximum ) ? numbers[ index ] : maximum;
+			}
+			range = maximum - minimum;
+		}
+		int width = ( range == 0 ) ? 0 : ( range <= 0xff ) ? 1 : ( range <= 0xffff ) ? 2 : ( range <= 0xffffffffULL ) ? 4 : 8;
+		putVarint( chunk, encodeZigzag( minimum ) );
+		chunk += (char) width;
+		for( size_t index = 0; index < valueCount; index++ )
+		{
+			uint64_t offset = numbers[ index ] - minimum;
+			for( int byte = 0; byte < width; byte++ )
+			{
+				chunk += (char)( ( offset >> ( 8 * byte ) ) & 0xff );
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+/**
+ * @brief decodeColumn
+ *
+ * @param [in] const string &chunk - output of encodeColumn
+ *
+ * @param [in] int encoding
+ *
+ * @param [in] size_t valueCount - values the chunk holds
+ *
+ * @param [out] vector< string > &values
+ *
+ * @return bool false if the chunk is damaged
+ *
+ * @note None
+ */
+bool decodeColumn( const string &chunk, int encoding, size_t valueCount, vector< string > &values )
+{
+	values.clear();
+	values.reserve( valueCount );
+	size_t position = 0;
+	uint64_t number;
+	if( encoding == ENCODING_LZ )
+	{
+		string raw;
+		if( !getVarint( chunk, position, number ) || !lzDecompress( chunk.substr( position ), number, raw ) )
+		{
+			return false;
+		}
+		size_t valueStart = 0;
+		size_t newline;
+		while( values.size() < valueCount && ( newline = raw.find( '\n', valueStart ) ) != string::npos )
+		{
+			values.push_back( raw.substr( valueStart, newline - valueStart ) );
+			valueStart = newline + 1;
+		}
+		return values.size() == valueCount && valueStart == raw.size();
+	}
+
+	if( encoding == ENCODING_RUN_LENGTH )
+	{
+		while( values.size() < valueCount )
+		{
+			uint64_t valueSize;
+			if( !getVarint( chunk, position, number ) || !getVarint( chunk, position, valueSize ) ||
+				number == 0 || number > valueCount - values.size() || valueSize > chunk.size() - position )
+			{
+				return false;
+			}
+			values.insert( values.end(), number, chunk.substr( position, valueSize ) );
+			position += valueSize;
+		}
+		return position == chunk.size();
+	}
+
+	if( encoding == ENCODING_DELTA )
+	{
+		int64_t previous = 0;
+		for( size_t index = 0; index < valueCount; index++ )
+		{
+			if( !getVarint( chunk, position, number ) )
+			{
+				return false;
+			}
+			previous += decodeZigzag( number );
+			values.push_back( to_string( (long long) previous ) );
+		}
+		return position == chunk.size();
+	}
+
+	if( encoding == ENCODING_FRAME )
+	{
+		if( !getVarint( chunk, position, number ) || position >= chunk.size() )
+		{
+			return false;
+		}
+		int64_t minimum = decodeZigzag( number );
+		size_t width = (unsigned char) chunk[ position++ ];
+		if( width > 8 || chunk.size() - position != width * valueCount )
+		{
+			return false;
+		}
+		for( size_t index = 0; index < valueCount; index++ )
+		{
+			uint64_t offset = 0;
+			for( size_t byte = 0; byte < width; byte++ )
+			{
+				offset |= (uint64_t)(unsigned char) chunk[ position++ ] << ( 8 * byte );
+			}
+			values.push_back( to_string( (long long)( minimum + (int64_t) offset ) ) );
+		}
+		return true;
+	}
+	return false;
+}
+
+/**
+ * @brief chooseEncoding
+ *
+ * @details picks the encoding of a column of a page
+ *
+ * @par Algorithm every encoding is tried on a sample of the values, a few
+ *      runs of consecutive values spread over the page, and the one giving
+ *      the smallest sample wins. Lighter encodings are tried first and kept
+ *      on a tie as they are cheaper to decode
+ *
+ * @param [in] const vector< string > &values
+ *
+ * @return int encoding to use, which may still fail on values outside the
+ *         sample
+ *
+ * @note None
+ */
+int chooseEncoding( const vector< string > &values )
+{
+	vector< string > sample;
+	size_t valueCount = values.size();
+	if( valueCount <= (size_t) PAGE_SAMPLE_SIZE )
+	{
+		sample = values;
+	}
+	else
+	{
+		size_t runLength = PAGE_SAMPLE_SIZE / PAGE_SAMPLE_RUNS;
+		for( int run = 0; run < PAGE_SAMPLE_RUNS; run++ )
+		{
+			size_t runStart = run * ( valueCount - runLength ) / ( PAGE_SAMPLE_RUNS - 1 );
+			sample.insert( sample.end(), values.begin() + runStart, values.begin() + runStart + runLength );
+		}
+	}
+
+	const int encodings[] = { ENCODING_RUN_LENGTH, ENCODING_FRAME, ENCODING_DELTA, ENCODING_LZ };
+	int bestEncoding = ENCODING_LZ;
+	size_t bestSize = string::npos;
+	string chunk;
+	for( int index = 0; index < 4; index++ )
+	{
+		if( encodeColumn( sample, encodings[ index ], chunk ) && chunk.size() < bestSize )
+		{
+			bestEncoding = encodings[ index ];
+			bestSize = chunk.size();
+		}
+	}
+	return bestEncoding;
+}
+
+/**
+ * @brief encodePage
+ *
+ * @details packs records into a page
+ *
+ * @par Algorithm the records are split into columns at their tabs, records
+ *      with fewer values than others leave their missing values empty.
+ *      The first column holds how many values each record has, so every
+ *      record comes back exactly as it was. The content is the number of
+ *      records and columns followed by each column as its encoding, the
+ *      size of its chunk and the chunk
+ *
+ * @param [in] const vector< string > &lines - records without newlines
+ *
+ * @return string page header and content
+ *
+ * @note None
+ */
+string encodePage( const vector< string > &lines )
+{
+	size_t lineCount = lines.size();
+	vector< vector< string > > columns( 1 );
+	for( size_t lineIndex = 0; lineIndex < lineCount; lineIndex++ )
+	{
+		const string &line = lines[ lineIndex ];
+		size_t fieldStart = 0;
+		size_t fieldCount = 0;
+		while( true )
+		{
+			size_t tab = line.find( '\t', fieldStart );
+			if( columns.size() <= fieldCount + 1 )
+			{
+				columns.push_back( vector< string >( lineIndex ) );
+			}
+			columns[ fieldCount + 1 ].push_back( line.substr( fieldStart, tab - fieldStart ) );
+			fieldCount++;
+			if( tab == string::npos )
+			{
+				break;
+			}
+			fieldStart = tab + 1;
+		}
+		for( size_t column = fieldCount + 1; column < columns.size(); column++ )
+		{
+			columns[ column ].push_back( "" );
+		}
+		columns[ 0 ].push_back( to_string( (long long) fieldCount ) );
+	}
+
+	string content;
+	putVarint( content, lineCount );
+	putVarint( content, columns.size() );
+	string chunk;
+	for( size_t column = 0; column < columns.size(); column++ )
+	{
+		int encoding = chooseEncoding( columns[ column ] );
+		if( !encodeColumn( columns[ column ], encoding, chunk ) )
+		{
+			encoding = ENCODING_LZ;
+			encodeColumn( columns[ column ], encoding, chunk );
+		}
+		content += (char) encoding;
+		putVarint( content, chunk.size() );
+		content += chunk;
+	}
+
+	string page( 1, PAGE_MARK );
+	for( int byte = 0; byte < PAGE_HEADER_SIZE - 1; byte++ )
+	{
+		page += (char)( ( content.size() >> ( 8 * byte ) ) & 0xff );
+	}
+	return page + content;
+}
+
+/**
+ * @brief getPageContentSize
+ *
+ * @param [in] const char *pageHeader - PAGE_HEADER_SIZE bytes
+ *
+ * @return long bytes of content after the header
+ *
+ * @note None
+ */
+long getPageContentSize( const char *pageHeader )
+{
+	long contentSize = 0;
+	for( int byte = 0; byte < PAGE_HEADER_SIZE - 1; byte++ )
+	{
+		contentSize |= (long)(unsigned char) pageHeader[ byte + 1 ] << ( 8 * byte );
+	}
+	return contentSize;
+}
+
+/**
+ * @brief decodePage
+ *
+ * @details unpacks the records of a page, the reverse of encodePage
+ *
+ * @param [in] const string &content - page without its header
+ *
+ * @param [out] vector< string > &lines
+ *
+ * @return bool false if the page is damaged
+ *
+ * @note None
+ */
+bool decodePage( const string &content, vector< string > &lines )
+{
+	lines.clear();
+	size_t position = 0;
+	uint64_t lineCount;
+	uint64_t columnCount;
+	if( !getVarint( content, position, lineCount ) || !getVarint( content, position, columnCount ) || columnCount == 0 || lineCount > (uint64_t) PAGE_SIZE )
+	{
+		return false;
+	}
+
+	vector< vector< string > > columns( columnCount );
+	for( uint64_t column = 0; column < columnCount; column++ )
+	{
+		uint64_t chunkSize;
+		if( position >= content.size() )
+		{
+			return false;
+		}
+		int encoding = content[ position++ ];
+		if( !getVarint( content, position, chunkSize ) || chunkSize > content.size() - position ||
+			!decodeColumn( content.substr( position, chunkSize ), encoding, lineCount, columns[ column ] ) )
+		{
+			return false;
+		}
+		position += chunkSize;
+	}
+
+	lines.resize( lineCount );
+	for( uint64_t lineIndex = 0; lineIndex < lineCount; lineIndex++ )
+	{
+		uint64_t fieldCount = atol( columns[ 0 ][ lineIndex ].c_str() );
+		if( fieldCount == 0 || fieldCount >= columnCount )
+		{
+			return false;
+		}
+		string &line = lines[ lineIndex ];
+		line = columns[ 1 ][ lineIndex ];
+		for( uint64_t field = 2; field <= fieldCount; field++ )
+		{
+			line += '\t';
+			line += columns[ field ][ lineIndex ];
+		}
+	}
+	return position == content.size();
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,61 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file PageCodec.h
+ *
+ * @brief Definition file for the page codec
+ *
+ * @details Specifies how the records of a compressed table are packed into
+ *          pages. A page stores its records column by column and every
+ *          column is encoded on its own, with run-length, delta or frame of
+ *          reference encoding or with the built-in LZ codec, whichever does
+ *          best on a sample of the column
+ *
+ * @Note None
+ */
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef PAGECODEC_H
+#define PAGECODEC_H
+
+//first byte of a page, which no text record starts with
+const char PAGE_MARK = '\0';
+
+//the mark followed by the size of the page content as 4 bytes little endian
+const int PAGE_HEADER_SIZE = 5;
+
+//bytes of records packed into one page before it is written
+const long PAGE_SIZE = 1 << 20;
+
+//values of a column the encodings are tried on, taken in a few runs
+//spread over the page so runs and deltas are kept
+const int PAGE_SAMPLE_SIZE = 256;
+const int PAGE_SAMPLE_RUNS = 4;
+
+//how a column of a page is encoded
+const int ENCODING_LZ = 0;
+const int ENCODING_RUN_LENGTH = 1;
+const int ENCODING_DELTA = 2;
+const int ENCODING_FRAME = 3;
+
+//sequences of the LZ codec are a token, literals, a 2 byte offset back into
+//the output and a match of at least LZ_MIN_MATCH bytes
+const int LZ_MIN_MATCH = 4;
+const long LZ_MAX_OFFSET = 65535;
+const int LZ_HASH_BITS = 14;
+
+string lzCompress( const string &input );
+bool lzDecompress( const string &input, size_t rawSize, string &output );
+bool encodeColumn( const vector< string > &values, int encoding, string &chunk );
+bool decodeColumn( const string &chunk, int encoding, size_t valueCount, vector< string > &values );
+int chooseEncoding( const vector< string > &values );
+string encodePage( const vector< string > &lines );
+long getPageContentSize( const char *pageHeader );
+bool decodePage( const string &content, vector< string > &lines );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,241 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file PreparedStatement.cpp
+ *
+ * @brief Implementation file for prepared statements
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements parameter binding and execution of prepared
+ *          statements. Statements are parsed by prepareStatement in sim.cpp
+ *
+ * @Note Requires PreparedStatement.h
+ */
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <memory>
+#include "PreparedStatement.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef PREPAREDSTATEMENT_CPP
+#define PREPAREDSTATEMENT_CPP
+
+/**
+ * @brief bindParameters
+ *
+ * @details places the argument values into the parameter slots
+ *
+ * @param [in] PreparedStatement &prepared - copy of the cached statement
+ *
+ * @param [in] vector< string > arguments - one value per ?, in order
+ *
+ * @return bool false if the number of arguments does not match
+ *
+ * @note None
+ */
+bool bindParameters( PreparedStatement &prepared, vector< string > arguments )
+{
+	int parameterSize = prepared.parameters.size();
+	if( (int) arguments.size() != parameterSize )
+	{
+		return false;
+	}
+
+	for( int index = 0; index < parameterSize; index++ )
+	{
+		ParameterSlot &slot = prepared.parameters[ index ];
+		if( slot.slotType == PARAM_INSERT )
+		{
+			prepared.insertValues[ slot.valueIndex ] = getStoredValue( arguments[ index ] );
+		}
+		else if( slot.slotType == PARAM_WHERE )
+		{
+			prepared.wCond.comparisonValue = getStoredValue( arguments[ index ] );
+			prepared.wCond.comparisonValueFloat = atof( arguments[ index ].c_str() );
+			if( prepared.wCond.intValue )
+			{
+				prepared.wCond.comparisonValue = convertValue( prepared.wCond.comparisonValue, "int" );
+			}
+			prepared.wCond.comparisonValueInt = atol( prepared.wCond.comparisonValue.c_str() );
+		}
+		else if( slot.slotType == PARAM_SET )
+		{
+			prepared.sCond.newValue = getStoredValue( arguments[ index ] );
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief executePrepared
+ *
+ * @details runs a prepared statement whose parameters are bound
+ *
+ * @param [in] PreparedStatement &prepared
+ *
+ * @param [out] bool &errorCode - set if the change could not be applied
+ *
+ * @param [in] ostream &out - stream that receives the messages
+ *
+ * @param [out] shared_ptr< Operator > &plan - query plan of a select
+ *
+ * @return None
+ *
+ * @note None
+ */
+void executePrepared( PreparedStatement &prepared, bool &errorCode, ostream &out, shared_ptr< Operator > &plan )
+{
+	if( prepared.actionType == "SELECT" )
+	{
+		plan = getStorageEngine( prepared.scan ).scan( prepared.scan, prepared.wCond, prepared.projection );
+	}
+	else if( prepared.actionType == "INSERT" )
+	{
+		prepared.table.insertRecord( prepared.scan, prepared.insertValues, errorCode, out );
+	}
+	else if( prepared.actionType == "UPDATE" )
+	{
+		prepared.table.updateRecords( prepared.scan, prepared.wCond, prepared.sCond, errorCode, out );
+	}
+	else if( prepared.actionType == "DELETE" )
+	{
+		prepared.table.deleteRecords( prepared.scan, prepared.wCond, errorCode, out );
+	}
+}
+
+/**
+ * @brief getArguments
+ *
+ * @details splits the argument list of an EXECUTE into its values
+ *
+ * @par Algorithm splits at commas that are not inside quotes and removes
+ *      the white space around each value
+ *
+ * @param [in] string input - e.g. 1, 'Gizmo, large', 19.99
+ *
+ * @return vector< string > values in order, empty if there are none
+ *
+ * @note None
+ */
+vector< string > getArguments( string input )
+{
+	vector< string > arguments;
+	string current;
+	bool inQuotes = false;
+	int inputSize = input.size();
+
+	for( int index = 0; index <= inputSize; index++ )
+	{
+		if( index == inputSize || ( input[ index ] == ',' && !inQuotes ) )
+		{
+			size_t first = current.find_first_not_of( " \t" );
+			size_t last = current.find_last_not_of( " \t" );
+			if( first != string::npos )
+			{
+				arguments.push_back( current.substr( first, last - first + 1 ) );
+			}
+			else if( index != inputSize || !arguments.empty() )
+			{
+				arguments.push_back( "" );
+			}
+			current.clear();
+		}
+		else
+		{
+			if( input[ index ] == '\'' )
+			{
+				inQuotes = !inQuotes;
+			}
+			current += input[ index ];
+		}
+	}
+	return arguments;
+}
+
+/**
+ * @brief getRedoRecord
+ *
+ * @details describes a bound INSERT, UPDATE or DELETE as a commit log line
+ *
+ * @par Algorithm the action, the table and the bound values separated by tabs
+ *      INSERT table offset value...
+ *      UPDATE table whereAttribute whereOperator whereValue setAttribute setValue
+ *      DELETE table whereAttribute whereOperator whereValue
+ *      Recovery redoes INSERT lines. The effect of UPDATE and DELETE lines
+ *      is in the staged table file named by the REPLACE line of the commit,
+ *      the storage engine describes inserts applied after the commit is
+ *      logged
+ *
+ * @param [in] PreparedStatement &bound
+ *
+ * @param [in] string tableName - database/table below DatabaseSystem
+ *
+ * @param [in] long insertOffset - where an inserted record starts in the file
+ *
+ * @return string record without the newline
+ *
+ * @note stored values never hold tabs or newlines
+ */
+string getRedoRecord( PreparedStatement &bound, string tableName, long insertOffset )
+{
+	vector< string > fields;
+	fields.push_back( bound.actionType );
+	fields.push_back( tableName );
+	if( bound.actionType == "INSERT" )
+	{
+		fields.push_back( to_string( insertOffset ) );
+		fields.insert( fields.end(), bound.insertValues.begin(), bound.insertValues.end() );
+	}
+	else
+	{
+		fields.push_back( bound.wCond.attributeName );
+		fields.push_back( bound.wCond.operatorValue );
+		fields.push_back( bound.wCond.comparisonValue );
+		if( bound.actionType == "UPDATE" )
+		{
+			fields.push_back( bound.sCond.attributeName );
+			fields.push_back( bound.sCond.newValue );
+		}
+	}
+	return joinRow( fields );
+}
+
+/**
+ * @brief getResultKey
+ *
+ * @details describes a bound SELECT in resolved form for the result cache
+ *
+ * @par Algorithm the table file, the projected attribute indexes and the
+ *      bound where condition separated by tabs, so queries that differ only
+ *      in spacing, case of keywords or the database they were named from
+ *      share one key
+ *
+ * @param [in] PreparedStatement &bound
+ *
+ * @return string cache key
+ *
+ * @note None
+ */
+string getResultKey( PreparedStatement &bound )
+{
+	vector< string > fields;
+	string projection;
+	int projectionSize = bound.projection.size();
+	for( int index = 0; index < projectionSize; index++ )
+	{
+		projection += to_string( bound.projection[ index ] ) + ",";
+	}
+	fields.push_back( bound.scan.filePath );
+	fields.push_back( projection );
+	fields.push_back( bound.wCond.attributeName );
+	fields.push_back( bound.wCond.operatorValue );
+	fields.push_back( bound.wCond.comparisonValue );
+	return joinRow( fields );
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,62 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file PreparedStatement.h
+ *
+ * @brief Definition file for prepared statements
+ *
+ * @details Specifies the parsed and resolved form of a SELECT, INSERT,
+ *          UPDATE or DELETE statement, which can be executed many times
+ *          with only its ? parameters bound per execution
+ *
+ * @Note None
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include "Table.h"
+#include "Operator.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef PREPAREDSTATEMENT_H
+#define PREPAREDSTATEMENT_H
+
+//marker that stands for a value bound at execution
+const string PARAMETER_MARKER = "?";
+
+//parts of a statement a parameter can stand for
+const int PARAM_INSERT = 0;
+const int PARAM_WHERE = 1;
+const int PARAM_SET = 2;
+
+struct ParameterSlot{
+	int slotType;
+	int valueIndex;
+};
+
+//parse tree of a statement with the table, attribute indexes and where
+//condition already resolved against the table file
+struct PreparedStatement{
+	string statementText;
+	string actionType;
+	long catalogVersion;
+	Table table;
+	TableScan scan;
+	vector< int > projection;
+	WhereCondition wCond;
+	SetCondition sCond;
+	vector< string > insertValues;
+	vector< ParameterSlot > parameters;
+};
+
+bool bindParameters( PreparedStatement &prepared, vector< string > arguments );
+void executePrepared( PreparedStatement &prepared, bool &errorCode, ostream &out, shared_ptr< Operator > &plan );
+vector< string > getArguments( string input );
+string getRedoRecord( PreparedStatement &bound, string tableName, long insertOffset );
+string getResultKey( PreparedStatement &bound );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,62 @@
+--CS457 Recovery, part 1
+--Stop the program with kill -9 once it has printed its last line, then run
+--Recovery2_test.sql in the same directory. This script has no .exit, so
+--no checkpoint is taken and the restart redoes the commit log
+
+--Construct the database and tables
+CREATE DATABASE CS457_RECOVERY;
+USE CS457_RECOVERY;
+CREATE TABLE Product (pid int PRIMARY KEY, name varchar(20), price float);
+CREATE TABLE Reading (rid int PRIMARY KEY, sensor varchar(20)) ENGINE=LSM;
+CREATE TABLE Stock (sid int, count int);
+ALTER TABLE Stock REWRITE FIXED;
+
+--Committed changes of every kind
+insert into Product values(2, 'PowerGizmo', 29.99);
+insert into Product values(1, 'Gizmo', 19.99);
+BEGIN;
+insert into Product values(3, 'SingleTouch', 149.99);
+update Product set price = 14.99 where pid = 1;
+delete from Product where pid = 2;
+COMMIT;
+insert into Reading values(9, 's9');
+insert into Reading values(4, 's4');
+insert into Stock values(1, 10);
+insert into Stock values(2, 20);
+update Stock set count = 15 where sid = 1;
+
+--Dropped changes
+BEGIN;
+delete from Product where pid = 1;
+ROLLBACK;
+BEGIN;
+insert into Product values(5, 'Gone', 1.0);
+
+-- Expected output
+--
+-- Database CS457_RECOVERY created.
+-- Using Database CS457_RECOVERY.
+-- Table Product created.
+-- Table Reading created.
+-- Table Stock created.
+-- Table Stock rewritten.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- Transaction started.
+-- Statement added to transaction.
+-- Statement added to transaction.
+-- Statement added to transaction.
+-- 1 new record inserted.
+-- 1 record modified.
+-- 1 record deleted.
+-- Transaction committed.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- 1 record modified.
+-- Transaction started.
+-- Statement added to transaction.
+-- Transaction rolled back.
+-- Transaction started.
+-- Statement added to transaction.
@@ -0,0 +1,39 @@
+--CS457 Recovery, part 2
+--Run after Recovery1_test.sql was killed, in the same directory
+
+--Every committed change survives the restart, nothing else does
+USE CS457_RECOVERY;
+select * from Product;
+select * from Reading;
+select * from Stock;
+
+--The recovered tables take new changes
+insert into Reading values(6, 's6');
+update Product set name = 'Gadget' where pid = 3;
+select * from Reading;
+select * from Product;
+
+.exit
+
+-- Expected output
+--
+-- Using Database CS457_RECOVERY.
+-- pid int|name varchar(20)|price float
+-- 1|Gizmo|14.99
+-- 3|SingleTouch|149.99
+-- rid int|sensor varchar(20)
+-- 4|s4
+-- 9|s9
+-- sid int|count int
+-- 1|15
+-- 2|20
+-- 1 new record inserted.
+-- 1 record modified.
+-- rid int|sensor varchar(20)
+-- 4|s4
+-- 6|s6
+-- 9|s9
+-- pid int|name varchar(20)|price float
+-- 1|Gizmo|14.99
+-- 3|Gadget|149.99
+-- All done.
@@ -0,0 +1,376 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file ResultCache.cpp
+ *
+ * @brief Implementation file for the ResultCache class
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements the result cache and the operators that fill it and
+ *          read from it. Results are recorded while a query streams its rows
+ *          to the caller, so a miss costs no extra pass over the table
+ *
+ * @Note Requires ResultCache.h
+ */
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "ResultCache.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef RESULTCACHE_CPP
+#define RESULTCACHE_CPP
+
+long resultCacheSizeOverride = -1;
+
+/**
+ * @brief getRowSize
+ *
+ * @details estimates the memory held by a row
+ *
+ * @param [in] const Row &row
+ *
+ * @return long bytes
+ *
+ * @note None
+ */
+long getRowSize( const Row &row )
+{
+	long rowSize = sizeof( Row );
+	int valueSize = row.values.size();
+	for( int index = 0; index < valueSize; index++ )
+	{
+		rowSize += sizeof( Value ) + row.values[ index ].text.capacity();
+	}
+	return rowSize;
+}
+
+/**
+ * @brief ResultCache default constructor
+ *
+ * @note None
+ */
+ResultCache::ResultCache()
+{
+	capacity = ( resultCacheSizeOverride >= 0 ) ? resultCacheSizeOverride : DEFAULT_RESULT_CACHE_SIZE;
+	usedBytes = 0;
+}
+
+/**
+ * @brief lookup
+ *
+ * @details finds the result of a query if its table has not changed since
+ *
+ * @param [in] string key - resolved form of the query
+ *
+ * @param [in] long catalogVersion - current schema version
+ *
+ * @param [in] long tableVersion - last committed version of the table
+ *
+ * @return shared_ptr< CachedResult > empty on a miss
+ *
+ * @note a result read at an older version is dropped
+ */
+shared_ptr< CachedResult > ResultCache::lookup( string key, long catalogVersion, long tableVersion )
+{
+	lock_guard< mutex > guard( cacheLock );
+	map< string, pair< shared_ptr< CachedResult >, list< string >::iterator > >::iterator entry = entries.find( key );
+	if( entry == entries.end() )
+	{
+		return shared_ptr< CachedResult >();
+	}
+
+	shared_ptr< CachedResult > result = entry->second.first;
+	if( result->catalogVersion != catalogVersion || result->tableVersion != tableVersion )
+	{
+		erase( entry );
+		return shared_ptr< CachedResult >();
+	}
+	recentKeys.splice( recentKeys.begin(), recentKeys, entry->second.second );
+	return result;
+}
+
+/**
+ * @brief insert
+ *
+ * @details adds a result, evicting the least recently used ones to fit it
+ *
+ * @param [in] string key
+ *
+ * @param [in] shared_ptr< CachedResult > result
+ *
+ * @return None
+ *
+ * @note a result recorded at an older version than the cached one is ignored
+ */
+void ResultCache::insert( string key, shared_ptr< CachedResult > result )
+{
+	lock_guard< mutex > guard( cacheLock );
+	if( capacity <= 0 || result->byteSize > capacity / RESULT_ENTRY_SHARE )
+	{
+		return;
+	}
+
+	map< string, pair< shared_ptr< CachedResult >, list< string >::iterator > >::iterator entry = entries.find( key );
+	if( entry != entries.end() )
+	{
+		if( entry->second.first->catalogVersion > result->catalogVersion || entry->second.first->tableVersion > result->tableVersion )
+		{
+			return;
+		}
+		erase( entry );
+	}
+
+	while( !recentKeys.empty() && usedBytes + result->byteSize > capacity )
+	{
+		erase( entries.find( recentKeys.back() ) );
+	}
+	recentKeys.push_front( key );
+	entries[ key ] = make_pair( result, recentKeys.begin() );
+	usedBytes += result->byteSize;
+}
+
+/**
+ * @brief getEntryLimit
+ *
+ * @return long largest result in bytes that will be cached, 0 if disabled
+ *
+ * @note None
+ */
+long ResultCache::getEntryLimit()
+{
+	return capacity / RESULT_ENTRY_SHARE;
+}
+
+/**
+ * @brief erase
+ *
+ * @param [in] entry - cached result to remove
+ *
+ * @return None
+ *
+ * @note the caller holds the cache lock
+ */
+void ResultCache::erase( map< string, pair< shared_ptr< CachedResult >, list< string >::iterator > >::iterator entry )
+{
+	usedBytes -= entry->second.first->byteSize;
+	recentKeys.erase( entry->second.second );
+	entries.erase( entry );
+}
+
+/**
+ * @brief CachedResultOperator constructor
+ *
+ * @param [in] shared_ptr< CachedResult > cachedResult
+ *
+ * @note the result is shared with the cache and never changed
+ */
+CachedResultOperator::CachedResultOperator( shared_ptr< CachedResult > cachedResult )
+	: result( cachedResult )
+{
+	rowIndex = 0;
+}
+
+/**
+ * @brief CachedResultOperator destructor
+ *
+ * @note None
+ */
+CachedResultOperator::~CachedResultOperator()
+{
+
+}
+
+/**
+ * @brief open
+ *
+ * @return bool always true
+ *
+ * @note None
+ */
+bool CachedResultOperator::open()
+{
+	rowIndex = 0;
+	return true;
+}
+
+/**
+ * @brief next
+ *
+ * @param [out] Row &row
+ *
+ * @return bool false once every row has been returned
+ *
+ * @note None
+ */
+bool CachedResultOperator::next( Row &row )
+{
+	if( rowIndex >= (int) result->rows.size() )
+	{
+		return false;
+	}
+	row = result->rows[ rowIndex++ ];
+	return true;
+}
+
+/**
+ * @brief close
+ *
+ * @return None
+ *
+ * @note None
+ */
+void CachedResultOperator::close()
+{
+	rowIndex = result->rows.size();
+}
+
+/**
+ * @brief getColumns
+ *
+ * @return vector< Attribute > columns of the cached result
+ *
+ * @note None
+ */
+vector< Attribute > CachedResultOperator::getColumns()
+{
+	return result->columns;
+}
+
+/**
+ * @brief ResultRecorder constructor
+ *
+ * @param [in] shared_ptr< Operator > inputPlan - query being run
+ *
+ * @param [in] shared_ptr< ResultCache > resultCache
+ *
+ * @param [in] string key - resolved form of the query
+ *
+ * @param [in] long catalogVersion - schema version the query was resolved at
+ *
+ * @param [in] long tableVersion - version of the snapshot being read
+ *
+ * @note None
+ */
+ResultRecorder::ResultRecorder( shared_ptr< Operator > inputPlan, shared_ptr< ResultCache > resultCache, string key, long catalogVersion, long tableVersion )
+	: input( inputPlan ), cache( resultCache ), recorded( new CachedResult ), resultKey( key )
+{
+	recorded->catalogVersion = catalogVersion;
+	recorded->tableVersion = tableVersion;
+	recorded->byteSize = sizeof( CachedResult ) + resultKey.size();
+}
+
+/**
+ * @brief ResultRecorder destructor
+ *
+ * @note a result that was not read to the end is not cached
+ */
+ResultRecorder::~ResultRecorder()
+{
+
+}
+
+/**
+ * @brief open
+ *
+ * @return bool result of opening the input
+ *
+ * @note None
+ */
+bool ResultRecorder::open()
+{
+	if( recorded != NULL )
+	{
+		recorded->columns = input->getColumns();
+	}
+	return input->open();
+}
+
+/**
+ * @brief next
+ *
+ * @details returns the next input row and records a copy of it
+ *
+ * @par Algorithm recording stops for good once the result outgrows the
+ *      largest entry the cache accepts, the rows still stream through
+ *
+ * @param [out] Row &row
+ *
+ * @return bool false once the input has no more rows
+ *
+ * @note None
+ */
+bool ResultRecorder::next( Row &row )
+{
+	if( !input->next( row ) )
+	{
+		if( recorded != NULL )
+		{
+			cache->insert( resultKey, recorded );
+			recorded.reset();
+		}
+		return false;
+	}
+
+	if( recorded != NULL )
+	{
+		recorded->byteSize += getRowSize( row );
+		if( recorded->byteSize > cache->getEntryLimit() )
+		{
+			recorded.reset();
+		}
+		else
+		{
+			recorded->rows.push_back( row );
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief close
+ *
+ * @return None
+ *
+ * @note None
+ */
+void ResultRecorder::close()
+{
+	input->close();
+}
+
+/**
+ * @brief getColumns
+ *
+ * @return vector< Attribute > columns of the input
+ *
+ * @note None
+ */
+vector< Attribute > ResultRecorder::getColumns()
+{
+	return input->getColumns();
+}
+
+/**
+ * @brief setResultCacheSize
+ *
+ * @details sets the bytes of results kept by catalogs opened later
+ *
+ * @param [in] long bytes - 0 turns the cache off
+ *
+ * @return None
+ *
+ * @note None
+ */
+void setResultCacheSize( long bytes )
+{
+	resultCacheSizeOverride = bytes;
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,99 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file ResultCache.h
+ *
+ * @brief Definition file for the ResultCache class
+ *
+ * @details Specifies the cache of query results shared by the connections of
+ *          a catalog. A result is kept with the version of the table it was
+ *          read from and only returned while the table is still at that
+ *          version, so a hit never has to read the table file
+ *
+ * @Note None
+ */
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "Operator.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+//bytes of query results kept unless overridden
+const long DEFAULT_RESULT_CACHE_SIZE = 64L << 20;
+
+//a single result may take at most this share of the cache
+const int RESULT_ENTRY_SHARE = 4;
+
+//rows of one query along with the versions they were read at
+struct CachedResult{
+	vector< Attribute > columns;
+	vector< Row > rows;
+	long catalogVersion;
+	long tableVersion;
+	long byteSize;
+};
+
+//least recently used results are evicted once the cache is over capacity
+class ResultCache{
+	public:
+		ResultCache();
+		shared_ptr< CachedResult > lookup( string key, long catalogVersion, long tableVersion );
+		void insert( string key, shared_ptr< CachedResult > result );
+		long getEntryLimit();
+
+	private:
+		mutex cacheLock;
+		list< string > recentKeys;
+		map< string, pair< shared_ptr< CachedResult >, list< string >::iterator > > entries;
+		long capacity;
+		long usedBytes;
+
+		void erase( map< string, pair< shared_ptr< CachedResult >, list< string >::iterator > >::iterator entry );
+};
+
+//returns the rows of a cached result
+class CachedResultOperator : public Operator{
+	public:
+		CachedResultOperator( shared_ptr< CachedResult > cachedResult );
+		~CachedResultOperator();
+		bool open();
+		bool next( Row &row );
+		void close();
+		vector< Attribute > getColumns();
+
+	private:
+		shared_ptr< CachedResult > result;
+		int rowIndex;
+};
+
+//passes rows through from its input and keeps a copy of them, which is
+//added to the cache once the input is read to the end
+class ResultRecorder : public Operator{
+	public:
+		ResultRecorder( shared_ptr< Operator > inputPlan, shared_ptr< ResultCache > resultCache, string key, long catalogVersion, long tableVersion );
+		~ResultRecorder();
+		bool open();
+		bool next( Row &row );
+		void close();
+		vector< Attribute > getColumns();
+
+	private:
+		shared_ptr< Operator > input;
+		shared_ptr< ResultCache > cache;
+		shared_ptr< CachedResult > recorded;
+		string resultKey;
+};
+
+long getRowSize( const Row &row );
+void setResultCacheSize( long bytes );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,712 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file Server.cpp
+ *
+ * @brief Implementation file for the Server class
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements server mode and its command line client. Every client
+ *          session gets a Connection on the catalog read at start up, so a
+ *          statement no longer pays for a process start and a scan of the
+ *          DatabaseSystem directory. Sessions are state machines driven by an
+ *          epoll loop, so thousands of idle clients need no threads
+ *
+ * @Note Requires Server.h
+ */
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <csignal>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "Server.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef SERVER_CPP
+#define SERVER_CPP
+
+bool exitCheck( string str );
+
+/**
+ * @brief nextStatement
+ *
+ * @details takes the next complete statement out of the bytes a client sent
+ *
+ * @par Algorithm follows the command line reader: blank lines and -- comment
+ *      lines are skipped, a line starting with . is a statement on its own
+ *      and anything else runs up to the next ; that is not inside quotes
+ *
+ * @param [in] string &buffer - received bytes, the statement is removed
+ *
+ * @param [out] string &statement - without the semicolon
+ *
+ * @return bool false if the buffer holds no complete statement yet
+ *
+ * @note None
+ */
+bool nextStatement( string &buffer, string &statement )
+{
+	while( true )
+	{
+		size_t start = buffer.find_first_not_of( " \t\r\n" );
+		if( start == string::npos )
+		{
+			buffer.clear();
+			return false;
+		}
+		buffer.erase( 0, start );
+
+		//comments and dot commands end with their line
+		if( buffer.compare( 0, 2, "--" ) == 0 || buffer[ 0 ] == '.' )
+		{
+			size_t lineEnd = buffer.find( '\n' );
+			if( lineEnd == string::npos )
+			{
+				return false;
+			}
+			string line = buffer.substr( 0, lineEnd );
+			buffer.erase( 0, lineEnd + 1 );
+			if( line[ 0 ] == '-' )
+			{
+				continue;
+			}
+			statement = line.substr( 0, line.find_last_not_of( " \t\r" ) + 1 );
+			return true;
+		}
+
+		bool inQuotes = false;
+		int bufferSize = buffer.size();
+		for( int index = 0; index < bufferSize; index++ )
+		{
+			if( buffer[ index ] == '\'' )
+			{
+				inQuotes = !inQuotes;
+			}
+			else if( buffer[ index ] == ';' && !inQuotes )
+			{
+				statement = buffer.substr( 0, index );
+				buffer.erase( 0, index + 1 );
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+/**
+ * @brief sendAll
+ *
+ * @details writes all of the data to a socket
+ *
+ * @param [in] int socket
+ *
+ * @param [in] string data
+ *
+ * @return bool false if the peer has gone away
+ *
+ * @note None
+ */
+bool sendAll( int socket, string data )
+{
+	size_t sent = 0;
+	while( sent < data.size() )
+	{
+		ssize_t written = send( socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL );
+		if( written < 0 && errno == EINTR )
+		{
+			continue;
+		}
+		if( written <= 0 )
+		{
+			return false;
+		}
+		sent += written;
+	}
+	return true;
+}
+
+/**
+ * @brief Server constructor
+ *
+ * @param [in] string workingDirectory - directory holding DatabaseSystem
+ *
+ * @param [in] string path - path of the Unix domain socket
+ *
+ * @note statements get one worker per scan worker, the scans themselves
+ *       still run on the shared scheduler
+ */
+Server::Server( string workingDirectory, string path )
+	: currentWorkingDirectory( workingDirectory ), socketPath( path ), stopping( false ),
+	  statementPool( getThreadPool().size() )
+{
+	listenSocket = -1;
+	eventPoll = -1;
+	wakeEvent = -1;
+}
+
+/**
+ * @brief Server destructor
+ *
+ * @note None
+ */
+Server::~Server()
+{
+	while( !sessions.empty() )
+	{
+		closeSession( sessions.begin()->second );
+	}
+	if( listenSocket >= 0 )
+	{
+		close( listenSocket );
+	}
+	if( wakeEvent >= 0 )
+	{
+		close( wakeEvent );
+	}
+	if( eventPoll >= 0 )
+	{
+		close( eventPoll );
+	}
+}
+
+/**
+ * @brief start
+ *
+ * @details reads the catalog and starts listening on the socket
+ *
+ * @return bool false if the catalog or the socket could not be opened
+ *
+ * @note a socket file left behind by an earlier server is replaced
+ */
+bool Server::start()
+{
+	if( !catalogConnection.open( currentWorkingDirectory ) )
+	{
+		return false;
+	}
+
+	struct sockaddr_un address;
+	memset( &address, 0, sizeof( address ) );
+	address.sun_family = AF_UNIX;
+	if( socketPath.empty() || socketPath.size() >= sizeof( address.sun_path ) )
+	{
+		return false;
+	}
+	strcpy( address.sun_path, socketPath.c_str() );
+
+	listenSocket = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0 );
+	eventPoll = epoll_create1( 0 );
+	wakeEvent = eventfd( 0, EFD_NONBLOCK );
+	if( listenSocket < 0 || eventPoll < 0 || wakeEvent < 0 )
+	{
+		return false;
+	}
+	unlink( socketPath.c_str() );
+	if( bind( listenSocket, (struct sockaddr*) &address, sizeof( address ) ) != 0 ||
+		listen( listenSocket, SOMAXCONN ) != 0 )
+	{
+		return false;
+	}
+
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.fd = listenSocket;
+	epoll_ctl( eventPoll, EPOLL_CTL_ADD, listenSocket, &event );
+	event.data.fd = wakeEvent;
+	epoll_ctl( eventPoll, EPOLL_CTL_ADD, wakeEvent, &event );
+	return true;
+}
+
+/**
+ * @brief run
+ *
+ * @details event loop of the server, returns after stop
+ *
+ * @par Algorithm waits on the listening socket, every client socket and the
+ *      wake up event of the statement pool. An idle session costs only its
+ *      buffers, a thread is used only while a statement runs
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Server::run()
+{
+	struct epoll_event events[ MAX_EVENTS ];
+
+	while( !( stopping && sessions.empty() ) )
+	{
+		int ready = epoll_wait( eventPoll, events, MAX_EVENTS, -1 );
+		if( ready < 0 )
+		{
+			if( errno == EINTR )
+			{
+				continue;
+			}
+			break;
+		}
+
+		for( int index = 0; index < ready; index++ )
+		{
+			int eventSocket = events[ index ].data.fd;
+			if( eventSocket == listenSocket )
+			{
+				acceptSessions();
+			}
+			else if( eventSocket == wakeEvent )
+			{
+				uint64_t count;
+				while( read( wakeEvent, &count, sizeof( count ) ) > 0 )
+				{
+
+				}
+				finishStatements();
+			}
+			else if( sessions.find( eventSocket ) != sessions.end() )
+			{
+				Session *session = sessions[ eventSocket ];
+				if( events[ index ].events & ( EPOLLIN | EPOLLHUP | EPOLLERR ) )
+				{
+					readSession( session );
+				}
+				if( events[ index ].events & EPOLLOUT )
+				{
+					writeSession( session );
+				}
+				serviceSession( session );
+			}
+		}
+
+		//sessions without a running statement end right away on stop
+		if( stopping )
+		{
+			if( listenSocket >= 0 )
+			{
+				epoll_ctl( eventPoll, EPOLL_CTL_DEL, listenSocket, NULL );
+				close( listenSocket );
+				listenSocket = -1;
+			}
+			vector< Session* > idleSessions;
+			for( map< int, Session* >::iterator it = sessions.begin(); it != sessions.end(); ++it )
+			{
+				if( !it->second->running )
+				{
+					idleSessions.push_back( it->second );
+				}
+			}
+			int idleSize = idleSessions.size();
+			for( int sessionIndex = 0; sessionIndex < idleSize; sessionIndex++ )
+			{
+				closeSession( idleSessions[ sessionIndex ] );
+			}
+		}
+	}
+	unlink( socketPath.c_str() );
+}
+
+/**
+ * @brief stop
+ *
+ * @details asks the event loop to end every session and return
+ *
+ * @return None
+ *
+ * @note safe to call from any thread, a statement that is running is
+ *       finished first
+ */
+void Server::stop()
+{
+	stopping = true;
+	wake();
+}
+
+/**
+ * @brief wake
+ *
+ * @details wakes the event loop out of epoll_wait
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Server::wake()
+{
+	uint64_t count = 1;
+	ssize_t written = write( wakeEvent, &count, sizeof( count ) );
+	(void) written;
+}
+
+/**
+ * @brief acceptSessions
+ *
+ * @details accepts every waiting client and registers it with epoll
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Server::acceptSessions()
+{
+	while( !stopping )
+	{
+		int clientSocket = accept4( listenSocket, NULL, NULL, SOCK_NONBLOCK );
+		if( clientSocket < 0 )
+		{
+			if( errno == EINTR || errno == ECONNABORTED )
+			{
+				continue;
+			}
+			return;
+		}
+
+		Session *session = new Session;
+		session->clientSocket = clientSocket;
+		session->connection.open( catalogConnection );
+		session->running = false;
+		session->statementExit = false;
+		session->exitRequested = false;
+		session->peerClosed = false;
+		sessions[ clientSocket ] = session;
+
+		struct epoll_event event;
+		event.events = EPOLLIN;
+		event.data.fd = clientSocket;
+		epoll_ctl( eventPoll, EPOLL_CTL_ADD, clientSocket, &event );
+	}
+}
+
+/**
+ * @brief readSession
+ *
+ * @details reads everything the client has sent so far
+ *
+ * @param [in] Session *session
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Server::readSession( Session *session )
+{
+	char data[ SOCKET_BUFFER_SIZE ];
+	while( !session->peerClosed )
+	{
+		ssize_t received = recv( session->clientSocket, data, sizeof( data ), 0 );
+		if( received > 0 )
+		{
+			session->inBuffer.append( data, received );
+		}
+		else if( received < 0 && errno == EINTR )
+		{
+			continue;
+		}
+		else if( received < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) )
+		{
+			return;
+		}
+		else
+		{
+			session->peerClosed = true;
+		}
+	}
+}
+
+/**
+ * @brief writeSession
+ *
+ * @details sends as much of the pending output as the socket takes
+ *
+ * @param [in] Session *session
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Server::writeSession( Session *session )
+{
+	while( !session->outBuffer.empty() )
+	{
+		ssize_t written = send( session->clientSocket, session->outBuffer.data(),
+								session->outBuffer.size(), MSG_NOSIGNAL );
+		if( written > 0 )
+		{
+			session->outBuffer.erase( 0, written );
+		}
+		else if( written < 0 && errno == EINTR )
+		{
+			continue;
+		}
+		else if( written < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) )
+		{
+			return;
+		}
+		else
+		{
+			//the client is gone, nothing more can be sent to it
+			session->outBuffer.clear();
+			session->peerClosed = true;
+			session->exitRequested = true;
+		}
+	}
+}
+
+/**
+ * @brief serviceSession
+ *
+ * @details moves a session on after any of its events
+ *
+ * @par Algorithm starts its next statement, sends its output, then either
+ *      closes it or waits for the events it still needs: input while the
+ *      client can send, output while a reply is pending
+ *
+ * @param [in] Session *session
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Server::serviceSession( Session *session )
+{
+	dispatchStatement( session );
+	writeSession( session );
+
+	if( !session->running && session->outBuffer.empty() &&
+		( session->exitRequested || session->peerClosed || stopping ) )
+	{
+		closeSession( session );
+		return;
+	}
+
+	struct epoll_event event;
+	event.events = 0;
+	if( !session->peerClosed )
+	{
+		event.events |= EPOLLIN;
+	}
+	if( !session->outBuffer.empty() )
+	{
+		event.events |= EPOLLOUT;
+	}
+	event.data.fd = session->clientSocket;
+	epoll_ctl( eventPoll, EPOLL_CTL_MOD, session->clientSocket, &event );
+}
+
+/**
+ * @brief dispatchStatement
+ *
+ * @details hands the next complete statement of a session to the pool
+ *
+ * @par Algorithm a session runs one statement at a time so its results stay
+ *      in order, statements of different sessions run side by side under the
+ *      catalog and table locks of their connections
+ *
+ * @param [in] Session *session
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Server::dispatchStatement( Session *session )
+{
+	string statement;
+	if( session->running || session->exitRequested || stopping ||
+		!nextStatement( session->inBuffer, statement ) )
+	{
+		return;
+	}
+
+	if( exitCheck( statement ) )
+	{
+		session->exitRequested = true;
+		session->outBuffer += "-- All done. \n";
+		return;
+	}
+
+	session->running = true;
+	statementPool.submit( [ this, session, statement ]()
+	{
+		ostringstream reply;
+		{
+			ResultSet result = session->connection.execute( statement );
+			result.print( reply );
+			session->statementExit = result.isExit();
+		}
+		session->reply = reply.str();
+
+		lock_guard< mutex > guard( completionLock );
+		completedSessions.push_back( session );
+		wake();
+	} );
+}
+
+/**
+ * @brief finishStatements
+ *
+ * @details queues the replies of finished statements for sending
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Server::finishStatements()
+{
+	vector< Session* > finished;
+	{
+		lock_guard< mutex > guard( completionLock );
+		finished.swap( completedSessions );
+	}
+
+	int finishedSize = finished.size();
+	for( int index = 0; index < finishedSize; index++ )
+	{
+		Session *session = finished[ index ];
+		session->running = false;
+		session->outBuffer += session->reply;
+		session->reply.clear();
+		if( session->statementExit )
+		{
+			session->exitRequested = true;
+			session->outBuffer += "-- All done. \n";
+		}
+		serviceSession( session );
+	}
+}
+
+/**
+ * @brief closeSession
+ *
+ * @details removes a session from the event loop and releases it
+ *
+ * @param [in] Session *session - must not have a running statement
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Server::closeSession( Session *session )
+{
+	epoll_ctl( eventPoll, EPOLL_CTL_DEL, session->clientSocket, NULL );
+	close( session->clientSocket );
+	sessions.erase( session->clientSocket );
+	session->connection.close();
+	delete session;
+}
+
+/**
+ * @brief startServer
+ *
+ * @details runs server mode until SIGINT or SIGTERM
+ *
+ * @par Algorithm the signals are blocked in every thread and taken by one
+ *      thread with sigwait, which then stops the server
+ *
+ * @param [in] string workingDirectory
+ *
+ * @param [in] string socketPath
+ *
+ * @return None
+ *
+ * @note None
+ */
+void startServer( string workingDirectory, string socketPath )
+{
+	sigset_t stopSignals;
+	sigemptyset( &stopSignals );
+	sigaddset( &stopSignals, SIGINT );
+	sigaddset( &stopSignals, SIGTERM );
+	pthread_sigmask( SIG_BLOCK, &stopSignals, NULL );
+
+	Server server( workingDirectory, socketPath );
+	if( !server.start() )
+	{
+		cout << "-- !Failed to start server on " << socketPath << "." << endl;
+		return;
+	}
+	cout << "-- Server listening on " << socketPath << "." << endl;
+
+	thread signalThread( [ &server, stopSignals ]()
+	{
+		int signalNumber;
+		sigwait( &stopSignals, &signalNumber );
+		server.stop();
+	} );
+	signalThread.detach();
+
+	server.run();
+	cout << "-- Server stopped." << endl;
+}
+
+/**
+ * @brief startClient
+ *
+ * @details command line client of server mode
+ *
+ * @par Algorithm standard input is sent to the server line by line from a
+ *      second thread while the replies are copied to standard output
+ *
+ * @param [in] string socketPath
+ *
+ * @return None
+ *
+ * @note None
+ */
+void startClient( string socketPath )
+{
+	struct sockaddr_un address;
+	memset( &address, 0, sizeof( address ) );
+	address.sun_family = AF_UNIX;
+	strncpy( address.sun_path, socketPath.c_str(), sizeof( address.sun_path ) - 1 );
+
+	int serverSocket = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if( serverSocket < 0 || connect( serverSocket, (struct sockaddr*) &address, sizeof( address ) ) != 0 )
+	{
+		cout << "-- !Failed to connect to server on " << socketPath << "." << endl;
+		return;
+	}
+
+	thread inputThread( [ serverSocket ]()
+	{
+		string line;
+		while( getline( cin, line ) && sendAll( serverSocket, line + "\n" ) )
+		{
+
+		}
+		shutdown( serverSocket, SHUT_WR );
+	} );
+	inputThread.detach();
+
+	char data[ SOCKET_BUFFER_SIZE ];
+	ssize_t received;
+	while( ( received = recv( serverSocket, data, sizeof( data ), 0 ) ) != 0 )
+	{
+		if( received < 0 )
+		{
+			if( errno == EINTR )
+			{
+				continue;
+			}
+			break;
+		}
+		cout.write( data, received );
+		cout.flush();
+	}
+	close( serverSocket );
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,89 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file Server.h
+ *
+ * @brief Definition file for the Server class
+ *
+ * @details Specifies the long running server mode. The server listens on a
+ *          Unix domain socket, reads the catalog once and serves many client
+ *          sessions at the same time, each with its own current database.
+ *          Sessions are multiplexed by one epoll event loop, statements run
+ *          on a pool of worker threads
+ *
+ * @Note None
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "Connection.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef SERVER_H
+#define SERVER_H
+
+//bytes read from a client socket at a time
+const int SOCKET_BUFFER_SIZE = 4096;
+
+//events taken from epoll per wake up
+const int MAX_EVENTS = 256;
+
+//state of one client, only the event loop touches it while no statement
+//of the session is running on the statement pool
+struct Session{
+	int clientSocket;
+	Connection connection;
+	string inBuffer;
+	string outBuffer;
+	string reply;
+	bool running;
+	bool statementExit;
+	bool exitRequested;
+	bool peerClosed;
+};
+
+class Server{
+	public:
+		Server( string workingDirectory, string path );
+		~Server();
+		bool start();
+		void run();
+		void stop();
+
+	private:
+		Connection catalogConnection;
+		string currentWorkingDirectory;
+		string socketPath;
+		int listenSocket;
+		int eventPoll;
+		int wakeEvent;
+		atomic< bool > stopping;
+		ThreadPool statementPool;
+		mutex completionLock;
+		vector< Session* > completedSessions;
+		map< int, Session* > sessions;
+
+		void acceptSessions();
+		void readSession( Session *session );
+		void writeSession( Session *session );
+		void serviceSession( Session *session );
+		void dispatchStatement( Session *session );
+		void finishStatements();
+		void closeSession( Session *session );
+		void wake();
+};
+
+bool nextStatement( string &buffer, string &statement );
+bool sendAll( int socket, string data );
+void startServer( string workingDirectory, string socketPath );
+void startClient( string socketPath );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
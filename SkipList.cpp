@@ -0,0 +1,242 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file SkipList.cpp
+ *
+ * @brief Implementation file for the SkipList class
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements the skip list an LSM table keeps its newest records
+ *          in. Records are found and inserted in O(log n) and visited in
+ *          key order when the list is written out
+ *
+ * @Note Requires SkipList.h
+ */
+#include <string>
+#include <vector>
+#include <functional>
+#include <random>
+#include "SkipList.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef SKIPLIST_CPP
+#define SKIPLIST_CPP
+
+/**
+ * @brief SkipList constructor
+ *
+ * @param [in] function< int( const string &key, const string &other ) >
+ *             keyCompare - negative, 0 or positive like string::compare
+ *
+ * @note None
+ */
+SkipList::SkipList( function< int( const string &key, const string &other ) > keyCompare )
+	: compare( keyCompare ), generator( 20180327 )
+{
+	head.next.assign( SKIP_LIST_MAX_HEIGHT, NULL );
+	height = 1;
+	nodeCount = 0;
+	byteSize = 0;
+}
+
+/**
+ * @brief SkipList destructor
+ *
+ * @details frees every node
+ *
+ * @note None
+ */
+SkipList::~SkipList()
+{
+	clear();
+}
+
+/**
+ * @brief getRandomHeight
+ *
+ * @return int levels a new node is linked on, each one above the first
+ *         with a chance of 1 in SKIP_LIST_BRANCHING
+ *
+ * @note None
+ */
+int SkipList::getRandomHeight()
+{
+	int nodeHeight = 1;
+	while( nodeHeight < SKIP_LIST_MAX_HEIGHT && generator() % SKIP_LIST_BRANCHING == 0 )
+	{
+		nodeHeight++;
+	}
+	return nodeHeight;
+}
+
+/**
+ * @brief findGreaterOrEqual
+ *
+ * @details finds the first node whose key is not below a key
+ *
+ * @par Algorithm starts on the top level of the head and moves right while
+ *      the next key is below the key, then one level down, so each level
+ *      passes only a few nodes
+ *
+ * @param [in] const string &key
+ *
+ * @param [out] vector< SkipNode * > *previous - last node before the key on
+ *              each level, may be NULL
+ *
+ * @return SkipNode * NULL if every key is below the key
+ *
+ * @note None
+ */
+SkipList::SkipNode *SkipList::findGreaterOrEqual( const string &key, vector< SkipNode * > *previous )
+{
+	SkipNode *node = &head;
+	for( int level = height - 1; level >= 0; level-- )
+	{
+		while( node->next[ level ] != NULL && compare( node->next[ level ]->key, key ) < 0 )
+		{
+			node = node->next[ level ];
+		}
+		if( previous != NULL )
+		{
+			( *previous )[ level ] = node;
+		}
+	}
+	return node->next[ 0 ];
+}
+
+/**
+ * @brief insert
+ *
+ * @details adds a record under its key, replacing the record the key held
+ *
+ * @param [in] const string &key
+ *
+ * @param [in] const string &record
+ *
+ * @return None
+ *
+ * @note None
+ */
+void SkipList::insert( const string &key, const string &record )
+{
+	vector< SkipNode * > previous( SKIP_LIST_MAX_HEIGHT, &head );
+	SkipNode *found = findGreaterOrEqual( key, &previous );
+	if( found != NULL && compare( found->key, key ) == 0 )
+	{
+		byteSize += (long) record.size() - (long) found->record.size();
+		found->record = record;
+		return;
+	}
+
+	int nodeHeight = getRandomHeight();
+	if( nodeHeight > height )
+	{
+		height = nodeHeight;
+	}
+	SkipNode *node = new SkipNode;
+	node->key = key;
+	node->record = record;
+	node->next.resize( nodeHeight );
+	for( int level = 0; level < nodeHeight; level++ )
+	{
+		node->next[ level ] = previous[ level ]->next[ level ];
+		previous[ level ]->next[ level ] = node;
+	}
+	nodeCount++;
+	byteSize += key.size() + record.size();
+}
+
+/**
+ * @brief find
+ *
+ * @param [in] const string &key
+ *
+ * @param [out] string &record
+ *
+ * @return bool false if no record has the key
+ *
+ * @note None
+ */
+bool SkipList::find( const string &key, string &record )
+{
+	SkipNode *found = findGreaterOrEqual( key, NULL );
+	if( found == NULL || compare( found->key, key ) != 0 )
+	{
+		return false;
+	}
+	record = found->record;
+	return true;
+}
+
+/**
+ * @brief forEach
+ *
+ * @details visits every record in key order
+ *
+ * @param [in] function< void( const string &key, const string &record ) >
+ *             visit
+ *
+ * @return None
+ *
+ * @note None
+ */
+void SkipList::forEach( function< void( const string &key, const string &record ) > visit )
+{
+	for( SkipNode *node = head.next[ 0 ]; node != NULL; node = node->next[ 0 ] )
+	{
+		visit( node->key, node->record );
+	}
+}
+
+/**
+ * @brief clear
+ *
+ * @details removes every record
+ *
+ * @return None
+ *
+ * @note None
+ */
+void SkipList::clear()
+{
+	SkipNode *node = head.next[ 0 ];
+	while( node != NULL )
+	{
+		SkipNode *next = node->next[ 0 ];
+		delete node;
+		node = next;
+	}
+	head.next.assign( SKIP_LIST_MAX_HEIGHT, NULL );
+	height = 1;
+	nodeCount = 0;
+	byteSize = 0;
+}
+
+/**
+ * @brief size
+ *
+ * @return long number of records
+ *
+ * @note None
+ */
+long SkipList::size()
+{
+	return nodeCount;
+}
+
+/**
+ * @brief getByteSize
+ *
+ * @return long bytes of the keys and records held
+ *
+ * @note None
+ */
+long SkipList::getByteSize()
+{
+	return byteSize;
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
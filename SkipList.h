@@ -0,0 +1,66 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file SkipList.h
+ *
+ * @brief Definition file for the SkipList class
+ *
+ * @details Specifies the ordered map of records by key that an LSM table
+ *          takes its inserts into before they are written to disk
+ *
+ * @Note None
+ */
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <random>
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
+//most levels a node can take part in, enough for far more nodes than a
+//memtable is allowed to hold
+const int SKIP_LIST_MAX_HEIGHT = 16;
+
+//a node reaches one level up with this chance in one
+const int SKIP_LIST_BRANCHING = 4;
+
+//entries stay in key order as they are inserted. Each node is linked on a
+//random number of levels, so finding the place of a key passes O(log n)
+//nodes and an insert never moves the others
+class SkipList{
+	public:
+		SkipList( function< int( const string &key, const string &other ) > keyCompare );
+		~SkipList();
+		void insert( const string &key, const string &record );
+		bool find( const string &key, string &record );
+		void forEach( function< void( const string &key, const string &record ) > visit );
+		void clear();
+		long size();
+		long getByteSize();
+
+	private:
+		struct SkipNode{
+			string key;
+			string record;
+			vector< SkipNode * > next;
+		};
+
+		function< int( const string &key, const string &other ) > compare;
+		SkipNode head;
+		int height;
+		long nodeCount;
+		long byteSize;
+		minstd_rand generator;
+
+		SkipList( const SkipList &other );
+		SkipList &operator=( const SkipList &other );
+		int getRandomHeight();
+		SkipNode *findGreaterOrEqual( const string &key, vector< SkipNode * > *previous );
+};
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,632 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file StorageEngine.cpp
+ *
+ * @brief Implementation file for the storage engines
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements the text engine and the list of engines the engine
+ *          named by a table is looked up in
+ *
+ * @Note Requires StorageEngine.h and LsmEngine.h
+ */
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "StorageEngine.h"
+#include "LsmEngine.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef STORAGEENGINE_CPP
+#define STORAGEENGINE_CPP
+
+/**
+ * @brief StorageEngine destructor
+ *
+ * @note None
+ */
+StorageEngine::~StorageEngine()
+{
+
+}
+
+/**
+ * @brief getName
+ *
+ * @return string name given after ENGINE=
+ *
+ * @note None
+ */
+string TextEngine::getName()
+{
+	return "TEXT";
+}
+
+/**
+ * @brief needsKey
+ *
+ * @return bool true if a table of the engine must have a primary key
+ *
+ * @note None
+ */
+bool TextEngine::needsKey()
+{
+	return false;
+}
+
+/**
+ * @brief getCreateFields
+ *
+ * @return string fields the attribute line of a new table gets, each after
+ *         a tab. The engine field names the engine the table is kept by
+ *
+ * @note None
+ */
+string TextEngine::getCreateFields()
+{
+	return "\t" + ENGINE_FIELD + " " + getName();
+}
+
+/**
+ * @brief scan
+ *
+ * @details builds the operator reading the table and its overflow file
+ *
+ * @par Algorithm the overflow records are read when the operator is built
+ *      and sorted by key, so they are merged with the table file in key
+ *      order
+ *
+ * @param [in] TableScan &scan - scan that has read the attributes
+ *
+ * @param [in] WhereCondition wCond
+ *
+ * @param [in] vector< int > projection - attribute indexes to return
+ *
+ * @return shared_ptr< Operator > scan with the condition and projection
+ *         pushed into it, not yet opened
+ *
+ * @note the caller holds the table lock shared or exclusively
+ */
+shared_ptr< Operator > TextEngine::scan( TableScan &scan, WhereCondition wCond, vector< int > projection )
+{
+	vector< string > records;
+	if( !scan.readOverflow( records ) )
+	{
+		return shared_ptr< Operator >( new TableScanOperator( scan, wCond, projection ) );
+	}
+
+	shared_ptr< vector< string > > overflow( new vector< string > );
+	if( scan.isClustered() )
+	{
+		int keyType = getValueType( scan.storedColumns[ scan.keyColumn ].attribute.attributeType );
+		vector< pair< string, string > > keyed;
+		for( unsigned int index = 0; index < records.size(); index++ )
+		{
+			keyed.push_back( make_pair( scan.getRecordKey( scan.getRecordValues( records[ index ] ), scan.keyColumn ), records[ index ] ) );
+		}
+		stable_sort( keyed.begin(), keyed.end(), [ keyType ]( const pair< string, string > &record, const pair< string, string > &other )
+		{
+			return compareKeys( record.first, other.first, keyType ) < 0;
+		} );
+		for( unsigned int index = 0; index < keyed.size(); index++ )
+		{
+			overflow->push_back( keyed[ index ].second );
+		}
+	}
+	else
+	{
+		overflow->swap( records );
+	}
+
+	TableScan recordScan( scan );
+	RecordScanner scanOverflow = [ recordScan, overflow ]( WhereCondition condition, vector< int > projectionIndexes, MorselResult &result ) mutable
+	{
+		recordScan.resolveCondition( condition );
+		for( unsigned int index = 0; index < overflow->size(); index++ )
+		{
+			recordScan.addMatchingRow( ( *overflow )[ index ], condition, projectionIndexes, result );
+		}
+	};
+	return shared_ptr< Operator >( new TableScanOperator( scan, wCond, projection, vector< TableScan >(), scanOverflow ) );
+}
+
+/**
+ * @brief insert
+ *
+ * @details adds one record to the table
+ *
+ * @par Algorithm a record of a table kept in key order is collected to be
+ *      placed where its key belongs together with the other inserts of its
+ *      transaction, or added to the overflow file when logInsert found its
+ *      key below the last one. Any other one is appended to the file
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] vector< string > values - stored values of the record
+ *
+ * @return int records inserted, -1 if the table could not be written
+ *
+ * @note None
+ */
+int TextEngine::insert( TableScan &scan, vector< string > values )
+{
+	if( scan.placeInserts )
+	{
+		scan.addPlacedRecord( values );
+		return 1;
+	}
+	if( scan.spillInsert )
+	{
+		scan.spillInsert = false;
+		return scan.writeOverflow( values, -1 ) ? 1 : -1;
+	}
+
+	ofstream fout;
+	fout.open( scan.filePath.c_str(), ofstream::out | ofstream::app );
+	if( !fout )
+	{
+		return -1;
+	}
+	fout << "\n" + joinRow( values );
+	fout.close();
+	return 1;
+}
+
+/**
+ * @brief update
+ *
+ * @details sets one attribute of the records matching a condition
+ *
+ * @par Algorithm the table is partitioned into morsels that evaluate the
+ *      where and set conditions in parallel, then the partitions are
+ *      stitched into the new table file
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] WhereCondition wCond
+ *
+ * @param [in] SetCondition sCond
+ *
+ * @return int records modified, -1 if the table could not be rewritten
+ *
+ * @note None
+ */
+int TextEngine::update( TableScan &scan, WhereCondition wCond, SetCondition sCond )
+{
+	scan.resolveCondition( wCond );
+	return scan.parallelRewrite( [ & ]( vector< string > &row )
+	{
+		if( sCond.attributeIndex < 0 || !scan.rowMatches( wCond, row ) )
+		{
+			return ROW_KEEP;
+		}
+		if( sCond.attributeIndex >= (int) row.size() )
+		{
+			row.resize( sCond.attributeIndex + 1 );
+		}
+		row[ sCond.attributeIndex ] = sCond.newValue;
+		return ROW_CHANGED;
+	}, &wCond );
+}
+
+/**
+ * @brief remove
+ *
+ * @details deletes the records matching a condition
+ *
+ * @par Algorithm the surviving records of every morsel are stitched into
+ *      the new table file. Morsels whose zone rules out the condition are
+ *      copied without being read
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] WhereCondition wCond
+ *
+ * @return int records deleted, -1 if the table could not be rewritten
+ *
+ * @note None
+ */
+int TextEngine::remove( TableScan &scan, WhereCondition wCond )
+{
+	scan.resolveCondition( wCond );
+	return scan.parallelRewrite( [ & ]( vector< string > &row )
+	{
+		return scan.rowMatches( wCond, row ) ? ROW_DELETE : ROW_KEEP;
+	}, &wCond );
+}
+
+/**
+ * @brief alter
+ *
+ * @details gives the table a new schema
+ *
+ * @par Algorithm only the schema file is written, records keep the layout
+ *      they were written in. Fixed width records have no room for a changed
+ *      schema, so such a table is rewritten in its new layout right away
+ *
+ * @param [in] TableScan &scan - scan of the table in its old schema
+ *
+ * @param [in] const vector< StoredColumn > &storedColumns - new schema
+ *
+ * @param [out] string &reason - why the change failed, empty if no reason
+ *              is known
+ *
+ * @return bool false if the old schema was kept
+ *
+ * @note None
+ */
+bool TextEngine::alter( TableScan &scan, const vector< StoredColumn > &storedColumns, string &reason )
+{
+	if( !writeSchemaFile( scan.filePath, scan.attributeData, storedColumns ) )
+	{
+		return false;
+	}
+	if( scan.recordWidth <= 0 )
+	{
+		return true;
+	}
+
+	string alterPath = getWorkPath( scan.filePath, "alter" );
+	TableScan altered;
+	if( !altered.scanOpen( scan.filePath ) || !altered.compactTo( alterPath, true, false ) ||
+		rename( alterPath.c_str(), scan.filePath.c_str() ) != 0 )
+	{
+		unlink( alterPath.c_str() );
+		writeSchemaFile( scan.filePath, scan.attributeData, scan.storedColumns );
+		reason = "a record is longer than its fixed width";
+		return false;
+	}
+	unlink( getWorkPath( scan.filePath, SCHEMA_SUFFIX ).c_str() );
+	return true;
+}
+
+/**
+ * @brief drop
+ *
+ * @details removes the table file and the hidden files kept next to it
+ *
+ * @param [in] string tableFilePath
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TextEngine::drop( string tableFilePath )
+{
+	unlink( tableFilePath.c_str() );
+	unlink( getWorkPath( tableFilePath, SCHEMA_SUFFIX ).c_str() );
+	unlink( getWorkPath( tableFilePath, ZONES_SUFFIX ).c_str() );
+	unlink( getWorkPath( tableFilePath, BLOOM_SUFFIX ).c_str() );
+	unlink( getWorkPath( tableFilePath, OVERFLOW_SUFFIX ).c_str() );
+}
+
+/**
+ * @brief release
+ *
+ * @details forgets what the engine keeps in memory of the tables below a
+ *          DatabaseSystem directory, whose files are then read again
+ *
+ * @param [in] string systemPath
+ *
+ * @return None
+ *
+ * @note the text engine keeps nothing
+ */
+void TextEngine::release( string systemPath )
+{
+
+}
+
+/**
+ * @brief buildUniqueIndex
+ *
+ * @details counts the records holding each value of the unique columns in
+ *          the table file and its overflow file
+ *
+ * @param [in] TableScan &scan - scan of the table as committed
+ *
+ * @param [out] UniqueIndex &index - versions are left to the caller
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TextEngine::buildUniqueIndex( TableScan &scan, UniqueIndex &index )
+{
+	vector< TableScan > moreScans;
+	vector< string > records;
+	scan.readOverflow( records );
+	scan.buildUniqueIndex( index, moreScans, records );
+}
+
+/**
+ * @brief mergeRecords
+ *
+ * @details merges the records the engine keeps outside the table file into
+ *          it, before the file is rewritten by an update, delete, rewrite or
+ *          schema change
+ *
+ * @param [in] TableScan &scan - scan of the table file
+ *
+ * @return int 0, the records of the overflow file are stored like those of
+ *         the table and every rewrite takes them in
+ *
+ * @note the caller holds the table lock exclusively
+ */
+int TextEngine::mergeRecords( TableScan &scan )
+{
+	return 0;
+}
+
+/**
+ * @brief needsBlockingRewrite
+ *
+ * @return bool true if a rewrite must hold the table throughout, as it
+ *         merges records into the file first. False lets it compact a
+ *         snapshot while writers carry on
+ *
+ * @note None
+ */
+bool TextEngine::needsBlockingRewrite()
+{
+	return false;
+}
+
+/**
+ * @brief writesAtCheckpoint
+ *
+ * @return bool true if a checkpoint writes to the table, it then holds the
+ *         table lock exclusively instead of shared
+ *
+ * @note None
+ */
+bool TextEngine::writesAtCheckpoint()
+{
+	return false;
+}
+
+/**
+ * @brief checkpoint
+ *
+ * @details brings what is kept next to a table up to date with the synced
+ *          table file
+ *
+ * @par Algorithm the zone map is extended over the records appended since
+ *      it was written. The overflow file is synced, as its inserts are no
+ *      longer needed in the log, or removed once a rewrite took it in
+ *
+ * @param [in] TableScan &scan - scan of the table file
+ *
+ * @return int -1 if the overflow file could not be synced, 0 otherwise,
+ *         the table file is not rewritten
+ *
+ * @note a zone map that cannot be extended is built again by a rewrite
+ */
+int TextEngine::checkpoint( TableScan &scan )
+{
+	scan.extendZones();
+	if( access( scan.overflowFilePath.c_str(), F_OK ) != 0 )
+	{
+		return 0;
+	}
+	if( scan.getOverflowSize() == 0 )
+	{
+		unlink( scan.overflowFilePath.c_str() );
+		return 0;
+	}
+	return syncFile( scan.overflowFilePath ) ? 0 : -1;
+}
+
+/**
+ * @brief stagesInserts
+ *
+ * @details tells whether the inserts of a transaction into a table need a
+ *          staged copy of it
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] const vector< vector< string > > &rows - stored values of the
+ *             inserted records in statement order
+ *
+ * @return bool true if they would break the key order of a clustered table
+ *         and would fill its overflow file, they are then placed where
+ *         their keys belong together with its records. False if they are
+ *         appended to the table or its overflow file
+ *
+ * @note a table without a zone token has no overflow file
+ */
+bool TextEngine::stagesInserts( TableScan &scan, const vector< vector< string > > &rows )
+{
+	if( scan.appendsInOrder( rows ) )
+	{
+		return false;
+	}
+	if( scan.getFileToken().empty() )
+	{
+		return true;
+	}
+	long overflowSize = scan.getOverflowSize();
+	for( unsigned int index = 0; index < rows.size(); index++ )
+	{
+		overflowSize += joinRow( rows[ index ] ).size() + 1;
+	}
+	return overflowSize > OVERFLOW_SIZE;
+}
+
+/**
+ * @brief logInsert
+ *
+ * @details describes an insert applied after it is logged as a commit log
+ *          line, INSERT table offset value..., or OVERFLOW table token
+ *          offset value... for a record added to the overflow file
+ *
+ * @par Algorithm a record of a clustered table whose key is below the last
+ *      key of the table, counting the records appended before it, goes to
+ *      the overflow file. The scan is told so for insert. The token is
+ *      that of the table file the overflow file belongs to
+ *
+ * @param [in] TableScan &scan - scan of the table
+ *
+ * @param [in] string tableName - database/table below DatabaseSystem
+ *
+ * @param [in] const vector< string > &values - stored values of the record
+ *
+ * @param [in/out] InsertCursor &cursor - where the next record starts in
+ *                 the file and the overflow file, and the last key
+ *
+ * @return string record without the newline
+ *
+ * @note the caller holds the table lock exclusively until the record is
+ *       inserted
+ */
+string TextEngine::logInsert( TableScan &scan, string tableName, const vector< string > &values, InsertCursor &cursor )
+{
+	bool clustered = scan.isClustered();
+	if( cursor.tableEnd < 0 )
+	{
+		struct stat buffer;
+		cursor.tableEnd = ( stat( scan.filePath.c_str(), &buffer ) == 0 ) ? buffer.st_size : 0;
+		cursor.overflowEnd = ZONE_TOKEN_SIZE + scan.getOverflowSize();
+		cursor.hasLastKey = clustered && scan.getLastKey( cursor.lastKey );
+	}
+	string key = clustered ? scan.getInsertKey( values ) : "";
+	scan.spillInsert = cursor.hasLastKey &&
+		compareKeys( key, cursor.lastKey, getValueType( scan.storedColumns[ scan.keyColumn ].attribute.attributeType ) ) < 0;
+
+	vector< string > fields;
+	fields.push_back( scan.spillInsert ? "OVERFLOW" : "INSERT" );
+	fields.push_back( tableName );
+	if( scan.spillInsert )
+	{
+		fields.push_back( scan.getFileToken() );
+		fields.push_back( to_string( cursor.overflowEnd ) );
+		cursor.overflowEnd += joinRow( values ).size() + 1;
+	}
+	else
+	{
+		fields.push_back( to_string( cursor.tableEnd ) );
+		cursor.tableEnd += joinRow( values ).size() + 1;
+		cursor.lastKey = key;
+		cursor.hasLastKey = clustered;
+	}
+	fields.insert( fields.end(), values.begin(), values.end() );
+	return joinRow( fields );
+}
+
+/**
+ * @brief finishCommit
+ *
+ * @details follows up on a commit that applied inserts to a table
+ *
+ * @param [in] TableScan &scan - scan of the table file
+ *
+ * @return int 0, appended records need nothing more
+ *
+ * @note the caller holds the table lock exclusively
+ */
+int TextEngine::finishCommit( TableScan &scan )
+{
+	return 0;
+}
+
+/**
+ * @brief redo
+ *
+ * @details redoes the commit log lines of the engine's own kind for a table
+ *
+ * @par Algorithm an OVERFLOW line is redone at its offset if its token is
+ *      that of the table file, otherwise the table was rewritten since and
+ *      holds the record
+ *
+ * @param [in] TableScan &scan - scan of the table file
+ *
+ * @param [in] vector< vector< string > > &records - fields of the lines in
+ *             log order, other than INSERT, WRITE and REPLACE lines
+ *
+ * @return bool false if a record could not be written or the overflow file
+ *         synced
+ *
+ * @note runs only while the commit log is opened
+ */
+bool TextEngine::redo( TableScan &scan, vector< vector< string > > &records )
+{
+	string token = scan.getFileToken();
+	bool redone = true;
+	bool written = false;
+	for( unsigned int index = 0; index < records.size(); index++ )
+	{
+		vector< string > &fields = records[ index ];
+		if( fields[ 0 ] == "OVERFLOW" && fields.size() > 4 && !token.empty() && fields[ 2 ] == token )
+		{
+			redone = scan.writeOverflow( vector< string >( fields.begin() + 4, fields.end() ), atol( fields[ 3 ].c_str() ) ) && redone;
+			written = true;
+		}
+	}
+	return redone && ( !written || syncFile( scan.overflowFilePath ) );
+}
+
+/**
+ * @brief getStorageEngines
+ *
+ * @details lists the engines a table can be created with
+ *
+ * @return vector< StorageEngine * > & engines
+ *
+ * @note None
+ */
+vector< StorageEngine * > &getStorageEngines()
+{
+	static LsmEngine lsmEngine;
+	static TextEngine textEngine;
+	static vector< StorageEngine * > engines = { &lsmEngine, &textEngine };
+	return engines;
+}
+
+/**
+ * @brief findStorageEngine
+ *
+ * @param [in] string name - name given after ENGINE=, in upper case
+ *
+ * @return StorageEngine * NULL if no engine has the name
+ *
+ * @note None
+ */
+StorageEngine *findStorageEngine( string name )
+{
+	vector< StorageEngine * > &engines = getStorageEngines();
+	for( unsigned int index = 0; index < engines.size(); index++ )
+	{
+		if( engines[ index ]->getName() == name )
+		{
+			return engines[ index ];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief getStorageEngine
+ *
+ * @param [in] TableScan &scan - scan that has read the attributes
+ *
+ * @return StorageEngine & engine named by the attribute line of the table
+ *
+ * @note a name no engine has is only written by hand, the table is then
+ *       read as text
+ */
+StorageEngine &getStorageEngine( TableScan &scan )
+{
+	StorageEngine *engine = findStorageEngine( scan.engineName );
+	return ( engine == NULL ) ? *findStorageEngine( DEFAULT_ENGINE ) : *engine;
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
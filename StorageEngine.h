@@ -0,0 +1,100 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file StorageEngine.h
+ *
+ * @brief Definition file for the storage engines
+ *
+ * @details Specifies the interface a table's storage goes through, so the
+ *          statements of Table and the commits, checkpoints and recovery of
+ *          the catalog do not depend on how records are laid out. The text
+ *          file is one engine and the LSM tree another, a table picks its
+ *          engine with CREATE TABLE ... ENGINE=name and keeps its name in
+ *          the attribute line
+ *
+ * @Note None
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include "Operator.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef STORAGEENGINE_H
+#define STORAGEENGINE_H
+
+//where the inserts of one transaction into a table go, which the engine
+//tracks while they are logged. The ends start at -1 until the first insert
+struct InsertCursor{
+	long tableEnd;
+	long overflowEnd;
+	bool hasLastKey;
+	string lastKey;
+};
+
+//the storage operations of a table. A scan has read the table's attributes
+//before any of them is called. Update and delete take the where condition
+//the records are matched by, the byte offset of a record being the only
+//address it has and changing whenever the table is rewritten. An engine
+//may keep records outside the table file, which the steps a commit,
+//checkpoint, rewrite and recovery take on the table are asked about. A
+//step returning int gives -1 if it failed, 1 if it rewrote the table file,
+//which then has a new version, otherwise 0
+class StorageEngine{
+	public:
+		virtual ~StorageEngine();
+		virtual string getName() = 0;
+		virtual bool needsKey() = 0;
+		virtual string getCreateFields() = 0;
+		virtual shared_ptr< Operator > scan( TableScan &scan, WhereCondition wCond, vector< int > projection ) = 0;
+		virtual int insert( TableScan &scan, vector< string > values ) = 0;
+		virtual int update( TableScan &scan, WhereCondition wCond, SetCondition sCond ) = 0;
+		virtual int remove( TableScan &scan, WhereCondition wCond ) = 0;
+		virtual bool alter( TableScan &scan, const vector< StoredColumn > &storedColumns, string &reason ) = 0;
+		virtual void drop( string tableFilePath ) = 0;
+		virtual void release( string systemPath ) = 0;
+		virtual void buildUniqueIndex( TableScan &scan, UniqueIndex &index ) = 0;
+		virtual int mergeRecords( TableScan &scan ) = 0;
+		virtual bool needsBlockingRewrite() = 0;
+		virtual bool writesAtCheckpoint() = 0;
+		virtual int checkpoint( TableScan &scan ) = 0;
+		virtual bool stagesInserts( TableScan &scan, const vector< vector< string > > &rows ) = 0;
+		virtual string logInsert( TableScan &scan, string tableName, const vector< string > &values, InsertCursor &cursor ) = 0;
+		virtual int finishCommit( TableScan &scan ) = 0;
+		virtual bool redo( TableScan &scan, vector< vector< string > > &records ) = 0;
+};
+
+//records are lines of the table file, appended or placed by their primary
+//key, and updates and deletes rewrite the file morsel by morsel
+class TextEngine : public StorageEngine{
+	public:
+		string getName();
+		bool needsKey();
+		string getCreateFields();
+		shared_ptr< Operator > scan( TableScan &scan, WhereCondition wCond, vector< int > projection );
+		int insert( TableScan &scan, vector< string > values );
+		int update( TableScan &scan, WhereCondition wCond, SetCondition sCond );
+		int remove( TableScan &scan, WhereCondition wCond );
+		bool alter( TableScan &scan, const vector< StoredColumn > &storedColumns, string &reason );
+		void drop( string tableFilePath );
+		void release( string systemPath );
+		void buildUniqueIndex( TableScan &scan, UniqueIndex &index );
+		int mergeRecords( TableScan &scan );
+		bool needsBlockingRewrite();
+		bool writesAtCheckpoint();
+		int checkpoint( TableScan &scan );
+		bool stagesInserts( TableScan &scan, const vector< vector< string > > &rows );
+		string logInsert( TableScan &scan, string tableName, const vector< string > &values, InsertCursor &cursor );
+		int finishCommit( TableScan &scan );
+		bool redo( TableScan &scan, vector< vector< string > > &records );
+};
+
+vector< StorageEngine * > &getStorageEngines();
+StorageEngine *findStorageEngine( string name );
+StorageEngine &getStorageEngine( TableScan &scan );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -19,6 +19,15 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include "Table.h"
+#include "PreparedStatement.h"
+#include "ThreadPool.cpp"
+#include "PageCodec.cpp"
+#include "SkipList.cpp"
+#include "TableScan.cpp"
+#include "ZoneMap.cpp"
+#include "Operator.cpp"
+#include "StorageEngine.cpp"
+#include "LsmEngine.cpp"
 
 using namespace std;
 
@@ -38,6 +47,8 @@ void getWhereCondition( WhereCondition &wCond, string whereType, vector< Attribu
 void getSetCondition( SetCondition &sCond, string setType, vector< Attribute > attributes );
 bool currIndexIsSubset( vector< AttributeSubset > attrSubsets, int indexVal );
 bool indexExists( int i, vector< int > indexCounter );
+void convertToUC( string &input );
+bool takeConstraint( string &declaration, const string &constraint );
 /**
  * @brief getCommaCount
  *
@@ -191,7 +202,7 @@ void removeLeadingWS( string &input )
 	input.erase( 0, index );
 
 	index = input.size() - 1;
-	while( input[ index ] == ' ' || input[ index ] == '\t' )
+	while( index >= 0 && ( input[ index ] == ' ' || input[ index ] == '\t' ) )
 	{
 		index--;
 	}
@@ -232,6 +243,81 @@ bool attributeNameExists( vector< Attribute > attributeTable, Attribute attr )
 }
 
 
+/**
+ * @brief takeConstraint
+ *
+ * @details removes a constraint such as PRIMARY KEY or UNIQUE from the end
+ *          of an attribute declaration
+ *
+ * @par Algorithm compares the end of the declaration with the constraint
+ *      in upper case, then removes it and the white space before it
+ *
+ * @param [in/out] string &declaration - e.g. int PRIMARY KEY
+ *
+ * @param [in] const string &constraint - in upper case
+ *
+ * @return bool true if the declaration had the constraint
+ *
+ * @note None
+ */
+bool takeConstraint( string &declaration, const string &constraint )
+{
+	string upperDeclaration = declaration;
+	convertToUC( upperDeclaration );
+	removeLeadingWS( upperDeclaration );
+	removeLeadingWS( declaration );
+	long start = (long) upperDeclaration.size() - (long) constraint.size();
+	if( start < 0 || upperDeclaration.compare( start, constraint.size(), constraint ) != 0 ||
+		( start > 0 && !isspace( upperDeclaration[ start - 1 ] ) ) )
+	{
+		return false;
+	}
+	declaration.erase( start );
+	removeLeadingWS( declaration );
+	return true;
+}
+
+
+/**
+ * @brief getInsertValues
+ *
+ * @details splits the value list of an insert into its values
+ *          
+ * @pre the surrounding parentheses have been removed
+ *
+ * @post values are returned without surrounding white space
+ *
+ * @par Algorithm takes everything up to each comma as one value
+ *
+ * @param [in] string input - e.g. 1, 'Gizmo', 19.99
+ *      
+ * @return vector< string > values in attribute order
+ *
+ * @note None
+ */
+vector< string > getInsertValues( string input )
+{
+	vector< string > values;
+	string temp;
+	int commaCount = getCommaCount( input );
+	for( int index = 0; index < commaCount; index++ )
+	{
+		//remove beginning parameter
+		temp = input.substr( 0, input.find( "," ));
+		input.erase( 0, input.find(",") + 1 );
+
+		//remove leading white space
+		removeLeadingWS( temp );
+		values.push_back( getStoredValue( temp ) );
+	}
+	
+	//remove leading WS from input
+	removeLeadingWS( input );
+	values.push_back( getStoredValue( input ) );
+	return values;
+}
+
+
 /**
  * @brief table default constructor
  *
@@ -267,7 +353,10 @@ Table::~Table()
  *
  * @post action word is found and returned
  *
- * @par Algorithm checks if table already exists in current directory, if not, then creates table in current database & directory
+ * @par Algorithm checks if table already exists in current directory, if not, then creates table in current database & directory.
+ *      An attribute declared PRIMARY KEY is named in the attribute line, the
+ *      table then keeps its records in the order of its values. Attributes
+ *      declared UNIQUE are listed there too
  *
  * @param [in] string currentWorkingDirectory
  *
@@ -278,20 +367,30 @@ Table::~Table()
  * @param [in] string input
  *
  * @param [in] bool &errorCode
+ *
+ * @param [in] ostream &out - stream that receives the messages
  *      
  * @return  none
  *
  * @note None
  */
-void Table::tableCreate( string currentWorkingDirectory, string currentDatabase, string tblName, string input, bool &errorCode )
+void Table::tableCreate( string currentWorkingDirectory, string currentDatabase, string tblName, string input, bool &errorCode, ostream &out )
 {
 	vector< Attribute> tblAttributes;
 	Attribute attr;
 	string temp;
+	string keyName;
+	string uniqueNames;
 	int commaCount;
 
 	//get filepath, Database name + table name
 	string filePath = "/" + currentDatabase + "/" + tblName;
+	//files any engine left under the name are removed
+	vector< StorageEngine * > &engines = getStorageEngines();
+	for( unsigned int index = 0; index < engines.size(); index++ )
+	{
+		engines[ index ]->drop( currentWorkingDirectory + filePath );
+	}
 	//output to file using ofstream operator
 	ofstream fout( ( currentWorkingDirectory + filePath ).c_str() );
 
@@ -299,6 +398,33 @@ void Table::tableCreate( string currentWorkingDirectory, string currentDatabase,
 		//remove beginning and end ()'s
 		//get first open paren
 	input.erase( 0, input.find( "(" ) + 1 );
+
+	//the storage engine may follow the attribute list, text by default
+	string options;
+	for( size_t index = input.find_last_of( ")" ) + 1; index < input.size(); index++ )
+	{
+		if( !isspace( input[ index ] ) && input[ index ] != ';' )
+		{
+			options += toupper( input[ index ] );
+		}
+	}
+	StorageEngine *engine = findStorageEngine( DEFAULT_ENGINE );
+	if( options.compare( 0, 7, "ENGINE=" ) == 0 )
+	{
+		engine = findStorageEngine( options.substr( 7 ) );
+	}
+	else if( !options.empty() )
+	{
+		engine = NULL;
+	}
+	if( engine == NULL )
+	{
+		errorCode = true;
+		out << "-- !Failed to create table " << tblName << " because its engine is not known." << endl;
+		fout.close();
+		system( ( "rm " + currentWorkingDirectory + filePath ).c_str() ) ;
+		return;
+	}
 	input.erase( input.find_last_of( ")" ), input.length()-1 );
 
 	commaCount = getCommaCount( input );
@@ -318,13 +444,32 @@ void Table::tableCreate( string currentWorkingDirectory, string currentDatabase,
 		if( attributeNameExists( tblAttributes, attr ) )
 		{
 			errorCode = true;
-			cout << "-- !Failed to create table " << tblName << " because there are multiple ";
-			cout << attr.attributeName << " variables." << endl;
-			system( ( "rm " +  filePath ).c_str() ) ;
+			out << "-- !Failed to create table " << tblName << " because there are multiple ";
+			out << attr.attributeName << " variables." << endl;
 			fout.close();
+			system( ( "rm " + currentWorkingDirectory + filePath ).c_str() ) ;
 			return;
 		}
 
+		//unique values are checked as records change, the records are kept
+		//in the order of the primary key
+		if( takeConstraint( temp, "UNIQUE" ) )
+		{
+			uniqueNames += ( uniqueNames.empty() ? "" : "," ) + attr.attributeName;
+		}
+		else if( takeConstraint( temp, "PRIMARY KEY" ) )
+		{
+			if( !keyName.empty() )
+			{
+				errorCode = true;
+				out << "-- !Failed to create table " << tblName << " because it has more than one primary key." << endl;
+				fout.close();
+				system( ( "rm " + currentWorkingDirectory + filePath ).c_str() ) ;
+				return;
+			}
+			keyName = attr.attributeName;
+		}
+
 		//push attribute onto file
 		tblAttributes.push_back( attr );
 
@@ -338,26 +483,62 @@ void Table::tableCreate( string currentWorkingDirectory, string currentDatabase,
 	//parse next two words
 	attr.attributeName = getNextWord( input );
 	//type is remaining string
+	bool lastUnique = takeConstraint( input, "UNIQUE" );
+	bool lastKey = !lastUnique && takeConstraint( input, "PRIMARY KEY" );
 	attr.attributeType = input;
 	if( attributeNameExists( tblAttributes, attr ) )
 	{
 		errorCode = true;
-		cout << "-- !Failed to create table " << tblName << " because there are multiple ";
-		cout << attr.attributeName << " variables." << endl;
-		system( ( "rm " +  currentDatabase + "/" + tblName ).c_str() ) ;
+		out << "-- !Failed to create table " << tblName << " because there are multiple ";
+		out << attr.attributeName << " variables." << endl;
+		fout.close();
+		system( ( "rm " + currentWorkingDirectory + filePath ).c_str() ) ;
+		return;
+	}
+	if( lastKey && !keyName.empty() )
+	{
+		errorCode = true;
+		out << "-- !Failed to create table " << tblName << " because it has more than one primary key." << endl;
+		fout.close();
+		system( ( "rm " + currentWorkingDirectory + filePath ).c_str() ) ;
+		return;
+	}
+	if( lastKey )
+	{
+		keyName = attr.attributeName;
+	}
+	if( lastUnique )
+	{
+		uniqueNames += ( uniqueNames.empty() ? "" : "," ) + attr.attributeName;
+	}
+	if( engine->needsKey() && keyName.empty() )
+	{
+		errorCode = true;
+		out << "-- !Failed to create table " << tblName << " because the " << engine->getName() << " engine needs a primary key." << endl;
 		fout.close();
+		system( ( "rm " + currentWorkingDirectory + filePath ).c_str() ) ;
 		return;
 	}
 
 	//push onto vecotr
 	tblAttributes.push_back( attr );
 	
-	//output to file
+	//output to file, the zone map of the records is built as they are added
 	fout << attr.attributeName << " ";
 	fout << attr.attributeType;
+	if( !keyName.empty() )
+	{
+		fout << "\t" << KEY_FIELD << " " << keyName;
+	}
+	if( !uniqueNames.empty() )
+	{
+		fout << "\t" << UNIQUE_FIELD << " " << uniqueNames;
+	}
+	fout << engine->getCreateFields();
+	fout << "\t" << ZONES_FIELD << " " << newZoneToken();
 	fout.close();
 
-	cout << "-- Table " << tblName << " created." << endl;
+	out << "-- Table " << tblName << " created." << endl;
 }
 
 
@@ -371,31 +552,42 @@ void Table::tableCreate( string currentWorkingDirectory, string currentDatabase,
  *
  * @post table no longer exists
  *
- * @par Algorithm uses sys library to run linux terminal commands to delete table
+ * @par Algorithm the storage engine of the table removes its files
  *
  * @param [in] string dbName - the database currently in 
+ *
+ * @param [in] ostream &out - stream that receives the messages
  *      
  * @return None
  *
  * @note None
  */
-void Table::tableDrop( string currentWorkingDirectory, string dbName )
+void Table::tableDrop( string currentWorkingDirectory, string dbName, ostream &out )
 {
-	system( ( "rm " + currentWorkingDirectory + "/" + dbName + "/" + tableName ).c_str() ) ;
-	cout << "-- Table " << tableName << " deleted." << endl;
+	string tableFilePath = currentWorkingDirectory + "/" + dbName + "/" + tableName;
+	TableScan scan;
+	scan.scanOpen( tableFilePath );
+	getStorageEngine( scan ).drop( tableFilePath );
+	out << "-- Table " << tableName << " deleted." << endl;
 }
 
 
 /**
  * @brief tableAlter method 
  *
- * @details used to add attributes to a specified table
+ * @details used to add, drop or change the type of attributes of a
+ *          specified table
  *          
  * @pre assumes table exists and attribute name and type are specified
  *
- * @post attribute(s) are added to the table
+ * @post the table's schema is changed
  *
- * @par Algorithm checks if table exists in current directory, and if so, adds the parsed attribute name & type
+ * @par Algorithm ADD appends the parsed attribute names, types and optional
+ *      DEFAULT values to the table's schema file, DROP marks an attribute
+ *      dropped and MODIFY gives it a new type. The table file is not
+ *      touched: records written before the change read the default of an
+ *      added attribute, skip a dropped one and have a modified one read as
+ *      its new type until ALTER TABLE ... REWRITE stores them that way
  *
  * @param [in] string currentWorkingDirectory
  *
@@ -404,405 +596,171 @@ void Table::tableDrop( string currentWorkingDirectory, string dbName )
  * @param [in] string input
  *
  * @param [in] bool &errorCode
+ *
+ * @param [in] ostream &out - stream that receives the messages
  *      
  * @return none
  *
  * @note None
  */
-void Table::tableAlter( string currentWorkingDirectory, string currentDatabase, string input, bool &errorCode )
+void Table::tableAlter( string currentWorkingDirectory, string currentDatabase, string input, bool &errorCode, ostream &out )
 {
-	vector < Attribute > tableAttributes;
-	vector < string > fileContents;
-	string attrLine;
 	Attribute attr;
-	Attribute tempAttr;
-	int commaCount = 0;
 	string temp;
-	int originalNumOfAttr = 0;
-	int newNumOfAttr = 0;
-	//create filepath  to read from file
-	string filePath = "/" + currentDatabase + "/" + tableName;
-	ifstream fin( ( currentWorkingDirectory + filePath ).c_str() );
+	int commaCount = 0;
+	//create filepath to read the schema from
+	string tableFilePath = currentWorkingDirectory + "/" + currentDatabase + "/" + tableName;
 
 	string action = getNextWord( input );
-
-	if( action == "ADD" )
+	convertToUC( action );
+	if( action != "ADD" && action != "DROP" && action != "MODIFY" )
 	{
-		while( !fin.eof() )
-		{
-			//get attribute line
-			getline( fin, attrLine );
+		errorCode = true;
+		out << "-- !Failed to modify table " << tableName << " because " << action << " is not a known change." << endl;
+		return;
+	}
 
-			while( !attrLine.empty() )
-			{
-				string attribute = getUntilTab( attrLine );
-				//parse attribute further
-				tempAttr.attributeName = getNextWord( attribute );
-				tempAttr.attributeType = attribute;
+	TableScan scan;
+	if( !scan.scanOpen( tableFilePath ) )
+	{
+		errorCode = true;
+		out << "-- !Failed to modify table " << tableName << "." << endl;
+		return;
+	}
+	vector< StoredColumn > storedColumns = scan.storedColumns;
 
-				tableAttributes.push_back( tempAttr );
-			}
-			//check again that it is not end of file
-			if( !fin.eof() )
-			{
-				getline( fin, temp );
-				fileContents.push_back( temp );
-			}	
-		}
+	if( action == "ADD" )
+	{
+		vector< Attribute > tableAttributes = scan.attributes;
 
-		//get comma count to get num of attributes
+		//get comma count to get num of attributes, the last one has no comma
 		commaCount = getCommaCount( input );
-
-		//get number of attributes
-		originalNumOfAttr = tableAttributes.size();
-
-		ofstream fout( ( currentWorkingDirectory + filePath ).c_str() );
-		//get additional attributes
-		for( int index = 0; index < commaCount; index++ )
+		for( int index = 0; index <= commaCount; index++ )
 		{
 			//remove beginning parameter
-			temp = input.substr( 0, input.find( "," ));
-			input.erase( 0, input.find(",") + 1 );
+			temp = input.substr( 0, input.find( "," ) );
+			input.erase( 0, ( index < commaCount ) ? input.find( "," ) + 1 : input.length() );
 			//remove leading white space
 			removeLeadingWS( temp );
-			//parse, get next two words
+			//parse, name and type then an optional DEFAULT value
 			attr.attributeName = getNextWord( temp );
 			attr.attributeType = getNextWord( temp );
+			string defaultWord = getNextWord( temp );
+			convertToUC( defaultWord );
+			removeLeadingWS( temp );
 
 			//check that variable name does not already exist
 			if( attributeNameExists( tableAttributes, attr ) )
 			{
 				errorCode = true;
-				cout << "-- !Failed to modify table " << tableName << " because there are multiple ";
-				cout << attr.attributeName << " variables." << endl;
-				system( ( "rm " +  filePath ).c_str() ) ;
+				out << "-- !Failed to modify table " << tableName << " because there are multiple ";
+				out << attr.attributeName << " variables." << endl;
 				return;
 			}
 
-			//push attribute onto file
+			//records written before now read the default, null unless given
+			StoredColumn column;
+			column.attribute = attr;
+			column.defaultValue = ( defaultWord == "DEFAULT" && !temp.empty() ) ? getStoredValue( temp ) : "";
+			column.dropped = false;
+			column.modified = false;
 			tableAttributes.push_back( attr );
+			storedColumns.push_back( column );
 		}
-	
-		//remove leading WS from input
+	}
+	else
+	{
+		//DROP [COLUMN] name or MODIFY [COLUMN] name type
 		removeLeadingWS( input );
-		//parse next two words
 		attr.attributeName = getNextWord( input );
-		//type is remaining string
+		temp = attr.attributeName;
+		convertToUC( temp );
+		if( temp == "COLUMN" )
+		{
+			attr.attributeName = getNextWord( input );
+		}
+		removeLeadingWS( input );
 		attr.attributeType = input;
-		if( attributeNameExists( tableAttributes, attr ) )
+
+		int attributeIndex = findAttrOccur( scan.attributes, attr.attributeName );
+		if( attributeIndex < 0 )
 		{
 			errorCode = true;
-			cout << "-- !Failed to modify table " << tableName << " because there are multiple ";
-			cout << attr.attributeName << " variables." << endl;
+			out << "-- !Failed to modify table " << tableName << " because attribute ";
+			out << attr.attributeName << " does not exist." << endl;
 			return;
 		}
-		//push onto vecotr
-		tableAttributes.push_back( attr );
-
-		int tableSize = tableAttributes.size();
-		newNumOfAttr = tableSize - originalNumOfAttr;
-		for( int index = 0; index < tableSize; index++ )
+		if( action == "DROP" && scan.attributes.size() == 1 )
 		{
-			if( index != tableSize - 1 )
-			{
-				//if its the last table then do not add tab
-				fout << tableAttributes[ index ].attributeName << " ";		
-				fout << tableAttributes[ index ].attributeType << "\t";	
-			}
-			else
-			{
-				fout << tableAttributes[ index ].attributeName << " ";		
-				fout << tableAttributes[ index ].attributeType;	
-			}
-
+			errorCode = true;
+			out << "-- !Failed to modify table " << tableName << " because ";
+			out << attr.attributeName << " is its only attribute." << endl;
+			return;
+		}
+		if( action == "MODIFY" && attr.attributeType.empty() )
+		{
+			errorCode = true;
+			out << "-- !Failed to modify table " << tableName << " because no type was given." << endl;
+			return;
 		}
 
-		//initalize all records so that attribtue is null
-		int contentSize = fileContents.size();
-		for( int index = 0; index < contentSize; index++ )
+		//stored values stay as they are and are read as the new schema says
+		StoredColumn &column = storedColumns[ scan.storedIndexes[ attributeIndex ] ];
+		if( action == "DROP" )
 		{
-			fout << endl << fileContents[ index ];
-			for( int newAttr = 0; newAttr < newNumOfAttr; newAttr++ )
-			{
-				fout << "\tnull";
-			}
+			column.dropped = true;
+		}
+		else
+		{
+			column.modified = column.modified || column.attribute.attributeType != attr.attributeType;
+			column.attribute.attributeType = attr.attributeType;
 		}
-		fin.close();
-		fout.close();
-		cout << "-- Table " << tableName << " modified." << endl;
 	}
-	else
+
+	//the engine decides how the records take the new schema
+	string reason;
+	if( !getStorageEngine( scan ).alter( scan, storedColumns, reason ) )
 	{
+		errorCode = true;
+		out << "-- !Failed to modify table " << tableName;
+		out << ( reason.empty() ? "" : " because " + reason ) << "." << endl;
 		return;
 	}
+	out << "-- Table " << tableName << " modified." << endl;
 }
 
 
 /**
- * @brief tableSelect method
+ * @brief getProjection
  *
- * @details  displays the attributes from queried table
+ * @details resolves the attributes named by a query into attribute indexes
  *          
- * @pre assumes table specified is in the current directory
- *
- * @post attributes stored in the directory are displayed 
- *
- * @par Algorithm goes to the filepath, and displays info from the file
+ * @pre attributes have been read from the table file
  *
- * @param [in] string currentWorkingDirectory
+ * @post indexes are returned in table order
  *
- * @param [in] string currentDatabase
- *   
- * @param [in] string whereType
+ * @par Algorithm takes each comma separated name of the query, then keeps
+ *      the attributes of the table that were named
  *
- * @param [in] string queryType
+ * @param [in] vector< Attribute > attributes
  *
- * @return None
+ * @param [in] string queryType - * or the list of attribute names
+ *      
+ * @return vector< int > attribute indexes to return
  *
  * @note None
  */
-void Table::tableSelect( string currentWorkingDirectory, string currentDatabase, string whereType, string queryType )
+vector< int > getProjection( vector< Attribute > attributes, string queryType )
 {
-	vector< Attribute > attributes;
 	vector< AttributeSubset > attrSubsets;
-	WhereCondition wCond;
-	string filePath = "/" + currentDatabase + "/" + tableName;
+	vector< int > projection;
 	string temp;
-	int commaCount;
-	int contentLineCount = 0;
-	double tempDouble;
-	ifstream fin( ( currentWorkingDirectory + filePath ).c_str() );
-
-	//get attributes
-		//get until end of line
-	//check type of query
-	getline( fin, temp);
-
-	//automatically get all the attributes
-	while( !temp.empty() )
-	{
-		Attribute tempAttribute;
-		tempAttribute.attributeName = getNextWord( temp );
-		tempAttribute.attributeType = getUntilTab( temp );
-		attributes.push_back( tempAttribute );
-	}
-
-	//if query all attributes
-	if( queryType == ALL )
-	{
-		cout << "-- ";
-		int size = attributes.size();
-
-		//output all attributes
-		for( int index = 0; index < size; index++ )
-		{
-			cout << attributes[ index ].attributeName << " ";
-			cout << attributes[ index ].attributeType;
-			if( index != size - 1 )
-			{
-				cout << "|";
-			}
-		}
-		cout << endl;
-
-		//if there is a where condition then output with where cond
-		if( !whereType.empty() )
-		{
-			getWhereCondition( wCond, whereType, attributes);
-		
-					//get size of file content
-			while( !fin.eof() )
-			{
-				getline( fin, temp );
-				contentLineCount++;
-			}
-			fin.close();
-			ifstream fin( ( currentWorkingDirectory + filePath ).c_str() );
-			//get attribute and store into temp, not used
-			getline( fin, temp );
-			//create 2d array
-			string twoDArr[ contentLineCount ][ attributes.size() ];
-			int attributesSize = attributes.size();
-			for( int iIndex = 0; iIndex < contentLineCount; iIndex++ )
-			{
-				getline( fin, temp );
-				for( int jIndex = 0; jIndex < attributesSize; jIndex++ )
-				{
-					twoDArr[ iIndex ][ jIndex ] = getUntilTab( temp );
-				}
-			}
-
-			//output specific data
-			//for each row
-			for( int iIndex = 0; iIndex < contentLineCount; iIndex++ )
-			{
-				bool printResult = false;
-				cout << "-- ";
-				//for each col
-				for( int jIndex = 0; jIndex < attributesSize; jIndex++ )
-				{
-						if( wCond.operatorValue == "=" )
-						{
-							
-							//if we are not comparing floats, then do not convert to double
-							if( !wCond.floatValue ) 
-							{
-								if( twoDArr[ iIndex ][ wCond.attributeIndex ] == wCond.comparisonValue )
-								{
-									printResult = true;
-								}
-							}
-							else if( wCond.floatValue )
-							{
-								tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-								if( tempDouble == wCond.comparisonValueFloat )
-								{
-									printResult = true;
-								}
-							}
-						}
-						else if( wCond.operatorValue == "!=" )
-						{
-							if( !wCond.floatValue ) 
-							{
-								if( twoDArr[ iIndex ][ wCond.attributeIndex ] != wCond.comparisonValue )
-								{
-									printResult = true;
-								}
-							}
-							else if( wCond.floatValue )
-							{
-								tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-								if( tempDouble != wCond.comparisonValueFloat )
-								{
-									printResult = true;
-								}
-							}
-						}
-						if( wCond.operatorValue == "<" )
-						{
-							if( !wCond.floatValue ) 
-							{
-								if( twoDArr[ iIndex ][ wCond.attributeIndex ] < wCond.comparisonValue )
-								{
-									printResult = true;
-								}
-							}
-							else if( wCond.floatValue )
-							{
-								tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-								if( tempDouble < wCond.comparisonValueFloat )
-								{
-									printResult = true;
-								}
-							}
-						}
-						else if( wCond.operatorValue == "<=" )
-						{
-							if( !wCond.floatValue ) 
-							{
-								if( twoDArr[ iIndex ][ wCond.attributeIndex ] <= wCond.comparisonValue )
-								{
-									printResult = true;
-								}
-							}
-							else if( wCond.floatValue )
-							{
-								tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-								if( tempDouble <= wCond.comparisonValueFloat )
-								{
-									printResult = true;
-								}
-							}
-						}
-						else if( wCond.operatorValue == ">" )
-						{
-							if( !wCond.floatValue ) 
-							{
-								if( twoDArr[ iIndex ][ wCond.attributeIndex ] >= wCond.comparisonValue )
-								{
-									printResult = true;
-								}
-							}
-							else if( wCond.floatValue )
-							{
-								tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-								if( tempDouble > wCond.comparisonValueFloat )
-								{
-									printResult = true;
-								}
-							}
-						}
-						else if( wCond.operatorValue == ">=" )
-						{
-							if( !wCond.floatValue ) 
-							{
-								if( twoDArr[ iIndex ][ wCond.attributeIndex ] >= wCond.comparisonValue )
-								{
-									printResult = true;
-								}
-							}
-							else if( wCond.floatValue )
-							{
-								tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-								if( tempDouble >= wCond.comparisonValueFloat )
-								{
-									printResult = true;
-								}
-							}
-						}
-						if( printResult )
-						{
-							string content = twoDArr[ iIndex ][ jIndex ];
-							if( content[ 0 ] == '\'' && content[ content.size() - 1 ] == '\'' )
-							{
-								content.erase( 0, content.find( "'" ) + 1 );
-								content.erase( content.find_last_of( "'" ), content.length()-1 );
-							}
-							cout << content << "|";
-						}	
-				}
-				if( printResult )
-				{
-					cout << "\b \b";
-					cout << endl;
-				}
-				else
-				{
-					cout << "\b \b\b\b";	
-				}
-			}
+	int attributesSize = attributes.size();
 
-		}
-		else //output everything otherwise
-		{
-			while( !fin.eof() )
-			{
-				getline( fin, temp);
-				cout << "-- ";
-				while( !temp.empty() )
-				{
-					string content = getUntilTab( temp );
-					//check that if start of string is "'" and end is "'"
-					if( content[ 0 ] == '\'' && content[ content.size() - 1 ] == '\'' )
-					{
-						content.erase( 0, content.find( "'" ) + 1 );
-						content.erase( content.find_last_of( "'" ), content.length()-1 );
-					}
-					cout << content << "|";
-				}
-				cout << "\b \b";
-				cout << endl;
-			}
-			fin.close();
-		}
-	}
-	else
+	//get subset to query, all attributes are queried with *
+	if( queryType != ALL )
 	{
-		//get attributes in query subset 
-		commaCount = getCommaCount( queryType );
-		
-		//get subset to query
+		int commaCount = getCommaCount( queryType );
 		for ( int index = 0; index < commaCount+1; index++ )
 		{
 			AttributeSubset tempAttr;
@@ -818,197 +776,89 @@ void Table::tableSelect( string currentWorkingDirectory, string currentDatabase,
 			tempAttr.attributeIndex = findAttrOccur( attributes, tempAttr.attributeName );
 			attrSubsets.push_back( tempAttr );
 		}
+	}
 
-		//check that there is where condition
-		if( !whereType.empty() )
+	//attributes are returned in table order
+	for( int index = 0; index < attributesSize; index++ )
+	{
+		if( queryType == ALL || currIndexIsSubset( attrSubsets, index ) )
 		{
-			getWhereCondition( wCond, whereType, attributes);
+			projection.push_back( index );
 		}
+	}
+	return projection;
+}
 
-		//get size of file content
-		while( !fin.eof() )
-		{
-			getline( fin, temp );
-			contentLineCount++;
-		}
+/**
+ * @brief selectPlan method
+ *
+ * @details  builds the operator tree that answers a query on this table
+ *          
+ * @pre assumes table specified is in the current directory
+ *
+ * @post the returned plan has not been opened
+ *
+ * @par Algorithm reads the attribute line, resolves the queried attributes
+ *      and the where condition, and has the table's storage engine build
+ *      the scan they are pushed into
+ *
+ * @param [in] string currentWorkingDirectory
+ *
+ * @param [in] string currentDatabase
+ *   
+ * @param [in] string whereType
+ *
+ * @param [in] string queryType
+ *
+ * @return shared_ptr< Operator > root of the plan
+ *
+ * @note None
+ */
+shared_ptr< Operator > Table::selectPlan( string currentWorkingDirectory, string currentDatabase, string whereType, string queryType )
+{
+	TableScan scan;
+	vector< int > projection;
+	WhereCondition wCond;
+	string filePath = "/" + currentDatabase + "/" + tableName;
 
-		fin.close();
-		ifstream fin( ( currentWorkingDirectory + filePath ).c_str() );
-		//get attribute and store into temp, not used
-		getline( fin, temp );
-		//create 2d array
-		string twoDArr[ contentLineCount ][ attributes.size() ];
-		
-		//store data in 2d array
-		int attributesSize = attributes.size();
-		for( int iIndex = 0; iIndex < contentLineCount; iIndex++ )
-		{
-			getline( fin, temp );
-			for( int jIndex = 0; jIndex < attributesSize; jIndex++ )
-			{
-				twoDArr[ iIndex ][ jIndex ] = getUntilTab( temp );
-			}
-		}
+	scan.scanOpen( currentWorkingDirectory + filePath );
+	projection = getProjection( scan.attributes, queryType );
 
-		//output attribute subset
-		cout << "-- ";
-		for( int index = 0; index < attributesSize; index++ )
-		{
-			if( currIndexIsSubset( attrSubsets, index ) )
-			{
-				cout << attributes[ index ].attributeName;
-				cout << " " << attributes[ index ].attributeType << "|"; 
-			}
-		}
-		cout << "\b \b" << endl;
+	//check that there is where condition
+	getWhereCondition( wCond, whereType, scan.attributes );
 
-		//output specific data
-		//for each row
-		for( int iIndex = 0; iIndex < contentLineCount; iIndex++ )
-		{
-			bool printResult = false;
-			cout << "-- ";
-			//for each col
-			for( int jIndex = 0; jIndex < attributesSize; jIndex++ )
-			{
-				//for each col check that the subset is to be called
-				if( currIndexIsSubset( attrSubsets, jIndex ) )
-				{
-					if( wCond.operatorValue == "=" )
-					{
-						
-						//if we are not comparing floats, then do not convert to double
-						if( !wCond.floatValue ) 
-						{
-							if( twoDArr[ iIndex ][ wCond.attributeIndex ] == wCond.comparisonValue )
-							{
-								printResult = true;
-							}
-						}
-						else if( wCond.floatValue )
-						{
-							tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-							if( tempDouble == wCond.comparisonValueFloat )
-							{
-								printResult = true;
-							}
-						}
-					}
-					else if( wCond.operatorValue == "!=" )
-					{
-						if( !wCond.floatValue ) 
-						{
-							if( twoDArr[ iIndex ][ wCond.attributeIndex ] != wCond.comparisonValue )
-							{
-								printResult = true;
-							}
-						}
-						else if( wCond.floatValue )
-						{
-							tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-							if( tempDouble != wCond.comparisonValueFloat )
-							{
-								printResult = true;
-							}
-						}
-					}
-					if( wCond.operatorValue == "<" )
-					{
-						if( !wCond.floatValue ) 
-						{
-							if( twoDArr[ iIndex ][ wCond.attributeIndex ] < wCond.comparisonValue )
-							{
-								printResult = true;
-							}
-						}
-						else if( wCond.floatValue )
-						{
-							tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-							if( tempDouble < wCond.comparisonValueFloat )
-							{
-								printResult = true;
-							}
-						}
-					}
-					else if( wCond.operatorValue == "<=" )
-					{
-						if( !wCond.floatValue ) 
-						{
-							if( twoDArr[ iIndex ][ wCond.attributeIndex ] <= wCond.comparisonValue )
-							{
-								printResult = true;
-							}
-						}
-						else if( wCond.floatValue )
-						{
-							tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-							if( tempDouble <= wCond.comparisonValueFloat )
-							{
-								printResult = true;
-							}
-						}
-					}
-					else if( wCond.operatorValue == ">" )
-					{
-						if( !wCond.floatValue ) 
-						{
-							if( twoDArr[ iIndex ][ wCond.attributeIndex ] >= wCond.comparisonValue )
-							{
-								printResult = true;
-							}
-						}
-						else if( wCond.floatValue )
-						{
-							tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-							if( tempDouble > wCond.comparisonValueFloat )
-							{
-								printResult = true;
-							}
-						}
-					}
-					else if( wCond.operatorValue == ">=" )
-					{
-						if( !wCond.floatValue ) 
-						{
-							if( twoDArr[ iIndex ][ wCond.attributeIndex ] >= wCond.comparisonValue )
-							{
-								printResult = true;
-							}
-						}
-						else if( wCond.floatValue )
-						{
-							tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-							if( tempDouble >= wCond.comparisonValueFloat )
-							{
-								printResult = true;
-							}
-						}
-					}
-					if( printResult )
-					{
-						string content = twoDArr[ iIndex ][ jIndex ];
-						if( content[ 0 ] == '\'' && content[ content.size() - 1 ] == '\'' )
-						{
-							content.erase( 0, content.find( "'" ) + 1 );
-							content.erase( content.find_last_of( "'" ), content.length()-1 );
-						}
-						cout << content << "|";
-					}	
-				}
-
-				
-			}
-			if( printResult )
-			{
-				cout << "\b \b";
-				cout << endl;
-			}
-			else
-			{
-				cout << "\b \b\b\b";	
-			}
-		}
-	}
+	return getStorageEngine( scan ).scan( scan, wCond, projection );
+}
+
+/**
+ * @brief tableSelect method
+ *
+ * @details  displays the attributes from queried table
+ *          
+ * @pre assumes table specified is in the current directory
+ *
+ * @post attributes stored in the directory are displayed 
+ *
+ * @par Algorithm builds the query plan and hands it to the console printer
+ *
+ * @param [in] string currentWorkingDirectory
+ *
+ * @param [in] string currentDatabase
+ *   
+ * @param [in] string whereType
+ *
+ * @param [in] string queryType
+ *
+ * @param [in] ostream &out - stream that receives the messages
+ *
+ * @return None
+ *
+ * @note None
+ */
+void Table::tableSelect( string currentWorkingDirectory, string currentDatabase, string whereType, string queryType, ostream &out )
+{
+	shared_ptr< Operator > plan = selectPlan( currentWorkingDirectory, currentDatabase, whereType, queryType );
+	printResults( *plan, out );
 }
 
 /**
@@ -1029,39 +879,43 @@ void Table::tableSelect( string currentWorkingDirectory, string currentDatabase,
  *
  *@param [in] bool &errorCode
  *
+ *@param [in] ostream &out - stream that receives the messages
+ *
 */
-void Table::tableInsert( string currentWorkingDirectory, string currentDatabase, string tblName, string input, bool &errorCode )
+void Table::tableInsert( string currentWorkingDirectory, string currentDatabase, string tblName, string input, bool &errorCode, ostream &out )
 {
-	string contentStr = "\n";
-	int commaCount;
+	TableScan scan;
 	string filePath = "/" + currentDatabase + "/" + tableName;
-	string temp;
-
-	commaCount = getCommaCount( input );
-	for( int index = 0; index < commaCount; index++ )
-	{
-		//remove beginning parameter
-		temp = input.substr( 0, input.find( "," ));
-		input.erase( 0, input.find(",") + 1 );
 
-		//remove leading white space
-		removeLeadingWS( temp );
+	scan.scanOpen( currentWorkingDirectory + filePath );
+	insertRecord( scan, getInsertValues( input ), errorCode, out );
+}
 
-		//concat temp to content str
-		contentStr = contentStr + temp + '\t';
+/**
+ *@brief insertRecord
+ *
+ *@details inserts one record with already parsed values through the
+ *         table's storage engine
+ *
+ *@param [in] TableScan &scan - scan of the table
+ *
+ *@param [in] vector< string > values - stored values of the record
+ *
+ *@param [out] bool &errorCode - set if the record could not be inserted
+ *
+ *@param [in] ostream &out - stream that receives the messages
+ *
+*/
+void Table::insertRecord( TableScan &scan, vector< string > values, bool &errorCode, ostream &out )
+{
+	if( getStorageEngine( scan ).insert( scan, values ) < 0 )
+	{
+		errorCode = true;
+		out << "-- !Failed to insert into " << tableName << "." << endl;
+		return;
 	}
-	
-	//remove leading WS from input
-	removeLeadingWS( input );
-	contentStr = contentStr + input;
-
-	ofstream fout;
-	fout.open( ( currentWorkingDirectory + filePath ).c_str(), ofstream::out | ofstream::app );
-	fout << contentStr;
 
-	fout.close();
-
-	cout << "-- 1 new record inserted." << endl;
+	out << "-- 1 new record inserted." << endl;
 }
 
 /**
@@ -1069,6 +923,9 @@ void Table::tableInsert( string currentWorkingDirectory, string currentDatabase,
  *
  *@details updates the table based on all records that match the given condition  
  *
+ *@par Algorithm resolves the where and set conditions against the table,
+ *            then its storage engine changes the matching records
+ *
  *@param [in] string currentWorkingDirectory
  *
  *@param [in] string currentDatabase
@@ -1077,435 +934,135 @@ void Table::tableInsert( string currentWorkingDirectory, string currentDatabase,
  *
  *@param [in] string setType
  *
+ *@param [in] ostream &out - stream that receives the messages
+ *
 */
-void Table::tableUpdate( string currentWorkingDirectory, string currentDatabase, string whereType, string setType )
+void Table::tableUpdate( string currentWorkingDirectory, string currentDatabase, string whereType, string setType, ostream &out )
 {
-	vector< Attribute > attributes;
+	TableScan scan;
 	SetCondition sCond;
 	WhereCondition wCond;
+	bool errorCode = false;
 	string filePath = "/" + currentDatabase + "/" + tableName;
-	string temp;
-	int recordsModified = 0;
-	int contentLineCount = 0;
-	double tempDouble;
-	ifstream fin( ( currentWorkingDirectory + filePath ).c_str() );
-
-	//get attributes
-		//get until end of line
-	//check type of query
-	getline( fin, temp);
-
-	//get attribute data
-	while( !temp.empty() )
-	{
-		Attribute tempAttribute;
-		tempAttribute.attributeName = getNextWord( temp );
-		tempAttribute.attributeType = getUntilTab( temp );
-		attributes.push_back( tempAttribute );
-	}
+
+	scan.scanOpen( currentWorkingDirectory + filePath );
 
 	//get where and set conditions
-	getWhereCondition( wCond, whereType, attributes);
-	getSetCondition( sCond, setType, attributes );
+	getWhereCondition( wCond, whereType, scan.attributes );
+	getSetCondition( sCond, setType, scan.attributes );
 
-	//get size of file content
-	while( !fin.eof() )
-	{
-		getline( fin, temp );
-		contentLineCount++;
-	}
+	updateRecords( scan, wCond, sCond, errorCode, out );
+}
 
-	fin.close();
-	
-	fin.open(( currentWorkingDirectory + filePath ).c_str() );
-	
-	//get attribute and store into temp 
-	getline( fin, temp );
-	string attributeData = temp;
-	
-	//create 2d array and store content data
-	string twoDArr[ contentLineCount ][ attributes.size() ];
-	int attributesSize = attributes.size();
-	for( int iIndex = 0; iIndex < contentLineCount; iIndex++ )
-	{
-		getline( fin, temp );
-		for( int jIndex = 0; jIndex < attributesSize; jIndex++ )
-		{
-			twoDArr[ iIndex ][ jIndex ] = getUntilTab( temp );
-		}
-	}
-	fin.close();
+/**
+ *@brief updateRecords
+ *
+ *@details updates the records matching an already resolved where condition
+ *
+ *@param [in] TableScan &scan - scan that has read the attributes
+ *
+ *@param [in] WhereCondition wCond
+ *
+ *@param [in] SetCondition sCond
+ *
+ *@param [out] bool &errorCode - set if the table could not be updated
+ *
+ *@param [in] ostream &out - stream that receives the messages
+ *
+*/
+void Table::updateRecords( TableScan &scan, WhereCondition wCond, SetCondition sCond, bool &errorCode, ostream &out )
+{
+	int recordsModified = getStorageEngine( scan ).update( scan, wCond, sCond );
 
-	ofstream fout( ( currentWorkingDirectory + filePath ).c_str() );
-	
-	fout << attributeData << endl;
-	
-	//output specific data
-	//for each row
-	for( int iIndex = 0; iIndex < contentLineCount; iIndex++ )
+	if( recordsModified < 0 )
 	{
-		bool printResult = false;
-		//for each col
-		for( int jIndex = 0; jIndex < attributesSize; jIndex++ )
-		{
-			//for each col check that the set index is to be called
-			if( sCond.attributeIndex == jIndex )
-			{
-				if( wCond.operatorValue == "=" )
-				{
-					//if we are not comparing floats, then do not convert to double
-					if( !wCond.floatValue ) 
-					{
-						if( twoDArr[ iIndex ][ wCond.attributeIndex ] == wCond.comparisonValue )
-						{
-							printResult = true;
-						}
-					}
-					else if( wCond.floatValue )
-					{
-						tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-						if( tempDouble == wCond.comparisonValueFloat )
-						{
-							printResult = true;
-						}
-					}
-				}
-				else if( wCond.operatorValue == "!=" )
-				{
-					if( !wCond.floatValue ) 
-					{
-						if( twoDArr[ iIndex ][ wCond.attributeIndex ] != wCond.comparisonValue )
-						{
-							printResult = true;
-						}
-					}
-					else if( wCond.floatValue )
-					{
-						tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-						if( tempDouble != wCond.comparisonValueFloat )
-						{
-							printResult = true;
-						}
-					}
-				}
-				if( wCond.operatorValue == "<" )
-				{
-					if( !wCond.floatValue ) 
-					{
-						if( twoDArr[ iIndex ][ wCond.attributeIndex ] < wCond.comparisonValue )
-						{
-							printResult = true;
-						}
-					}
-					else if( wCond.floatValue )
-					{
-						tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-						if( tempDouble < wCond.comparisonValueFloat )
-						{
-							printResult = true;
-						}
-					}
-				}
-				else if( wCond.operatorValue == "<=" )
-				{
-					if( !wCond.floatValue ) 
-					{
-						if( twoDArr[ iIndex ][ wCond.attributeIndex ] <= wCond.comparisonValue )
-						{
-							printResult = true;
-						}
-					}
-					else if( wCond.floatValue )
-					{
-						tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-						if( tempDouble <= wCond.comparisonValueFloat )
-						{
-							printResult = true;
-						}
-					}
-				}
-				else if( wCond.operatorValue == ">" )
-				{
-					if( !wCond.floatValue ) 
-					{
-						if( twoDArr[ iIndex ][ wCond.attributeIndex ] >= wCond.comparisonValue )
-						{
-							printResult = true;
-						}
-					}
-					else if( wCond.floatValue )
-					{
-						tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-						if( tempDouble > wCond.comparisonValueFloat )
-						{
-							printResult = true;
-						}
-					}
-				}
-				else if( wCond.operatorValue == ">=" )
-				{
-					if( !wCond.floatValue ) 
-					{
-						if( twoDArr[ iIndex ][ wCond.attributeIndex ] >= wCond.comparisonValue )
-						{
-							printResult = true;
-						}
-					}
-					else if( wCond.floatValue )
-					{
-						tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-						if( tempDouble >= wCond.comparisonValueFloat )
-						{
-							printResult = true;
-						}
-					}
-				}
-				if( printResult )
-				{
-					recordsModified++;
-					twoDArr[ iIndex ][ jIndex ] = sCond.newValue;
-				}	
-			}
-			fout << twoDArr[ iIndex ][ jIndex ];
-			if( jIndex != attributesSize - 1 )
-			{
-				fout << "\t";
-			}
-		}
-		if( iIndex != contentLineCount- 1 )
-		{
-			fout << endl;
-		}
+		errorCode = true;
+		out << "-- !Failed to update table " << tableName << "." << endl;
+		return;
 	}
-	cout << "-- " << recordsModified; 
+
+	out << "-- " << recordsModified; 
 	if( recordsModified == 1 )
 	{
-		cout  << " record modified." << endl;
+		out  << " record modified." << endl;
 	}
 	else
 	{
-		cout << " records modified." << endl;
+		out << " records modified." << endl;
 	}
 }
 
-
-void Table::tableDelete( string currentWorkingDirectory, string currentDatabase, string whereType )
+/**
+ *@brief tableDelete
+ *
+ *@details deletes all records that match the given condition
+ *
+ *@par Algorithm resolves the where condition against the table, then its
+ *            storage engine removes the matching records
+ *
+ *@param [in] string currentWorkingDirectory
+ *
+ *@param [in] string currentDatabase
+ *
+ *@param [in] string whereType
+ *
+ *@param [in] ostream &out - stream that receives the messages
+ *
+*/
+void Table::tableDelete( string currentWorkingDirectory, string currentDatabase, string whereType, ostream &out )
 {
-	vector< Attribute > attributes;
-	vector< string > contentOutput;
-	SetCondition sCond;
+	TableScan scan;
 	WhereCondition wCond;
+	bool errorCode = false;
 	string filePath = "/" + currentDatabase + "/" + tableName;
-	string temp;
-	vector< int > recordsModified;
-	int contentLineCount = 0;
-	double tempDouble;
-	ifstream fin( ( currentWorkingDirectory + filePath ).c_str() );
-
-	//get attributes
-		//get until end of line
-	//check type of query
-	getline( fin, temp);
-
-	//get attribute data
-	while( !temp.empty() )
-	{
-		Attribute tempAttribute;
-		tempAttribute.attributeName = getNextWord( temp );
-		tempAttribute.attributeType = getUntilTab( temp );
-		attributes.push_back( tempAttribute );
-	}
 
-	getWhereCondition( wCond, whereType, attributes);
+	scan.scanOpen( currentWorkingDirectory + filePath );
 
-	//get size of file content
-	while( !fin.eof() )
-	{
-		getline( fin, temp );
-		contentLineCount++;
-	}
+	getWhereCondition( wCond, whereType, scan.attributes );
 
-	fin.close();
-	//ifstream fin( ( currentWorkingDirectory + filePath ).c_str() );
-	fin.open(( currentWorkingDirectory + filePath ).c_str() );
-	//get attribute and store into temp 
-	getline( fin, temp );
-	string attributeData = temp;
-	//create 2d array
-	string twoDArr[ contentLineCount ][ attributes.size() ];
-	int attributesSize = attributes.size();
-	for( int iIndex = 0; iIndex < contentLineCount; iIndex++ )
-	{
-		getline( fin, temp );
-		for( int jIndex = 0; jIndex < attributesSize; jIndex++ )
-		{
-			twoDArr[ iIndex ][ jIndex ] = getUntilTab( temp );
-		}
-	}
-	fin.close();
-
-	ofstream fout( ( currentWorkingDirectory + filePath ).c_str() );
-	
-	fout << attributeData << endl;
-	//output specific data
-	//for each row
-	for( int iIndex = 0; iIndex < contentLineCount; iIndex++ )
-	{
-		bool printResult = true;
-		//check that index val does 
-		if( wCond.operatorValue == "=" )
-		{
-			
-			//if we are not comparing floats, then do not convert to double
-			if( !wCond.floatValue ) 
-			{
-				if( twoDArr[ iIndex ][ wCond.attributeIndex ] == wCond.comparisonValue )
-				{
-					printResult = false;
-				}
-			}
-			else if( wCond.floatValue )
-			{
-				tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-				if( tempDouble == wCond.comparisonValueFloat )
-				{
-					printResult = false;
-				}
-			}
-		}
-		else if( wCond.operatorValue == "!=" )
-		{
-			if( !wCond.floatValue ) 
-			{
-				if( twoDArr[ iIndex ][ wCond.attributeIndex ] != wCond.comparisonValue )
-				{
-					printResult = false;
-				}
-			}
-			else if( wCond.floatValue )
-			{
-				tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-				if( tempDouble != wCond.comparisonValueFloat )
-				{
-					printResult = false;
-				}
-			}
-		}
-		if( wCond.operatorValue == "<" )
-		{
-			if( !wCond.floatValue ) 
-			{
-				if( twoDArr[ iIndex ][ wCond.attributeIndex ] < wCond.comparisonValue )
-				{
-					printResult = false;
-				}
-			}
-			else if( wCond.floatValue )
-			{
-				tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-				if( tempDouble < wCond.comparisonValueFloat )
-				{
-					printResult = false;
-				}
-			}
-		}
-		else if( wCond.operatorValue == "<=" )
-		{
-			if( !wCond.floatValue ) 
-			{
-				if( twoDArr[ iIndex ][ wCond.attributeIndex ] <= wCond.comparisonValue )
-				{
-					printResult = false;
-				}
-			}
-			else if( wCond.floatValue )
-			{
-				tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-				if( tempDouble <= wCond.comparisonValueFloat )
-				{
-					printResult = false;
-				}
-			}
-		}
-		else if( wCond.operatorValue == ">" )
-		{
-			if( !wCond.floatValue ) 
-			{
-				if( twoDArr[ iIndex ][ wCond.attributeIndex ] >= wCond.comparisonValue )
-				{
-					printResult = false;
-				}
-			}
-			else if( wCond.floatValue )
-			{
-				tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-				if( tempDouble > wCond.comparisonValueFloat )
-				{
-					printResult = false;
-				}
-			}
-		}
-		else if( wCond.operatorValue == ">=" )
-		{
-			if( !wCond.floatValue ) 
-			{
-				if( twoDArr[ iIndex ][ wCond.attributeIndex ] >= wCond.comparisonValue )
-				{
-					printResult = false;
-				}
-			}
-			else if( wCond.floatValue )
-			{
-				tempDouble = atof( twoDArr[ iIndex ][ wCond.attributeIndex ].c_str() );
-				if( tempDouble >= wCond.comparisonValueFloat )
-				{
-					printResult = false;
-				}
-			}
-		}
-
-		if( printResult == true )
-		{
-			string content = "";
-			for( int jIndex = 0; jIndex < attributesSize; jIndex++ )
-			{
-				content = content + twoDArr[ iIndex ][ jIndex ];
-				if( jIndex != attributesSize - 1 )
-				{
-					content = content + '\t';
-				}
-			}
-			contentOutput.push_back( content );
-		}
-	}
+	deleteRecords( scan, wCond, errorCode, out );
+}
 
-	int newContentSize = contentOutput.size();
+/**
+ *@brief deleteRecords
+ *
+ *@details deletes the records matching an already resolved where condition
+ *
+ *@param [in] TableScan &scan - scan that has read the attributes
+ *
+ *@param [in] WhereCondition wCond
+ *
+ *@param [out] bool &errorCode - set if the table could not be rewritten
+ *
+ *@param [in] ostream &out - stream that receives the messages
+ *
+*/
+void Table::deleteRecords( TableScan &scan, WhereCondition wCond, bool &errorCode, ostream &out )
+{
+	int recordsDeleted = getStorageEngine( scan ).remove( scan, wCond );
 
-	for( int index = 0; index < newContentSize; index++ )
+	if( recordsDeleted < 0 )
 	{
-		fout << contentOutput[ index ];
-		if( index != newContentSize - 1 )
-		{
-			fout << endl;
-		}
+		errorCode = true;
+		out << "-- !Failed to delete from table " << tableName << "." << endl;
+		return;
 	}
 
-	int recordsDeleted = contentLineCount - newContentSize;
-	cout << "-- " << recordsDeleted;
+	out << "-- " << recordsDeleted;
 	if( recordsDeleted == 1 )
 	{
-		cout << " record deleted." << endl;
+		out << " record deleted." << endl;
 	}
 	else
 	{
-		cout << " records deleted." << endl;
+		out << " records deleted." << endl;
 	}
 }
 
 int findAttrOccur( vector< Attribute > attributes, string attrName )
 {
 	int attrSize = attributes.size();
-	int attrIndex;
+	int attrIndex = -1;
 	for ( int index = 0; index < attrSize; index++ )
 	{
 		if( attributes[ index ].attributeName == attrName )
@@ -1550,16 +1107,54 @@ bool isAttrFloat( vector< Attribute > attributes, string attrName )
 */
 void getWhereCondition( WhereCondition &wCond, string whereType, vector< Attribute > attributes )
 {
+	removeLeadingWS( whereType );
 	wCond.attributeName = getNextWord( whereType );
 	wCond.attributeIndex = findAttrOccur( attributes, wCond.attributeName );
 	wCond.operatorValue = getNextWord( whereType );
-	wCond.comparisonValue = whereType;
+	wCond.comparisonValue = getStoredValue( whereType );
+	wCond.comparisonCode = NO_CODE;
+	wCond.floatValue = false;
+	wCond.intValue = false;
+
+	//IS NULL and IS NOT NULL have no value to compare with
+	string operatorWord = wCond.operatorValue;
+	convertToUC( operatorWord );
+	if( operatorWord == "IS" )
+	{
+		string testWord = getNextWord( whereType );
+		convertToUC( testWord );
+		if( testWord == "NOT" )
+		{
+			testWord = getNextWord( whereType );
+			convertToUC( testWord );
+			wCond.operatorValue = ( testWord == "NULL" ) ? IS_NOT_NULL : operatorWord;
+		}
+		else
+		{
+			wCond.operatorValue = ( testWord == "NULL" ) ? IS_NULL : operatorWord;
+		}
+		wCond.comparisonValue = "";
+		return;
+	}
+	wCond.comparisonValueFloat = 0.0;
+	wCond.comparisonValueInt = 0;
 
+	//int and float attributes are compared by value instead of by text
 	if( isAttrFloat( attributes, wCond.attributeName ) )
 	{
 		wCond.floatValue = true;
 		wCond.comparisonValueFloat = atof( wCond.comparisonValue.c_str() );
 	}
+	else if( wCond.attributeIndex >= 0 && getValueType( attributes[ wCond.attributeIndex ].attributeType ) == TYPE_INT )
+	{
+		//a parameter keeps its marker, its value is converted when bound
+		wCond.intValue = true;
+		if( wCond.comparisonValue != PARAMETER_MARKER )
+		{
+			wCond.comparisonValue = convertValue( wCond.comparisonValue, attributes[ wCond.attributeIndex ].attributeType );
+		}
+		wCond.comparisonValueInt = atol( wCond.comparisonValue.c_str() );
+	}
 }
 
 /**
@@ -1584,7 +1179,7 @@ void getSetCondition( SetCondition &sCond, string setType, vector< Attribute > a
 	sCond.attributeName = getNextWord( setType );
 	sCond.attributeIndex = findAttrOccur( attributes, sCond.attributeName );
 	sCond.operatorValue = getNextWord( setType );
-	sCond.newValue = setType;
+	sCond.newValue = getStoredValue( setType );
 }
 
 /**
@@ -12,6 +12,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <memory>
 using namespace std;
 
 // Precompiler directives /////////////////////////////////////////////////////
@@ -37,9 +38,39 @@ struct WhereCondition{
 	string operatorValue;
 	bool floatValue;
 	double comparisonValueFloat;
+	bool intValue;
+	long comparisonValueInt;
 	string comparisonValue;
+	long comparisonCode;
 };
 
+//comparison value missing from the dictionary of an encoded column
+const long NO_CODE = -1;
+
+//operators of where conditions that test for null
+const string IS_NULL = "IS NULL";
+const string IS_NOT_NULL = "IS NOT NULL";
+
+//value types derived from the declared attribute type
+const int TYPE_STRING = 0;
+const int TYPE_INT = 1;
+const int TYPE_FLOAT = 2;
+
+//one typed value, text keeps the value as it is displayed
+struct Value{
+	int valueType;
+	bool isNull;
+	long intValue;
+	double floatValue;
+	string text;
+};
+
+struct Row{
+	vector< Value > values;
+};
+
+class Operator;
+class TableScan;
 
 class Table{
 	public: 
@@ -47,13 +78,17 @@ class Table{
 
 		Table();
 		~Table();
-		void tableCreate( string currentWorkingDirectory, string currentDatabase, string tblName, string input, bool &errorCode );
-		void tableDrop( string currentWorkingDirectory, string dbName );
-		void tableAlter( string currentWorkingDirectory, string currentDatabase, string input, bool &errorCode );
-		void tableSelect( string currentWorkingDirectory, string currentDatabase, string whereType, string queryType );
-		void tableInsert( string currentWorkingDirectory, string currentDatabase, string tblName, string input, bool &errorCode );
-		void tableUpdate( string currentWorkingDirectory, string currentDatabase, string whereType, string setType );
-		void tableDelete( string currentWorkingDirectory, string currentDatabase, string whereType);
+		void tableCreate( string currentWorkingDirectory, string currentDatabase, string tblName, string input, bool &errorCode, ostream &out );
+		void tableDrop( string currentWorkingDirectory, string dbName, ostream &out );
+		void tableAlter( string currentWorkingDirectory, string currentDatabase, string input, bool &errorCode, ostream &out );
+		shared_ptr< Operator > selectPlan( string currentWorkingDirectory, string currentDatabase, string whereType, string queryType );
+		void tableSelect( string currentWorkingDirectory, string currentDatabase, string whereType, string queryType, ostream &out );
+		void tableInsert( string currentWorkingDirectory, string currentDatabase, string tblName, string input, bool &errorCode, ostream &out );
+		void tableUpdate( string currentWorkingDirectory, string currentDatabase, string whereType, string setType, ostream &out );
+		void tableDelete( string currentWorkingDirectory, string currentDatabase, string whereType, ostream &out );
+		void insertRecord( TableScan &scan, vector< string > values, bool &errorCode, ostream &out );
+		void updateRecords( TableScan &scan, WhereCondition wCond, SetCondition sCond, bool &errorCode, ostream &out );
+		void deleteRecords( TableScan &scan, WhereCondition wCond, bool &errorCode, ostream &out );
 };
 
 // Terminating precompiler directives  ////////////////////////////////////////
@@ -0,0 +1,3701 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file TableScan.cpp
+ *
+ * @brief Implementation file for TableScan class
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements the morsel-driven table scan. The data section of a
+ *          table file is cut into fixed-size byte ranges (morsels) that are
+ *          handed to worker threads, each of which filters and projects the
+ *          rows of its morsel independently. The zone maps the scan skips
+ *          morsels by are in ZoneMap.cpp
+ *
+ * @Note Requires TableScan.h
+ */
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+#include <atomic>
+#include <queue>
+#include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "TableScan.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef TABLESCAN_CPP
+#define TABLESCAN_CPP
+
+string getWorkPath( string tableFilePath, string suffix );
+bool syncFile( string path );
+bool syncDirectory( string filePath );
+int getValueType( string attributeType );
+
+/**
+ * @brief splitRow
+ *
+ * @details splits a stored record into its tab separated values
+ *
+ * @param [in] const string &line
+ *
+ * @return vector< string > values of the record in attribute order
+ *
+ * @note None
+ */
+vector< string > splitRow( const string &line )
+{
+	vector< string > values;
+	size_t start = 0;
+	size_t tabIndex = line.find( '\t' );
+	while( tabIndex != string::npos )
+	{
+		values.push_back( line.substr( start, tabIndex - start ) );
+		start = tabIndex + 1;
+		tabIndex = line.find( '\t', start );
+	}
+	values.push_back( line.substr( start ) );
+	return values;
+}
+
+/**
+ * @brief joinRow
+ *
+ * @details joins values into a stored record, the reverse of splitRow
+ *
+ * @param [in] const vector< string > &values
+ *
+ * @return string values separated by tabs
+ *
+ * @note None
+ */
+string joinRow( const vector< string > &values )
+{
+	string line;
+	int valueSize = values.size();
+	for( int index = 0; index < valueSize; index++ )
+	{
+		if( index != 0 )
+		{
+			line += '\t';
+		}
+		line += values[ index ];
+	}
+
+	//empty lines are not records, so a lone null keeps a trailing tab
+	if( valueSize == 1 && line.empty() )
+	{
+		line += '\t';
+	}
+	return line;
+}
+
+/**
+ * @brief isNullValue
+ *
+ * @details tells whether a stored value is null
+ *
+ * @par Algorithm null is stored as an empty value, which no other value is
+ *      since strings are quoted, so the test is a length check. Tables
+ *      written before then may still hold the text null
+ *
+ * @param [in] const string &content - value as stored
+ *
+ * @return bool
+ *
+ * @note None
+ */
+bool isNullValue( const string &content )
+{
+	return content.empty() || ( content.size() == 4 && content == "null" );
+}
+
+/**
+ * @brief getStoredValue
+ *
+ * @details turns a value as written in a statement into its stored form
+ *
+ * @param [in] string literal - e.g. 1, 'Gizmo' or NULL
+ *
+ * @return string the literal, or an empty value for null
+ *
+ * @note None
+ */
+string getStoredValue( string literal )
+{
+	size_t first = literal.find_first_not_of( " \t" );
+	size_t last = literal.find_last_not_of( " \t" );
+	if( first != string::npos && last - first == 3 && strncasecmp( literal.c_str() + first, "null", 4 ) == 0 )
+	{
+		return "";
+	}
+	return literal;
+}
+
+/**
+ * @brief parseAttributeData
+ *
+ * @details converts the attribute line of a table file into attributes
+ *
+ * @par Algorithm fields starting with # describe the file, not a column
+ *
+ * @param [in] string attributeData - first line of the table file
+ *
+ * @return vector< Attribute > attributes in table order
+ *
+ * @note None
+ */
+vector< Attribute > parseAttributeData( string attributeData )
+{
+	vector< Attribute > attributes;
+
+	//the attribute line of a fixed width table is padded like its records
+	attributeData.erase( attributeData.find_last_not_of( ' ' ) + 1 );
+	vector< string > columns = splitRow( attributeData );
+	int columnSize = columns.size();
+	for( int index = 0; index < columnSize; index++ )
+	{
+		if( columns[ index ].empty() || columns[ index ][ 0 ] == '#' )
+		{
+			continue;
+		}
+		Attribute tempAttribute;
+		size_t spaceIndex = columns[ index ].find( ' ' );
+		tempAttribute.attributeName = columns[ index ].substr( 0, spaceIndex );
+		if( spaceIndex != string::npos )
+		{
+			tempAttribute.attributeType = columns[ index ].substr( spaceIndex + 1 );
+		}
+		attributes.push_back( tempAttribute );
+	}
+	return attributes;
+}
+
+/**
+ * @brief getAttributeLine
+ *
+ * @details builds the attribute line of a table file, the reverse of
+ *          parseAttributeData
+ *
+ * @param [in] const vector< Attribute > &attributes
+ *
+ * @return string name and type of each attribute separated by tabs
+ *
+ * @note None
+ */
+string getAttributeLine( const vector< Attribute > &attributes )
+{
+	vector< string > columns;
+	int attributeSize = attributes.size();
+	for( int index = 0; index < attributeSize; index++ )
+	{
+		columns.push_back( attributes[ index ].attributeName + " " + attributes[ index ].attributeType );
+	}
+	return joinRow( columns );
+}
+
+/**
+ * @brief getRecordWidth
+ *
+ * @details finds the size of the records of a fixed width table
+ *
+ * @par Algorithm each value gets the width of its declared type, strings
+ *      declared with a length get that length and their quotes
+ *
+ * @param [in] const vector< Attribute > &attributes
+ *
+ * @return long bytes per record including the newline before it
+ *
+ * @note None
+ */
+long getRecordWidth( const vector< Attribute > &attributes )
+{
+	int attributeSize = attributes.size();
+	long contentWidth = ( attributeSize > 0 ) ? attributeSize - 1 : 0;
+	for( int index = 0; index < attributeSize; index++ )
+	{
+		string attributeType = attributes[ index ].attributeType;
+		int valueType = getValueType( attributeType );
+		size_t openIndex = attributeType.find( '(' );
+		if( valueType == TYPE_INT )
+		{
+			contentWidth += INT_VALUE_WIDTH;
+		}
+		else if( valueType == TYPE_FLOAT )
+		{
+			contentWidth += FLOAT_VALUE_WIDTH;
+		}
+		else if( openIndex != string::npos && atol( attributeType.c_str() + openIndex + 1 ) > 0 )
+		{
+			contentWidth += atol( attributeType.c_str() + openIndex + 1 ) + 2;
+		}
+		else
+		{
+			contentWidth += STRING_VALUE_WIDTH;
+		}
+	}
+	return contentWidth + 1;
+}
+
+/**
+ * @brief getDictionaryCount
+ *
+ * @details finds how many dictionary lines follow an attribute line
+ *
+ * @param [in] const string &attributeData
+ *
+ * @return int 0 if no column of the table is dictionary encoded
+ *
+ * @note None
+ */
+int getDictionaryCount( const string &attributeData )
+{
+	size_t fieldIndex = attributeData.rfind( "\t" + DICTIONARY_FIELD + " " );
+	if( fieldIndex == string::npos )
+	{
+		return 0;
+	}
+	return atoi( attributeData.c_str() + fieldIndex + DICTIONARY_FIELD.size() + 2 );
+}
+
+/**
+ * @brief getFieldList
+ *
+ * @details reads the column names listed by a field of an attribute line
+ *
+ * @param [in] const string &attributeData
+ *
+ * @param [in] const string &field - e.g. #bloom
+ *
+ * @return vector< string > names in order, empty without the field
+ *
+ * @note None
+ */
+vector< string > getFieldList( const string &attributeData, const string &field )
+{
+	vector< string > names;
+	size_t fieldIndex = attributeData.find( "\t" + field + " " );
+	if( fieldIndex == string::npos )
+	{
+		return names;
+	}
+	size_t listStart = fieldIndex + field.size() + 2;
+	string list = attributeData.substr( listStart, attributeData.find_first_of( "\t ", listStart ) - listStart );
+	size_t start = 0;
+	size_t commaIndex = list.find( ',' );
+	while( commaIndex != string::npos )
+	{
+		names.push_back( list.substr( start, commaIndex - start ) );
+		start = commaIndex + 1;
+		commaIndex = list.find( ',', start );
+	}
+	names.push_back( list.substr( start ) );
+	return names;
+}
+
+/**
+ * @brief getValueCode
+ *
+ * @param [in] const string &value - stored value
+ *
+ * @return long dictionary code of the value, NO_CODE if it is not coded
+ *
+ * @note None
+ */
+long getValueCode( const string &value )
+{
+	if( value.size() < 2 || value[ 0 ] != CODE_MARK || value.find_first_not_of( "0123456789", 1 ) != string::npos )
+	{
+		return NO_CODE;
+	}
+	return atol( value.c_str() + 1 );
+}
+
+/**
+ * @brief setLsmSequence
+ *
+ * @param [in] string header - attribute line, may be followed by more lines
+ *
+ * @param [in] long sequence - last sequence merged into the table file
+ *
+ * @return string the header with the sequence in its lsm field, unchanged
+ *         if the attribute line has none
+ *
+ * @note None
+ */
+string setLsmSequence( string header, long sequence )
+{
+	size_t fieldIndex = header.find( "\t" + LSM_FIELD + " " );
+	if( fieldIndex != string::npos && fieldIndex < header.find( '\n' ) )
+	{
+		char digits[ LSM_SEQUENCE_SIZE + 1 ];
+		snprintf( digits, sizeof( digits ), "%016ld", sequence );
+		header.replace( fieldIndex + LSM_FIELD.size() + 2, LSM_SEQUENCE_SIZE, digits );
+	}
+	return header;
+}
+
+/**
+ * @brief getSchemaKey
+ *
+ * @details the attribute line a schema file is matched with, without the
+ *          zone token and LSM sequence that change whenever the records are
+ *          rewritten
+ *
+ * @param [in] const string &attributeData
+ *
+ * @return string
+ *
+ * @note None
+ */
+string getSchemaKey( const string &attributeData )
+{
+	return setLsmSequence( setZoneToken( attributeData, string( ZONE_TOKEN_SIZE, '0' ) ), 0 );
+}
+
+/**
+ * @brief compareKeys
+ *
+ * @details orders two primary key values the way records are kept
+ *
+ * @par Algorithm nulls come first and floats that are not a number last,
+ *      other values compare like compareZoneValues
+ *
+ * @param [in] const string &key - decoded value
+ *
+ * @param [in] const string &other - decoded value
+ *
+ * @param [in] int valueType - type of the key column
+ *
+ * @return int negative, 0 or positive like string::compare
+ *
+ * @note None
+ */
+int compareKeys( const string &key, const string &other, int valueType )
+{
+	bool keyNull = isNullValue( key );
+	bool otherNull = isNullValue( other );
+	if( keyNull || otherNull )
+	{
+		return ( keyNull == otherNull ) ? 0 : keyNull ? -1 : 1;
+	}
+	if( valueType == TYPE_FLOAT )
+	{
+		bool keyNan = std::isnan( atof( key.c_str() ) );
+		bool otherNan = std::isnan( atof( other.c_str() ) );
+		if( keyNan || otherNan )
+		{
+			return ( keyNan == otherNan ) ? 0 : keyNan ? 1 : -1;
+		}
+	}
+	return compareZoneValues( key, other, valueType );
+}
+
+/**
+ * @brief padRecord
+ *
+ * @details fills the values of a record up to the record width
+ *
+ * @par Algorithm spaces are added after the last value. No value ends in a
+ *      space, strings being quoted, so readRow can strip them again
+ *
+ * @param [in/out] vector< string > &values
+ *
+ * @param [in] long recordWidth - 0 for a table without fixed width
+ *
+ * @return bool false if the values are too long for the record
+ *
+ * @note None
+ */
+bool padRecord( vector< string > &values, long recordWidth )
+{
+	if( recordWidth <= 0 || values.empty() )
+	{
+		return true;
+	}
+
+	long contentWidth = values.size() - 1;
+	int valueSize = values.size();
+	for( int index = 0; index < valueSize; index++ )
+	{
+		contentWidth += values[ index ].size();
+	}
+	if( contentWidth > recordWidth - 1 )
+	{
+		return false;
+	}
+	values.back().append( recordWidth - 1 - contentWidth, ' ' );
+	return true;
+}
+
+/**
+ * @brief readSchemaFile
+ *
+ * @details reads the schema kept next to a table whose schema was changed
+ *          without rewriting it
+ *
+ * @par Algorithm the first line is the attribute line of the table file the
+ *      schema belongs to, without its zone token. A schema whose first line
+ *      no longer matches was left behind by a rewrite and is ignored. Then one line per stored
+ *      column: its name and type, the value synthesized for records written
+ *      before the column existed and its state, dropped or modified
+ *
+ * @param [in] string tableFilePath
+ *
+ * @param [in] string attributeData - attribute line of the table file
+ *
+ * @param [out] vector< StoredColumn > &columns
+ *
+ * @return bool false if the table has no schema file that applies
+ *
+ * @note None
+ */
+bool readSchemaFile( string tableFilePath, string attributeData, vector< StoredColumn > &columns )
+{
+	ifstream fin( getWorkPath( tableFilePath, SCHEMA_SUFFIX ).c_str() );
+	string line;
+	if( !fin.is_open() || !getline( fin, line ) || getSchemaKey( line ) != getSchemaKey( attributeData ) )
+	{
+		return false;
+	}
+
+	columns.clear();
+	while( getline( fin, line ) )
+	{
+		vector< string > fields = splitRow( line );
+		vector< Attribute > parsed = parseAttributeData( fields[ 0 ] );
+		if( parsed.empty() )
+		{
+			continue;
+		}
+
+		StoredColumn column;
+		column.attribute = parsed[ 0 ];
+		column.defaultValue = ( fields.size() > 1 ) ? getStoredValue( fields[ 1 ] ) : "";
+		column.dropped = ( fields.size() > 2 && fields[ 2 ] == "dropped" );
+		column.modified = ( fields.size() > 2 && fields[ 2 ] == "modified" );
+		columns.push_back( column );
+	}
+	return true;
+}
+
+/**
+ * @brief writeSchemaFile
+ *
+ * @details replaces the schema kept next to a table
+ *
+ * @par Algorithm the schema is written to a work file, synced and renamed
+ *      over the old one, so it is never seen half written
+ *
+ * @param [in] string tableFilePath
+ *
+ * @param [in] string attributeData - attribute line of the table file
+ *
+ * @param [in] const vector< StoredColumn > &columns
+ *
+ * @return bool true if the schema was replaced
+ *
+ * @note None
+ */
+bool writeSchemaFile( string tableFilePath, string attributeData, const vector< StoredColumn > &columns )
+{
+	string schemaPath = getWorkPath( tableFilePath, SCHEMA_SUFFIX );
+	string tempPath = schemaPath + ".tmp";
+	ofstream fout( tempPath.c_str(), ofstream::trunc );
+	fout << getSchemaKey( attributeData ) << "\n";
+	int columnSize = columns.size();
+	for( int index = 0; index < columnSize; index++ )
+	{
+		fout << columns[ index ].attribute.attributeName << " " << columns[ index ].attribute.attributeType;
+		fout << "\t" << columns[ index ].defaultValue;
+		fout << "\t" << ( columns[ index ].dropped ? "dropped" : columns[ index ].modified ? "modified" : "" ) << "\n";
+	}
+	fout.close();
+
+	if( fout.fail() || !syncFile( tempPath ) || rename( tempPath.c_str(), schemaPath.c_str() ) != 0 )
+	{
+		unlink( tempPath.c_str() );
+		return false;
+	}
+	return syncDirectory( schemaPath );
+}
+
+/**
+ * @brief convertValue
+ *
+ * @details rewrites a stored value in the form of the type of its column
+ *
+ * @param [in] string content - value as stored
+ *
+ * @param [in] string attributeType - type the column now has
+ *
+ * @return string value to store
+ *
+ * @note null stays null, strings are kept as stored
+ */
+string convertValue( string content, string attributeType )
+{
+	int valueType = getValueType( attributeType );
+	if( isNullValue( content ) || valueType == TYPE_STRING )
+	{
+		return content;
+	}
+	if( content.size() > 1 && content[ 0 ] == '\'' && content[ content.size() - 1 ] == '\'' )
+	{
+		content = content.substr( 1, content.size() - 2 );
+	}
+
+	char *end;
+	double number = strtod( content.c_str(), &end );
+	if( valueType == TYPE_INT )
+	{
+		return to_string( (long) number );
+	}
+	return ( *end == '\0' && end != content.c_str() ) ? content : to_string( number );
+}
+
+/**
+ * @brief valueMatchesCondition
+ *
+ * @details evaluates a where condition against the value of its attribute
+ *
+ * @par Algorithm IS NULL and IS NOT NULL only test the value for null. A
+ *      comparison with null is never true. Otherwise compares by value
+ *      when the condition is on an int or float attribute and compares the
+ *      stored text if not
+ *
+ * @param [in] const WhereCondition &wCond
+ *
+ * @param [in] const string &content - value of the attribute in a record
+ *
+ * @return bool true if the value satisfies the condition
+ *
+ * @note None
+ */
+bool valueMatchesCondition( const WhereCondition &wCond, const string &content )
+{
+	bool valueNull = isNullValue( content );
+	if( wCond.operatorValue == IS_NULL || wCond.operatorValue == IS_NOT_NULL )
+	{
+		return valueNull == ( wCond.operatorValue == IS_NULL );
+	}
+	if( valueNull || wCond.comparisonValue.empty() )
+	{
+		return false;
+	}
+
+	int comparison;
+	if( wCond.floatValue )
+	{
+		double value = atof( content.c_str() );
+		comparison = ( value < wCond.comparisonValueFloat ) ? -1 : ( value > wCond.comparisonValueFloat ) ? 1 : 0;
+	}
+	else if( wCond.intValue )
+	{
+		long value = atol( content.c_str() );
+		comparison = ( value < wCond.comparisonValueInt ) ? -1 : ( value > wCond.comparisonValueInt ) ? 1 : 0;
+	}
+	else
+	{
+		comparison = content.compare( wCond.comparisonValue );
+	}
+
+	if( wCond.operatorValue == "=" )
+	{
+		return comparison == 0;
+	}
+	else if( wCond.operatorValue == "!=" )
+	{
+		return comparison != 0;
+	}
+	else if( wCond.operatorValue == "<" )
+	{
+		return comparison < 0;
+	}
+	else if( wCond.operatorValue == "<=" )
+	{
+		return comparison <= 0;
+	}
+	else if( wCond.operatorValue == ">" )
+	{
+		return comparison > 0;
+	}
+	else if( wCond.operatorValue == ">=" )
+	{
+		return comparison >= 0;
+	}
+	return false;
+}
+
+/**
+ * @brief rowMatchesCondition
+ *
+ * @details evaluates a where condition against one record
+ *
+ * @param [in] const WhereCondition &wCond
+ *
+ * @param [in] const vector< string > &row
+ *
+ * @return bool true if the record satisfies the condition or there is none
+ *
+ * @note None
+ */
+bool rowMatchesCondition( const WhereCondition &wCond, const vector< string > &row )
+{
+	if( wCond.operatorValue.empty() )
+	{
+		return true;
+	}
+	if( wCond.attributeIndex < 0 || wCond.attributeIndex >= (int) row.size() )
+	{
+		return false;
+	}
+	return valueMatchesCondition( wCond, row[ wCond.attributeIndex ] );
+}
+
+/**
+ * @brief TableSnapshot default constructor
+ *
+ * @note None
+ */
+TableSnapshot::TableSnapshot()
+{
+	fd = -1;
+	fileSize = 0;
+	version = 0;
+}
+
+/**
+ * @brief TableSnapshot destructor
+ *
+ * @details closes the table file, the last reader of a replaced file frees it
+ *
+ * @note None
+ */
+TableSnapshot::~TableSnapshot()
+{
+	if( fd >= 0 )
+	{
+		close( fd );
+	}
+	if( pins != NULL )
+	{
+		( *pins )--;
+	}
+}
+
+/**
+ * @brief TableScan default constructor
+ *
+ * @details initializes an unopened scan
+ *
+ * @note None
+ */
+TableScan::TableScan()
+{
+	dataOffset = 0;
+	fileSize = 0;
+	recordWidth = 0;
+	compressed = false;
+	compacting = false;
+	converting = false;
+	rewriteWidth = 0;
+	rewriteCompressed = false;
+	filtersLoaded = false;
+	keyColumn = -1;
+	placeInserts = false;
+	spillInsert = false;
+	sortType = TYPE_STRING;
+	lsmSequence = -1;
+	engineName = DEFAULT_ENGINE;
+}
+
+/**
+ * @brief TableScan default destructor
+ *
+ * @details nothing to release, a snapshot is closed by its last scan
+ *
+ * @note None
+ */
+TableScan::~TableScan()
+{
+
+}
+
+/**
+ * @brief scanOpen
+ *
+ * @details reads the attribute line and records where the records begin,
+ *          the table's schema file takes the place of the attribute line
+ *          when there is one. attributes holds the columns of the schema,
+ *          storedColumns every column records are stored with. The
+ *          dictionaries of encoded columns follow the attribute line. The
+ *          zone map is only read once the file is cut into morsels
+ *
+ * @param [in] string tableFilePath - full path to the table file
+ *
+ * @return bool true if the table file could be opened
+ *
+ * @note None
+ */
+bool TableScan::scanOpen( string tableFilePath )
+{
+	filePath = tableFilePath;
+	ifstream fin( filePath.c_str(), ifstream::binary );
+	if( !fin.is_open() )
+	{
+		return false;
+	}
+
+	getline( fin, attributeData );
+
+	//schema changes made since the table was written are only in the
+	//schema file, the attribute line still describes how records are stored
+	vector< Attribute > written = parseAttributeData( attributeData );
+	storedColumns.clear();
+	for( unsigned int index = 0; index < written.size(); index++ )
+	{
+		StoredColumn column;
+		column.attribute = written[ index ];
+		column.dropped = false;
+		column.modified = false;
+		storedColumns.push_back( column );
+	}
+	readSchemaFile( filePath, attributeData, storedColumns );
+
+	//the key orders the records only while the column written with it is
+	//kept, and a unique column is only unique while it is
+	keyName.clear();
+	keyColumn = -1;
+	size_t keyIndex = attributeData.find( "\t" + KEY_FIELD + " " );
+	if( keyIndex != string::npos )
+	{
+		size_t nameStart = keyIndex + KEY_FIELD.size() + 2;
+		keyName = attributeData.substr( nameStart, attributeData.find_first_of( "\t ", nameStart ) - nameStart );
+	}
+	vector< string > uniqueNames = getFieldList( attributeData, UNIQUE_FIELD );
+	uniqueStoredColumns.clear();
+	for( unsigned int index = 0; index < written.size(); index++ )
+	{
+		if( !keyName.empty() && written[ index ].attributeName == keyName && !storedColumns[ index ].dropped )
+		{
+			keyColumn = index;
+		}
+		else if( find( uniqueNames.begin(), uniqueNames.end(), written[ index ].attributeName ) != uniqueNames.end() &&
+			!storedColumns[ index ].dropped )
+		{
+			uniqueStoredColumns.push_back( index );
+		}
+	}
+
+	attributes.clear();
+	storedIndexes.clear();
+	converting = false;
+	for( unsigned int index = 0; index < storedColumns.size(); index++ )
+	{
+		if( !storedColumns[ index ].dropped )
+		{
+			attributes.push_back( storedColumns[ index ].attribute );
+			storedIndexes.push_back( index );
+			converting = converting || storedColumns[ index ].modified;
+		}
+	}
+
+	//each dictionary line is the stored index of its column and its values
+	dictionaryData.clear();
+	dictionaries.reset();
+	int dictionaryCount = getDictionaryCount( attributeData );
+	string line;
+	for( int count = 0; count < dictionaryCount && getline( fin, line ); count++ )
+	{
+		dictionaryData += "\n" + line;
+		vector< string > fields = splitRow( line );
+		unsigned int storedIndex = atoi( fields[ 0 ].c_str() + 1 );
+		if( storedIndex >= storedColumns.size() )
+		{
+			continue;
+		}
+		if( dictionaries == NULL )
+		{
+			dictionaries.reset( new vector< ColumnDictionary >( storedColumns.size() ) );
+		}
+		ColumnDictionary &dictionary = ( *dictionaries )[ storedIndex ];
+		dictionary.values.assign( fields.begin() + 1, fields.end() );
+		for( unsigned int code = 0; code < dictionary.values.size(); code++ )
+		{
+			dictionary.codes[ dictionary.values[ code ] ] = code;
+		}
+	}
+
+	size_t fixedIndex = attributeData.find( "\t" + FIXED_FIELD + " " );
+	recordWidth = ( fixedIndex == string::npos ) ? 0 : atol( attributeData.c_str() + fixedIndex + FIXED_FIELD.size() + 2 );
+
+	compressed = attributeData.find( "\t" + PAGES_FIELD ) != string::npos;
+
+	//the zone map stays with the table when records are staged elsewhere
+	zoneFilePath = getWorkPath( filePath, ZONES_SUFFIX );
+	bloomFilePath = getWorkPath( filePath, BLOOM_SUFFIX );
+	overflowFilePath = getWorkPath( filePath, OVERFLOW_SUFFIX );
+	zoneToken.clear();
+	zoneStamp.clear();
+	zones.reset();
+	filtersLoaded = false;
+	bloomColumns = getFieldList( attributeData, BLOOM_FIELD );
+	size_t lsmIndex = attributeData.find( "\t" + LSM_FIELD + " " );
+	lsmSequence = ( lsmIndex == string::npos ) ? -1 : atol( attributeData.c_str() + lsmIndex + LSM_FIELD.size() + 2 );
+	size_t engineIndex = attributeData.find( "\t" + ENGINE_FIELD + " " );
+	engineName = DEFAULT_ENGINE;
+	if( engineIndex != string::npos )
+	{
+		size_t nameStart = engineIndex + ENGINE_FIELD.size() + 2;
+		engineName = attributeData.substr( nameStart, attributeData.find_first_of( "\t ", nameStart ) - nameStart );
+	}
+
+	//records start after the newline that ends the attribute line
+	fin.clear();
+	fin.seekg( 0, ifstream::end );
+	fileSize = fin.tellg();
+	dataOffset = attributeData.size() + dictionaryData.size() + 1;
+	if( dataOffset > fileSize )
+	{
+		dataOffset = fileSize;
+	}
+	fin.close();
+	return true;
+}
+
+/**
+ * @brief snapshotOpen
+ *
+ * @details pins the committed version of the table file for a query
+ *
+ * @param [in] long version - commit version of the table
+ *
+ * @param [in] shared_ptr< atomic< int > > pins - count of the table's open
+ *             snapshots, kept up while this one is open, may be empty
+ *
+ * @return bool true if the table file could be opened
+ *
+ * @note must be called while no writer holds the table, the scan then reads
+ *       the snapshot without any lock
+ */
+bool TableScan::snapshotOpen( long version, shared_ptr< atomic< int > > pins )
+{
+	shared_ptr< TableSnapshot > opened( new TableSnapshot );
+	struct stat buffer;
+	opened->fd = open( filePath.c_str(), O_RDONLY );
+	if( opened->fd < 0 || fstat( opened->fd, &buffer ) != 0 )
+	{
+		return false;
+	}
+	opened->fileSize = buffer.st_size;
+	opened->version = version;
+	if( pins != NULL )
+	{
+		( *pins )++;
+		opened->pins = pins;
+	}
+
+	snapshot = opened;
+	fileSize = snapshot->fileSize;
+	return true;
+}
+
+/**
+ * @brief readRow
+ *
+ * @details turns a stored record into values in attribute order
+ *
+ * @par Algorithm the padding of a fixed width record is stripped. Records
+ *      written before a column was added are shorter and get the column's
+ *      default. Values of dropped columns are skipped and
+ *      values of modified columns are converted to the column's new type.
+ *      Other values are left dictionary coded
+ *
+ * @param [in] const string &line
+ *
+ * @return vector< string > one value per attribute
+ *
+ * @note None
+ */
+vector< string > TableScan::readRow( const string &line )
+{
+	vector< string > row = splitRow( line );
+	if( recordWidth > 0 )
+	{
+		row.back().erase( row.back().find_last_not_of( ' ' ) + 1 );
+	}
+	int storedSize = storedColumns.size();
+	for( int index = row.size(); index < storedSize; index++ )
+	{
+		row.push_back( storedColumns[ index ].defaultValue );
+	}
+	if( (int) row.size() > storedSize )
+	{
+		row.resize( storedSize );
+	}
+	if( storedIndexes.size() == storedColumns.size() && !converting )
+	{
+		return row;
+	}
+
+	int attributeSize = attributes.size();
+	vector< string > values( attributeSize );
+	for( int index = 0; index < attributeSize; index++ )
+	{
+		StoredColumn &column = storedColumns[ storedIndexes[ index ] ];
+		const string &value = row[ storedIndexes[ index ] ];
+		values[ index ] = column.modified ? convertValue( decodeStoredValue( storedIndexes[ index ], value ), column.attribute.attributeType ) : value;
+	}
+	return values;
+}
+
+/**
+ * @brief storeRow
+ *
+ * @details turns values in attribute order into the values of a stored
+ *          record, the reverse of readRow
+ *
+ * @param [in] const vector< string > &values
+ *
+ * @return vector< string > values with dropped columns left empty
+ *
+ * @note None
+ */
+vector< string > TableScan::storeRow( const vector< string > &values )
+{
+	if( storedIndexes.size() == storedColumns.size() )
+	{
+		return values;
+	}
+
+	int valueSize = values.size();
+	int attributeSize = attributes.size();
+	vector< string > row( storedColumns.size() );
+	for( int index = 0; index < valueSize; index++ )
+	{
+		if( index < attributeSize )
+		{
+			row[ storedIndexes[ index ] ] = values[ index ];
+		}
+		else
+		{
+			row.push_back( values[ index ] );
+		}
+	}
+	return row;
+}
+
+/**
+ * @brief decodeValue
+ *
+ * @details turns a value of readRow back into the value it was written as
+ *
+ * @param [in] int attributeIndex
+ *
+ * @param [in] const string &value
+ *
+ * @return string the value of its dictionary code, the value itself if it
+ *         is not coded
+ *
+ * @note None
+ */
+string TableScan::decodeValue( int attributeIndex, const string &value )
+{
+	if( dictionaries == NULL || attributeIndex < 0 || attributeIndex >= (int) storedIndexes.size() )
+	{
+		return value;
+	}
+	return decodeStoredValue( storedIndexes[ attributeIndex ], value );
+}
+
+/**
+ * @brief decodeStoredValue
+ *
+ * @param [in] int storedIndex - stored column of the value
+ *
+ * @param [in] const string &value
+ *
+ * @return string the value of its dictionary code, the value itself if it
+ *         is not coded
+ *
+ * @note None
+ */
+string TableScan::decodeStoredValue( int storedIndex, const string &value )
+{
+	if( dictionaries == NULL || storedIndex >= (int) dictionaries->size() )
+	{
+		return value;
+	}
+	const vector< string > &values = ( *dictionaries )[ storedIndex ].values;
+	long code = getValueCode( value );
+	if( code < 0 || code >= (long) values.size() )
+	{
+		return value;
+	}
+	return values[ code ];
+}
+
+/**
+ * @brief decodeOutputValue
+ *
+ * @details decodes a value of a record a rewrite writes
+ *
+ * @param [in] int column - column of the written record
+ *
+ * @param [in] const string &value
+ *
+ * @return string the value of its dictionary code, with the dictionaries a
+ *         compaction builds when compacting
+ *
+ * @note None
+ */
+string TableScan::decodeOutputValue( int column, const string &value )
+{
+	if( !compacting )
+	{
+		return decodeStoredValue( column, value );
+	}
+	if( rewriteDictionaries == NULL || column >= (int) rewriteDictionaries->size() )
+	{
+		return value;
+	}
+	const vector< string > &values = ( *rewriteDictionaries )[ column ].values;
+	long code = getValueCode( value );
+	return ( code < 0 || code >= (long) values.size() ) ? value : values[ code ];
+}
+
+/**
+ * @brief resolveCondition
+ *
+ * @details looks up the comparison value of a condition on an encoded
+ *          column in its dictionary, once before the records are evaluated
+ *
+ * @param [in/out] WhereCondition &wCond - comparisonCode is set
+ *
+ * @return None
+ *
+ * @note must be called after parameters are bound to the condition
+ */
+void TableScan::resolveCondition( WhereCondition &wCond )
+{
+	wCond.comparisonCode = NO_CODE;
+	if( dictionaries == NULL || wCond.attributeIndex < 0 || wCond.attributeIndex >= (int) storedIndexes.size() )
+	{
+		return;
+	}
+	const ColumnDictionary &dictionary = ( *dictionaries )[ storedIndexes[ wCond.attributeIndex ] ];
+	map< string, long >::const_iterator found = dictionary.codes.find( wCond.comparisonValue );
+	if( found != dictionary.codes.end() )
+	{
+		wCond.comparisonCode = found->second;
+	}
+}
+
+/**
+ * @brief rowMatches
+ *
+ * @details evaluates a resolved where condition against one record of
+ *          readRow
+ *
+ * @par Algorithm a coded value is tested for equality by comparing its code
+ *      with the code of the comparison value, as codes stand for distinct
+ *      values. Only other comparisons decode it. Values that are not coded
+ *      are evaluated like rowMatchesCondition does
+ *
+ * @param [in] const WhereCondition &wCond - resolved by resolveCondition
+ *
+ * @param [in] const vector< string > &row
+ *
+ * @return bool true if the record satisfies the condition or there is none
+ *
+ * @note None
+ */
+bool TableScan::rowMatches( const WhereCondition &wCond, const vector< string > &row )
+{
+	if( dictionaries == NULL || wCond.operatorValue.empty() || wCond.attributeIndex < 0 || wCond.attributeIndex >= (int) row.size() )
+	{
+		return rowMatchesCondition( wCond, row );
+	}
+
+	const vector< string > &values = ( *dictionaries )[ storedIndexes[ wCond.attributeIndex ] ].values;
+	long code = getValueCode( row[ wCond.attributeIndex ] );
+	if( code < 0 || code >= (long) values.size() )
+	{
+		return rowMatchesCondition( wCond, row );
+	}
+	if( wCond.operatorValue == "=" || wCond.operatorValue == "!=" )
+	{
+		return !wCond.comparisonValue.empty() && ( code == wCond.comparisonCode ) == ( wCond.operatorValue == "=" );
+	}
+	return valueMatchesCondition( wCond, values[ code ] );
+}
+
+/**
+ * @brief compactTo
+ *
+ * @details writes the table in the layout of its schema
+ *
+ * @par Algorithm a parallel rewrite that writes the attribute line of the
+ *      schema and every record as readRow sees it, so values of dropped
+ *      columns are removed and values of modified columns converted. Once
+ *      the new file replaces the table the schema file no longer applies.
+ *      Low cardinality string columns get a new dictionary, written after
+ *      the attribute line, and their values are stored as codes. The new
+ *      file always gets a zone map, with Bloom filters on the bloomColumns
+ *      that are not floats. The records of a table with a primary key are
+ *      sorted by it
+ *
+ * @param [in] string targetPath - work file receiving the new table
+ *
+ * @param [in] bool fixedWidth - pads the records to the widths of the
+ *             declared types of the schema
+ *
+ * @param [in] bool compressedPages - packs the records into compressed
+ *             pages, not together with fixedWidth
+ *
+ * @return bool true if the new table was written, false also if a value
+ *         is too long for a fixed width record
+ *
+ * @note the table is left untouched
+ */
+bool TableScan::compactTo( string targetPath, bool fixedWidth, bool compressedPages )
+{
+	buildDictionaries();
+	string headerLine = getAttributeLine( attributes );
+	string dictionaryLines;
+	int dictionaryCount = 0;
+	int attributeSize = attributes.size();
+	for( int index = 0; index < attributeSize; index++ )
+	{
+		if( !( *rewriteDictionaries )[ index ].values.empty() )
+		{
+			dictionaryLines += "\n" + string( 1, CODE_MARK ) + to_string( index ) + "\t" + joinRow( ( *rewriteDictionaries )[ index ].values );
+			dictionaryCount++;
+		}
+	}
+	if( dictionaryCount > 0 )
+	{
+		headerLine += "\t" + DICTIONARY_FIELD + " " + to_string( dictionaryCount );
+	}
+	if( compressedPages )
+	{
+		headerLine += "\t" + PAGES_FIELD;
+	}
+	string bloomList;
+	for( int index = 0; index < attributeSize; index++ )
+	{
+		if( getValueType( attributes[ index ].attributeType ) != TYPE_FLOAT &&
+			find( bloomColumns.begin(), bloomColumns.end(), attributes[ index ].attributeName ) != bloomColumns.end() )
+		{
+			bloomList += ( bloomList.empty() ? "" : "," ) + attributes[ index ].attributeName;
+		}
+	}
+	if( !bloomList.empty() )
+	{
+		headerLine += "\t" + BLOOM_FIELD + " " + bloomList;
+	}
+	if( keyColumn >= 0 )
+	{
+		headerLine += "\t" + KEY_FIELD + " " + keyName;
+	}
+	string uniqueList;
+	for( int index = 0; index < attributeSize; index++ )
+	{
+		if( find( uniqueStoredColumns.begin(), uniqueStoredColumns.end(), storedIndexes[ index ] ) != uniqueStoredColumns.end() )
+		{
+			uniqueList += ( uniqueList.empty() ? "" : "," ) + attributes[ index ].attributeName;
+		}
+	}
+	if( !uniqueList.empty() )
+	{
+		headerLine += "\t" + UNIQUE_FIELD + " " + uniqueList;
+	}
+	headerLine += "\t" + ENGINE_FIELD + " " + engineName;
+	if( lsmSequence >= 0 )
+	{
+		headerLine = setLsmSequence( headerLine + "\t" + LSM_FIELD + " " + string( LSM_SEQUENCE_SIZE, '0' ), lsmSequence );
+	}
+	rewriteWidth = fixedWidth ? getRecordWidth( attributes ) : 0;
+	if( fixedWidth )
+	{
+		headerLine += "\t" + FIXED_FIELD + " " + to_string( rewriteWidth );
+	}
+	headerLine += "\t" + ZONES_FIELD + " " + string( ZONE_TOKEN_SIZE, '0' );
+	rewriteHeader = headerLine + dictionaryLines;
+
+	string tableRewritePath = rewritePath;
+	rewritePath = targetPath;
+	rewriteCompressed = compressedPages;
+	compacting = true;
+	int recordCount = parallelRewrite( [ & ]( vector< string > &row )
+	{
+		int valueSize = ( (int) row.size() < attributeSize ) ? row.size() : attributeSize;
+		for( int index = 0; index < valueSize; index++ )
+		{
+			const map< string, long > &codes = ( *rewriteDictionaries )[ index ].codes;
+			string value = decodeValue( index, row[ index ] );
+			map< string, long >::const_iterator found = codes.find( value );
+			row[ index ] = ( found == codes.end() ) ? value : CODE_MARK + to_string( found->second );
+		}
+		return ROW_KEEP;
+	}, NULL );
+	compacting = false;
+	rewriteDictionaries.reset();
+	rewritePath = tableRewritePath;
+	return recordCount >= 0;
+}
+
+/**
+ * @brief buildDictionaries
+ *
+ * @details chooses the string columns a compaction encodes and collects
+ *          their distinct values
+ *
+ * @par Algorithm morsels collect the distinct values of every string
+ *      column in parallel, a column is given up on once it has more than
+ *      DICTIONARY_MAX_SIZE. The sets are merged and a column is encoded
+ *      when its values repeat at least twice on average
+ *
+ * @return None
+ *
+ * @note rewriteDictionaries holds one dictionary per attribute, empty for
+ *       columns that are not encoded
+ */
+void TableScan::buildDictionaries()
+{
+	int attributeSize = attributes.size();
+	rewriteDictionaries.reset( new vector< ColumnDictionary >( attributeSize ) );
+	vector< int > candidates;
+	for( int index = 0; index < attributeSize; index++ )
+	{
+		if( getValueType( attributes[ index ].attributeType ) == TYPE_STRING )
+		{
+			candidates.push_back( index );
+		}
+	}
+	int candidateSize = candidates.size();
+	if( candidateSize == 0 )
+	{
+		return;
+	}
+
+	vector< Morsel > morsels = getMorsels( MORSEL_SIZE );
+	int partitionCount = morsels.size();
+	vector< vector< set< string > > > partitionValues( partitionCount, vector< set< string > >( candidateSize ) );
+	vector< long > partitionRows( partitionCount, 0 );
+	parallelFor( partitionCount, [ & ]( int index )
+	{
+		forEachRow( morsels[ index ], [ & ]( string &line )
+		{
+			vector< string > row = readRow( line );
+			partitionRows[ index ]++;
+			for( int candidate = 0; candidate < candidateSize; candidate++ )
+			{
+				set< string > &values = partitionValues[ index ][ candidate ];
+				int attributeIndex = candidates[ candidate ];
+				if( (int) values.size() <= DICTIONARY_MAX_SIZE && attributeIndex < (int) row.size() && !isNullValue( row[ attributeIndex ] ) )
+				{
+					values.insert( decodeValue( attributeIndex, row[ attributeIndex ] ) );
+				}
+			}
+		} );
+	} );
+
+	long rowCount = 0;
+	for( int index = 0; index < partitionCount; index++ )
+	{
+		rowCount += partitionRows[ index ];
+	}
+	for( int candidate = 0; candidate < candidateSize; candidate++ )
+	{
+		set< string > merged;
+		for( int index = 0; index < partitionCount && (int) merged.size() <= DICTIONARY_MAX_SIZE; index++ )
+		{
+			merged.insert( partitionValues[ index ][ candidate ].begin(), partitionValues[ index ][ candidate ].end() );
+		}
+		if( merged.empty() || (int) merged.size() > DICTIONARY_MAX_SIZE || rowCount < 2 * (long) merged.size() )
+		{
+			continue;
+		}
+		ColumnDictionary &dictionary = ( *rewriteDictionaries )[ candidates[ candidate ] ];
+		dictionary.values.assign( merged.begin(), merged.end() );
+		for( unsigned int code = 0; code < dictionary.values.size(); code++ )
+		{
+			dictionary.codes[ dictionary.values[ code ] ] = code;
+		}
+	}
+}
+
+/**
+ * @brief getMorsels
+ *
+ * @details cuts the record section of the file into byte ranges
+ *
+ * @par Algorithm pages are found by their headers and each is a morsel,
+ *      records behind them are text. Text covered by the zone map is cut
+ *      along its zones so a morsel can be skipped by the range of its zone,
+ *      the rest is cut by size
+ *
+ * @param [in] long morselSize - number of bytes per morsel
+ *
+ * @return vector< Morsel > morsels in file order, those of a fixed width
+ *         table hold whole records and each page of a compressed table is
+ *         a morsel of its own
+ *
+ * @note morsel boundaries are aligned to rows when the morsel is scanned
+ */
+vector< Morsel > TableScan::getMorsels( long morselSize )
+{
+	vector< Morsel > morsels;
+
+	//without a snapshot the table may have grown since it was opened
+	struct stat buffer;
+	if( snapshot != NULL )
+	{
+		fileSize = snapshot->fileSize;
+	}
+	else if( stat( filePath.c_str(), &buffer ) == 0 )
+	{
+		fileSize = buffer.st_size;
+	}
+	if( recordWidth > 0 )
+	{
+		morselSize = ( morselSize > recordWidth ) ? morselSize - morselSize % recordWidth : recordWidth;
+	}
+
+	//the zone map must belong to the version of the file being read
+	bool zoned = attributeData.find( "\t" + ZONES_FIELD + " " ) != string::npos;
+	int fd = ( snapshot != NULL ) ? snapshot->fd : ( compressed || zoned ) ? open( filePath.c_str(), O_RDONLY ) : -1;
+	loadZones( fd );
+	int zoneCount = ( zones != NULL ) ? zones->size() : 0;
+	int zoneIndex = 0;
+
+	long textStart = dataOffset;
+	char pageHeader[ PAGE_HEADER_SIZE ];
+	while( compressed && fd >= 0 && textStart < fileSize && pread( fd, pageHeader, PAGE_HEADER_SIZE, textStart ) == PAGE_HEADER_SIZE &&
+		pageHeader[ 0 ] == PAGE_MARK )
+	{
+		while( zoneIndex < zoneCount && ( *zones )[ zoneIndex ].endOffset <= textStart )
+		{
+			zoneIndex++;
+		}
+		Morsel morsel;
+		morsel.startOffset = textStart;
+		morsel.endOffset = textStart + PAGE_HEADER_SIZE + getPageContentSize( pageHeader );
+		morsel.zoneIndex = ( zoneIndex < zoneCount && ( *zones )[ zoneIndex ].startOffset <= textStart ) ? zoneIndex : -1;
+		morsels.push_back( morsel );
+		textStart = morsel.endOffset + 1;
+	}
+	if( fd >= 0 && snapshot == NULL )
+	{
+		close( fd );
+	}
+
+	function< void( long start, long end ) > cutMorsels = [ & ]( long start, long end )
+	{
+		for( ; start < end; start += morselSize )
+		{
+			Morsel morsel;
+			morsel.startOffset = start;
+			morsel.endOffset = ( start + morselSize < end ) ? start + morselSize : end;
+			morsel.zoneIndex = -1;
+			morsels.push_back( morsel );
+		}
+	};
+	for( ; zoneIndex < zoneCount; zoneIndex++ )
+	{
+		const Zone &zone = ( *zones )[ zoneIndex ];
+		if( zone.endOffset <= textStart )
+		{
+			continue;
+		}
+		if( zone.startOffset < textStart || zone.startOffset >= fileSize )
+		{
+			break;
+		}
+		cutMorsels( textStart, zone.startOffset );
+		Morsel morsel;
+		morsel.startOffset = zone.startOffset;
+		morsel.endOffset = ( zone.endOffset < fileSize ) ? zone.endOffset : fileSize;
+		morsel.zoneIndex = zoneIndex;
+		morsels.push_back( morsel );
+		textStart = zone.endOffset;
+	}
+	cutMorsels( textStart, fileSize );
+	return morsels;
+}
+
+/**
+ * @brief forEachRow
+ *
+ * @details visits every record that starts inside the morsel
+ *
+ * @param [in] Morsel morsel
+ *
+ * @param [in] function< void( string &line ) > visit - called per record
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TableScan::forEachRow( Morsel morsel, function< void( string &line ) > visit )
+{
+	forEachRecord( morsel, [ & ]( string &line, long offset )
+	{
+		visit( line );
+	} );
+}
+
+/**
+ * @brief forEachRecord
+ *
+ * @details visits every record that starts inside the morsel along with
+ *          where it is in the file
+ *
+ * @par Algorithm if the morsel does not start on a row boundary, skip the
+ *      partial row (it belongs to the previous morsel), then read rows until
+ *      a row starts at or past the end of the morsel. The file is read in
+ *      blocks with pread, from the snapshot when the scan has one. A morsel
+ *      that is a page is read whole and its records are unpacked
+ *
+ * @param [in] Morsel morsel
+ *
+ * @param [in] function< void( string &line, long offset ) > visit - called
+ *             per record with the offset of its first byte, the records of
+ *             a page get the offset of the page
+ *
+ * @return None
+ *
+ * @note rows are never read past the file size the morsels were cut from
+ */
+void TableScan::forEachRecord( Morsel morsel, function< void( string &line, long offset ) > visit )
+{
+	int fd = ( snapshot != NULL ) ? snapshot->fd : open( filePath.c_str(), O_RDONLY );
+	if( fd < 0 )
+	{
+		return;
+	}
+
+	string page;
+	if( compressed && readPage( fd, morsel, page ) )
+	{
+		vector< string > lines;
+		if( !page.empty() && decodePage( page.substr( PAGE_HEADER_SIZE ), lines ) )
+		{
+			for( unsigned int index = 0; index < lines.size(); index++ )
+			{
+				visit( lines[ index ], morsel.startOffset );
+			}
+		}
+		if( snapshot == NULL )
+		{
+			close( fd );
+		}
+		return;
+	}
+
+	//a row starting before the morsel is the previous morsel's
+	bool skipPartial = false;
+	char previous;
+	if( morsel.startOffset > dataOffset && pread( fd, &previous, 1, morsel.startOffset - 1 ) == 1 )
+	{
+		skipPartial = ( previous != '\n' );
+	}
+
+	string buffer;
+	string line;
+	long bufferStart = morsel.startOffset;
+	size_t lineStart = 0;
+	size_t searchStart = 0;
+	while( true )
+	{
+		size_t newline = buffer.find( '\n', searchStart );
+		if( newline == string::npos )
+		{
+			//keep the unfinished row and read the next block behind it
+			buffer.erase( 0, lineStart );
+			bufferStart += lineStart;
+			lineStart = 0;
+			searchStart = buffer.size();
+
+			long readOffset = bufferStart + buffer.size();
+			long readSize = ( fileSize - readOffset < READ_BLOCK_SIZE ) ? fileSize - readOffset : READ_BLOCK_SIZE;
+			long bytesRead = 0;
+			if( readSize > 0 )
+			{
+				buffer.resize( searchStart + readSize );
+				bytesRead = pread( fd, &buffer[ searchStart ], readSize, readOffset );
+				buffer.resize( searchStart + ( bytesRead > 0 ? bytesRead : 0 ) );
+			}
+			if( bytesRead <= 0 )
+			{
+				//the last row of the file has no newline after it
+				if( !skipPartial && !buffer.empty() && bufferStart < morsel.endOffset )
+				{
+					visit( buffer, bufferStart );
+				}
+				break;
+			}
+			continue;
+		}
+
+		long rowStart = bufferStart + lineStart;
+		searchStart = newline + 1;
+		if( skipPartial )
+		{
+			skipPartial = false;
+			lineStart = searchStart;
+			continue;
+		}
+		if( rowStart >= morsel.endOffset )
+		{
+			break;
+		}
+		line.assign( buffer, lineStart, newline - lineStart );
+		lineStart = searchStart;
+		if( !line.empty() )
+		{
+			visit( line, rowStart );
+		}
+	}
+
+	if( snapshot == NULL )
+	{
+		close( fd );
+	}
+}
+
+/**
+ * @brief scanMorsel
+ *
+ * @details filters and projects every record that starts inside the morsel
+ *
+ * @par Algorithm a morsel whose zone rules out the condition is not read.
+ *      The condition is evaluated on dictionary codes, values are only
+ *      decoded once a record matched and was projected
+ *
+ * @param [in] Morsel morsel
+ *
+ * @param [in] WhereCondition wCond - empty operator matches every row
+ *
+ * @param [in] vector< int > projection - attribute indexes to keep
+ *
+ * @param [out] MorselResult &result
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TableScan::scanMorsel( Morsel morsel, WhereCondition wCond, vector< int > projection, MorselResult &result )
+{
+	if( !morselMayMatch( morsel, wCond ) )
+	{
+		return;
+	}
+	resolveCondition( wCond );
+	forEachRow( morsel, [ & ]( string &line )
+	{
+		addMatchingRow( line, wCond, projection, result );
+	} );
+}
+
+/**
+ * @brief addMatchingRow
+ *
+ * @details adds the projected values of a record satisfying a condition
+ *
+ * @param [in] const string &line - stored record
+ *
+ * @param [in] const WhereCondition &wCond - resolved
+ *
+ * @param [in] const vector< int > &projection - attribute indexes to keep
+ *
+ * @param [in/out] MorselResult &result
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TableScan::addMatchingRow( const string &line, const WhereCondition &wCond, const vector< int > &projection, MorselResult &result )
+{
+	int projectionSize = projection.size();
+	vector< string > row = readRow( line );
+	if( rowMatches( wCond, row ) )
+	{
+		vector< string > projected;
+		for( int index = 0; index < projectionSize; index++ )
+		{
+			if( projection[ index ] < (int) row.size() )
+			{
+				projected.push_back( decodeValue( projection[ index ], row[ projection[ index ] ] ) );
+			}
+			else
+			{
+				projected.push_back( "" );
+			}
+		}
+		result.rows.push_back( projected );
+	}
+}
+
+/**
+ * @brief readPage
+ *
+ * @details reads a morsel that is a page
+ *
+ * @param [in] int fd - open table file
+ *
+ * @param [in] const Morsel &morsel
+ *
+ * @param [out] string &page - header and content of the page, empty if the
+ *              page could not be read whole
+ *
+ * @return bool true if the morsel is a page
+ *
+ * @note None
+ */
+bool TableScan::readPage( int fd, const Morsel &morsel, string &page )
+{
+	char pageHeader[ PAGE_HEADER_SIZE ];
+	page.clear();
+	if( fd < 0 || pread( fd, pageHeader, PAGE_HEADER_SIZE, morsel.startOffset ) != PAGE_HEADER_SIZE || pageHeader[ 0 ] != PAGE_MARK )
+	{
+		return false;
+	}
+	long pageSize = PAGE_HEADER_SIZE + getPageContentSize( pageHeader );
+	if( morsel.startOffset + pageSize <= fileSize )
+	{
+		page.resize( pageSize );
+		if( pread( fd, &page[ 0 ], pageSize, morsel.startOffset ) != pageSize )
+		{
+			page.clear();
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief isClustered
+ *
+ * @details tells whether the records are kept in primary key order
+ *
+ * @return bool false for a table without a key, or whose key column was
+ *         modified since the file was written
+ *
+ * @note None
+ */
+bool TableScan::isClustered()
+{
+	return keyColumn >= 0 && !storedColumns[ keyColumn ].modified;
+}
+
+/**
+ * @brief isKeyAttribute
+ *
+ * @param [in] int attributeIndex
+ *
+ * @return bool true if the attribute is the key the records are kept in
+ *         the order of
+ *
+ * @note None
+ */
+bool TableScan::isKeyAttribute( int attributeIndex )
+{
+	return isClustered() && attributeIndex >= 0 && attributeIndex < (int) storedIndexes.size() && storedIndexes[ attributeIndex ] == keyColumn;
+}
+
+/**
+ * @brief getSortColumn
+ *
+ * @details finds the column a rewrite orders the written records by
+ *
+ * @par Algorithm a compaction orders by the key column in its converted
+ *      type, other rewrites only keep a clustered table in order
+ *
+ * @return int column of the written records, -1 if they keep their order
+ *
+ * @note sets sortType
+ */
+int TableScan::getSortColumn()
+{
+	sortType = TYPE_STRING;
+	int attributeSize = attributes.size();
+	for( int index = 0; index < attributeSize && compacting && keyColumn >= 0; index++ )
+	{
+		if( storedIndexes[ index ] == keyColumn )
+		{
+			sortType = getValueType( attributes[ index ].attributeType );
+			return index;
+		}
+	}
+	if( compacting || !isClustered() )
+	{
+		return -1;
+	}
+	sortType = getValueType( storedColumns[ keyColumn ].attribute.attributeType );
+	return keyColumn;
+}
+
+/**
+ * @brief getRecordValues
+ *
+ * @param [in] const string &record - record as the rewrite writes it
+ *
+ * @return vector< string > its values without the padding of a fixed width
+ *         record
+ *
+ * @note None
+ */
+vector< string > TableScan::getRecordValues( const string &record )
+{
+	vector< string > values = splitRow( record );
+	if( ( compacting ? rewriteWidth : recordWidth ) > 0 )
+	{
+		values.back().erase( values.back().find_last_not_of( ' ' ) + 1 );
+	}
+	return values;
+}
+
+/**
+ * @brief getRecordKey
+ *
+ * @param [in] const vector< string > &values - values of a written record
+ *
+ * @param [in] int column - key column of the written records
+ *
+ * @return string decoded key, empty if it is null
+ *
+ * @note None
+ */
+string TableScan::getRecordKey( const vector< string > &values, int column )
+{
+	return decodeOutputValue( column, ( column < (int) values.size() ) ? values[ column ] : "" );
+}
+
+/**
+ * @brief readRecordAt
+ *
+ * @details reads the first text record starting at or after an offset
+ *
+ * @param [in] int fd - open table file
+ *
+ * @param [in] long offset
+ *
+ * @param [out] long &recordStart - offset of the record
+ *
+ * @param [out] string &record
+ *
+ * @return bool false if no record starts at or after the offset
+ *
+ * @note None
+ */
+bool TableScan::readRecordAt( int fd, long offset, long &recordStart, string &record )
+{
+	//a record starts after a newline, or where the records start
+	bool started = offset <= dataOffset;
+	long readOffset = started ? dataOffset : offset - 1;
+	recordStart = readOffset;
+	record.clear();
+	vector< char > block( READ_BLOCK_SIZE );
+	while( readOffset < fileSize )
+	{
+		long readSize = ( fileSize - readOffset < READ_BLOCK_SIZE ) ? fileSize - readOffset : READ_BLOCK_SIZE;
+		long bytesRead = pread( fd, &block[ 0 ], readSize, readOffset );
+		if( bytesRead <= 0 )
+		{
+			return false;
+		}
+		const char *data = &block[ 0 ];
+		long index = 0;
+		if( !started )
+		{
+			const char *newline = (const char *) memchr( data, '\n', bytesRead );
+			if( newline == NULL )
+			{
+				readOffset += bytesRead;
+				continue;
+			}
+			started = true;
+			index = newline - data + 1;
+			recordStart = readOffset + index;
+		}
+		const char *end = (const char *) memchr( data + index, '\n', bytesRead - index );
+		if( end != NULL )
+		{
+			record.append( data + index, end - data - index );
+			return true;
+		}
+		record.append( data + index, bytesRead - index );
+		readOffset += bytesRead;
+	}
+	return started && !record.empty();
+}
+
+/**
+ * @brief readFirstKey
+ *
+ * @details reads the key of the first record of a morsel
+ *
+ * @param [in] int fd - open table file
+ *
+ * @param [in] const Morsel &morsel
+ *
+ * @param [out] string &key
+ *
+ * @return bool false if no record starts in the morsel
+ *
+ * @note None
+ */
+bool TableScan::readFirstKey( int fd, const Morsel &morsel, string &key )
+{
+	string record;
+	string page;
+	long recordStart;
+	if( compressed && readPage( fd, morsel, page ) )
+	{
+		vector< string > lines;
+		if( page.empty() || !decodePage( page.substr( PAGE_HEADER_SIZE ), lines ) || lines.empty() )
+		{
+			return false;
+		}
+		record = lines[ 0 ];
+	}
+	else if( !readRecordAt( fd, morsel.startOffset, recordStart, record ) || recordStart >= morsel.endOffset )
+	{
+		return false;
+	}
+	key = getRecordKey( getRecordValues( record ), keyColumn );
+	return true;
+}
+
+/**
+ * @brief getLastKey
+ *
+ * @details finds the key of the last record of a clustered table
+ *
+ * @par Algorithm a zoned last block has its largest key in its zone, as
+ *      nulls come first. Otherwise the last page is unpacked or the end of
+ *      the file read back to the start of its last record
+ *
+ * @param [out] string &key
+ *
+ * @return bool false if the table has no records
+ *
+ * @note None
+ */
+bool TableScan::getLastKey( string &key )
+{
+	vector< Morsel > morsels = getMorsels( MORSEL_SIZE );
+	if( morsels.empty() )
+	{
+		return false;
+	}
+	const Morsel &last = morsels.back();
+	if( zones != NULL && last.zoneIndex >= 0 && keyColumn < (int) ( *zones )[ last.zoneIndex ].maximums.size() )
+	{
+		key = ( *zones )[ last.zoneIndex ].maximums[ keyColumn ];
+		return true;
+	}
+
+	int fd = ( snapshot != NULL ) ? snapshot->fd : open( filePath.c_str(), O_RDONLY );
+	if( fd < 0 )
+	{
+		return false;
+	}
+	string page;
+	string record;
+	bool found = false;
+	if( compressed && readPage( fd, last, page ) )
+	{
+		vector< string > lines;
+		if( !page.empty() && decodePage( page.substr( PAGE_HEADER_SIZE ), lines ) && !lines.empty() )
+		{
+			record = lines.back();
+			found = true;
+		}
+	}
+	else
+	{
+		//the last record runs from the last newline to the end of the file
+		vector< char > block( READ_BLOCK_SIZE );
+		long readEnd = fileSize;
+		while( !found && readEnd > dataOffset - 1 && readEnd > 0 )
+		{
+			long readStart = max( readEnd - READ_BLOCK_SIZE, max( dataOffset - 1, 0L ) );
+			long bytesRead = pread( fd, &block[ 0 ], readEnd - readStart, readStart );
+			if( bytesRead != readEnd - readStart )
+			{
+				break;
+			}
+			for( long index = bytesRead - 1; index >= 0 && !found; index-- )
+			{
+				if( block[ index ] == '\n' || readStart + index < dataOffset )
+				{
+					found = true;
+					record = string( &block[ 0 ] + index + 1, bytesRead - index - 1 ) + record;
+				}
+			}
+			if( !found )
+			{
+				record = string( &block[ 0 ], bytesRead ) + record;
+			}
+			readEnd = readStart;
+		}
+		found = found && !record.empty();
+	}
+	if( snapshot == NULL )
+	{
+		close( fd );
+	}
+	if( found )
+	{
+		key = getRecordKey( getRecordValues( record ), keyColumn );
+	}
+	return found;
+}
+
+/**
+ * @brief findMorsel
+ *
+ * @details finds the last morsel of a clustered table starting with a key
+ *          below a value
+ *
+ * @par Algorithm binary search on the first key of the morsels. A morsel
+ *      without records takes the first key of the next one that has some
+ *
+ * @param [in] int fd - open table file
+ *
+ * @param [in] const vector< Morsel > &morsels
+ *
+ * @param [in] const string &key - decoded value
+ *
+ * @param [in] bool upper - a first key equal to the value counts as below
+ *
+ * @return int morsel index, -1 if every morsel starts at or above the value
+ *
+ * @note None
+ */
+int TableScan::findMorsel( int fd, const vector< Morsel > &morsels, const string &key, bool upper )
+{
+	int low = 0;
+	int high = morsels.size();
+	while( low < high )
+	{
+		int middle = low + ( high - low ) / 2;
+		int probe = middle;
+		string firstKey;
+		while( probe < high && !readFirstKey( fd, morsels[ probe ], firstKey ) )
+		{
+			probe++;
+		}
+		int comparison = ( probe < high ) ? compareKeys( firstKey, key, sortType ) : 1;
+		if( comparison < 0 || ( upper && comparison == 0 ) )
+		{
+			low = probe + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low - 1;
+}
+
+/**
+ * @brief findKeyMorsels
+ *
+ * @details finds the morsels of a clustered table that can hold records
+ *          satisfying a comparison with the key
+ *
+ * @param [in] int fd - open table file
+ *
+ * @param [in] const vector< Morsel > &morsels
+ *
+ * @param [in] const WhereCondition &wCond
+ *
+ * @param [out] int &first
+ *
+ * @param [out] int &last - below first if no morsel can
+ *
+ * @return bool false if the condition does not compare the key the way
+ *         the records are ordered, floats included as those that are not a
+ *         number equal every value
+ *
+ * @note sets sortType
+ */
+bool TableScan::findKeyMorsels( int fd, const vector< Morsel > &morsels, const WhereCondition &wCond, int &first, int &last )
+{
+	const string &operatorValue = wCond.operatorValue;
+	int keyType = isKeyAttribute( wCond.attributeIndex ) ? getValueType( storedColumns[ keyColumn ].attribute.attributeType ) : TYPE_FLOAT;
+	if( fd < 0 || keyType == TYPE_FLOAT || wCond.comparisonValue.empty() || wCond.floatValue || wCond.intValue != ( keyType == TYPE_INT ) ||
+		( operatorValue != "=" && operatorValue != "<" && operatorValue != "<=" && operatorValue != ">" && operatorValue != ">=" ) )
+	{
+		return false;
+	}
+
+	sortType = keyType;
+	first = 0;
+	last = morsels.size() - 1;
+	if( operatorValue == "=" || operatorValue == ">=" )
+	{
+		first = max( findMorsel( fd, morsels, wCond.comparisonValue, false ), 0 );
+	}
+	else if( operatorValue == ">" )
+	{
+		first = max( findMorsel( fd, morsels, wCond.comparisonValue, true ), 0 );
+	}
+	if( operatorValue == "=" || operatorValue == "<=" )
+	{
+		last = findMorsel( fd, morsels, wCond.comparisonValue, true );
+	}
+	else if( operatorValue == "<" )
+	{
+		last = findMorsel( fd, morsels, wCond.comparisonValue, false );
+	}
+	return true;
+}
+
+/**
+ * @brief bisectMorsel
+ *
+ * @details narrows a text morsel of a clustered table to where its keys
+ *          reach a value
+ *
+ * @par Algorithm binary search on the byte range, reading the first record
+ *      after the middle, until the range left fits in one read
+ *
+ * @param [in] int fd - open table file
+ *
+ * @param [in/out] Morsel &morsel
+ *
+ * @param [in] const string &key - decoded value
+ *
+ * @param [in] bool upper - searches for the first key above the value
+ *             rather than the first one not below it
+ *
+ * @param [in] bool lowerEnd - moves the start of the morsel up to the
+ *             found record, otherwise its end down to it
+ *
+ * @return None
+ *
+ * @note pages are left whole
+ */
+void TableScan::bisectMorsel( int fd, Morsel &morsel, const string &key, bool upper, bool lowerEnd )
+{
+	char mark;
+	if( compressed && pread( fd, &mark, 1, morsel.startOffset ) == 1 && mark == PAGE_MARK )
+	{
+		return;
+	}
+
+	//records starting before low are below the key, those from high on not
+	long low = morsel.startOffset;
+	long high = morsel.endOffset;
+	while( high - low > READ_BLOCK_SIZE )
+	{
+		long middle = low + ( high - low ) / 2;
+		long recordStart;
+		string record;
+		if( !readRecordAt( fd, middle, recordStart, record ) || recordStart >= high )
+		{
+			high = middle;
+			continue;
+		}
+		int comparison = compareKeys( getRecordKey( getRecordValues( record ), keyColumn ), key, sortType );
+		if( comparison > 0 || ( !upper && comparison == 0 ) )
+		{
+			high = middle;
+		}
+		else
+		{
+			low = recordStart + 1;
+		}
+	}
+	if( lowerEnd )
+	{
+		morsel.startOffset = low;
+	}
+	else
+	{
+		morsel.endOffset = high;
+	}
+}
+
+/**
+ * @brief narrowMorsels
+ *
+ * @details drops the morsels of a clustered table that cannot hold records
+ *          satisfying a comparison with the key
+ *
+ * @par Algorithm the first and last morsel that can are found by binary
+ *      search on their first keys, then the end morsels are cut down to
+ *      the records in range by binary search within them
+ *
+ * @param [in/out] vector< Morsel > &morsels - from getMorsels
+ *
+ * @param [in] const WhereCondition &wCond
+ *
+ * @return None
+ *
+ * @note other conditions leave the morsels as they are
+ */
+void TableScan::narrowMorsels( vector< Morsel > &morsels, const WhereCondition &wCond )
+{
+	if( morsels.empty() || !isKeyAttribute( wCond.attributeIndex ) )
+	{
+		return;
+	}
+	int fd = ( snapshot != NULL ) ? snapshot->fd : open( filePath.c_str(), O_RDONLY );
+	int first;
+	int last;
+	if( findKeyMorsels( fd, morsels, wCond, first, last ) )
+	{
+		const string &operatorValue = wCond.operatorValue;
+		morsels.erase( morsels.begin() + last + 1, morsels.end() );
+		morsels.erase( morsels.begin(), morsels.begin() + min( first, last + 1 ) );
+		if( !morsels.empty() && ( operatorValue == "=" || operatorValue == ">=" || operatorValue == ">" ) )
+		{
+			bisectMorsel( fd, morsels.front(), wCond.comparisonValue, operatorValue == ">", true );
+		}
+		if( !morsels.empty() && ( operatorValue == "=" || operatorValue == "<=" || operatorValue == "<" ) )
+		{
+			bisectMorsel( fd, morsels.back(), wCond.comparisonValue, operatorValue != "<", false );
+		}
+	}
+	if( fd >= 0 && snapshot == NULL )
+	{
+		close( fd );
+	}
+}
+
+/**
+ * @brief appendsInOrder
+ *
+ * @details tells whether records appended to a clustered table keep it in
+ *          key order
+ *
+ * @param [in] const vector< vector< string > > &rows - stored values of the
+ *             records in the order they are appended
+ *
+ * @return bool true if no key is below the one before it
+ *
+ * @note None
+ */
+bool TableScan::appendsInOrder( const vector< vector< string > > &rows )
+{
+	if( !isClustered() || rows.empty() )
+	{
+		return true;
+	}
+	int keyType = getValueType( storedColumns[ keyColumn ].attribute.attributeType );
+	string previous;
+	bool hasPrevious = getLastKey( previous );
+	int rowSize = rows.size();
+	for( int index = 0; index < rowSize; index++ )
+	{
+		string key = getInsertKey( rows[ index ] );
+		if( hasPrevious && compareKeys( key, previous, keyType ) < 0 )
+		{
+			return false;
+		}
+		previous = key;
+		hasPrevious = true;
+	}
+	return true;
+}
+
+/**
+ * @brief addPlacedRecord
+ *
+ * @details collects a record to insert into a clustered table where its
+ *          key belongs, once placeRecords is called
+ *
+ * @param [in] const vector< string > &values - stored values, padded for a
+ *             fixed width table
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TableScan::addPlacedRecord( const vector< string > &values )
+{
+	SortedRecord placed;
+	placed.values = values;
+	if( recordWidth > 0 && !placed.values.empty() )
+	{
+		placed.values.back().erase( placed.values.back().find_last_not_of( ' ' ) + 1 );
+	}
+	placed.key = getRecordKey( placed.values, keyColumn );
+	placed.record = joinRow( values );
+	placedRecords.push_back( placed );
+}
+
+/**
+ * @brief placeRecords
+ *
+ * @details inserts the collected records into a clustered table where
+ *          their keys belong
+ *
+ * @par Algorithm one rewrite routes every record to the morsel its key
+ *      falls in. Every other morsel with a zone is copied unread, so only
+ *      the receiving blocks are sorted and split into zones again
+ *
+ * @return int records placed, -1 if the rewrite failed
+ *
+ * @note the collected records are dropped either way
+ */
+int TableScan::placeRecords()
+{
+	int placedSize = placedRecords.size();
+	int recordCount = parallelRewrite( []( vector< string > &row )
+	{
+		return ROW_KEEP;
+	}, NULL );
+	placedRecords.clear();
+	return ( recordCount < 0 ) ? -1 : placedSize;
+}
+
+/**
+ * @brief getInsertKey
+ *
+ * @param [in] const vector< string > &values - stored values of a record to
+ *             insert, padded for a fixed width table
+ *
+ * @return string decoded key, empty if it is null
+ *
+ * @note None
+ */
+string TableScan::getInsertKey( const vector< string > &values )
+{
+	vector< string > unpadded = values;
+	if( recordWidth > 0 && !unpadded.empty() )
+	{
+		unpadded.back().erase( unpadded.back().find_last_not_of( ' ' ) + 1 );
+	}
+	return getRecordKey( unpadded, keyColumn );
+}
+
+/**
+ * @brief getFileToken
+ *
+ * @return string zone token in the attribute line of the file being read,
+ *         empty if it has none
+ *
+ * @note None
+ */
+string TableScan::getFileToken()
+{
+	size_t fieldIndex = attributeData.find( "\t" + ZONES_FIELD + " " );
+	int fd = ( snapshot != NULL ) ? snapshot->fd : open( filePath.c_str(), O_RDONLY );
+	char token[ ZONE_TOKEN_SIZE ];
+	bool found = fd >= 0 && fieldIndex != string::npos &&
+		pread( fd, token, ZONE_TOKEN_SIZE, fieldIndex + ZONES_FIELD.size() + 2 ) == ZONE_TOKEN_SIZE;
+	if( fd >= 0 && snapshot == NULL )
+	{
+		close( fd );
+	}
+	return found ? string( token, ZONE_TOKEN_SIZE ) : "";
+}
+
+/**
+ * @brief readOverflow
+ *
+ * @details reads the records of a clustered table kept in its overflow file
+ *
+ * @param [out] vector< string > &records - records in the order they were
+ *              inserted
+ *
+ * @return bool true if the file belongs to the file being read and holds
+ *         records
+ *
+ * @note a stale file, or one next to a staged copy, is not read
+ */
+bool TableScan::readOverflow( vector< string > &records )
+{
+	records.clear();
+	ifstream fin( overflowFilePath.c_str(), ifstream::binary );
+	string line;
+	if( overflowFilePath.empty() || !fin || !getline( fin, line ) || line.empty() || line != getFileToken() )
+	{
+		return false;
+	}
+	while( getline( fin, line ) )
+	{
+		records.push_back( line );
+	}
+	return !records.empty();
+}
+
+/**
+ * @brief getOverflowSize
+ *
+ * @return long bytes the records of the overflow file take, each with the
+ *         newline before it. 0 if it is stale or missing
+ *
+ * @note None
+ */
+long TableScan::getOverflowSize()
+{
+	ifstream fin( overflowFilePath.c_str(), ifstream::binary );
+	string token;
+	if( overflowFilePath.empty() || !fin || !getline( fin, token ) || token.empty() || token != getFileToken() )
+	{
+		return 0;
+	}
+	fin.clear();
+	fin.seekg( 0, ifstream::end );
+	return (long) fin.tellg() - ZONE_TOKEN_SIZE;
+}
+
+/**
+ * @brief writeOverflow
+ *
+ * @details adds a record to the overflow file of a clustered table
+ *
+ * @par Algorithm a missing or stale file is started again with the token of
+ *      the table file. Like an insert redone at the end of a table, a
+ *      record already whole at its offset is left alone and a torn one is
+ *      cut off and written again
+ *
+ * @param [in] const vector< string > &values - stored values, padded for a
+ *             fixed width table
+ *
+ * @param [in] long offset - where the record starts, -1 at the end
+ *
+ * @return bool false if the record could not be written
+ *
+ * @note the caller holds the table lock exclusively
+ */
+bool TableScan::writeOverflow( const vector< string > &values, long offset )
+{
+	string token = getFileToken();
+	int fd = token.empty() ? -1 : open( overflowFilePath.c_str(), O_RDWR | O_CREAT, 0644 );
+	struct stat buffer;
+	if( fd < 0 || fstat( fd, &buffer ) != 0 )
+	{
+		if( fd >= 0 )
+		{
+			close( fd );
+		}
+		return false;
+	}
+
+	long overflowSize = buffer.st_size;
+	char fileToken[ ZONE_TOKEN_SIZE ];
+	bool written = true;
+	if( overflowSize < ZONE_TOKEN_SIZE || pread( fd, fileToken, ZONE_TOKEN_SIZE, 0 ) != ZONE_TOKEN_SIZE ||
+		token.compare( 0, ZONE_TOKEN_SIZE, fileToken, ZONE_TOKEN_SIZE ) != 0 )
+	{
+		written = ftruncate( fd, 0 ) == 0 && pwrite( fd, token.c_str(), ZONE_TOKEN_SIZE, 0 ) == ZONE_TOKEN_SIZE;
+		overflowSize = ZONE_TOKEN_SIZE;
+	}
+	string content = "\n" + joinRow( values );
+	if( offset < 0 )
+	{
+		offset = overflowSize;
+	}
+	if( written && overflowSize < offset + (long) content.size() )
+	{
+		if( overflowSize > offset && ftruncate( fd, offset ) == 0 )
+		{
+			overflowSize = offset;
+		}
+		written = pwrite( fd, content.c_str(), content.size(), overflowSize ) == (long) content.size();
+	}
+	close( fd );
+	return written;
+}
+
+/**
+ * @brief getKeyAttribute
+ *
+ * @return int attribute index of the primary key, -1 if the table has none
+ *
+ * @note None
+ */
+int TableScan::getKeyAttribute()
+{
+	int attributeSize = storedIndexes.size();
+	for( int index = 0; index < attributeSize && keyColumn >= 0; index++ )
+	{
+		if( storedIndexes[ index ] == keyColumn )
+		{
+			return index;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief getUniqueAttributes
+ *
+ * @return vector< int > attribute indexes of the columns whose values must
+ *         be unique, the primary key first
+ *
+ * @note None
+ */
+vector< int > TableScan::getUniqueAttributes()
+{
+	vector< int > uniqueAttributes;
+	int keyAttribute = getKeyAttribute();
+	if( keyAttribute >= 0 )
+	{
+		uniqueAttributes.push_back( keyAttribute );
+	}
+	int attributeSize = storedIndexes.size();
+	for( int index = 0; index < attributeSize; index++ )
+	{
+		if( find( uniqueStoredColumns.begin(), uniqueStoredColumns.end(), storedIndexes[ index ] ) != uniqueStoredColumns.end() )
+		{
+			uniqueAttributes.push_back( index );
+		}
+	}
+	return uniqueAttributes;
+}
+
+/**
+ * @brief getUniqueValue
+ *
+ * @details gives the value of a unique column the index keeps for a record
+ *
+ * @par Algorithm floats are equal by value, so they are written out again
+ *      in one form
+ *
+ * @param [in] int attributeIndex
+ *
+ * @param [in] const vector< string > &row - record as readRow returns it
+ *
+ * @return string decoded value, empty if it is null
+ *
+ * @note None
+ */
+string TableScan::getUniqueValue( int attributeIndex, const vector< string > &row )
+{
+	string value = ( attributeIndex < (int) row.size() ) ? decodeValue( attributeIndex, row[ attributeIndex ] ) : "";
+	if( isNullValue( value ) )
+	{
+		return "";
+	}
+	if( getValueType( attributes[ attributeIndex ].attributeType ) == TYPE_FLOAT )
+	{
+		char number[ 32 ];
+		snprintf( number, sizeof( number ), "%.17g", atof( value.c_str() ) );
+		return number;
+	}
+	return value;
+}
+
+/**
+ * @brief buildUniqueIndex
+ *
+ * @details counts the records holding each value of the unique columns
+ *
+ * @par Algorithm morsels collect their values in parallel, which are then
+ *      counted into one hash table per column. Scans of the other files
+ *      the engine keeps records in are cut into morsels along with it, the
+ *      records it keeps in memory follow
+ *
+ * @param [out] UniqueIndex &index - versions are left to the caller
+ *
+ * @param [in] vector< TableScan > &moreScans - scans of the other files
+ *
+ * @param [in] const vector< string > &moreRecords - records in memory
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TableScan::buildUniqueIndex( UniqueIndex &index, vector< TableScan > &moreScans, const vector< string > &moreRecords )
+{
+	index.attributes = getUniqueAttributes();
+	int columnSize = index.attributes.size();
+	index.counts.assign( columnSize, unordered_map< string, long >() );
+	index.changes.assign( columnSize, map< string, long >() );
+	index.added.clear();
+
+	vector< Morsel > morsels = getMorsels( MORSEL_SIZE );
+	vector< TableScan * > morselScans( morsels.size(), this );
+	for( unsigned int scan = 0; scan < moreScans.size(); scan++ )
+	{
+		vector< Morsel > scanMorsels = moreScans[ scan ].getMorsels( MORSEL_SIZE );
+		morsels.insert( morsels.end(), scanMorsels.begin(), scanMorsels.end() );
+		morselScans.insert( morselScans.end(), scanMorsels.size(), &moreScans[ scan ] );
+	}
+	int morselCount = morsels.size();
+	vector< vector< vector< string > > > morselValues( morselCount + 1, vector< vector< string > >( columnSize ) );
+	function< void( int morselIndex, const string &line ) > addValues = [ & ]( int morselIndex, const string &line )
+	{
+		vector< string > row = readRow( line );
+		for( int column = 0; column < columnSize; column++ )
+		{
+			string value = getUniqueValue( index.attributes[ column ], row );
+			if( !value.empty() )
+			{
+				morselValues[ morselIndex ][ column ].push_back( value );
+			}
+		}
+	};
+	parallelFor( morselCount, [ & ]( int morselIndex )
+	{
+		morselScans[ morselIndex ]->forEachRow( morsels[ morselIndex ], [ & ]( string &line )
+		{
+			addValues( morselIndex, line );
+		} );
+	} );
+	for( unsigned int record = 0; record < moreRecords.size(); record++ )
+	{
+		addValues( morselCount, moreRecords[ record ] );
+	}
+	morselCount++;
+	for( int column = 0; column < columnSize; column++ )
+	{
+		long valueCount = 0;
+		for( int morselIndex = 0; morselIndex < morselCount; morselIndex++ )
+		{
+			valueCount += morselValues[ morselIndex ][ column ].size();
+		}
+		index.counts[ column ].reserve( valueCount );
+	}
+	for( int morselIndex = 0; morselIndex < morselCount; morselIndex++ )
+	{
+		for( int column = 0; column < columnSize; column++ )
+		{
+			vector< string > &values = morselValues[ morselIndex ][ column ];
+			for( unsigned int value = 0; value < values.size(); value++ )
+			{
+				index.counts[ column ][ move( values[ value ] ) ]++;
+			}
+			vector< string >().swap( values );
+		}
+	}
+}
+
+/**
+ * @brief recordUniqueChanges
+ *
+ * @details notes how a rewrite changes the values of the unique columns
+ *          of one record
+ *
+ * @param [in] const vector< string > &before - record as it was read
+ *
+ * @param [in] const vector< string > &after - record after rowAction
+ *
+ * @param [in] int action - ROW_CHANGED or ROW_DELETE
+ *
+ * @param [out] vector< pair< int, string > > &removed - column of the index
+ *              and value
+ *
+ * @param [out] vector< pair< int, string > > &added
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TableScan::recordUniqueChanges( const vector< string > &before, const vector< string > &after, int action,
+	vector< pair< int, string > > &removed, vector< pair< int, string > > &added )
+{
+	int columnSize = uniqueIndex->attributes.size();
+	for( int column = 0; column < columnSize; column++ )
+	{
+		string oldValue = getUniqueValue( uniqueIndex->attributes[ column ], before );
+		string newValue = ( action == ROW_CHANGED ) ? getUniqueValue( uniqueIndex->attributes[ column ], after ) : "";
+		if( action == ROW_CHANGED && oldValue == newValue )
+		{
+			continue;
+		}
+		if( !oldValue.empty() )
+		{
+			removed.push_back( make_pair( column, oldValue ) );
+		}
+		if( !newValue.empty() )
+		{
+			added.push_back( make_pair( column, newValue ) );
+		}
+	}
+}
+
+/**
+ * @brief applyUniqueChanges
+ *
+ * @details adds the changes partitions noted to the unique index
+ *
+ * @param [in/out] vector< vector< pair< int, string > > > &removed - one
+ *                 list per partition, emptied
+ *
+ * @param [in/out] vector< vector< pair< int, string > > > &added
+ *
+ * @return None
+ *
+ * @note the new values are kept for checkUniqueValues
+ */
+void TableScan::applyUniqueChanges( vector< vector< pair< int, string > > > &removed, vector< vector< pair< int, string > > > &added )
+{
+	for( unsigned int partition = 0; partition < removed.size(); partition++ )
+	{
+		for( unsigned int index = 0; index < removed[ partition ].size(); index++ )
+		{
+			uniqueIndex->changes[ removed[ partition ][ index ].first ][ removed[ partition ][ index ].second ]--;
+		}
+		removed[ partition ].clear();
+	}
+	for( unsigned int partition = 0; partition < added.size(); partition++ )
+	{
+		for( unsigned int index = 0; index < added[ partition ].size(); index++ )
+		{
+			uniqueIndex->changes[ added[ partition ][ index ].first ][ added[ partition ][ index ].second ]++;
+			uniqueIndex->added.push_back( added[ partition ][ index ] );
+		}
+		added[ partition ].clear();
+	}
+}
+
+/**
+ * @brief addUniqueRecord
+ *
+ * @details adds the values of an inserted record to the unique index
+ *
+ * @param [in] const vector< string > &values - stored values of the record
+ *
+ * @param [out] string &violation - column and value already taken
+ *
+ * @return bool false if a value is already taken
+ *
+ * @note uniqueIndex must be set
+ */
+bool TableScan::addUniqueRecord( const vector< string > &values, string &violation )
+{
+	vector< string > row = readRow( joinRow( values ) );
+	int columnSize = uniqueIndex->attributes.size();
+	for( int column = 0; column < columnSize; column++ )
+	{
+		string value = getUniqueValue( uniqueIndex->attributes[ column ], row );
+		if( !value.empty() )
+		{
+			uniqueIndex->changes[ column ][ value ]++;
+			uniqueIndex->added.push_back( make_pair( column, value ) );
+		}
+	}
+	return checkUniqueValues( violation );
+}
+
+/**
+ * @brief checkUniqueValues
+ *
+ * @details probes the unique index for the values the last statement gave
+ *          records
+ *
+ * @par Algorithm the count of a value is its count at the indexed version
+ *      plus the changes of the transaction so far, one lookup each
+ *
+ * @param [out] string &violation - column and value held by more than one
+ *              record
+ *
+ * @return bool false if a value is held by more than one record
+ *
+ * @note the values are forgotten once checked
+ */
+bool TableScan::checkUniqueValues( string &violation )
+{
+	bool unique = true;
+	for( unsigned int index = 0; index < uniqueIndex->added.size() && unique; index++ )
+	{
+		int column = uniqueIndex->added[ index ].first;
+		const string &value = uniqueIndex->added[ index ].second;
+		unordered_map< string, long >::const_iterator counted = uniqueIndex->counts[ column ].find( value );
+		map< string, long >::const_iterator changed = uniqueIndex->changes[ column ].find( value );
+		long count = ( counted == uniqueIndex->counts[ column ].end() ? 0 : counted->second ) +
+			( changed == uniqueIndex->changes[ column ].end() ? 0 : changed->second );
+		if( count > 1 )
+		{
+			violation = attributes[ uniqueIndex->attributes[ column ] ].attributeName + " = " + value;
+			unique = false;
+		}
+	}
+	uniqueIndex->added.clear();
+	return unique;
+}
+
+/**
+ * @brief getWorkPath
+ *
+ * @details builds the path of a hidden work file next to a table file
+ *
+ * @param [in] string tableFilePath
+ *
+ * @param [in] string suffix
+ *
+ * @return string path of the form directory/.table.suffix
+ *
+ * @note hidden files are not loaded as tables
+ */
+string getWorkPath( string tableFilePath, string suffix )
+{
+	size_t slashIndex = tableFilePath.find_last_of( '/' );
+	return tableFilePath.substr( 0, slashIndex + 1 ) + "." + tableFilePath.substr( slashIndex + 1 ) + "." + suffix;
+}
+
+/**
+ * @brief syncFile
+ *
+ * @details flushes a file to disk
+ *
+ * @param [in] string path
+ *
+ * @return bool true if the file exists and was synced
+ *
+ * @note None
+ */
+bool syncFile( string path )
+{
+	int fd = open( path.c_str(), O_RDONLY );
+	if( fd < 0 )
+	{
+		return false;
+	}
+	bool synced = fsync( fd ) == 0;
+	close( fd );
+	return synced;
+}
+
+/**
+ * @brief syncDirectory
+ *
+ * @details flushes the directory holding a file, making creates and renames
+ *          of the file durable
+ *
+ * @param [in] string filePath
+ *
+ * @return bool true if the directory was synced
+ *
+ * @note None
+ */
+bool syncDirectory( string filePath )
+{
+	size_t slashIndex = filePath.find_last_of( '/' );
+	if( slashIndex == string::npos )
+	{
+		return syncFile( "." );
+	}
+	return syncFile( filePath.substr( 0, slashIndex + 1 ) );
+}
+
+/**
+ * @brief copyFile
+ *
+ * @details copies a file byte for byte and syncs the copy
+ *
+ * @param [in] string sourcePath
+ *
+ * @param [in] string targetPath - created or truncated
+ *
+ * @return bool true if the whole file was copied
+ *
+ * @note None
+ */
+bool copyFile( string sourcePath, string targetPath )
+{
+	int sourceFd = open( sourcePath.c_str(), O_RDONLY );
+	if( sourceFd < 0 )
+	{
+		return false;
+	}
+	int targetFd = open( targetPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	if( targetFd < 0 )
+	{
+		close( sourceFd );
+		return false;
+	}
+
+	bool copyValid = true;
+	vector< char > buffer( READ_BLOCK_SIZE );
+	long bytesRead;
+	while( ( bytesRead = read( sourceFd, &buffer[ 0 ], buffer.size() ) ) > 0 )
+	{
+		if( write( targetFd, &buffer[ 0 ], bytesRead ) != bytesRead )
+		{
+			copyValid = false;
+			break;
+		}
+	}
+	copyValid = copyValid && bytesRead >= 0 && fsync( targetFd ) == 0;
+	close( sourceFd );
+	close( targetFd );
+	return copyValid;
+}
+
+/**
+ * @brief writeRecords
+ *
+ * @details overwrites records of a fixed width table where they are
+ *
+ * @param [in] string tableFilePath
+ *
+ * @param [in] const map< long, string > &writes - new record by offset,
+ *             each as long as the one it replaces
+ *
+ * @return bool true if every record was written
+ *
+ * @note the file is not synced, the writes are in the commit log
+ */
+bool writeRecords( string tableFilePath, const map< long, string > &writes )
+{
+	int fd = open( tableFilePath.c_str(), O_WRONLY );
+	if( fd < 0 )
+	{
+		return false;
+	}
+
+	bool writeValid = true;
+	for( map< long, string >::const_iterator it = writes.begin(); it != writes.end(); ++it )
+	{
+		writeValid = pwrite( fd, it->second.c_str(), it->second.size(), it->first ) == (long) it->second.size() && writeValid;
+	}
+	close( fd );
+	return writeValid;
+}
+
+/**
+ * @brief getTempPath
+ *
+ * @details builds the path of a hidden work file next to the table file
+ *
+ * @param [in] string suffix
+ *
+ * @return string path of the form directory/.table.suffix, or
+ *         rewritePath.suffix when the rewrite goes to a work file
+ *
+ * @note hidden files are not loaded as tables. A rewrite to a work file may
+ *       run alongside a writer of the table, so its files are kept apart
+ */
+string TableScan::getTempPath( string suffix )
+{
+	if( !rewritePath.empty() )
+	{
+		return rewritePath + "." + suffix;
+	}
+	return getWorkPath( filePath, suffix );
+}
+
+/**
+ * @brief parallelRewrite
+ *
+ * @details rewrites the table, letting rowAction keep, change or drop records
+ *
+ * @par Algorithm every morsel is a partition. Partitions are evaluated in
+ *      parallel and each writes its surviving records to its own work file.
+ *      The work files are then stitched behind the attribute line into one
+ *      new table file, which is renamed over the old one so readers see
+ *      either the old or the new table and never a half written one. When
+ *      rewritePath is set the new file is renamed there instead and the
+ *      table is left untouched. The records of a compressed table are
+ *      packed into pages again, including the text records behind its pages.
+ *      Each partition keeps the range of the records it writes, which become
+ *      the zones of the new file along with the Bloom filters of its values.
+ *      A morsel whose zone rules out skipCondition is copied without
+ *      evaluating its records and keeps its zone's range and filters.
+ *      A partition of a clustered table sorts its records by key, taking
+ *      in the placed records whose key falls in it, and is split into
+ *      zones of about a morsel. Zoned morsels a condition on the key rules
+ *      out, or that no record is placed in, are copied. The records of the
+ *      overflow file are evaluated too, and those kept are placed like the
+ *      inserted ones, or go to the last partition when there is no key to
+ *      place them by. Partitions whose keys leave the range they held are
+ *      merged into one, as are the partitions with the runs folded into an
+ *      LSM table
+ *
+ * @param [in] function< int( vector< string > &row ) > rowAction - returns
+ *             ROW_KEEP, ROW_CHANGED (row was modified) or ROW_DELETE
+ *
+ * @param [in] const WhereCondition *skipCondition - condition rowAction
+ *             keeps every record failing, NULL if there is none
+ *
+ * @return int number of records changed or deleted, -1 if the rewrite failed
+ *
+ * @note None
+ */
+int TableScan::parallelRewrite( function< int( vector< string > &row ) > rowAction, const WhereCondition *skipCondition )
+{
+	if( pendingWrites != NULL )
+	{
+		return collectWrites( rowAction, skipCondition );
+	}
+
+	vector< Morsel > morsels = getMorsels( MORSEL_SIZE );
+	int sortColumn = getSortColumn();
+	setZoneColumns();
+	if( !compacting )
+	{
+		loadFilters( NULL );
+	}
+	vector< string > overflowRecords;
+	readOverflow( overflowRecords );
+	if( morsels.empty() && ( !placedRecords.empty() || !overflowRecords.empty() ) )
+	{
+		Morsel morsel;
+		morsel.startOffset = dataOffset;
+		morsel.endOffset = dataOffset;
+		morsel.zoneIndex = -1;
+		morsels.push_back( morsel );
+	}
+	int partitionCount = morsels.size();
+	vector< string > partitionPaths( partitionCount );
+	vector< int > partitionCounts( partitionCount, 0 );
+	vector< bool > partitionWritten( partitionCount, false );
+	int columnSize = columnTypes.size();
+	Zone emptyZone;
+	emptyZone.minimums.resize( columnSize );
+	emptyZone.maximums.resize( columnSize );
+	vector< vector< Zone > > partitionZones( partitionCount );
+
+	//values of the unique columns the rewrite takes from records and gives
+	//them, per partition
+	vector< vector< pair< int, string > > > removedValues( partitionCount ), addedValues( partitionCount );
+	function< int( int index, vector< string > &row ) > evaluateRow = [ & ]( int index, vector< string > &row )
+	{
+		if( uniqueIndex == NULL )
+		{
+			return rowAction( row );
+		}
+		vector< string > before = row;
+		int action = rowAction( row );
+		if( action != ROW_KEEP )
+		{
+			recordUniqueChanges( before, row, action, removedValues[ index ], addedValues[ index ] );
+		}
+		return action;
+	};
+
+	//the records of the overflow file are evaluated first, those kept are
+	//placed like inserted ones. Their changes count towards the first
+	//partition, as the partitions are not evaluated yet
+	vector< SortedRecord > placing = ( sortColumn >= 0 ) ? placedRecords : vector< SortedRecord >();
+	bool overflowFits = true;
+	int overflowSize = overflowRecords.size();
+	for( int index = 0; index < overflowSize; index++ )
+	{
+		vector< string > row = readRow( overflowRecords[ index ] );
+		int action = evaluateRow( 0, row );
+		if( action != ROW_KEEP )
+		{
+			partitionCounts[ 0 ]++;
+		}
+		if( action == ROW_DELETE )
+		{
+			continue;
+		}
+		SortedRecord record;
+		record.values = compacting ? row : storeRow( row );
+		record.key = ( sortColumn >= 0 ) ? getRecordKey( record.values, sortColumn ) : "";
+		if( action == ROW_KEEP && !compacting )
+		{
+			record.record = overflowRecords[ index ];
+		}
+		else
+		{
+			vector< string > stored = record.values;
+			overflowFits = padRecord( stored, compacting ? rewriteWidth : recordWidth ) && overflowFits;
+			record.record = joinRow( stored );
+		}
+		placing.push_back( record );
+	}
+
+	//a placed record goes to the last morsel starting with a key not above
+	//its own, which may then reach up to the first key of the next morsel.
+	//Without a key to search by it goes to the last morsel
+	int fd = ( snapshot != NULL ) ? snapshot->fd : ( sortColumn >= 0 && !compacting ) ? open( filePath.c_str(), O_RDONLY ) : -1;
+	vector< vector< SortedRecord > > partitionPlaced( partitionCount );
+	//upperBounds is 1 when a partition may reach up to its upperKeys, 2 when
+	//no morsel after it has records and 0 when nothing was placed in it
+	vector< string > upperKeys( partitionCount );
+	vector< int > upperBounds( partitionCount, 0 );
+	int placedSize = placing.size();
+	for( int index = 0; index < placedSize; index++ )
+	{
+		if( sortColumn < 0 || compacting )
+		{
+			partitionPlaced[ partitionCount - 1 ].push_back( placing[ index ] );
+			continue;
+		}
+		int target = max( findMorsel( fd, morsels, placing[ index ].key, true ), 0 );
+		partitionPlaced[ target ].push_back( placing[ index ] );
+		if( upperBounds[ target ] != 0 )
+		{
+			continue;
+		}
+		int next = target + 1;
+		while( next < partitionCount && !readFirstKey( fd, morsels[ next ], upperKeys[ target ] ) )
+		{
+			next++;
+		}
+		upperBounds[ target ] = ( next < partitionCount ) ? 1 : 2;
+	}
+	int firstKeyMorsel = 0;
+	int lastKeyMorsel = partitionCount - 1;
+	if( skipCondition != NULL && sortColumn >= 0 && !compacting )
+	{
+		findKeyMorsels( fd, morsels, *skipCondition, firstKeyMorsel, lastKeyMorsel );
+	}
+	if( fd >= 0 && snapshot == NULL )
+	{
+		close( fd );
+	}
+	int keyAttribute = find( storedIndexes.begin(), storedIndexes.end(), sortColumn ) - storedIndexes.begin();
+	vector< string > firstKeys( partitionCount );
+	vector< string > lastKeys( partitionCount );
+	vector< string > originalFirstKeys( partitionCount );
+	vector< string > originalLastKeys( partitionCount );
+	vector< int > keysWritten( partitionCount, 0 );
+	vector< int > keysRead( partitionCount, 0 );
+
+	parallelFor( partitionCount, [ & ]( int index )
+	{
+		partitionPaths[ index ] = getTempPath( "part" + to_string( index ) );
+		ofstream fout( partitionPaths[ index ].c_str(), ofstream::binary | ofstream::trunc );
+		bool recordsFit = true;
+		bool pagesWritten = compacting ? rewriteCompressed : compressed;
+		vector< string > pageLines;
+		long pageBytes = 0;
+		Zone zone = emptyZone;
+		vector< vector< unsigned long > > valueHashes( columnSize );
+		function< void( const string &record ) > writeRecord = [ & ]( const string &record )
+		{
+			if( !pagesWritten )
+			{
+				fout << '\n' << record;
+				return;
+			}
+			pageLines.push_back( record );
+			pageBytes += record.size() + 1;
+			if( pageBytes >= PAGE_SIZE )
+			{
+				fout << '\n' << encodePage( pageLines );
+				pageLines.clear();
+				pageBytes = 0;
+			}
+		};
+		bool excluded = morsels[ index ].zoneIndex >= 0 && partitionPlaced[ index ].empty() &&
+			( ( skipCondition != NULL && ( index < firstKeyMorsel || index > lastKeyMorsel || !morselMayMatch( morsels[ index ], *skipCondition ) ) ) ||
+			( skipCondition == NULL && !placedRecords.empty() ) );
+		if( excluded )
+		{
+			string page;
+			int fd = ( snapshot != NULL ) ? snapshot->fd : open( filePath.c_str(), O_RDONLY );
+			bool pageRead = compressed && readPage( fd, morsels[ index ], page );
+			if( fd >= 0 && snapshot == NULL )
+			{
+				close( fd );
+			}
+			if( pageRead )
+			{
+				fout << '\n' << page;
+				recordsFit = !page.empty();
+			}
+			else
+			{
+				forEachRow( morsels[ index ], writeRecord );
+			}
+			const Zone &oldZone = ( *zones )[ morsels[ index ].zoneIndex ];
+			mergeZone( zone, oldZone, columnTypes );
+			if( !oldZone.filters.empty() )
+			{
+				zone.filters.assign( columnSize, "" );
+				for( int column = 0; column < columnSize && column < (int) oldZone.filters.size(); column++ )
+				{
+					if( filteredColumns[ column ] )
+					{
+						zone.filters[ column ] = oldZone.filters[ column ];
+					}
+				}
+			}
+		}
+		else if( sortColumn >= 0 )
+		{
+			vector< SortedRecord > records = partitionPlaced[ index ];
+			long recordBytes = 0;
+			for( unsigned int placed = 0; placed < records.size(); placed++ )
+			{
+				recordBytes += records[ placed ].record.size() + 1;
+			}
+			forEachRow( morsels[ index ], [ & ]( string &line )
+			{
+				vector< string > row = readRow( line );
+				if( !compacting )
+				{
+					originalLastKeys[ index ] = decodeValue( keyAttribute, row[ keyAttribute ] );
+					if( !keysRead[ index ] )
+					{
+						originalFirstKeys[ index ] = originalLastKeys[ index ];
+						keysRead[ index ] = 1;
+					}
+				}
+				int action = evaluateRow( index, row );
+				if( action != ROW_DELETE )
+				{
+					SortedRecord record;
+					record.values = compacting ? row : storeRow( row );
+					record.key = getRecordKey( record.values, sortColumn );
+					if( action == ROW_KEEP && !compacting )
+					{
+						record.record = line;
+					}
+					else
+					{
+						vector< string > stored = record.values;
+						recordsFit = padRecord( stored, compacting ? rewriteWidth : recordWidth ) && recordsFit;
+						record.record = joinRow( stored );
+					}
+					recordBytes += record.record.size() + 1;
+					records.push_back( record );
+				}
+				if( action != ROW_KEEP )
+				{
+					partitionCounts[ index ]++;
+				}
+			} );
+			stable_sort( records.begin(), records.end(), [ & ]( const SortedRecord &record, const SortedRecord &other )
+			{
+				return compareKeys( record.key, other.key, sortType ) < 0;
+			} );
+			if( !records.empty() )
+			{
+				firstKeys[ index ] = records.front().key;
+				lastKeys[ index ] = records.back().key;
+				keysWritten[ index ] = 1;
+			}
+			long zoneCount = max( recordBytes / MORSEL_SIZE, 1L );
+			writeSortedRecords( fout, records, recordBytes / zoneCount, partitionZones[ index ] );
+		}
+		else
+		{
+			forEachRow( morsels[ index ], [ & ]( string &line )
+			{
+				vector< string > row = readRow( line );
+				int action = evaluateRow( index, row );
+				if( action != ROW_DELETE )
+				{
+					vector< string > stored = compacting ? row : storeRow( row );
+					addToZone( zone, stored, valueHashes );
+					if( action == ROW_KEEP && !compacting )
+					{
+						writeRecord( line );
+					}
+					else
+					{
+						recordsFit = padRecord( stored, compacting ? rewriteWidth : recordWidth ) && recordsFit;
+						writeRecord( joinRow( stored ) );
+					}
+				}
+				if( action != ROW_KEEP )
+				{
+					partitionCounts[ index ]++;
+				}
+			} );
+			for( unsigned int placed = 0; placed < partitionPlaced[ index ].size(); placed++ )
+			{
+				addToZone( zone, partitionPlaced[ index ][ placed ].values, valueHashes );
+				writeRecord( partitionPlaced[ index ][ placed ].record );
+			}
+			buildFilters( zone, valueHashes );
+		}
+		if( !pageLines.empty() )
+		{
+			fout << '\n' << encodePage( pageLines );
+		}
+
+		//zones are kept relative to the partition until it is stitched
+		long partitionSize = fout.tellp();
+		if( partitionZones[ index ].empty() && partitionSize > 0 )
+		{
+			zone.startOffset = 1;
+			zone.endOffset = partitionSize + 1;
+			partitionZones[ index ].push_back( zone );
+		}
+		fout.close();
+		partitionWritten[ index ] = !fout.fail() && recordsFit;
+	} );
+
+	int recordCount = 0;
+	bool rewriteValid = overflowFits;
+	for( int index = 0; index < partitionCount; index++ )
+	{
+		recordCount += partitionCounts[ index ];
+		rewriteValid = rewriteValid && partitionWritten[ index ];
+	}
+	if( uniqueIndex != NULL )
+	{
+		applyUniqueChanges( removedValues, addedValues );
+	}
+
+	//sorted files merged into the table are partitions of their own,
+	//already in key order, which are merged with the others
+	for( unsigned int index = 0; index < mergedFiles.size(); index++ )
+	{
+		partitionPaths.push_back( getTempPath( "part" + to_string( partitionPaths.size() ) ) );
+		partitionZones.push_back( vector< Zone >() );
+		rewriteValid = copySortedFile( mergedFiles[ index ], partitionPaths.back() ) && rewriteValid;
+	}
+
+	//partitions stay in key order if each keeps to the keys it held, the
+	//first and last are open ended. Compacted ones must follow each other
+	bool keysOrdered = mergedFiles.empty();
+	int previous = -1;
+	for( int index = 0; index < partitionCount && sortColumn >= 0; index++ )
+	{
+		if( !keysWritten[ index ] )
+		{
+			continue;
+		}
+		if( compacting )
+		{
+			keysOrdered = keysOrdered && ( previous < 0 || compareKeys( lastKeys[ previous ], firstKeys[ index ], sortType ) <= 0 );
+			previous = index;
+			continue;
+		}
+		bool lowKept = index == 0 || ( keysRead[ index ] && compareKeys( originalFirstKeys[ index ], firstKeys[ index ], sortType ) <= 0 );
+		bool highKept = index == partitionCount - 1 || upperBounds[ index ] == 2 ||
+			( upperBounds[ index ] == 1 && compareKeys( lastKeys[ index ], upperKeys[ index ], sortType ) <= 0 ) ||
+			( keysRead[ index ] && compareKeys( lastKeys[ index ], originalLastKeys[ index ], sortType ) <= 0 );
+		keysOrdered = keysOrdered && lowKept && highKept;
+	}
+
+	if( !rewriteValid || ( !keysOrdered && !mergePartitions( partitionPaths, partitionZones ) ) ||
+		!stitchPartitions( partitionPaths, partitionZones ) )
+	{
+		for( unsigned int index = 0; index < partitionPaths.size(); index++ )
+		{
+			unlink( partitionPaths[ index ].c_str() );
+		}
+		return -1;
+	}
+	return recordCount;
+}
+
+/**
+ * @brief copySortedFile
+ *
+ * @details copies the records of a sorted file to a partition work file
+ *
+ * @param [in] const SortedFile &sorted
+ *
+ * @param [in] string targetPath
+ *
+ * @return bool false if the copy could not be written
+ *
+ * @note None
+ */
+bool TableScan::copySortedFile( const SortedFile &sorted, string targetPath )
+{
+	ofstream fout( targetPath.c_str(), ofstream::binary | ofstream::trunc );
+	vector< char > block( READ_BLOCK_SIZE );
+	long readOffset = sorted.dataOffset - 1;
+	while( readOffset < sorted.fileSize )
+	{
+		long bytesRead = pread( sorted.snapshot->fd, &block[ 0 ], min( READ_BLOCK_SIZE, sorted.fileSize - readOffset ), readOffset );
+		if( bytesRead <= 0 )
+		{
+			return false;
+		}
+		fout.write( &block[ 0 ], bytesRead );
+		readOffset += bytesRead;
+	}
+	fout.close();
+	return !fout.fail();
+}
+
+/**
+ * @brief writeSortedRecords
+ *
+ * @details writes records in key order to a partition, split into zones
+ *
+ * @par Algorithm a zone is closed once its records reach zoneSize bytes,
+ *      each page of a compressed table is a zone of its own
+ *
+ * @param [in] ofstream &fout - partition work file
+ *
+ * @param [in] vector< SortedRecord > &records - sorted
+ *
+ * @param [in] long zoneSize
+ *
+ * @param [out] vector< Zone > &zoneList - zones appended, relative to the
+ *              start of the work file
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TableScan::writeSortedRecords( ofstream &fout, vector< SortedRecord > &records, long zoneSize, vector< Zone > &zoneList )
+{
+	bool pagesWritten = compacting ? rewriteCompressed : compressed;
+	int columnSize = columnTypes.size();
+	int recordSize = records.size();
+	Zone zone;
+	vector< vector< unsigned long > > valueHashes( columnSize );
+	vector< string > pageLines;
+	long zoneBytes = 0;
+	for( int index = 0; index < recordSize; index++ )
+	{
+		if( zoneBytes == 0 )
+		{
+			zone.startOffset = (long) fout.tellp() + 1;
+			zone.minimums.assign( columnSize, "" );
+			zone.maximums.assign( columnSize, "" );
+			zone.filters.clear();
+		}
+		addToZone( zone, records[ index ].values, valueHashes );
+		zoneBytes += records[ index ].record.size() + 1;
+		if( pagesWritten )
+		{
+			pageLines.push_back( records[ index ].record );
+		}
+		else
+		{
+			fout << '\n' << records[ index ].record;
+		}
+		if( zoneBytes >= ( pagesWritten ? PAGE_SIZE : zoneSize ) || index + 1 == recordSize )
+		{
+			if( pagesWritten )
+			{
+				fout << '\n' << encodePage( pageLines );
+				pageLines.clear();
+			}
+			zone.endOffset = (long) fout.tellp() + 1;
+			buildFilters( zone, valueHashes );
+			zoneList.push_back( zone );
+			zoneBytes = 0;
+		}
+	}
+}
+
+/**
+ * @brief mergePartitions
+ *
+ * @details merges sorted partition work files into one in key order
+ *
+ * @par Algorithm the first record of each partition is kept in a priority
+ *      queue, ties taken from the earlier partition. Pages are unpacked as
+ *      they are reached. The merged records are written in chunks of about
+ *      a morsel, each a zone
+ *
+ * @param [in/out] vector< string > &partitionPaths - replaced by the merged
+ *                 work file, the others are removed
+ *
+ * @param [in/out] vector< vector< Zone > > &partitionZones - replaced by the
+ *                 zones of the merged file
+ *
+ * @return bool false if the merged file could not be written
+ *
+ * @note None
+ */
+bool TableScan::mergePartitions( vector< string > &partitionPaths, vector< vector< Zone > > &partitionZones )
+{
+	int sortColumn = getSortColumn();
+	int partitionCount = partitionPaths.size();
+	vector< shared_ptr< ifstream > > inputs( partitionCount );
+	vector< vector< string > > pageLines( partitionCount );
+	vector< unsigned int > pageIndexes( partitionCount, 0 );
+	vector< SortedRecord > heads( partitionCount );
+	bool inputsValid = true;
+
+	//every record and page of a partition follows a newline
+	function< bool( int partition ) > readHead = [ & ]( int partition )
+	{
+		ifstream &fin = *inputs[ partition ];
+		string &record = heads[ partition ].record;
+		if( pageIndexes[ partition ] < pageLines[ partition ].size() )
+		{
+			record = pageLines[ partition ][ pageIndexes[ partition ]++ ];
+		}
+		else if( fin.peek() == PAGE_MARK )
+		{
+			char pageHeader[ PAGE_HEADER_SIZE ];
+			fin.read( pageHeader, PAGE_HEADER_SIZE );
+			string content( getPageContentSize( pageHeader ), '\0' );
+			if( content.empty() || !fin.read( &content[ 0 ], content.size() ) || !decodePage( content, pageLines[ partition ] ) ||
+				pageLines[ partition ].empty() )
+			{
+				inputsValid = false;
+				return false;
+			}
+			fin.get();
+			record = pageLines[ partition ][ 0 ];
+			pageIndexes[ partition ] = 1;
+		}
+		else if( !getline( fin, record ) )
+		{
+			return false;
+		}
+		heads[ partition ].values = getRecordValues( record );
+		heads[ partition ].key = getRecordKey( heads[ partition ].values, sortColumn );
+		return true;
+	};
+	priority_queue< int, vector< int >, function< bool( int, int ) > > nextRecords( [ & ]( int partition, int other )
+	{
+		int comparison = compareKeys( heads[ partition ].key, heads[ other ].key, sortType );
+		return comparison > 0 || ( comparison == 0 && partition > other );
+	} );
+	for( int index = 0; index < partitionCount; index++ )
+	{
+		inputs[ index ].reset( new ifstream( partitionPaths[ index ].c_str(), ifstream::binary ) );
+		inputs[ index ]->get();
+		if( readHead( index ) )
+		{
+			nextRecords.push( index );
+		}
+	}
+
+	string mergePath = getTempPath( "merge" );
+	ofstream fout( mergePath.c_str(), ofstream::binary | ofstream::trunc );
+	vector< Zone > mergedZones;
+	vector< SortedRecord > chunk;
+	long chunkBytes = 0;
+	while( !nextRecords.empty() )
+	{
+		int partition = nextRecords.top();
+		nextRecords.pop();
+		chunkBytes += heads[ partition ].record.size() + 1;
+		chunk.push_back( heads[ partition ] );
+		if( readHead( partition ) )
+		{
+			nextRecords.push( partition );
+		}
+		if( chunkBytes >= MORSEL_SIZE || nextRecords.empty() )
+		{
+			writeSortedRecords( fout, chunk, chunkBytes, mergedZones );
+			chunk.clear();
+			chunkBytes = 0;
+		}
+	}
+	fout.close();
+
+	for( int index = 0; index < partitionCount; index++ )
+	{
+		inputs[ index ].reset();
+		unlink( partitionPaths[ index ].c_str() );
+	}
+	partitionPaths.assign( 1, mergePath );
+	partitionZones.assign( 1, mergedZones );
+	return inputsValid && !fout.fail();
+}
+
+/**
+ * @brief collectWrites
+ *
+ * @details changes the records of a fixed width table without rewriting it
+ *
+ * @par Algorithm morsels of a fixed width table hold whole records, so they
+ *      are evaluated in parallel like a rewrite. Each changed record is
+ *      padded to the same width and kept in pendingWrites by its offset,
+ *      which the committer logs and then writes over the old record. A
+ *      record changed by an earlier statement of the transaction is read
+ *      from pendingWrites
+ *
+ * @param [in] function< int( vector< string > &row ) > rowAction - returns
+ *             ROW_KEEP or ROW_CHANGED
+ *
+ * @param [in] const WhereCondition *skipCondition - morsels whose zone or
+ *             key range rules it out are not read, may be NULL
+ *
+ * @return int number of records changed, -1 if a record was deleted or a
+ *         changed one no longer fits
+ *
+ * @note the table file is not written
+ */
+int TableScan::collectWrites( function< int( vector< string > &row ) > rowAction, const WhereCondition *skipCondition )
+{
+	vector< Morsel > morsels = getMorsels( MORSEL_SIZE );
+	int partitionCount = morsels.size();
+	vector< map< long, string > > partitionWrites( partitionCount );
+	atomic< bool > writesValid( recordWidth > 0 );
+	if( skipCondition != NULL )
+	{
+		loadFilters( skipCondition );
+		narrowMorsels( morsels, *skipCondition );
+		partitionCount = morsels.size();
+		partitionWrites.resize( partitionCount );
+	}
+
+	//values of the unique columns the writes takes from records and gives
+	//them, per partition
+	vector< vector< pair< int, string > > > removedValues( partitionCount ), addedValues( partitionCount );
+	function< int( int index, vector< string > &row ) > evaluateRow = [ & ]( int index, vector< string > &row )
+	{
+		if( uniqueIndex == NULL )
+		{
+			return rowAction( row );
+		}
+		vector< string > before = row;
+		int action = rowAction( row );
+		if( action != ROW_KEEP )
+		{
+			recordUniqueChanges( before, row, action, removedValues[ index ], addedValues[ index ] );
+		}
+		return action;
+	};
+
+	parallelFor( partitionCount, [ & ]( int index )
+	{
+		if( skipCondition != NULL && !morselMayMatch( morsels[ index ], *skipCondition ) )
+		{
+			return;
+		}
+		forEachRecord( morsels[ index ], [ & ]( string &line, long offset )
+		{
+			map< long, string >::const_iterator pending = pendingWrites->find( offset );
+			vector< string > row = readRow( pending == pendingWrites->end() ? line : pending->second );
+			int action = evaluateRow( index, row );
+			if( action == ROW_KEEP )
+			{
+				return;
+			}
+
+			vector< string > stored = storeRow( row );
+			if( action == ROW_DELETE || !padRecord( stored, recordWidth ) )
+			{
+				writesValid = false;
+				return;
+			}
+			partitionWrites[ index ][ offset ] = joinRow( stored );
+		} );
+	} );
+
+	if( !writesValid )
+	{
+		return -1;
+	}
+	if( uniqueIndex != NULL )
+	{
+		applyUniqueChanges( removedValues, addedValues );
+	}
+	int recordCount = 0;
+	for( int index = 0; index < partitionCount; index++ )
+	{
+		recordCount += partitionWrites[ index ].size();
+		for( map< long, string >::iterator it = partitionWrites[ index ].begin(); it != partitionWrites[ index ].end(); ++it )
+		{
+			( *pendingWrites )[ it->first ] = it->second;
+		}
+	}
+	return recordCount;
+}
+
+/**
+ * @brief stitchPartitions
+ *
+ * @details joins the partition work files into the new table file
+ *
+ * @par Algorithm the partition sizes give each partition its offset in the
+ *      new file, so partitions are copied in parallel with pwrite. The file
+ *      is synced and then atomically renamed over the table, or to
+ *      rewritePath when one is set. The dictionaries stay behind the
+ *      attribute line. A compacting rewrite starts the file with the
+ *      attribute line of the schema, padded like the records, and the
+ *      dictionaries it built. A file with a zone map gets a new token and
+ *      the zone map of its partitions is written before the file is renamed
+ *
+ * @param [in] vector< string > &partitionPaths - removed once copied
+ *
+ * @param [in] vector< vector< Zone > > &partitionZones - zones of each
+ *             partition, relative to its work file
+ *
+ * @return bool true if the table was replaced
+ *
+ * @note None
+ */
+bool TableScan::stitchPartitions( vector< string > &partitionPaths, vector< vector< Zone > > &partitionZones )
+{
+	int partitionCount = partitionPaths.size();
+	string header = compacting ? rewriteHeader : attributeData + dictionaryData;
+	string token = newZoneToken();
+	header = setLsmSequence( setZoneToken( header, token ), lsmSequence );
+	vector< long > partitionOffsets( partitionCount + 1 );
+	partitionOffsets[ 0 ] = header.size();
+	for( int index = 0; index < partitionCount; index++ )
+	{
+		struct stat buffer;
+		long partitionSize = 0;
+		if( stat( partitionPaths[ index ].c_str(), &buffer ) == 0 )
+		{
+			partitionSize = buffer.st_size;
+		}
+		partitionOffsets[ index + 1 ] = partitionOffsets[ index ] + partitionSize;
+	}
+
+	string tempPath = getTempPath( "tmp" );
+	int fd = open( tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	if( fd < 0 )
+	{
+		return false;
+	}
+
+	atomic< bool > copyValid( pwrite( fd, header.c_str(), header.size(), 0 ) == (long) header.size() );
+	parallelFor( partitionCount, [ & ]( int index )
+	{
+		int partFd = open( partitionPaths[ index ].c_str(), O_RDONLY );
+		if( partFd < 0 )
+		{
+			copyValid = false;
+			return;
+		}
+
+		vector< char > buffer( 1 << 16 );
+		long offset = partitionOffsets[ index ];
+		long bytesRead;
+		while( ( bytesRead = read( partFd, &buffer[ 0 ], buffer.size() ) ) > 0 )
+		{
+			if( pwrite( fd, &buffer[ 0 ], bytesRead, offset ) != bytesRead )
+			{
+				copyValid = false;
+				break;
+			}
+			offset += bytesRead;
+		}
+		close( partFd );
+		unlink( partitionPaths[ index ].c_str() );
+	} );
+
+	if( fsync( fd ) != 0 )
+	{
+		copyValid = false;
+	}
+	close( fd );
+
+	//a zone holds the records from its first one up to the first one of
+	//the next, moved by the offset of its partition
+	vector< Zone > stitchedZones;
+	for( int index = 0; index < partitionCount; index++ )
+	{
+		for( unsigned int zoneIndex = 0; zoneIndex < partitionZones[ index ].size(); zoneIndex++ )
+		{
+			Zone &zone = partitionZones[ index ][ zoneIndex ];
+			zone.startOffset += partitionOffsets[ index ];
+			zone.endOffset += partitionOffsets[ index ];
+			stitchedZones.push_back( zone );
+		}
+	}
+	if( copyValid && header.find( "\t" + ZONES_FIELD + " " ) < header.find( '\n' ) )
+	{
+		saveZones( token, stitchedZones );
+	}
+
+	string targetPath = rewritePath.empty() ? filePath : rewritePath;
+	if( !copyValid || rename( tempPath.c_str(), targetPath.c_str() ) != 0 )
+	{
+		unlink( tempPath.c_str() );
+		return false;
+	}
+	return true;
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,294 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file TableScan.h
+ *
+ * @brief Definition file for TableScan class
+ *
+ * @details Specifies the morsel-driven scan used to read table files
+ *
+ * @Note None
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <memory>
+#include <map>
+#include <unordered_map>
+#include <set>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include "Table.h"
+#include "ThreadPool.h"
+#include "PageCodec.h"
+#include "ZoneMap.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef TABLESCAN_H
+#define TABLESCAN_H
+
+//size in bytes of the piece of table file handed to one worker at a time
+const long MORSEL_SIZE = 1 << 20;
+
+//bytes read from a table file per read call
+const long READ_BLOCK_SIZE = 1 << 16;
+
+//byte range of a table file, rows belong to the morsel holding their first
+//byte. zoneIndex is the zone the morsel lies in, -1 if none
+struct Morsel{
+	long startOffset;
+	long endOffset;
+	int zoneIndex;
+};
+
+//hidden file next to a table holding its schema once it was changed
+//without rewriting the table
+const string SCHEMA_SUFFIX = "schema";
+
+//one column as records are stored. A dropped column keeps its place and a
+//modified one its old values until the table is rewritten
+struct StoredColumn{
+	Attribute attribute;
+	string defaultValue;
+	bool dropped;
+	bool modified;
+};
+
+//field ending the attribute line of a table with dictionary encoded columns,
+//followed by the number of dictionary lines between it and the records
+const string DICTIONARY_FIELD = "#dictionaries";
+
+//field ending the attribute line of a table whose records are packed into
+//compressed pages. Records appended later stay text lines behind the pages
+const string PAGES_FIELD = "#pages";
+
+//field of the attribute line of a table whose records are all padded to
+//one width, followed by that width counting the newline before a record
+const string FIXED_FIELD = "#fixed";
+
+//field of the attribute line naming the primary key column. Records are
+//kept in the order of its values, the order conditions compare them in
+const string KEY_FIELD = "#key";
+
+//hidden file next to a clustered table holding the records inserted with a
+//key below its last one, in the order they came. Its first line is the
+//zone token of the table file it belongs to, so a rewrite of the table,
+//which takes the records in, leaves the file behind as stale
+const string OVERFLOW_SUFFIX = "overflow";
+
+//records inserted below the last key are placed into the table once the
+//overflow file would hold more than this many bytes of them
+const long OVERFLOW_SIZE = 4 << 20;
+
+//field of the attribute line naming the columns declared UNIQUE, separated
+//by commas. The primary key is unique without being named here
+const string UNIQUE_FIELD = "#unique";
+
+//number of records holding each value of the unique columns of a table as
+//of one version of it, the primary key first. changes holds what the
+//transaction being committed adds and removes, and added the values the
+//statement being checked gave records
+struct UniqueIndex{
+	long tableVersion;
+	long catalogVersion;
+	vector< int > attributes;
+	vector< unordered_map< string, long > > counts;
+	vector< map< string, long > > changes;
+	vector< pair< int, string > > added;
+};
+
+//field of the attribute line of a table kept as a log-structured merge
+//tree, followed by the last sequence of the runs merged into the table file.
+//The sequence keeps its width, so the records stay where they are
+const string LSM_FIELD = "#lsm";
+const int LSM_SEQUENCE_SIZE = 16;
+
+//field of the attribute line naming the storage engine of the table. A
+//table without one is kept by the engine of tables created without ENGINE=
+const string ENGINE_FIELD = "#engine";
+const string DEFAULT_ENGINE = "TEXT";
+
+//a record a rewrite writes in key order, with its stored values and the
+//decoded key it is sorted by
+struct SortedRecord{
+	string key;
+	vector< string > values;
+	string record;
+};
+
+//a stored value made of this mark and a number is the code of a value in the
+//dictionary of its column, values written since the dictionary are not coded
+const char CODE_MARK = '#';
+
+//a rewrite encodes a string column holding at most this many distinct
+//values, each used at least twice on average
+const int DICTIONARY_MAX_SIZE = 1024;
+
+//distinct values of an encoded column in sorted order, the code of a value
+//is its place in the order
+struct ColumnDictionary{
+	vector< string > values;
+	map< string, long > codes;
+};
+
+//characters a value takes in a fixed width record, strings declared with a
+//length take that length plus their quotes
+const int INT_VALUE_WIDTH = 20;
+const int FLOAT_VALUE_WIDTH = 24;
+const int STRING_VALUE_WIDTH = 32;
+
+//what a rewrite does with one record
+const int ROW_KEEP = 0;
+const int ROW_CHANGED = 1;
+const int ROW_DELETE = 2;
+
+//rows produced by one morsel, kept separate so output can be merged in order
+struct MorselResult{
+	vector< vector< string > > rows;
+};
+
+//committed version of a table file held open for a query. Writers replace
+//the file or only append to it, so the open descriptor and the size at the
+//time it was taken keep showing the same rows until the query ends. Records
+//are only overwritten in place while no snapshot pins the table
+class TableSnapshot{
+	public:
+		int fd;
+		long fileSize;
+		long version;
+		shared_ptr< atomic< int > > pins;
+
+		TableSnapshot();
+		~TableSnapshot();
+};
+
+//records in key order in a file of their own, between dataOffset and
+//fileSize, which the snapshot keeps open. A rewrite of a clustered table
+//merges them in as a partition
+struct SortedFile{
+	shared_ptr< TableSnapshot > snapshot;
+	long dataOffset;
+	long fileSize;
+};
+
+class TableScan{
+	public:
+		string filePath;
+		string attributeData;
+		vector< Attribute > attributes;
+		vector< StoredColumn > storedColumns;
+		vector< int > storedIndexes;
+		long dataOffset;
+		long fileSize;
+		long recordWidth;
+		bool compressed;
+		string rewritePath;
+		shared_ptr< map< long, string > > pendingWrites;
+		shared_ptr< vector< ColumnDictionary > > dictionaries;
+		string dictionaryData;
+		string zoneFilePath;
+		string bloomFilePath;
+		string overflowFilePath;
+		vector< string > bloomColumns;
+		string keyName;
+		int keyColumn;
+		bool placeInserts;
+		bool spillInsert;
+		shared_ptr< UniqueIndex > uniqueIndex;
+		shared_ptr< TableSnapshot > snapshot;
+		long lsmSequence;
+		string engineName;
+
+		TableScan();
+		~TableScan();
+		bool scanOpen( string tableFilePath );
+		bool snapshotOpen( long version, shared_ptr< atomic< int > > pins );
+		vector< string > readRow( const string &line );
+		vector< string > storeRow( const vector< string > &values );
+		string decodeValue( int attributeIndex, const string &value );
+		void resolveCondition( WhereCondition &wCond );
+		bool rowMatches( const WhereCondition &wCond, const vector< string > &row );
+		vector< Morsel > getMorsels( long morselSize );
+		void forEachRow( Morsel morsel, function< void( string &line ) > visit );
+		void forEachRecord( Morsel morsel, function< void( string &line, long offset ) > visit );
+		void scanMorsel( Morsel morsel, WhereCondition wCond, vector< int > projection, MorselResult &result );
+		bool morselMayMatch( const Morsel &morsel, const WhereCondition &wCond );
+		void loadFilters( const WhereCondition *wCond );
+		bool isClustered();
+		bool isKeyAttribute( int attributeIndex );
+		void narrowMorsels( vector< Morsel > &morsels, const WhereCondition &wCond );
+		bool appendsInOrder( const vector< vector< string > > &rows );
+		void addPlacedRecord( const vector< string > &values );
+		int placeRecords();
+		string getInsertKey( const vector< string > &values );
+		bool readOverflow( vector< string > &records );
+		long getOverflowSize();
+		bool writeOverflow( const vector< string > &values, long offset );
+		int getKeyAttribute();
+		vector< int > getUniqueAttributes();
+		void buildUniqueIndex( UniqueIndex &index, vector< TableScan > &moreScans, const vector< string > &moreRecords );
+		bool addUniqueRecord( const vector< string > &values, string &violation );
+		bool checkUniqueValues( string &violation );
+		int parallelRewrite( function< int( vector< string > &row ) > rowAction, const WhereCondition *skipCondition );
+		bool compactTo( string targetPath, bool fixedWidth, bool compressedPages );
+		bool extendZones();
+		bool widenZones( const map< long, string > &writes );
+
+	private:
+		friend class TextEngine;
+		friend class LsmEngine;
+		bool compacting;
+		bool converting;
+		long rewriteWidth;
+		bool rewriteCompressed;
+		shared_ptr< vector< ColumnDictionary > > rewriteDictionaries;
+		string rewriteHeader;
+		string zoneToken;
+		string zoneStamp;
+		shared_ptr< vector< Zone > > zones;
+		bool filtersLoaded;
+		vector< int > columnTypes;
+		vector< bool > filteredColumns;
+		int sortType;
+		vector< SortedRecord > placedRecords;
+		vector< int > uniqueStoredColumns;
+		vector< SortedFile > mergedFiles;
+
+		string getTempPath( string suffix );
+		string decodeStoredValue( int storedIndex, const string &value );
+		string decodeOutputValue( int column, const string &value );
+		void setZoneColumns();
+		void addToZone( Zone &zone, const vector< string > &values, vector< vector< unsigned long > > &valueHashes );
+		void buildFilters( Zone &zone, vector< vector< unsigned long > > &valueHashes );
+		bool saveZones( const string &token, const vector< Zone > &zoneList );
+		void loadZones( int fd );
+		bool readPage( int fd, const Morsel &morsel, string &page );
+		int getSortColumn();
+		vector< string > getRecordValues( const string &record );
+		string getRecordKey( const vector< string > &values, int column );
+		bool readRecordAt( int fd, long offset, long &recordStart, string &record );
+		bool readFirstKey( int fd, const Morsel &morsel, string &key );
+		bool getLastKey( string &key );
+		int findMorsel( int fd, const vector< Morsel > &morsels, const string &key, bool upper );
+		bool findKeyMorsels( int fd, const vector< Morsel > &morsels, const WhereCondition &wCond, int &first, int &last );
+		void bisectMorsel( int fd, Morsel &morsel, const string &key, bool upper, bool lowerEnd );
+		void writeSortedRecords( ofstream &fout, vector< SortedRecord > &records, long zoneSize, vector< Zone > &zoneList );
+		bool mergePartitions( vector< string > &partitionPaths, vector< vector< Zone > > &partitionZones );
+		string getUniqueValue( int attributeIndex, const vector< string > &row );
+		void recordUniqueChanges( const vector< string > &before, const vector< string > &after, int action,
+			vector< pair< int, string > > &removed, vector< pair< int, string > > &added );
+		void applyUniqueChanges( vector< vector< pair< int, string > > > &removed, vector< vector< pair< int, string > > > &added );
+		void buildDictionaries();
+		int collectWrites( function< int( vector< string > &row ) > rowAction, const WhereCondition *skipCondition );
+		bool stitchPartitions( vector< string > &partitionPaths, vector< vector< Zone > > &partitionZones );
+		void addMatchingRow( const string &line, const WhereCondition &wCond, const vector< int > &projection, MorselResult &result );
+		bool copySortedFile( const SortedFile &sorted, string targetPath );
+		string getFileToken();
+};
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,459 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file ThreadPool.cpp
+ *
+ * @brief Implementation file for ThreadPool and TaskGroup classes
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements a work-stealing scheduler. Every worker owns a deque of
+ *          tasks; tasks submitted from a worker go to the back of its own
+ *          deque and idle workers steal from the front of a random victim.
+ *          All parallel operators share one pool so that several of them in
+ *          one statement do not oversubscribe the cores
+ *
+ * @Note Requires ThreadPool.h
+ */
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include "ThreadPool.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef THREADPOOL_CPP
+#define THREADPOOL_CPP
+
+//worker count requested on the command line, 0 uses one worker per core
+int threadPoolSizeOverride = 0;
+
+//pool and index of the worker running on this thread, -1 if not a worker
+thread_local ThreadPool *currentPool = NULL;
+thread_local int currentWorker = -1;
+thread_local unsigned int victimSeed = 0;
+
+/**
+ * @brief nextVictim
+ *
+ * @details picks a pseudo random worker to steal from
+ *
+ * @param [in] int workerCount
+ *
+ * @return int index of the victim worker
+ *
+ * @note xorshift keeps the choice cheap and per thread
+ */
+int nextVictim( int workerCount )
+{
+	if( victimSeed == 0 )
+	{
+		victimSeed = hash< thread::id >()( this_thread::get_id() ) | 1;
+	}
+	victimSeed ^= victimSeed << 13;
+	victimSeed ^= victimSeed >> 17;
+	victimSeed ^= victimSeed << 5;
+	return victimSeed % workerCount;
+}
+
+/**
+ * @brief ThreadPool constructor
+ *
+ * @details creates one deque and one thread per worker
+ *
+ * @param [in] int workerCount - at least one worker is always created
+ *
+ * @note None
+ */
+ThreadPool::ThreadPool( int workerCount )
+	: queuedTasks( 0 ), nextQueue( 0 ), stopping( false )
+{
+	if( workerCount < 1 )
+	{
+		workerCount = 1;
+	}
+	for( int index = 0; index < workerCount; index++ )
+	{
+		queues.push_back( new WorkerQueue );
+	}
+	for( int index = 0; index < workerCount; index++ )
+	{
+		workers.push_back( thread( &ThreadPool::workerLoop, this, index ) );
+	}
+}
+
+/**
+ * @brief ThreadPool destructor
+ *
+ * @details lets the workers drain their queues, then joins them
+ *
+ * @note None
+ */
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard< mutex > guard( sleepLock );
+		stopping = true;
+	}
+	sleepCondition.notify_all();
+
+	int workerCount = workers.size();
+	for( int index = 0; index < workerCount; index++ )
+	{
+		workers[ index ].join();
+		delete queues[ index ];
+	}
+}
+
+/**
+ * @brief size
+ *
+ * @details number of worker threads in the pool
+ *
+ * @return int
+ *
+ * @note None
+ */
+int ThreadPool::size()
+{
+	return workers.size();
+}
+
+/**
+ * @brief submit
+ *
+ * @details queues a task for execution
+ *
+ * @par Algorithm a worker pushes onto its own deque so the task stays cache
+ *      local, any other thread spreads tasks over the deques round robin
+ *
+ * @param [in] function< void() > task
+ *
+ * @return None
+ *
+ * @note None
+ */
+void ThreadPool::submit( function< void() > task )
+{
+	int queueIndex;
+	if( currentPool == this && currentWorker >= 0 )
+	{
+		queueIndex = currentWorker;
+	}
+	else
+	{
+		queueIndex = nextQueue++ % queues.size();
+	}
+
+	{
+		lock_guard< mutex > guard( queues[ queueIndex ]->queueLock );
+		queues[ queueIndex ]->tasks.push_back( task );
+	}
+	queuedTasks++;
+
+	//take the sleep lock so a worker about to sleep cannot miss the wake up
+	{
+		lock_guard< mutex > guard( sleepLock );
+	}
+	sleepCondition.notify_one();
+}
+
+/**
+ * @brief popTask
+ *
+ * @details takes the next task for a worker
+ *
+ * @par Algorithm pop the newest task of the worker's own deque, otherwise
+ *      visit every other deque starting at a random victim and steal its
+ *      oldest task
+ *
+ * @param [in] int workerIndex - -1 when the caller is not a worker
+ *
+ * @param [out] function< void() > &task
+ *
+ * @return bool true if a task was taken
+ *
+ * @note None
+ */
+bool ThreadPool::popTask( int workerIndex, function< void() > &task )
+{
+	int queueCount = queues.size();
+	if( workerIndex >= 0 )
+	{
+		lock_guard< mutex > guard( queues[ workerIndex ]->queueLock );
+		if( !queues[ workerIndex ]->tasks.empty() )
+		{
+			task = queues[ workerIndex ]->tasks.back();
+			queues[ workerIndex ]->tasks.pop_back();
+			queuedTasks--;
+			return true;
+		}
+	}
+
+	int victim = nextVictim( queueCount );
+	for( int offset = 0; offset < queueCount; offset++ )
+	{
+		int queueIndex = ( victim + offset ) % queueCount;
+		if( queueIndex == workerIndex )
+		{
+			continue;
+		}
+		lock_guard< mutex > guard( queues[ queueIndex ]->queueLock );
+		if( !queues[ queueIndex ]->tasks.empty() )
+		{
+			task = queues[ queueIndex ]->tasks.front();
+			queues[ queueIndex ]->tasks.pop_front();
+			queuedTasks--;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief runPendingTask
+ *
+ * @details runs one queued task on the calling thread
+ *
+ * @return bool true if a task was run
+ *
+ * @note used by threads waiting on a TaskGroup so they help instead of block
+ */
+bool ThreadPool::runPendingTask()
+{
+	function< void() > task;
+	int workerIndex = ( currentPool == this ) ? currentWorker : -1;
+	if( popTask( workerIndex, task ) )
+	{
+		task();
+		return true;
+	}
+	return false;
+}
+
+/**
+ * @brief workerLoop
+ *
+ * @details body of each worker thread
+ *
+ * @param [in] int workerIndex
+ *
+ * @return None
+ *
+ * @note None
+ */
+void ThreadPool::workerLoop( int workerIndex )
+{
+	currentPool = this;
+	currentWorker = workerIndex;
+
+	function< void() > task;
+	while( true )
+	{
+		if( popTask( workerIndex, task ) )
+		{
+			task();
+			continue;
+		}
+
+		unique_lock< mutex > guard( sleepLock );
+		sleepCondition.wait( guard, [ this ]() { return stopping || queuedTasks > 0; } );
+		if( stopping && queuedTasks == 0 )
+		{
+			return;
+		}
+	}
+}
+
+/**
+ * @brief TaskGroup constructor
+ *
+ * @param [in] ThreadPool &taskPool - pool the tasks are submitted to
+ *
+ * @note None
+ */
+TaskGroup::TaskGroup( ThreadPool &taskPool )
+	: pool( taskPool ), pendingTasks( 0 )
+{
+
+}
+
+/**
+ * @brief TaskGroup destructor
+ *
+ * @details tasks reference the group, so it waits for all of them
+ *
+ * @note a failure nobody waited for is dropped, a destructor must not throw
+ */
+TaskGroup::~TaskGroup()
+{
+	awaitTasks();
+}
+
+/**
+ * @brief run
+ *
+ * @details submits a task that belongs to this group
+ *
+ * @param [in] function< void() > task
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TaskGroup::run( function< void() > task )
+{
+	//counts the task done however it ends, waking the waiter after the last.
+	//The count only drops under doneLock, so the waiter cannot see it reach
+	//zero and destroy the group before this worker is done with the lock
+	struct TaskDone{
+		TaskGroup *group;
+		~TaskDone()
+		{
+			lock_guard< mutex > guard( group->doneLock );
+			if( --group->pendingTasks == 0 )
+			{
+				group->doneCondition.notify_all();
+			}
+		}
+	};
+
+	pendingTasks++;
+	pool.submit( [ this, task ]()
+	{
+		TaskDone done = { this };
+		try
+		{
+			task();
+		}
+		catch( ... )
+		{
+			lock_guard< mutex > guard( doneLock );
+			if( !failure )
+			{
+				failure = current_exception();
+			}
+		}
+	} );
+}
+
+/**
+ * @brief wait
+ *
+ * @details returns once every task of the group has finished
+ *
+ * @par Algorithm the waiting thread runs queued tasks itself while it waits,
+ *      so nested groups never deadlock and the caller is one more worker.
+ *      Once nothing is queued the rest of the group is running on other
+ *      threads, and it sleeps until the last of them is done
+ *
+ * @return None
+ *
+ * @note rethrows the first exception a task of the group threw
+ */
+void TaskGroup::wait()
+{
+	awaitTasks();
+
+	exception_ptr thrown;
+	{
+		lock_guard< mutex > guard( doneLock );
+		thrown = failure;
+		failure = NULL;
+	}
+	if( thrown )
+	{
+		rethrow_exception( thrown );
+	}
+}
+
+/**
+ * @brief awaitTasks
+ *
+ * @details blocks until every task of the group has finished
+ *
+ * @par Algorithm queued tasks are run here first. The count is then read
+ *      under doneLock, which the last worker holds while it drops the
+ *      count to zero, so no worker uses the group after this returns
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TaskGroup::awaitTasks()
+{
+	while( pendingTasks > 0 && pool.runPendingTask() )
+	{
+	}
+
+	unique_lock< mutex > guard( doneLock );
+	doneCondition.wait( guard, [ this ]() { return pendingTasks == 0; } );
+}
+
+/**
+ * @brief setThreadPoolSize
+ *
+ * @details overrides the number of workers, must be called before first use
+ *
+ * @param [in] int workerCount - 0 restores one worker per core
+ *
+ * @return None
+ *
+ * @note None
+ */
+void setThreadPoolSize( int workerCount )
+{
+	threadPoolSizeOverride = workerCount;
+}
+
+/**
+ * @brief getThreadPool
+ *
+ * @details returns the scheduler shared by every operator
+ *
+ * @return ThreadPool &
+ *
+ * @note created on first use, sized from hardware_concurrency unless overridden
+ */
+ThreadPool &getThreadPool()
+{
+	static ThreadPool pool( threadPoolSizeOverride > 0 ? threadPoolSizeOverride : thread::hardware_concurrency() );
+	return pool;
+}
+
+/**
+ * @brief parallelFor
+ *
+ * @details runs body( 0 ) .. body( count - 1 ) on the shared pool and waits
+ *
+ * @param [in] int count
+ *
+ * @param [in] function< void( int ) > body
+ *
+ * @return None
+ *
+ * @note None
+ */
+void parallelFor( int count, function< void( int ) > body )
+{
+	if( count == 1 )
+	{
+		body( 0 );
+		return;
+	}
+
+	TaskGroup group( getThreadPool() );
+	for( int index = 0; index < count; index++ )
+	{
+		group.run( [ &body, index ]() { body( index ); } );
+	}
+	group.wait();
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,78 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file ThreadPool.h
+ *
+ * @brief Definition file for ThreadPool and TaskGroup classes
+ *
+ * @details Specifies the work-stealing scheduler shared by every parallel
+ *          operator of a statement
+ *
+ * @Note None
+ */
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+//task deque owned by one worker, the owner works at the back, thieves at the front
+struct WorkerQueue{
+	mutex queueLock;
+	deque< function< void() > > tasks;
+};
+
+class ThreadPool{
+	public:
+		ThreadPool( int workerCount );
+		~ThreadPool();
+		int size();
+		void submit( function< void() > task );
+		bool runPendingTask();
+
+	private:
+		vector< WorkerQueue* > queues;
+		vector< thread > workers;
+		atomic< int > queuedTasks;
+		atomic< unsigned int > nextQueue;
+		mutex sleepLock;
+		condition_variable sleepCondition;
+		bool stopping;
+
+		void workerLoop( int workerIndex );
+		bool popTask( int workerIndex, function< void() > &task );
+};
+
+//set of tasks that one operator waits on as a unit
+class TaskGroup{
+	public:
+		TaskGroup( ThreadPool &taskPool );
+		~TaskGroup();
+		void run( function< void() > task );
+		void wait();
+
+	private:
+		ThreadPool &pool;
+		atomic< int > pendingTasks;
+		mutex doneLock;
+		condition_variable doneCondition;
+		exception_ptr failure;
+
+		void awaitTasks();
+};
+
+void setThreadPoolSize( int workerCount );
+ThreadPool &getThreadPool();
+void parallelFor( int count, function< void( int ) > body );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
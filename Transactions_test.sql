@@ -0,0 +1,87 @@
+--CS457 Transactions
+
+--Construct the database and table
+CREATE DATABASE CS457_TXN;
+USE CS457_TXN;
+CREATE TABLE Account (aid int PRIMARY KEY, owner varchar(20), balance float);
+insert into Account values(1, 'Ann', 100.0);
+insert into Account values(2, 'Bob', 50.0);
+
+--Commit applies every statement together
+BEGIN;
+update Account set balance = 75.0 where aid = 1;
+update Account set balance = 75.0 where aid = 2;
+insert into Account values(3, 'Cid', 10.0);
+select * from Account;
+COMMIT;
+select * from Account;
+
+--Rollback drops the statements
+BEGIN;
+delete from Account where aid = 3;
+insert into Account values(4, 'Dee', 20.0);
+ROLLBACK;
+select * from Account;
+
+--A failing statement fails the whole transaction
+BEGIN;
+update Account set balance = 0.0 where aid = 1;
+insert into Account values(2, 'Eve', 5.0);
+COMMIT;
+select * from Account;
+
+--Schema changes are not allowed inside a transaction
+BEGIN;
+CREATE TABLE Other (x int);
+ALTER TABLE Account ADD note varchar(10);
+COMMIT;
+COMMIT;
+ROLLBACK;
+
+.exit
+
+-- Expected output
+--
+-- Database CS457_TXN created.
+-- Using Database CS457_TXN.
+-- Table Account created.
+-- 1 new record inserted.
+-- 1 new record inserted.
+-- Transaction started.
+-- Statement added to transaction.
+-- Statement added to transaction.
+-- Statement added to transaction.
+-- aid int|owner varchar(20)|balance float
+-- 1|Ann|100.0
+-- 2|Bob|50.0
+-- 1 record modified.
+-- 1 record modified.
+-- 1 new record inserted.
+-- Transaction committed.
+-- aid int|owner varchar(20)|balance float
+-- 1|Ann|75.0
+-- 2|Bob|75.0
+-- 3|Cid|10.0
+-- Transaction started.
+-- Statement added to transaction.
+-- Statement added to transaction.
+-- Transaction rolled back.
+-- aid int|owner varchar(20)|balance float
+-- 1|Ann|75.0
+-- 2|Bob|75.0
+-- 3|Cid|10.0
+-- Transaction started.
+-- Statement added to transaction.
+-- Statement added to transaction.
+-- !Failed to insert into Account because aid = 2 already exists.
+-- aid int|owner varchar(20)|balance float
+-- 1|Ann|75.0
+-- 2|Bob|75.0
+-- 3|Cid|10.0
+-- Transaction started.
+-- !Failed to complete command because a transaction is in progress.
+-- !Failed to complete command because a transaction is in progress.
+-- Transaction committed.
+-- !Failed to commit transaction because none is in progress.
+-- !Failed to rollback transaction because none is in progress.
+-- All done.
@@ -0,0 +1,979 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file ZoneMap.cpp
+ *
+ * @brief Implementation file for the zone maps and Bloom filters of table
+ *        files
+ *
+ * @author Carli Decapito, Sanya Gupta, Eugene Nelson
+ *
+ * @details Implements the zone and filter files kept next to a table and
+ *          the parts of TableScan that build, extend and read them to skip
+ *          morsels a condition cannot match
+ *
+ * @Note Requires ZoneMap.h and TableScan.h
+ */
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "ZoneMap.h"
+#include "TableScan.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef ZONEMAP_CPP
+#define ZONEMAP_CPP
+
+/**
+ * @brief newZoneToken
+ *
+ * @details makes the token a new table file gives its zone map
+ *
+ * @return string ZONE_TOKEN_SIZE hex digits from the clock, the process and
+ *         a counter
+ *
+ * @note None
+ */
+string newZoneToken()
+{
+	static atomic< unsigned long > counter( 0 );
+	unsigned long value = chrono::system_clock::now().time_since_epoch().count();
+	value = value * 6364136223846793005UL + ( counter++ ) * 1442695040888963407UL + getpid();
+	char token[ ZONE_TOKEN_SIZE + 1 ];
+	snprintf( token, sizeof( token ), "%016lx", value );
+	return string( token, ZONE_TOKEN_SIZE );
+}
+
+/**
+ * @brief setZoneToken
+ *
+ * @param [in] string header - attribute line, may be followed by more lines
+ *
+ * @param [in] const string &token
+ *
+ * @return string the header with the token in its zones field, unchanged
+ *         if the attribute line has none
+ *
+ * @note None
+ */
+string setZoneToken( string header, const string &token )
+{
+	size_t fieldIndex = header.find( "\t" + ZONES_FIELD + " " );
+	if( fieldIndex != string::npos && fieldIndex < header.find( '\n' ) )
+	{
+		header.replace( fieldIndex + ZONES_FIELD.size() + 2, ZONE_TOKEN_SIZE, token );
+	}
+	return header;
+}
+
+/**
+ * @brief compareZoneValues
+ *
+ * @details orders two values of a column the way conditions compare them
+ *
+ * @param [in] const string &value
+ *
+ * @param [in] const string &other
+ *
+ * @param [in] int valueType - int and float columns compare by value,
+ *             strings by their text
+ *
+ * @return int negative, 0 or positive like string::compare
+ *
+ * @note None
+ */
+int compareZoneValues( const string &value, const string &other, int valueType )
+{
+	if( valueType == TYPE_FLOAT )
+	{
+		double number = atof( value.c_str() );
+		double otherNumber = atof( other.c_str() );
+		return ( number < otherNumber ) ? -1 : ( number > otherNumber ) ? 1 : 0;
+	}
+	if( valueType == TYPE_INT )
+	{
+		long number = atol( value.c_str() );
+		long otherNumber = atol( other.c_str() );
+		return ( number < otherNumber ) ? -1 : ( number > otherNumber ) ? 1 : 0;
+	}
+	return value.compare( other );
+}
+
+/**
+ * @brief includeZoneValue
+ *
+ * @details widens the range of a column of a zone to a value
+ *
+ * @par Algorithm a float that is not a number compares equal to everything,
+ *      so it is kept as both ends and the column is never skipped
+ *
+ * @param [in/out] Zone &zone
+ *
+ * @param [in] int column
+ *
+ * @param [in] const string &value - decoded value, not null
+ *
+ * @param [in] int valueType - type of the column
+ *
+ * @return None
+ *
+ * @note None
+ */
+void includeZoneValue( Zone &zone, int column, const string &value, int valueType )
+{
+	string &minimum = zone.minimums[ column ];
+	string &maximum = zone.maximums[ column ];
+	bool numeric = valueType == TYPE_FLOAT;
+	if( minimum.empty() || ( numeric && std::isnan( atof( value.c_str() ) ) ) )
+	{
+		minimum = value;
+		maximum = value;
+	}
+	else if( numeric && std::isnan( atof( minimum.c_str() ) ) )
+	{
+		return;
+	}
+	else if( compareZoneValues( value, minimum, valueType ) < 0 )
+	{
+		minimum = value;
+	}
+	else if( compareZoneValues( value, maximum, valueType ) > 0 )
+	{
+		maximum = value;
+	}
+}
+
+/**
+ * @brief mergeZone
+ *
+ * @details widens a zone to the ranges of another
+ *
+ * @param [in/out] Zone &zone
+ *
+ * @param [in] const Zone &other - columns it has no range for are dropped
+ *             from zone
+ *
+ * @param [in] const vector< int > &columnTypes
+ *
+ * @return None
+ *
+ * @note None
+ */
+void mergeZone( Zone &zone, const Zone &other, const vector< int > &columnTypes )
+{
+	if( other.minimums.size() < zone.minimums.size() )
+	{
+		zone.minimums.resize( other.minimums.size() );
+		zone.maximums.resize( other.maximums.size() );
+	}
+	int columnSize = zone.minimums.size();
+	for( int column = 0; column < columnSize; column++ )
+	{
+		if( !other.minimums[ column ].empty() )
+		{
+			includeZoneValue( zone, column, other.minimums[ column ], columnTypes[ column ] );
+			includeZoneValue( zone, column, other.maximums[ column ], columnTypes[ column ] );
+		}
+	}
+}
+
+/**
+ * @brief readZoneFile
+ *
+ * @details reads the zone map kept next to a table
+ *
+ * @par Algorithm the first line is the token of the table file the zones
+ *      describe. Then one line per zone: its start and end offset and the
+ *      smallest and largest value of each stored column
+ *
+ * @param [in] string zoneFilePath
+ *
+ * @param [in] const string &token - token of the table file being read
+ *
+ * @param [out] vector< Zone > &zones - in file order
+ *
+ * @return bool false if the file belongs to another table file or is damaged
+ *
+ * @note None
+ */
+bool readZoneFile( string zoneFilePath, const string &token, vector< Zone > &zones )
+{
+	ifstream fin( zoneFilePath.c_str() );
+	string line;
+	if( !fin.is_open() || !getline( fin, line ) || line != token )
+	{
+		return false;
+	}
+
+	zones.clear();
+	long previousEnd = 0;
+	while( getline( fin, line ) )
+	{
+		vector< string > fields = splitRow( line );
+		Zone zone;
+		zone.startOffset = atol( fields[ 0 ].c_str() );
+		zone.endOffset = ( fields.size() > 1 ) ? atol( fields[ 1 ].c_str() ) : 0;
+		if( fields.size() % 2 != 0 || zone.startOffset < previousEnd || zone.endOffset <= zone.startOffset )
+		{
+			return false;
+		}
+		for( unsigned int index = 2; index < fields.size(); index += 2 )
+		{
+			zone.minimums.push_back( fields[ index ] );
+			zone.maximums.push_back( fields[ index + 1 ] );
+		}
+		zones.push_back( zone );
+		previousEnd = zone.endOffset;
+	}
+	return true;
+}
+
+/**
+ * @brief writeZoneFile
+ *
+ * @details replaces the zone map kept next to a table, the reverse of
+ *          readZoneFile
+ *
+ * @par Algorithm written to a work file named after the token and renamed
+ *      over the old map. The map is not synced, a map lost in a crash is
+ *      ignored and built again
+ *
+ * @param [in] string zoneFilePath
+ *
+ * @param [in] const string &token
+ *
+ * @param [in] const vector< Zone > &zones
+ *
+ * @return bool true if the map was replaced
+ *
+ * @note None
+ */
+bool writeZoneFile( string zoneFilePath, const string &token, const vector< Zone > &zones )
+{
+	string tempPath = zoneFilePath + "." + token + ".tmp";
+	ofstream fout( tempPath.c_str(), ofstream::trunc );
+	fout << token;
+	for( unsigned int index = 0; index < zones.size(); index++ )
+	{
+		fout << "\n" << zones[ index ].startOffset << "\t" << zones[ index ].endOffset;
+		for( unsigned int column = 0; column < zones[ index ].minimums.size(); column++ )
+		{
+			fout << "\t" << zones[ index ].minimums[ column ] << "\t" << zones[ index ].maximums[ column ];
+		}
+	}
+	fout << "\n";
+	fout.close();
+
+	if( fout.fail() || rename( tempPath.c_str(), zoneFilePath.c_str() ) != 0 )
+	{
+		unlink( tempPath.c_str() );
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief getValueHash
+ *
+ * @details hashes a value for the Bloom filters with 64 bit FNV-1a, which
+ *          stays the same across builds unlike std::hash
+ *
+ * @param [in] const string &value - decoded value
+ *
+ * @return unsigned long
+ *
+ * @note None
+ */
+unsigned long getValueHash( const string &value )
+{
+	unsigned long hash = 14695981039346656037UL;
+	for( unsigned int index = 0; index < value.size(); index++ )
+	{
+		hash ^= (unsigned char) value[ index ];
+		hash *= 1099511628211UL;
+	}
+	return hash;
+}
+
+/**
+ * @brief getFilterBit
+ *
+ * @details finds one of the bits a value sets in a Bloom filter
+ *
+ * @par Algorithm double hashing, the second hash is the first one mixed
+ *      again and made odd so the bits of a value differ
+ *
+ * @param [in] unsigned long hash - from getValueHash
+ *
+ * @param [in] int round - 0 up to BLOOM_HASH_COUNT
+ *
+ * @param [in] unsigned long bitCount
+ *
+ * @return unsigned long
+ *
+ * @note None
+ */
+unsigned long getFilterBit( unsigned long hash, int round, unsigned long bitCount )
+{
+	unsigned long mixed = ( hash ^ ( hash >> 31 ) ) * 0x9E3779B97F4A7C15UL;
+	mixed = ( mixed ^ ( mixed >> 29 ) ) | 1;
+	return ( hash + round * mixed ) % bitCount;
+}
+
+/**
+ * @brief addToFilter
+ *
+ * @param [in/out] string &filter - bits of a Bloom filter
+ *
+ * @param [in] unsigned long hash - from getValueHash
+ *
+ * @return None
+ *
+ * @note None
+ */
+void addToFilter( string &filter, unsigned long hash )
+{
+	unsigned long bitCount = filter.size() * 8;
+	for( int round = 0; round < BLOOM_HASH_COUNT; round++ )
+	{
+		unsigned long bit = getFilterBit( hash, round, bitCount );
+		filter[ bit / 8 ] |= (char) ( 1 << ( bit % 8 ) );
+	}
+}
+
+/**
+ * @brief filterMayContain
+ *
+ * @param [in] const string &filter - bits of a Bloom filter
+ *
+ * @param [in] unsigned long hash - from getValueHash
+ *
+ * @return bool false only if no value with the hash was added
+ *
+ * @note None
+ */
+bool filterMayContain( const string &filter, unsigned long hash )
+{
+	unsigned long bitCount = filter.size() * 8;
+	for( int round = 0; round < BLOOM_HASH_COUNT && bitCount > 0; round++ )
+	{
+		unsigned long bit = getFilterBit( hash, round, bitCount );
+		if( ( filter[ bit / 8 ] & ( 1 << ( bit % 8 ) ) ) == 0 )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief readBloomFile
+ *
+ * @details reads the Bloom filters of a zone map
+ *
+ * @par Algorithm the first line is the token of the table file. Then one
+ *      line per zone with filters: its start offset and the bits of the
+ *      filter of each stored column in hex, empty for columns without one
+ *
+ * @param [in] string bloomFilePath
+ *
+ * @param [in] const string &token
+ *
+ * @param [in/out] vector< Zone > &zones - filters are set by start offset
+ *
+ * @return bool false if the file belongs to another table file
+ *
+ * @note None
+ */
+bool readBloomFile( string bloomFilePath, const string &token, vector< Zone > &zones )
+{
+	ifstream fin( bloomFilePath.c_str() );
+	string line;
+	if( !fin.is_open() || !getline( fin, line ) || line != token )
+	{
+		return false;
+	}
+
+	unsigned int zoneIndex = 0;
+	while( getline( fin, line ) )
+	{
+		vector< string > fields = splitRow( line );
+		long startOffset = atol( fields[ 0 ].c_str() );
+		while( zoneIndex < zones.size() && zones[ zoneIndex ].startOffset < startOffset )
+		{
+			zoneIndex++;
+		}
+		if( zoneIndex == zones.size() || zones[ zoneIndex ].startOffset != startOffset )
+		{
+			continue;
+		}
+
+		Zone &zone = zones[ zoneIndex ];
+		zone.filters.assign( fields.size() - 1, "" );
+		for( unsigned int column = 1; column < fields.size(); column++ )
+		{
+			const string &hex = fields[ column ];
+			string &filter = zone.filters[ column - 1 ];
+			for( unsigned int index = 0; index + 1 < hex.size(); index += 2 )
+			{
+				filter += (char) strtol( hex.substr( index, 2 ).c_str(), NULL, 16 );
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief writeBloomFile
+ *
+ * @details replaces the Bloom filters of a zone map, the reverse of
+ *          readBloomFile
+ *
+ * @param [in] string bloomFilePath
+ *
+ * @param [in] const string &token
+ *
+ * @param [in] const vector< Zone > &zones
+ *
+ * @return bool true if the filters were replaced, or removed when no zone
+ *         has one
+ *
+ * @note None
+ */
+bool writeBloomFile( string bloomFilePath, const string &token, const vector< Zone > &zones )
+{
+	string tempPath = bloomFilePath + "." + token + ".tmp";
+	ofstream fout( tempPath.c_str(), ofstream::trunc );
+	fout << token;
+	bool filtered = false;
+	char hex[ 3 ];
+	for( unsigned int index = 0; index < zones.size(); index++ )
+	{
+		if( zones[ index ].filters.empty() )
+		{
+			continue;
+		}
+		filtered = true;
+		fout << "\n" << zones[ index ].startOffset;
+		for( unsigned int column = 0; column < zones[ index ].filters.size(); column++ )
+		{
+			const string &filter = zones[ index ].filters[ column ];
+			fout << "\t";
+			for( unsigned int byte = 0; byte < filter.size(); byte++ )
+			{
+				snprintf( hex, sizeof( hex ), "%02x", (unsigned char) filter[ byte ] );
+				fout << hex;
+			}
+		}
+	}
+	fout << "\n";
+	fout.close();
+
+	if( !filtered )
+	{
+		unlink( tempPath.c_str() );
+		return unlink( bloomFilePath.c_str() ) == 0 || access( bloomFilePath.c_str(), F_OK ) != 0;
+	}
+	if( fout.fail() || rename( tempPath.c_str(), bloomFilePath.c_str() ) != 0 )
+	{
+		unlink( tempPath.c_str() );
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief setZoneColumns
+ *
+ * @details finds for each column of the records written whether its values
+ *          are compared by value and whether its zones get a Bloom filter,
+ *          those of a compaction follow the schema
+ *
+ * @par Algorithm float columns compare by value, so equal values may be
+ *      written differently and are not filtered. Neither are columns
+ *      dropped or modified since the file was written
+ *
+ * @return None
+ *
+ * @note sets columnTypes and filteredColumns
+ */
+void TableScan::setZoneColumns()
+{
+	columnTypes.clear();
+	filteredColumns.clear();
+	int columnSize = compacting ? attributes.size() : storedColumns.size();
+	for( int column = 0; column < columnSize; column++ )
+	{
+		const Attribute &attribute = compacting ? attributes[ column ] : storedColumns[ column ].attribute;
+		int valueType = getValueType( attribute.attributeType );
+		bool changed = !compacting && ( storedColumns[ column ].dropped || storedColumns[ column ].modified );
+		columnTypes.push_back( valueType );
+		filteredColumns.push_back( valueType != TYPE_FLOAT && !changed &&
+			find( bloomColumns.begin(), bloomColumns.end(), attribute.attributeName ) != bloomColumns.end() );
+	}
+}
+
+/**
+ * @brief addToZone
+ *
+ * @details widens a zone to the values of a written record
+ *
+ * @param [in/out] Zone &zone
+ *
+ * @param [in] const vector< string > &values - stored values, a record
+ *             written before a column was added gets its default
+ *
+ * @param [in/out] vector< vector< unsigned long > > &valueHashes - hashes
+ *                 of the values of each filtered column
+ *
+ * @return None
+ *
+ * @note setZoneColumns must have been called
+ */
+void TableScan::addToZone( Zone &zone, const vector< string > &values, vector< vector< unsigned long > > &valueHashes )
+{
+	int columnSize = zone.minimums.size();
+	int valueSize = values.size();
+	for( int column = 0; column < columnSize; column++ )
+	{
+		const string &stored = ( column < valueSize ) ? values[ column ] : compacting ? "" : storedColumns[ column ].defaultValue;
+		if( !isNullValue( stored ) )
+		{
+			string value = decodeOutputValue( column, stored );
+			if( !isNullValue( value ) )
+			{
+				includeZoneValue( zone, column, value, columnTypes[ column ] );
+				if( filteredColumns[ column ] )
+				{
+					valueHashes[ column ].push_back( getValueHash( value ) );
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief buildFilters
+ *
+ * @details gives a zone the Bloom filters of the values added to it
+ *
+ * @par Algorithm a filter is sized to the distinct values of its column,
+ *      BLOOM_BITS_PER_VALUE bits each and at least 64
+ *
+ * @param [in/out] Zone &zone
+ *
+ * @param [in/out] vector< vector< unsigned long > > &valueHashes - from
+ *                 addToZone, emptied
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TableScan::buildFilters( Zone &zone, vector< vector< unsigned long > > &valueHashes )
+{
+	int columnSize = filteredColumns.size();
+	if( find( filteredColumns.begin(), filteredColumns.end(), true ) == filteredColumns.end() )
+	{
+		return;
+	}
+	zone.filters.assign( columnSize, "" );
+	for( int column = 0; column < columnSize; column++ )
+	{
+		vector< unsigned long > &hashes = valueHashes[ column ];
+		if( !filteredColumns[ column ] )
+		{
+			continue;
+		}
+		sort( hashes.begin(), hashes.end() );
+		hashes.erase( unique( hashes.begin(), hashes.end() ), hashes.end() );
+		long filterSize = max( ( long ) ( hashes.size() * BLOOM_BITS_PER_VALUE + 63 ) / 64 * 8, 8L );
+		zone.filters[ column ].assign( filterSize, '\0' );
+		for( unsigned int index = 0; index < hashes.size(); index++ )
+		{
+			addToFilter( zone.filters[ column ], hashes[ index ] );
+		}
+		hashes.clear();
+	}
+}
+
+/**
+ * @brief saveZones
+ *
+ * @details writes the zone map of a table file with its Bloom filters
+ *
+ * @par Algorithm the filters go first, a reader that sees the new zones
+ *      then also finds filters holding every value of them
+ *
+ * @param [in] const string &token - token of the table file
+ *
+ * @param [in] const vector< Zone > &zoneList
+ *
+ * @return bool true if both were written
+ *
+ * @note None
+ */
+bool TableScan::saveZones( const string &token, const vector< Zone > &zoneList )
+{
+	return writeBloomFile( bloomFilePath, token, zoneList ) && writeZoneFile( zoneFilePath, token, zoneList );
+}
+
+/**
+ * @brief loadZones
+ *
+ * @details reads the zone map of the table file being scanned
+ *
+ * @par Algorithm the token is read from the attribute line of the open file,
+ *      a snapshot keeps the token of its version. The map is read again only
+ *      once the token or the zone file changed. A map of another version of
+ *      the file is not used
+ *
+ * @param [in] int fd - open table file, -1 if it could not be opened
+ *
+ * @return None
+ *
+ * @note a zone may reach past the end of a snapshot, its range still holds
+ *       every record of the snapshot that starts in it. A scan of another
+ *       file of the table's engine keeps the zones read with it
+ */
+void TableScan::loadZones( int fd )
+{
+	if( zoneFilePath.empty() )
+	{
+		return;
+	}
+	size_t fieldIndex = attributeData.find( "\t" + ZONES_FIELD + " " );
+	char token[ ZONE_TOKEN_SIZE ];
+	if( fd < 0 || fieldIndex == string::npos || pread( fd, token, ZONE_TOKEN_SIZE, fieldIndex + ZONES_FIELD.size() + 2 ) != ZONE_TOKEN_SIZE )
+	{
+		zoneToken.clear();
+		zoneStamp.clear();
+		zones.reset();
+		filtersLoaded = false;
+		return;
+	}
+	zoneToken.assign( token, ZONE_TOKEN_SIZE );
+
+	struct stat buffer;
+	if( stat( zoneFilePath.c_str(), &buffer ) != 0 )
+	{
+		zoneStamp.clear();
+		zones.reset();
+		filtersLoaded = false;
+		return;
+	}
+	string stamp = zoneToken + " " + to_string( buffer.st_ino ) + " " + to_string( buffer.st_size ) + " " +
+		to_string( buffer.st_mtim.tv_sec ) + "." + to_string( buffer.st_mtim.tv_nsec );
+	if( stamp == zoneStamp )
+	{
+		return;
+	}
+
+	vector< Zone > loaded;
+	zoneStamp = stamp;
+	zones.reset();
+	filtersLoaded = false;
+	if( readZoneFile( zoneFilePath, zoneToken, loaded ) )
+	{
+		zones.reset( new vector< Zone >( loaded ) );
+	}
+}
+
+/**
+ * @brief loadFilters
+ *
+ * @details adds the Bloom filters to the loaded zone map when a condition
+ *          can use them
+ *
+ * @par Algorithm only = on a filtered column that is stored unchanged can
+ *      be ruled out by a filter, other conditions leave the file unread. The
+ *      zones are copied, as scans prepared from this one share them
+ *
+ * @param [in] const WhereCondition *wCond - NULL to load the filters for
+ *             writing the zone map
+ *
+ * @return None
+ *
+ * @note None
+ */
+void TableScan::loadFilters( const WhereCondition *wCond )
+{
+	if( zones == NULL || filtersLoaded || bloomColumns.empty() )
+	{
+		return;
+	}
+	if( wCond != NULL )
+	{
+		if( wCond->operatorValue != "=" || wCond->comparisonValue.empty() || wCond->attributeIndex < 0 ||
+			wCond->attributeIndex >= (int) storedIndexes.size() )
+		{
+			return;
+		}
+		const StoredColumn &column = storedColumns[ storedIndexes[ wCond->attributeIndex ] ];
+		if( column.modified || find( bloomColumns.begin(), bloomColumns.end(), column.attribute.attributeName ) == bloomColumns.end() )
+		{
+			return;
+		}
+	}
+
+	vector< Zone > loaded( *zones );
+	readBloomFile( bloomFilePath, zoneToken, loaded );
+	zones.reset( new vector< Zone >( loaded ) );
+	filtersLoaded = true;
+}
+
+/**
+ * @brief morselMayMatch
+ *
+ * @details tells from the zone of a morsel whether any of its records can
+ *          satisfy a condition
+ *
+ * @par Algorithm only comparisons with a value are ruled out. = needs the
+ *      value within the range of the zone and in its Bloom filter if it has
+ *      one, < and <= a smallest value below it, > and >= a largest value
+ *      above it. Comparisons never match a zone holding only nulls. Columns
+ *      changed since the zone was taken are not ruled out
+ *
+ * @param [in] const Morsel &morsel
+ *
+ * @param [in] const WhereCondition &wCond
+ *
+ * @return bool false only if no record of the morsel satisfies the condition
+ *
+ * @note None
+ */
+bool TableScan::morselMayMatch( const Morsel &morsel, const WhereCondition &wCond )
+{
+	const string &operatorValue = wCond.operatorValue;
+	if( zones == NULL || morsel.zoneIndex < 0 || morsel.zoneIndex >= (int) zones->size() || wCond.comparisonValue.empty() ||
+		wCond.attributeIndex < 0 || wCond.attributeIndex >= (int) storedIndexes.size() ||
+		( operatorValue != "=" && operatorValue != "<" && operatorValue != "<=" && operatorValue != ">" && operatorValue != ">=" ) )
+	{
+		return true;
+	}
+
+	//the range must be ordered the way the condition compares
+	int storedIndex = storedIndexes[ wCond.attributeIndex ];
+	const StoredColumn &column = storedColumns[ storedIndex ];
+	const Zone &zone = ( *zones )[ morsel.zoneIndex ];
+	int valueType = getValueType( column.attribute.attributeType );
+	if( column.modified || storedIndex >= (int) zone.minimums.size() ||
+		wCond.floatValue != ( valueType == TYPE_FLOAT ) || wCond.intValue != ( valueType == TYPE_INT ) )
+	{
+		return true;
+	}
+	const string &minimum = zone.minimums[ storedIndex ];
+	const string &maximum = zone.maximums[ storedIndex ];
+	if( minimum.empty() )
+	{
+		return false;
+	}
+
+	int lowComparison;
+	int highComparison;
+	if( wCond.floatValue )
+	{
+		double low = atof( minimum.c_str() );
+		double high = atof( maximum.c_str() );
+		double value = wCond.comparisonValueFloat;
+		if( std::isnan( low ) || std::isnan( value ) )
+		{
+			return true;
+		}
+		lowComparison = ( low < value ) ? -1 : ( low > value ) ? 1 : 0;
+		highComparison = ( high < value ) ? -1 : ( high > value ) ? 1 : 0;
+	}
+	else if( wCond.intValue )
+	{
+		long low = atol( minimum.c_str() );
+		long high = atol( maximum.c_str() );
+		long value = wCond.comparisonValueInt;
+		lowComparison = ( low < value ) ? -1 : ( low > value ) ? 1 : 0;
+		highComparison = ( high < value ) ? -1 : ( high > value ) ? 1 : 0;
+	}
+	else
+	{
+		lowComparison = minimum.compare( wCond.comparisonValue );
+		highComparison = maximum.compare( wCond.comparisonValue );
+	}
+
+	if( operatorValue == "=" )
+	{
+		if( lowComparison > 0 || highComparison < 0 )
+		{
+			return false;
+		}
+		return storedIndex >= (int) zone.filters.size() || zone.filters[ storedIndex ].empty() ||
+			filterMayContain( zone.filters[ storedIndex ], getValueHash( wCond.comparisonValue ) );
+	}
+	else if( operatorValue == "<" )
+	{
+		return lowComparison < 0;
+	}
+	else if( operatorValue == "<=" )
+	{
+		return lowComparison <= 0;
+	}
+	else if( operatorValue == ">" )
+	{
+		return highComparison > 0;
+	}
+	return highComparison >= 0;
+}
+
+/**
+ * @brief extendZones
+ *
+ * @details adds zones for the records appended to the table since its zone
+ *          map was written
+ *
+ * @par Algorithm the morsels behind the last zone become zones, except the
+ *      last one which records are still being appended to. Their ranges are
+ *      taken in parallel. A table whose zone map was lost gets a new one,
+ *      one whose map was written for a newer version of the file by a
+ *      rewrite not yet renamed over it is left alone
+ *
+ * @return bool false if the zone map could not be written
+ *
+ * @note the table must not be written while its zones are extended
+ */
+bool TableScan::extendZones()
+{
+	vector< Morsel > morsels = getMorsels( MORSEL_SIZE );
+	struct stat zoneBuffer;
+	struct stat tableBuffer;
+	if( zoneToken.empty() || ( zones == NULL && stat( zoneFilePath.c_str(), &zoneBuffer ) == 0 &&
+		stat( filePath.c_str(), &tableBuffer ) == 0 && ( zoneBuffer.st_mtim.tv_sec > tableBuffer.st_mtim.tv_sec ||
+		( zoneBuffer.st_mtim.tv_sec == tableBuffer.st_mtim.tv_sec && zoneBuffer.st_mtim.tv_nsec >= tableBuffer.st_mtim.tv_nsec ) ) ) )
+	{
+		return true;
+	}
+
+	loadFilters( NULL );
+	vector< Zone > extended;
+	if( zones != NULL )
+	{
+		extended = *zones;
+	}
+	long zonedEnd = extended.empty() ? dataOffset : extended.back().endOffset;
+	vector< int > newMorsels;
+	int morselCount = morsels.size();
+	for( int index = 0; index + 1 < morselCount; index++ )
+	{
+		if( morsels[ index ].zoneIndex < 0 && morsels[ index ].startOffset >= zonedEnd )
+		{
+			newMorsels.push_back( index );
+		}
+	}
+	if( newMorsels.empty() )
+	{
+		return true;
+	}
+
+	setZoneColumns();
+	int newSize = newMorsels.size();
+	vector< Zone > newZones( newSize );
+	parallelFor( newSize, [ & ]( int index )
+	{
+		Zone &zone = newZones[ index ];
+		vector< vector< unsigned long > > valueHashes( columnTypes.size() );
+		zone.startOffset = morsels[ newMorsels[ index ] ].startOffset;
+		zone.endOffset = morsels[ newMorsels[ index ] + 1 ].startOffset;
+		zone.minimums.resize( columnTypes.size() );
+		zone.maximums.resize( columnTypes.size() );
+		forEachRow( morsels[ newMorsels[ index ] ], [ & ]( string &line )
+		{
+			vector< string > values = splitRow( line );
+			if( recordWidth > 0 )
+			{
+				values.back().erase( values.back().find_last_not_of( ' ' ) + 1 );
+			}
+			addToZone( zone, values, valueHashes );
+		} );
+		buildFilters( zone, valueHashes );
+	} );
+	extended.insert( extended.end(), newZones.begin(), newZones.end() );
+	if( !saveZones( zoneToken, extended ) )
+	{
+		return false;
+	}
+	zones.reset( new vector< Zone >( extended ) );
+	return true;
+}
+
+/**
+ * @brief widenZones
+ *
+ * @details widens the zones of the records a commit overwrites in place
+ *
+ * @par Algorithm done before the records are written, so a zone never
+ *      misses a value of its records. New values are added to the Bloom
+ *      filters of their zones. A zone map that cannot be written is removed
+ *
+ * @param [in] const map< long, string > &writes - new record by offset
+ *
+ * @return bool false if the zone map could neither be written nor removed
+ *
+ * @note None
+ */
+bool TableScan::widenZones( const map< long, string > &writes )
+{
+	int fd = open( filePath.c_str(), O_RDONLY );
+	loadZones( fd );
+	if( fd >= 0 )
+	{
+		close( fd );
+	}
+	if( zones == NULL )
+	{
+		return true;
+	}
+
+	loadFilters( NULL );
+	vector< Zone > widened = *zones;
+	setZoneColumns();
+	int zoneIndex = 0;
+	int zoneCount = widened.size();
+	for( map< long, string >::const_iterator it = writes.begin(); it != writes.end(); ++it )
+	{
+		while( zoneIndex < zoneCount && widened[ zoneIndex ].endOffset <= it->first )
+		{
+			zoneIndex++;
+		}
+		if( zoneIndex < zoneCount && widened[ zoneIndex ].startOffset <= it->first )
+		{
+			vector< string > values = splitRow( it->second );
+			values.back().erase( values.back().find_last_not_of( ' ' ) + 1 );
+			vector< vector< unsigned long > > valueHashes( columnTypes.size() );
+			Zone &zone = widened[ zoneIndex ];
+			addToZone( zone, values, valueHashes );
+			for( int column = 0; column < (int) zone.filters.size() && column < (int) valueHashes.size(); column++ )
+			{
+				for( unsigned int index = 0; index < valueHashes[ column ].size() && !zone.filters[ column ].empty(); index++ )
+				{
+					addToFilter( zone.filters[ column ], valueHashes[ column ][ index ] );
+				}
+			}
+		}
+	}
+	if( !saveZones( zoneToken, widened ) )
+	{
+		zones.reset();
+		return unlink( zoneFilePath.c_str() ) == 0 || access( zoneFilePath.c_str(), F_OK ) != 0;
+	}
+	zones.reset( new vector< Zone >( widened ) );
+	return true;
+}
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -0,0 +1,73 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file ZoneMap.h
+ *
+ * @brief Definition file for the zone maps and Bloom filters of table files
+ *
+ * @details Specifies the zones a table file is cut into, the range of values
+ *          and the Bloom filter each keeps per column, and the hidden files
+ *          they are saved in next to the table
+ *
+ * @Note None
+ */
+
+#include <vector>
+#include <string>
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef ZONEMAP_H
+#define ZONEMAP_H
+
+//field of the attribute line holding the token of the table file's zone
+//map. A rewritten file gets a new token of the same length, so the records
+//start at the same offset
+const string ZONES_FIELD = "#zones";
+const int ZONE_TOKEN_SIZE = 16;
+
+//hidden file next to a table holding the zone map of the table file whose
+//token is on its first line
+const string ZONES_SUFFIX = "zones";
+
+//field of the attribute line naming the columns whose zones get a Bloom
+//filter, separated by commas
+const string BLOOM_FIELD = "#bloom";
+
+//hidden file next to a table holding the Bloom filters of its zone map, only
+//read for conditions they can rule out
+const string BLOOM_SUFFIX = "bloom";
+
+//a filter has this many bits per distinct value of its zone and sets this
+//many of them per value, about one lookup in a hundred is a false match
+const int BLOOM_BITS_PER_VALUE = 10;
+const int BLOOM_HASH_COUNT = 7;
+
+//smallest and largest value of each stored column among the records
+//starting in a byte range of the table file, empty when all are null.
+//filters holds the Bloom filter of each stored column, empty for columns
+//without one
+struct Zone{
+	long startOffset;
+	long endOffset;
+	vector< string > minimums;
+	vector< string > maximums;
+	vector< string > filters;
+};
+
+string newZoneToken();
+string setZoneToken( string header, const string &token );
+int compareZoneValues( const string &value, const string &other, int valueType );
+void includeZoneValue( Zone &zone, int column, const string &value, int valueType );
+void mergeZone( Zone &zone, const Zone &other, const vector< int > &columnTypes );
+bool readZoneFile( string zoneFilePath, const string &token, vector< Zone > &zones );
+bool writeZoneFile( string zoneFilePath, const string &token, const vector< Zone > &zones );
+unsigned long getValueHash( const string &value );
+unsigned long getFilterBit( unsigned long hash, int round, unsigned long bitCount );
+void addToFilter( string &filter, unsigned long hash );
+bool filterMayContain( const string &filter, unsigned long hash );
+bool readBloomFile( string bloomFilePath, const string &token, vector< Zone > &zones );
+bool writeBloomFile( string bloomFilePath, const string &token, const vector< Zone > &zones );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif
@@ -13,7 +13,7 @@
  *		  Eugene Nelson (March 27 2018)
  *          Original code
  *
- * @Note Requires sim.cpp
+ * @Note Requires sim.h, links against libdbms.a
  */
 #include <iostream>
 #include <string>
@@ -22,18 +22,65 @@
 #include <fstream>
 #include <stdlib.h>
 #include <unistd.h>
-#include "sim.cpp"
+#include "sim.h"
 
 using namespace std;
 
-int main()
+int main( int argc, char *argv[] )
 {
+	string serverPath;
+	string clientPath;
+
+	//--threads N overrides the number of scheduler workers
+	//--server PATH serves clients on a socket, --client PATH connects to one
+	//--checkpoint SECONDS sets how much commit log a restart may have to redo
+	//--result-cache MB sets the memory kept for query results, 0 turns it off
+	//--sync-commit off lets autocommits return before the log is synced
+	for( int index = 1; index < argc; index++ )
+	{
+		if( strcmp( argv[ index ], "--threads" ) == 0 && index + 1 < argc )
+		{
+			setThreadPoolSize( atoi( argv[ ++index ] ) );
+		}
+		else if( strcmp( argv[ index ], "--checkpoint" ) == 0 && index + 1 < argc )
+		{
+			setCheckpointInterval( atoi( argv[ ++index ] ) );
+		}
+		else if( strcmp( argv[ index ], "--result-cache" ) == 0 && index + 1 < argc )
+		{
+			setResultCacheSize( atol( argv[ ++index ] ) << 20 );
+		}
+		else if( strcmp( argv[ index ], "--sync-commit" ) == 0 && index + 1 < argc )
+		{
+			setSyncCommit( strcmp( argv[ ++index ], "off" ) != 0 );
+		}
+		else if( strcmp( argv[ index ], "--server" ) == 0 && index + 1 < argc )
+		{
+			serverPath = argv[ ++index ];
+		}
+		else if( strcmp( argv[ index ], "--client" ) == 0 && index + 1 < argc )
+		{
+			clientPath = argv[ ++index ];
+		}
+	}
+
 	//get current working directory
 	char buffer[200];
 	getcwd( buffer, sizeof( buffer ) );
 	string currentWorkingDirectory( buffer );
 
-	startSimulation( currentWorkingDirectory );
+	if( !clientPath.empty() )
+	{
+		startClient( clientPath );
+	}
+	else if( !serverPath.empty() )
+	{
+		startServer( currentWorkingDirectory, serverPath );
+	}
+	else
+	{
+		startSimulation( currentWorkingDirectory );
+	}
 
 	return 0;
 }
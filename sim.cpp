@@ -27,7 +27,14 @@
 #include <fstream>
 #include <stdlib.h>
 #include <unistd.h>
+#include "sim.h"
 #include "Database.cpp"
+#include "PreparedStatement.cpp"
+#include "LockManager.cpp"
+#include "CommitLog.cpp"
+#include "ResultCache.cpp"
+#include "Connection.cpp"
+#include "Server.cpp"
 
 using namespace std;
 
@@ -54,12 +61,13 @@ void startSimulation( string currentWorkingDirectory );
 bool exitCheck( string str );
 bool stringValid( string str );
 bool removeSemiColon( string &input );
-bool startEvent( string input, vector< Database> &dbms, string currentWorkingDirectory, string &currentDatabase );
+bool startEvent( string input, vector< Database> &dbms, string currentWorkingDirectory, string &currentDatabase, bool &errorCode, ostream &out, shared_ptr< Operator > &plan );
+bool prepareStatement( string input, vector< Database > &dbms, string currentWorkingDirectory, string currentDatabase, PreparedStatement &prepared, int &errorType, string &errorContainerName );
 string getNextWord( string &input );
 bool databaseExists( vector<Database> dbms, Database dbInput, int &dbReturn );
 void removeDatabase( vector< Database > &dbms, int index );
 void removeTable( vector< Database > &dbms, int dbReturn, int tblReturn );
-void handleError( int errorType, string commandError, string errorContainerName );
+void handleError( int errorType, string commandError, string errorContainerName, ostream &out );
 void convertToLC( string &input );
 void convertToUC( string &input );
 string getQueryType( string &input );
@@ -67,35 +75,6 @@ string getWhereCondition( string &input );
 string getSetCondition( string &input );
 void removeNewLine( string &input );
 
-/**
- * @brief read_Directory method
- *
- * @details reads contents of a directory into a vector
- *
- * @param [in] string &name
- *             
- * @param [in] vector <string &v>
- *
- * @return bool
- *
- * @note Code from stack overflow
- */
-bool read_directory(const std::string& name, vector< string >& v)
-{
-	struct stat buffer;
-	if( !( stat( name.c_str(), &buffer ) == 0 ) )
-		return false;
-
-    DIR* dirp = opendir(name.c_str());
-    struct dirent * dp;
-    while ((dp = readdir(dirp)) != NULL) {
-        v.push_back(dp->d_name);
-    }
-    closedir(dirp);
-
-    return true;
-}
-
 /**
  * @brief startSimulation 
  *
@@ -107,7 +86,7 @@ bool read_directory(const std::string& name, vector< string >& v)
  *
  * @par Algorithm 
  *      Loop until .EXIT is inputted from terminal
- *		Otherwise parse string to find out what action to take
+ *		Otherwise run the statement on a Connection and display its result
  *      
  * @exception None
  *
@@ -121,62 +100,11 @@ bool read_directory(const std::string& name, vector< string >& v)
  */
 void startSimulation( string currentWorkingDirectory )
 {
-	currentWorkingDirectory += "/DatabaseSystem";
-
-	// Check if the database system directory exists
-	struct stat buffer;
-	if( !( stat( currentWorkingDirectory.c_str(), &buffer ) == 0 ) )
-	{
-		// if not, create it.
-		system( ( "mkdir " + currentWorkingDirectory ).c_str() );
-	}
-
 	string input;
 	string temp;
-	string currentDatabase;
-	vector< Database > dbms;
+	Connection connection;
 
-	// Retrieve all of the information about existing directories
-	vector< string > directoryItems;
-	if( read_directory( currentWorkingDirectory, directoryItems ) )
-	{
-		for( unsigned int i = 0; i < directoryItems.size(); i++ )
-		{
-			if(directoryItems[i] == "." || directoryItems[i] == "..")
-			{
-				directoryItems.erase(directoryItems.begin() + i);
-				i--;
-			}
-			else
-			{
-				Database tempDatabase;
-				tempDatabase.databaseName = directoryItems[i];
-
-				vector< string > tableItems;
-				Table tempTable;
-
-				if( read_directory( currentWorkingDirectory + "/" + tempDatabase.databaseName, tableItems ) )
-				{
-					for( unsigned int j = 0; j < tableItems.size(); j++ )
-					{
-						if(tableItems[j] == "." || tableItems[j] == "..")
-						{
-							tableItems.erase(tableItems.begin() + j);
-							j--;
-						}
-						else
-						{
-							tempTable.tableName = tableItems[j];
-
-							tempDatabase.databaseTable.push_back(tempTable);
-						}
-					}
-				}
-
-				dbms.push_back(tempDatabase);
-			}
-		}
-	}
+	connection.open( currentWorkingDirectory );
 
 	bool simulationEnd = false;
 
@@ -198,8 +126,10 @@ void startSimulation( string currentWorkingDirectory )
 		//first checks that data is valid, if not valid will not check for semi colon
 		if(  !simulationEnd && stringValid( input ) ) 
 		{ 
-			//call helper function to check if modifying db or tbl
-			simulationEnd = startEvent( input, dbms, currentWorkingDirectory, currentDatabase );
+			//run the statement on the connection and display its result
+			ResultSet result = connection.execute( input );
+			result.print( cout );
+			simulationEnd = result.isExit();
 		}
 	}while( simulationEnd == false );
 
@@ -312,11 +242,17 @@ bool removeSemiColon( string &input )
  *
  * @param [out] dbms provides system of database to add databases and tables
  *
- * @return None
+ * @param [out] errorCode is set if the statement failed
+ *
+ * @param [in] out provides stream that receives the messages
+ *
+ * @param [out] plan provides query plan of a select, left empty otherwise
+ *
+ * @return bool true if the program is to exit
  *
  * @note None
  */
-bool startEvent( string input, vector< Database> &dbms, string currentWorkingDirectory, string &currentDatabase )
+bool startEvent( string input, vector< Database> &dbms, string currentWorkingDirectory, string &currentDatabase, bool &errorCode, ostream &out, shared_ptr< Operator > &plan )
 {
 	bool exitProgram = false;
 	bool errorExists = false;
@@ -336,32 +272,18 @@ bool startEvent( string input, vector< Database> &dbms, string currentWorkingDir
 
 	string containerType;
 
-	if( caseInsCompare( actionType, SELECT ) )
+	if( caseInsCompare( actionType, SELECT ) || actionType.compare( INSERT ) == 0 ||
+		actionType.compare( UPDATE ) == 0 || actionType.compare( DELETE ) == 0 )
 	{
-		Database dbTemp;
-		dbTemp.databaseName = currentDatabase;
-		databaseExists( dbms, dbTemp, dbReturn );
-
-		//get all words before from
-		string qType = getQueryType( input );
-
-		//get table name
-		string tName = getNextWord( input );
-
-		Table tblTemp;
-		tblTemp.tableName = tName;
-
-		string cType = getWhereCondition( input );
-
-		if( !(dbms[ dbReturn ].tableExists( tblTemp.tableName, tblReturn )) )
+		//parse and resolve the statement, then run it
+		PreparedStatement prepared;
+		if( prepareStatement( originalInput, dbms, currentWorkingDirectory, currentDatabase, prepared, errorType, errorContainerName ) )
 		{
-			errorExists = true;
-			errorType = ERROR_TBL_NOT_EXISTS;
-			errorContainerName = tblTemp.tableName;		
+			executePrepared( prepared, errorCode, out, plan );
 		}
 		else
 		{
-			tblTemp.tableSelect( currentWorkingDirectory, currentDatabase, cType, qType );
+			errorExists = true;
 		}
 	}
 	else if( caseInsCompare( actionType, USE) )
@@ -376,7 +298,7 @@ bool startEvent( string input, vector< Database> &dbms, string currentWorkingDir
 		{
 			//if it does then set current database as string
 			currentDatabase = dbTemp.databaseName;
-			dbTemp.databaseUse();
+			dbTemp.databaseUse( out );
 		}
 		else
 		{
@@ -415,7 +337,7 @@ bool startEvent( string input, vector< Database> &dbms, string currentWorkingDir
 				dbms.push_back( dbTemp );
 
 				//create directory
-				dbTemp.databaseCreate();
+				dbTemp.databaseCreate( currentWorkingDirectory, out );
 			}
 		}
 		//table create
@@ -447,7 +369,7 @@ bool startEvent( string input, vector< Database> &dbms, string currentWorkingDir
 				if( !(dbms[ dbReturn ].tableExists( tblTemp.tableName, tblReturn )) )
 				{
 					//check that table attributes are not the same
-					tblTemp.tableCreate( currentWorkingDirectory, currentDatabase, tblTemp.tableName, input, attrError );
+					tblTemp.tableCreate( currentWorkingDirectory, currentDatabase, tblTemp.tableName, input, attrError, out );
 					if( !attrError  )
 					{
 						//if it doesnt then push table onto database	
@@ -497,7 +419,7 @@ bool startEvent( string input, vector< Database> &dbms, string currentWorkingDir
 				removeDatabase( dbms, dbReturn );
 
 				//remove directory
-				dbTemp.databaseDrop(currentWorkingDirectory);
+				dbTemp.databaseDrop( currentWorkingDirectory, out );
 			}
 
 
@@ -526,7 +448,7 @@ bool startEvent( string input, vector< Database> &dbms, string currentWorkingDir
 				removeTable( dbms, dbReturn, tblReturn );
 
 				//remove table/file
-				tblTemp.tableDrop(currentWorkingDirectory, currentDatabase );
+				tblTemp.tableDrop( currentWorkingDirectory, currentDatabase, out );
 			}
 		}
 		else
@@ -539,6 +461,7 @@ bool startEvent( string input, vector< Database> &dbms, string currentWorkingDir
 	else if( actionType.compare( ALTER ) == 0 ) 
 	{
 		containerType = getNextWord( input );
+		convertToUC( containerType );
 		if( containerType == TABLE_TYPE )
 		{
 			//call alter tbl function
@@ -560,126 +483,181 @@ bool startEvent( string input, vector< Database> &dbms, string currentWorkingDir
 			else
 			{
 				//remove table/file
-				tblTemp.tableAlter( currentWorkingDirectory, currentDatabase, input, attrError );	
+				tblTemp.tableAlter( currentWorkingDirectory, currentDatabase, input, attrError, out );	
 			}
 		}
-	}
-	else if( actionType.compare( INSERT ) == 0 )
-	{
-		temp = getNextWord( input );
-		//check that temp is into
-		if( temp != "into" )
+		else
 		{
 			errorExists = true;
 			errorType = ERROR_INCORRECT_COMMAND;
-			errorContainerName = originalInput;	
+			errorContainerName = originalInput;
 		}
+	}
+	else if( actionType.compare( EXIT ) == 0 )
+	{
+		exitProgram = true;
+	}
+	else
+	{
+		errorExists = true;
+		errorType = ERROR_INCORRECT_COMMAND;
+		errorContainerName = originalInput;
+	}
 
-		//check that current db exists
-		Database dbTemp;
-		dbTemp.databaseName = currentDatabase;
-		databaseExists( dbms, dbTemp, dbReturn );
+	if( errorExists )
+	{
+		handleError( errorType, actionType, errorContainerName, out );
+	}
+	if( errorExists || attrError )
+	{
+		errorCode = true;
+	}
 
-		//get table 
-		Table tblTemp;
-		tblTemp.tableName = getNextWord( input );
+	return exitProgram;
+}
 
+/**
+ * @brief prepareStatement
+ *
+ * @details parses a SELECT, INSERT, UPDATE or DELETE and resolves it
+ *          
+ * @pre dbms exists
+ *
+ * @post prepared holds the table, attribute indexes, conditions and the
+ *       positions of any ? parameters
+ *
+ * @par Algorithm 
+ *      split the statement into its clauses the same way for every
+ *      execution, check the table exists, then read the attribute line once
+ *      to resolve the queried attributes and the where and set conditions
+ *      
+ * @exception None
+ *
+ * @param [in] input provides the statement text
+ *
+ * @param [in] dbms provides system of database to look the table up in
+ *
+ * @param [out] prepared provides the parsed statement
+ *
+ * @param [out] errorType provides the error if the statement is not valid
+ *
+ * @param [out] errorContainerName provides error source
+ *
+ * @return bool true if the statement was prepared
+ *
+ * @note None
+ */
+bool prepareStatement( string input, vector< Database > &dbms, string currentWorkingDirectory, string currentDatabase, PreparedStatement &prepared, int &errorType, string &errorContainerName )
+{
+	int dbReturn;
+	int tblReturn;
+	string originalInput = input;
+	string whereType;
+	string setType;
+	string queryType;
+	string tableName;
 
-		//check if table exists
-		if( !(dbms[ dbReturn ].tableExists( tblTemp.tableName, tblReturn )) )
-		{
-			//if it doesnt exist then return error
-			errorExists = true;
-			errorType = ERROR_TBL_NOT_EXISTS;
-			errorContainerName = tblTemp.tableName;
-		}
-		else if( !errorExists )
-		{
-			//table exists and we can modify it
-			//return only stuff between parentheses
-			input.erase( 0, input.find( "(" ) + 1 );
-			input.erase( input.find_last_of( ")" ), input.length()-1 );
+	//get first action word & convert to uppercase
+	string temp = getNextWord( input );
+	convertToUC( temp );
+	prepared.actionType = temp;
+	prepared.statementText = originalInput;
+	prepared.parameters.clear();
 
-			tblTemp.tableInsert( currentWorkingDirectory, currentDatabase, tblTemp.tableName, input, attrError );
-		}	
+	if( prepared.actionType == SELECT )
+	{
+		//get all words before from, then the table and the condition
+		queryType = getQueryType( input );
+		tableName = getNextWord( input );
+		whereType = getWhereCondition( input );
 	}
-	else if( actionType.compare( UPDATE ) == 0 )
+	else if( prepared.actionType == INSERT )
 	{
-		//get index of curr DB
-		Database dbTemp;
-		dbTemp.databaseName = currentDatabase;
-		databaseExists( dbms, dbTemp, dbReturn );
-
-		//get table name
-		Table tblTemp;
-		tblTemp.tableName = getNextWord( input );
-		
-		//get where condition
-		string wCond = getWhereCondition( input );
-
-		//get set condition
-		string sCond = getSetCondition( input );
-	
-		//check if table exists
-		if( !(dbms[ dbReturn ].tableExists( tblTemp.tableName, tblReturn )) )
-		{
-			//if it doesnt exist then return error
-			errorExists = true;
-			errorType = ERROR_TBL_NOT_EXISTS;
-			errorContainerName = tblTemp.tableName;
-		}
-		else
+		//check that temp is into
+		temp = getNextWord( input );
+		if( temp != "into" )
 		{
-			//update values
-			tblTemp.tableUpdate( currentWorkingDirectory, currentDatabase, wCond, sCond );
+			errorType = ERROR_INCORRECT_COMMAND;
+			errorContainerName = originalInput;
+			return false;
 		}
+		tableName = getNextWord( input );
 	}
-	else if( actionType.compare( DELETE ) == 0 )
+	else if( prepared.actionType == UPDATE )
 	{
-		//get index of curr DB
-		Database dbTemp;
-		dbTemp.databaseName = currentDatabase;
-		databaseExists( dbms, dbTemp, dbReturn );
-
-		string temp = getQueryType( input );
-		//get table name
-		Table tblTemp;
-		tblTemp.tableName = getNextWord( input );
-
-		//get where condition
-		string wCond = getWhereCondition( input );
-	
-		//check if table exists
-		if( !(dbms[ dbReturn ].tableExists( tblTemp.tableName, tblReturn )) )
-		{
-			//if it doesnt exist then return error
-			errorExists = true;
-			errorType = ERROR_TBL_NOT_EXISTS;
-			errorContainerName = tblTemp.tableName;
-		}
-		else
-		{
-			//update values
-			tblTemp.tableDelete( currentWorkingDirectory, currentDatabase, wCond );
-		}
+		tableName = getNextWord( input );
+		whereType = getWhereCondition( input );
+		setType = getSetCondition( input );
 	}
-	else if( actionType.compare( EXIT ) == 0 )
+	else if( prepared.actionType == DELETE )
 	{
-		exitProgram = true;
+		getQueryType( input );
+		tableName = getNextWord( input );
+		whereType = getWhereCondition( input );
 	}
 	else
 	{
-		errorExists = true;
 		errorType = ERROR_INCORRECT_COMMAND;
 		errorContainerName = originalInput;
+		return false;
 	}
 
-	if( errorExists )
+	//check if table exists in the current database
+	Database dbTemp;
+	dbTemp.databaseName = currentDatabase;
+	if( !databaseExists( dbms, dbTemp, dbReturn ) || !( dbms[ dbReturn ].tableExists( tableName, tblReturn ) ) )
+	{
+		errorType = ERROR_TBL_NOT_EXISTS;
+		errorContainerName = tableName;
+		return false;
+	}
+
+	prepared.table.tableName = tableName;
+	prepared.scan.scanOpen( currentWorkingDirectory + "/" + dbms[ dbReturn ].databaseName + "/" + tableName );
+	getWhereCondition( prepared.wCond, whereType, prepared.scan.attributes );
+
+	if( prepared.actionType == SELECT )
 	{
-		handleError( errorType, actionType, errorContainerName );
+		prepared.projection = getProjection( prepared.scan.attributes, queryType );
+	}
+	else if( prepared.actionType == INSERT )
+	{
+		//return only stuff between parentheses
+		input.erase( 0, input.find( "(" ) + 1 );
+		input.erase( input.find_last_of( ")" ), input.length()-1 );
+		//values are kept in the order records are stored in
+		prepared.insertValues = prepared.scan.storeRow( getInsertValues( input ) );
+	}
+	else if( prepared.actionType == UPDATE )
+	{
+		getSetCondition( prepared.sCond, setType, prepared.scan.attributes );
 	}
 
-	return exitProgram;
+	//record where the parameters go, in the order they appear
+	ParameterSlot slot;
+	int valueSize = prepared.insertValues.size();
+	for( int index = 0; index < valueSize; index++ )
+	{
+		if( prepared.insertValues[ index ] == PARAMETER_MARKER )
+		{
+			slot.slotType = PARAM_INSERT;
+			slot.valueIndex = index;
+			prepared.parameters.push_back( slot );
+		}
+	}
+	if( prepared.actionType == UPDATE && prepared.sCond.newValue == PARAMETER_MARKER )
+	{
+		slot.slotType = PARAM_SET;
+		slot.valueIndex = 0;
+		prepared.parameters.push_back( slot );
+	}
+	if( prepared.wCond.comparisonValue == PARAMETER_MARKER )
+	{
+		slot.slotType = PARAM_WHERE;
+		slot.valueIndex = 0;
+		prepared.parameters.push_back( slot );
+	}
+	return true;
 }
 
 /**
@@ -752,7 +730,7 @@ void removeTable( vector< Database > &dbms, int dbReturn, int tblReturn )
  *
  * @note None
  */
-void handleError( int errorType, string commandError, string errorContainerName )
+void handleError( int errorType, string commandError, string errorContainerName, ostream &out )
 {
 
 	if( commandError == "SELECT" )
@@ -765,32 +743,32 @@ void handleError( int errorType, string commandError, string errorContainerName
 	// if problem is that databse does exist (used for create db )
 	if( errorType == ERROR_DB_EXISTS )
 	{
-		cout << "-- !Failed to " << commandError << " database " << errorContainerName;
-		cout << " because it already exists." << endl;
+		out << "-- !Failed to " << commandError << " database " << errorContainerName;
+		out << " because it already exists." << endl;
 	}
 	//if problem is that database does not exist ( used for use, drop)
 	else if( errorType == ERROR_DB_NOT_EXISTS )
 	{
-		cout << "-- !Failed to " << commandError << " database " << errorContainerName;
-		cout << " because it does not exist." << endl;
+		out << "-- !Failed to " << commandError << " database " << errorContainerName;
+		out << " because it does not exist." << endl;
 	}
 	//if problem is that table exists ( used for create table)
 	else if( errorType == ERROR_TBL_EXISTS )
 	{
-		cout << "-- !Failed to " << commandError << " table " << errorContainerName;
-		cout << " because it already exists." << endl;
+		out << "-- !Failed to " << commandError << " table " << errorContainerName;
+		out << " because it already exists." << endl;
 	}
 	//if problem is that table does not exist( used for alter, select, drop )
 	else if( errorType == ERROR_TBL_NOT_EXISTS )
 	{
-		cout << "-- !Failed to " << commandError << " table " << errorContainerName;
-		cout << " because it does not exist." << endl;
+		out << "-- !Failed to " << commandError << " table " << errorContainerName;
+		out << " because it does not exist." << endl;
 	}
 	//if problem is that an unrecognized error occurs
 	else if( errorType == ERROR_INCORRECT_COMMAND )
 	{
-		cout << "-- !Failed to complete command. "<< endl;
-		cout << "-- !Incorrect instruction: " << errorContainerName << endl;
+		out << "-- !Failed to complete command. "<< endl;
+		out << "-- !Incorrect instruction: " << errorContainerName << endl;
 	}
 }
 
@@ -909,7 +887,7 @@ string getWhereCondition( string &input )
 			( input[ index + 1 ] == 'h' || input[ index + 1 ] == 'H' ) && 
 			( input[ index + 2 ] == 'e' || input[ index + 2 ] == 'E' ) &&
 			( input[ index + 3 ] == 'r' || input[ index + 3] == 'R' ) && 
-			( input[ index + 4 ] == 'e' || input[ index + 3] == 'E' ))
+			( input[ index + 4 ] == 'e' || input[ index + 4 ] == 'E' ))
 		{
 			whereOccurs = true;
 			whereOccurance = index;
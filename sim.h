@@ -0,0 +1,28 @@
+// Program Information ////////////////////////////////////////////////////////
+/**
+ * @file sim.h
+ *
+ * @brief Definition file for the simulation functions
+ *
+ * @details Specifies the command line front end, which reads statements
+ *          from standard input and runs them on a Connection, and server mode
+ *
+ * @Note Link against libdbms.a
+ */
+
+#include <string>
+#include "Connection.h"
+#include "Server.h"
+#include "ThreadPool.h"
+#include "CommitLog.h"
+
+using namespace std;
+
+// Precompiler directives /////////////////////////////////////////////////////
+#ifndef SIM_H
+#define SIM_H
+
+void startSimulation( string currentWorkingDirectory );
+
+// Terminating precompiler directives  ////////////////////////////////////////
+#endif